@@ -0,0 +1,65 @@
+#pragma once
+
+#include <stdint.h>
+#include <functional>
+#include <initializer_list>
+
+typedef struct _BENCH_CONTEXT
+{
+    const char *filter;
+    uint64_t minTimeNs;
+    uint32_t samples;
+    uint32_t emitted;
+} BENCH_CONTEXT;
+
+typedef struct _BENCH_RESULT
+{
+    uint64_t iterations;
+    double nsPerOp;
+    double medianNsPerOp;
+    double bytesPerSecond;
+} BENCH_RESULT;
+
+typedef struct _BENCH_COUNTER
+{
+    const char *name;
+    double value;
+} BENCH_COUNTER;
+
+bool benchSelected(const BENCH_CONTEXT *ctx, const char *name);
+BENCH_RESULT benchMeasure(
+    const BENCH_CONTEXT *ctx,
+    uint64_t bytesPerOp,
+    const std::function<void(uint64_t)> &fn);
+void benchEmit(
+    BENCH_CONTEXT *ctx,
+    const char *name,
+    const BENCH_RESULT *result,
+    std::initializer_list<BENCH_COUNTER> counters = {});
+void *benchAlloc(size_t size);
+void benchFree(void *ptr);
+
+// keeps the optimizer from dropping work whose result is otherwise unused
+template <typename T>
+inline void benchKeep(T const &value)
+{
+    asm volatile(""
+                 :
+                 : "r,m"(value)
+                 : "memory");
+}
+
+void benchCodec(BENCH_CONTEXT *ctx);
+void benchCompositor(BENCH_CONTEXT *ctx);
+void benchFollow(BENCH_CONTEXT *ctx);
+void benchFrame(BENCH_CONTEXT *ctx);
+void benchGovernor(BENCH_CONTEXT *ctx);
+void benchHud(BENCH_CONTEXT *ctx);
+void benchPixel(BENCH_CONTEXT *ctx);
+void benchPool(BENCH_CONTEXT *ctx);
+void benchProcscan(BENCH_CONTEXT *ctx);
+void benchSampler(BENCH_CONTEXT *ctx);
+void benchScale(BENCH_CONTEXT *ctx);
+void benchText(BENCH_CONTEXT *ctx);
+void benchTexture(BENCH_CONTEXT *ctx);
+void benchDevice(BENCH_CONTEXT *ctx);
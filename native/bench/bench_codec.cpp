@@ -0,0 +1,168 @@
+#include <stdio.h>
+#include <string.h>
+#include "../src/codec.h"
+#include "../src/frame.h"
+#include "bench.h"
+
+typedef enum _BENCH_CONTENT
+{
+    BENCH_CONTENT_UI = 0, // flat panels, text-like edges, soft gradient
+    BENCH_CONTENT_NOISE,
+    BENCH_CONTENT_COUNT
+} BENCH_CONTENT;
+
+static const char *contentNames_[BENCH_CONTENT_COUNT] = {"ui", "noise"};
+
+static void benchCodecFill(uint8_t *frame, BENCH_CONTENT content, uint32_t seed)
+{
+    auto pixels = (uint32_t *)frame;
+    auto state = seed * 2654435761u + 1;
+
+    for (uint32_t y = 0; y < FRAME_HEIGHT; ++y)
+    {
+        for (uint32_t x = 0; x < FRAME_WIDTH; ++x)
+        {
+            uint32_t pixel;
+
+            if (content == BENCH_CONTENT_NOISE)
+            {
+                state = state * 1664525u + 1013904223u;
+                pixel = state;
+            }
+            else if (y < 48)
+            {
+                pixel = 0xf0000000u | (0x30 + y) * 0x010101u; // header gradient
+            }
+            else if ((x / 8 + y / 16 + seed) % 7 == 0 && (y % 16) < 12)
+            {
+                pixel = 0xffe0e0e0u; // "glyphs"
+            }
+            else
+            {
+                pixel = (x / 128 + y / 128) % 2 != 0 ? 0xe0202020u : 0xe0282828u;
+            }
+
+            pixels[y * FRAME_WIDTH + x] = pixel;
+        }
+    }
+}
+
+void benchCodec(BENCH_CONTEXT *ctx)
+{
+    auto frame = (uint8_t *)benchAlloc(FRAME_SIZE);
+    auto next = (uint8_t *)benchAlloc(FRAME_SIZE);
+    auto out = (uint8_t *)benchAlloc(frameCodecBound(FRAME_WIDTH, FRAME_HEIGHT));
+
+    FRAME_CODEC encoder;
+    FRAME_CODEC decoder;
+    frameCodecInit(&encoder);
+    frameCodecInit(&decoder);
+
+    char name[128];
+
+    for (uint32_t content = 0; content < BENCH_CONTENT_COUNT; ++content)
+    {
+        benchCodecFill(frame, (BENCH_CONTENT)content, 0);
+
+        // keyframe: whole frame against an empty reference
+        snprintf(name, sizeof(name), "frameEncode/key/%s", contentNames_[content]);
+        if (benchSelected(ctx, name) != false)
+        {
+            uint32_t size = 0;
+            auto result = benchMeasure(
+                ctx,
+                FRAME_SIZE,
+                [&](uint64_t iterations)
+                {
+                    for (uint64_t i = 0; i < iterations; ++i)
+                    {
+                        frameCodecReset(&encoder);
+                        size = frameEncode(&encoder, out, frame, 0, 0, FRAME_WIDTH, FRAME_HEIGHT);
+                        benchKeep(out);
+                    }
+                });
+            benchEmit(
+                ctx,
+                name,
+                &result,
+                {{"framesPerSecond", 1e9 / result.nsPerOp},
+                 {"ratio", (double)size / FRAME_SIZE}});
+        }
+
+        snprintf(name, sizeof(name), "frameDecode/key/%s", contentNames_[content]);
+        if (benchSelected(ctx, name) != false)
+        {
+            frameCodecReset(&encoder);
+            auto size = frameEncode(&encoder, out, frame, 0, 0, FRAME_WIDTH, FRAME_HEIGHT);
+
+            auto result = benchMeasure(
+                ctx,
+                FRAME_SIZE,
+                [&](uint64_t iterations)
+                {
+                    for (uint64_t i = 0; i < iterations; ++i)
+                    {
+                        frameCodecReset(&decoder);
+                        benchKeep(frameDecode(&decoder, out, size, 0, 0, FRAME_WIDTH, FRAME_HEIGHT));
+                    }
+                });
+            benchEmit(ctx, name, &result, {{"framesPerSecond", 1e9 / result.nsPerOp}});
+        }
+    }
+
+    // delta: alternate between two UI frames that differ in the "text" only
+    benchCodecFill(frame, BENCH_CONTENT_UI, 0);
+    benchCodecFill(next, BENCH_CONTENT_UI, 1);
+
+    if (benchSelected(ctx, "frameEncode/delta/ui") != false)
+    {
+        uint32_t size = 0;
+        auto result = benchMeasure(
+            ctx,
+            FRAME_SIZE,
+            [&](uint64_t iterations)
+            {
+                for (uint64_t i = 0; i < iterations; ++i)
+                {
+                    size = frameEncode(
+                        &encoder,
+                        out,
+                        (i & 1) != 0 ? next : frame,
+                        0,
+                        0,
+                        FRAME_WIDTH,
+                        FRAME_HEIGHT);
+                    benchKeep(out);
+                }
+            });
+        benchEmit(
+            ctx,
+            "frameEncode/delta/ui",
+            &result,
+            {{"framesPerSecond", 1e9 / result.nsPerOp},
+             {"ratio", (double)size / FRAME_SIZE}});
+    }
+
+    if (benchSelected(ctx, "frameEncode/unchanged") != false)
+    {
+        frameEncode(&encoder, out, frame, 0, 0, FRAME_WIDTH, FRAME_HEIGHT);
+
+        auto result = benchMeasure(
+            ctx,
+            FRAME_SIZE,
+            [&](uint64_t iterations)
+            {
+                for (uint64_t i = 0; i < iterations; ++i)
+                {
+                    benchKeep(frameEncode(&encoder, out, frame, 0, 0, FRAME_WIDTH, FRAME_HEIGHT));
+                }
+            });
+        benchEmit(ctx, "frameEncode/unchanged", &result, {{"framesPerSecond", 1e9 / result.nsPerOp}});
+    }
+
+    frameCodecExit(&decoder);
+    frameCodecExit(&encoder);
+    benchFree(out);
+    benchFree(next);
+    benchFree(frame);
+}
@@ -0,0 +1,100 @@
+#include <stdio.h>
+#include <string.h>
+#include "../src/compositor.h"
+#include "../src/frame.h"
+#include "bench.h"
+
+void benchCompositor(BENCH_CONTEXT *ctx)
+{
+    auto data = (uint8_t *)benchAlloc(FRAME_SIZE);
+    auto page = (uint8_t *)benchAlloc(FRAME_SIZE);
+    auto rgba = (uint8_t *)benchAlloc(64 * 64 * 4);
+
+    for (uint32_t i = 0; i < FRAME_SIZE; ++i)
+    {
+        page[i] = (uint8_t)(i * 2654435761u >> 24);
+    }
+
+    for (uint32_t i = 0; i < 64 * 64 * 4; ++i)
+    {
+        rgba[i] = (uint8_t)(i * 40503u >> 8);
+    }
+
+    memset(data, 0, FRAME_SIZE);
+
+    OVERLAY_DATA overlayData;
+    overlayDataInit(&overlayData, data);
+    overlayDataWrite(&overlayData, page, 0, 0, FRAME_WIDTH, FRAME_HEIGHT);
+
+    // a toast and a few icons over the page
+    SPRITE_PROPS props = {16, 400, 1, 255, true};
+    auto toast = compositorCreateSprite(&overlayData, rgba, 64, 64, &props);
+    for (int32_t i = 0; i < 4; ++i)
+    {
+        props = {400 + i * 24, 16, 0, 255, true};
+        compositorCreateSprite(&overlayData, rgba, 16, 16, &props);
+    }
+
+    // what replaces a chromium repaint: move and fade one sprite
+    if (benchSelected(ctx, "compositorUpdateSprite/move") != false)
+    {
+        auto result = benchMeasure(
+            ctx,
+            64 * 64 * 4,
+            [&](uint64_t iterations)
+            {
+                for (uint64_t i = 0; i < iterations; ++i)
+                {
+                    props = {16 + (int32_t)(i & 63), 400, 1, 255, true};
+                    compositorUpdateSprite(&overlayData, toast, &props);
+                    overlayData.dirty.exchange(false);
+                }
+            });
+        benchEmit(ctx, "compositorUpdateSprite/move", &result);
+    }
+
+    if (benchSelected(ctx, "compositorUpdateSprite/fade") != false)
+    {
+        auto result = benchMeasure(
+            ctx,
+            64 * 64 * 4,
+            [&](uint64_t iterations)
+            {
+                for (uint64_t i = 0; i < iterations; ++i)
+                {
+                    props = {16, 400, 1, (uint8_t)i, true};
+                    compositorUpdateSprite(&overlayData, toast, &props);
+                    overlayData.dirty.exchange(false);
+                }
+            });
+        benchEmit(ctx, "compositorUpdateSprite/fade", &result);
+    }
+
+    // the page still repaints under the sprites
+    if (benchSelected(ctx, "compositorWritePage/full") != false)
+    {
+        auto result = benchMeasure(
+            ctx,
+            FRAME_SIZE,
+            [&](uint64_t iterations)
+            {
+                for (uint64_t i = 0; i < iterations; ++i)
+                {
+                    overlayDataWrite(&overlayData, page, 0, 0, FRAME_WIDTH, FRAME_HEIGHT);
+                    overlayData.dirty.exchange(false);
+                }
+            });
+        benchEmit(ctx, "compositorWritePage/full", &result);
+    }
+
+    while (overlayData.compositor != NULL)
+    {
+        compositorDestroySprite(
+            &overlayData,
+            overlayData.compositor->sprites[overlayData.compositor->order[0]].id);
+    }
+
+    benchFree(rgba);
+    benchFree(page);
+    benchFree(data);
+}
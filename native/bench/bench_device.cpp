@@ -0,0 +1,202 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <stdio.h>
+#include "../src/device.h"
+#include "../src/platform.h"
+#include "bench.h"
+
+#define BENCH_DEVICE_COUNT 16 // HMD, 2 controllers, trackers, base stations
+
+static void benchDeviceFill(VR_DEVICE_TABLE *table, uint32_t seed)
+{
+    // same write pattern as overlayUpdateTrackedDevices()
+    table->count = 0;
+
+    for (uint32_t i = 0; i < BENCH_DEVICE_COUNT; ++i)
+    {
+        auto deviceData = &table->data[table->count++];
+        deviceData->deviceClass = i == 0
+                                      ? vr::TrackedDeviceClass_HMD
+                                  : i < 3 ? vr::TrackedDeviceClass_Controller
+                                          : vr::TrackedDeviceClass_GenericTracker;
+        deviceData->isConnected = true;
+        deviceData->isCharging = ((seed + i) & 7) == 0;
+        deviceData->batteryPercentage = (float)((seed + i) % 100) / 100.0f;
+        deviceData->controllerRole = vr::TrackedControllerRole_Invalid;
+        deviceData->buttonPressedMask = seed;
+        deviceData->buttonTouchedMask = seed >> 1;
+    }
+}
+
+static uint32_t benchDeviceMarshal(
+    VR_DEVICE_TABLE *table,
+    VR_DEVICE_DATA *local,
+    double *values)
+{
+    // getVRDeviceList() minus the V8 object creation, which needs a live
+    // napi_env and cannot run in a standalone executable
+    auto count = deviceTableSnapshot(table, local);
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        auto deviceData = &local[i];
+        auto v = &values[i * 7];
+        v[0] = deviceData->deviceClass;
+        v[1] = deviceData->isConnected;
+        v[2] = deviceData->isCharging;
+        v[3] = deviceData->batteryPercentage;
+        v[4] = deviceData->controllerRole;
+        v[5] = (double)deviceData->buttonPressedMask;
+        v[6] = (double)deviceData->buttonTouchedMask;
+    }
+
+    return count;
+}
+
+static void benchDeviceContended(BENCH_CONTEXT *ctx, uint32_t readerCount)
+{
+    char name[128];
+    snprintf(name, sizeof(name), "deviceTableSnapshot/contended/readers=%u", readerCount);
+    if (benchSelected(ctx, name) == false)
+    {
+        return;
+    }
+
+    static VR_DEVICE_TABLE table;
+    benchDeviceFill(&table, 0);
+
+    std::atomic<bool> isRunning{true};
+    std::atomic<uint64_t> writerUpdates{0};
+    std::atomic<uint64_t> writerSkips{0};
+    std::vector<std::thread> threads;
+
+    // the overlay thread: try_lock and skip the update when a reader holds it
+    threads.emplace_back(
+        [&]()
+        {
+            uint32_t seed = 0;
+            while (isRunning.load(std::memory_order_relaxed) != false)
+            {
+                if (table.lock.try_lock() != false)
+                {
+                    benchDeviceFill(&table, ++seed);
+                    table.lock.unlock();
+                    writerUpdates.fetch_add(1, std::memory_order_relaxed);
+                }
+                else
+                {
+                    writerSkips.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        });
+
+    // extra readers besides the measuring thread
+    for (uint32_t i = 1; i < readerCount; ++i)
+    {
+        threads.emplace_back(
+            [&]()
+            {
+                VR_DEVICE_DATA local[vr::k_unMaxTrackedDeviceCount];
+                while (isRunning.load(std::memory_order_relaxed) != false)
+                {
+                    benchKeep(deviceTableSnapshot(&table, local));
+                }
+            });
+    }
+
+    VR_DEVICE_DATA local[vr::k_unMaxTrackedDeviceCount];
+    auto startNs = platformNowNs();
+
+    auto result = benchMeasure(
+        ctx,
+        sizeof(VR_DEVICE_DATA) * BENCH_DEVICE_COUNT,
+        [&](uint64_t iterations)
+        {
+            for (uint64_t i = 0; i < iterations; ++i)
+            {
+                benchKeep(deviceTableSnapshot(&table, local));
+            }
+        });
+
+    auto elapsedNs = platformNowNs() - startNs;
+    isRunning.store(false, std::memory_order_relaxed);
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    auto updates = (double)writerUpdates.load();
+    auto skips = (double)writerSkips.load();
+
+    benchEmit(
+        ctx,
+        name,
+        &result,
+        {{"writerUpdatesPerSecond", updates * 1e9 / (double)elapsedNs},
+         {"writerSkipRatio", updates + skips != 0 ? skips / (updates + skips) : 0.0}});
+}
+
+void benchDevice(BENCH_CONTEXT *ctx)
+{
+    static VR_DEVICE_TABLE table;
+    benchDeviceFill(&table, 1);
+
+    if (benchSelected(ctx, "deviceTableSnapshot/uncontended") != false)
+    {
+        VR_DEVICE_DATA local[vr::k_unMaxTrackedDeviceCount];
+
+        auto result = benchMeasure(
+            ctx,
+            sizeof(VR_DEVICE_DATA) * BENCH_DEVICE_COUNT,
+            [&](uint64_t iterations)
+            {
+                for (uint64_t i = 0; i < iterations; ++i)
+                {
+                    benchKeep(deviceTableSnapshot(&table, local));
+                }
+            });
+        benchEmit(ctx, "deviceTableSnapshot/uncontended", &result);
+    }
+
+    if (benchSelected(ctx, "overlayUpdateTrackedDevices/write") != false)
+    {
+        uint32_t seed = 0;
+
+        auto result = benchMeasure(
+            ctx,
+            sizeof(VR_DEVICE_DATA) * BENCH_DEVICE_COUNT,
+            [&](uint64_t iterations)
+            {
+                for (uint64_t i = 0; i < iterations; ++i)
+                {
+                    table.lock.lock();
+                    benchDeviceFill(&table, ++seed);
+                    table.lock.unlock();
+                }
+            });
+        benchEmit(ctx, "overlayUpdateTrackedDevices/write", &result);
+    }
+
+    if (benchSelected(ctx, "getVRDeviceList/marshal") != false)
+    {
+        VR_DEVICE_DATA local[vr::k_unMaxTrackedDeviceCount];
+        double values[vr::k_unMaxTrackedDeviceCount * 7];
+
+        auto result = benchMeasure(
+            ctx,
+            0,
+            [&](uint64_t iterations)
+            {
+                for (uint64_t i = 0; i < iterations; ++i)
+                {
+                    benchKeep(benchDeviceMarshal(&table, local, values));
+                    benchKeep(values);
+                }
+            });
+        benchEmit(ctx, "getVRDeviceList/marshal", &result);
+    }
+
+    benchDeviceContended(ctx, 1);
+    benchDeviceContended(ctx, 3);
+}
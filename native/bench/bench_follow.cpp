@@ -0,0 +1,59 @@
+#include <math.h>
+#include "../src/follow.h"
+#include "bench.h"
+
+void benchFollow(BENCH_CONTEXT *ctx)
+{
+    // added to every overlay thread poll, 10ms apart
+    if (benchSelected(ctx, "followUpdate") != false)
+    {
+        FOLLOW_CONFIG config;
+        followDefaultConfig(&config);
+
+        FOLLOW follow = {};
+        followInit(&follow, &config);
+
+        const float offset[12] = {
+            1.0f, 0.0f, 0.0f, 0.0f,
+            0.0f, 1.0f, 0.0f, -0.1f,
+            0.0f, 0.0f, 1.0f, -1.0f};
+
+        uint64_t nowNs = 0;
+        uint64_t submits = 0;
+        float hmd[12];
+        float transform[12];
+
+        auto result = benchMeasure(
+            ctx,
+            0,
+            [&](uint64_t iterations)
+            {
+                for (uint64_t i = 0; i < iterations; ++i)
+                {
+                    nowNs += 10000000ull;
+
+                    // looking around: a slow sway with the odd glance aside
+                    auto yaw = 0.2f * sinf((float)(i % 6283) * 0.001f) +
+                               ((i & 2047) < 300 ? 0.6f : 0.0f);
+                    auto c = cosf(yaw);
+                    auto s = sinf(yaw);
+                    const float pose[12] = {
+                        c, 0.0f, s, 0.0f,
+                        0.0f, 1.0f, 0.0f, 1.6f,
+                        -s, 0.0f, c, 0.0f};
+                    for (uint32_t j = 0; j < 12; ++j)
+                    {
+                        hmd[j] = pose[j];
+                    }
+
+                    submits += followUpdate(&follow, hmd, offset, nowNs, transform);
+                    benchKeep(transform);
+                }
+            });
+        benchEmit(
+            ctx,
+            "followUpdate",
+            &result,
+            {{"submitsPerOp", (double)submits / (double)result.iterations}});
+    }
+}
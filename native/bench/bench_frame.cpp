@@ -0,0 +1,132 @@
+#include <stdio.h>
+#include <string.h>
+#include "../src/frame.h"
+#include "bench.h"
+
+typedef struct _FRAME_RECT_CASE
+{
+    const char *name;
+    uint32_t x;
+    uint32_t y;
+    uint32_t width;
+    uint32_t height;
+} FRAME_RECT_CASE;
+
+// shapes seen from Chromium's paint events plus a few worst cases
+static const FRAME_RECT_CASE rectCases_[] = {
+    {"full", 0, 0, FRAME_WIDTH, FRAME_HEIGHT},
+    {"bottom", 0, 106, FRAME_WIDTH, 406},
+    {"half", 0, 0, FRAME_WIDTH / 2, FRAME_HEIGHT},
+    {"column", 100, 0, 16, FRAME_HEIGHT},
+    {"row", 0, 200, FRAME_WIDTH, 1},
+    {"tile64", 200, 200, 64, 64},
+    {"glyph", 301, 17, 9, 16}};
+
+void benchFrame(BENCH_CONTEXT *ctx)
+{
+    auto source = (uint8_t *)benchAlloc(FRAME_SIZE);
+    auto target = (uint8_t *)benchAlloc(FRAME_SIZE);
+
+    for (uint32_t i = 0; i < FRAME_SIZE; ++i)
+    {
+        source[i] = (uint8_t)(i * 2654435761u >> 24);
+    }
+
+    char name[128];
+
+    for (auto &rect : rectCases_)
+    {
+        snprintf(name, sizeof(name), "copyFrameBuffer/%s", rect.name);
+        if (benchSelected(ctx, name) == false)
+        {
+            continue;
+        }
+
+        auto result = benchMeasure(
+            ctx,
+            rect.width * rect.height * 4ull,
+            [&](uint64_t iterations)
+            {
+                for (uint64_t i = 0; i < iterations; ++i)
+                {
+                    copyFrameBuffer(
+                        target,
+                        source,
+                        rect.x,
+                        rect.y,
+                        rect.width,
+                        rect.height);
+                    benchKeep(target);
+                }
+            });
+        benchEmit(ctx, name, &result);
+    }
+
+    OVERLAY_DATA overlayData;
+    memset(target, 0, FRAME_SIZE);
+    overlayDataInit(&overlayData, target);
+
+    for (auto &rect : rectCases_)
+    {
+        snprintf(name, sizeof(name), "overlayDataWrite/%s", rect.name);
+        if (benchSelected(ctx, name) == false)
+        {
+            continue;
+        }
+
+        auto result = benchMeasure(
+            ctx,
+            rect.width * rect.height * 4ull,
+            [&](uint64_t iterations)
+            {
+                for (uint64_t i = 0; i < iterations; ++i)
+                {
+                    if (frameIsValidRect(
+                            rect.x,
+                            rect.y,
+                            rect.width,
+                            rect.height) != false)
+                    {
+                        overlayDataWrite(
+                            &overlayData,
+                            source,
+                            rect.x,
+                            rect.y,
+                            rect.width,
+                            rect.height);
+                    }
+                    overlayData.dirty.exchange(false);
+                }
+            });
+        benchEmit(ctx, name, &result);
+    }
+
+    // tile rescan after a paint, for a frame with nothing drawn (every tile
+    // scanned to the end) and one drawn everywhere (first pixel hits)
+    for (uint32_t filled = 0; filled < 2; ++filled)
+    {
+        auto name = filled != 0 ? "frameUpdateTiles/full/filled" : "frameUpdateTiles/full/empty";
+        if (benchSelected(ctx, name) == false)
+        {
+            continue;
+        }
+
+        memset(target, filled != 0 ? 0xff : 0, FRAME_SIZE);
+
+        auto result = benchMeasure(
+            ctx,
+            FRAME_SIZE,
+            [&](uint64_t iterations)
+            {
+                for (uint64_t i = 0; i < iterations; ++i)
+                {
+                    frameUpdateTiles(&overlayData, 0, 0, FRAME_WIDTH, FRAME_HEIGHT);
+                    benchKeep(overlayData.filledTiles);
+                }
+            });
+        benchEmit(ctx, name, &result);
+    }
+
+    benchFree(target);
+    benchFree(source);
+}
@@ -0,0 +1,41 @@
+#include "../src/governor.h"
+#include "bench.h"
+
+void benchGovernor(BENCH_CONTEXT *ctx)
+{
+    // added to every overlay thread poll, 10ms apart
+    if (benchSelected(ctx, "governorUpdate") != false)
+    {
+        GOVERNOR_CONFIG config;
+        governorDefaultConfig(&config);
+
+        GOVERNOR governor;
+        governorInit(&governor, &config, 0, 0);
+
+        uint64_t nowNs = 0;
+        uint32_t damageCount = 0;
+        uint64_t changes = 0;
+
+        auto result = benchMeasure(
+            ctx,
+            0,
+            [&](uint64_t iterations)
+            {
+                for (uint64_t i = 0; i < iterations; ++i)
+                {
+                    nowNs += 10000000ull;
+                    // bursts of animation between quiet stretches
+                    if ((i & 1023) < 300 && (i % 3) == 0)
+                    {
+                        ++damageCount;
+                    }
+                    changes += governorUpdate(&governor, nowNs, damageCount, false, true);
+                }
+            });
+        benchEmit(
+            ctx,
+            "governorUpdate",
+            &result,
+            {{"modeChangesPerOp", (double)changes / (double)result.iterations}});
+    }
+}
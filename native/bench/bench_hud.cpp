@@ -0,0 +1,66 @@
+#include <string.h>
+#include "../src/device.h"
+#include "../src/frame.h"
+#include "../src/hud.h"
+#include "bench.h"
+
+void benchHud(BENCH_CONTEXT *ctx)
+{
+    auto data = (uint8_t *)benchAlloc(FRAME_SIZE);
+    memset(data, 0, FRAME_SIZE);
+
+    OVERLAY_DATA overlayData;
+    overlayDataInit(&overlayData, data);
+
+    static VR_DEVICE_TABLE table;
+    deviceTableFillMock(&table, 0);
+
+    HUD_STATE state;
+    hudStateFromDevices(&state, table.data, table.count);
+
+    HUD hud;
+    SPRITE_PROPS props = {16, 16, 0, 255, true};
+    hudCreate(&overlayData, &hud, &state, &props);
+
+    // added to every overlay thread tick while the hud is on
+    if (benchSelected(ctx, "hudStateFromDevices") != false)
+    {
+        HUD_STATE posted = state;
+
+        auto result = benchMeasure(
+            ctx,
+            sizeof(VR_DEVICE_DATA) * table.count,
+            [&](uint64_t iterations)
+            {
+                for (uint64_t i = 0; i < iterations; ++i)
+                {
+                    hudStateFromDevices(&state, table.data, table.count);
+                    benchKeep(hudStateEquals(&state, &posted));
+                }
+            });
+        benchEmit(ctx, "hudStateFromDevices", &result);
+    }
+
+    // a controller's bar drops one step
+    if (benchSelected(ctx, "hudUpdate/oneCell") != false)
+    {
+        HUD_STATE states[2] = {state, state};
+        states[1].cells[1].level -= 1;
+
+        auto result = benchMeasure(
+            ctx,
+            HUD_CELL_WIDTH * HUD_CELL_HEIGHT * 4,
+            [&](uint64_t iterations)
+            {
+                for (uint64_t i = 0; i < iterations; ++i)
+                {
+                    hudUpdate(&overlayData, &hud, &states[i & 1]);
+                    overlayData.dirty.exchange(false);
+                }
+            });
+        benchEmit(ctx, "hudUpdate/oneCell", &result);
+    }
+
+    hudDestroy(&overlayData, &hud);
+    benchFree(data);
+}
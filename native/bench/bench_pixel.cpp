@@ -0,0 +1,175 @@
+#include <stdio.h>
+#include <string.h>
+#include "../src/frame.h"
+#include "../src/pixel.h"
+#include "bench.h"
+
+typedef struct _PIXEL_OP_CASE
+{
+    const char *name;
+    PIXEL_CONVERT convert;
+} PIXEL_OP_CASE;
+
+static const PIXEL_OP_CASE opCases_[] = {
+    {"swizzle", {PIXEL_OP_SWIZZLE, 0, 255}},
+    {"premultiply", {PIXEL_OP_PREMULTIPLY, 0, 255}},
+    {"unpremultiply", {PIXEL_OP_UNPREMULTIPLY, 0, 255}},
+    {"threshold", {PIXEL_OP_ALPHA_THRESHOLD, 16, 255}},
+    {"opacity", {PIXEL_OP_OPACITY, 0, 192}},
+    {"straightRgba", {PIXEL_OP_OPACITY | PIXEL_OP_UNPREMULTIPLY | PIXEL_OP_SWIZZLE, 0, 192}}};
+
+void benchPixel(BENCH_CONTEXT *ctx)
+{
+    auto source = (uint8_t *)benchAlloc(FRAME_SIZE);
+    auto target = (uint8_t *)benchAlloc(FRAME_SIZE);
+
+    // premultiplied, with a spread of alpha including 0 and 255
+    for (uint32_t i = 0; i < FRAME_SIZE; i += 4)
+    {
+        auto hash = (i / 4) * 2654435761u;
+        uint8_t a = (uint8_t)(hash >> 24);
+        source[i + 0] = (uint8_t)((hash & 0xff) * a / 255);
+        source[i + 1] = (uint8_t)((hash >> 8 & 0xff) * a / 255);
+        source[i + 2] = (uint8_t)((hash >> 16 & 0xff) * a / 255);
+        source[i + 3] = a;
+    }
+
+    char name[128];
+
+    for (uint32_t isa = 0; isa < PIXEL_ISA_COUNT; ++isa)
+    {
+        auto kernel = pixelGetKernel((PIXEL_ISA)isa);
+        if (kernel == NULL)
+        {
+            continue;
+        }
+
+        for (auto &op : opCases_)
+        {
+            snprintf(
+                name,
+                sizeof(name),
+                "pixelConvertRow/%s/%s",
+                pixelIsaName((PIXEL_ISA)isa),
+                op.name);
+            if (benchSelected(ctx, name) == false)
+            {
+                continue;
+            }
+
+            auto result = benchMeasure(
+                ctx,
+                FRAME_SIZE,
+                [&](uint64_t iterations)
+                {
+                    for (uint64_t i = 0; i < iterations; ++i)
+                    {
+                        kernel(target, source, FRAME_WIDTH * FRAME_HEIGHT, &op.convert);
+                        benchKeep(target);
+                    }
+                });
+            benchEmit(ctx, name, &result);
+        }
+    }
+
+    for (uint32_t isa = 0; isa < PIXEL_ISA_COUNT; ++isa)
+    {
+        auto blend = pixelGetBlend((PIXEL_ISA)isa);
+        if (blend == NULL)
+        {
+            continue;
+        }
+
+        snprintf(name, sizeof(name), "pixelBlendRow/%s", pixelIsaName((PIXEL_ISA)isa));
+        if (benchSelected(ctx, name) == false)
+        {
+            continue;
+        }
+
+        auto result = benchMeasure(
+            ctx,
+            FRAME_SIZE,
+            [&](uint64_t iterations)
+            {
+                for (uint64_t i = 0; i < iterations; ++i)
+                {
+                    blend(target, source, FRAME_WIDTH * FRAME_HEIGHT, 192);
+                    benchKeep(target);
+                }
+            });
+        benchEmit(ctx, name, &result);
+    }
+
+    // worst case for the transparency scan: nothing drawn, every row read
+    auto empty = (uint8_t *)benchAlloc(FRAME_SIZE);
+    memset(empty, 0, FRAME_SIZE);
+
+    for (uint32_t isa = 0; isa < PIXEL_ISA_COUNT; ++isa)
+    {
+        auto scan = pixelGetAlphaScan((PIXEL_ISA)isa);
+        if (scan == NULL)
+        {
+            continue;
+        }
+
+        snprintf(name, sizeof(name), "pixelHasAlpha/%s/empty", pixelIsaName((PIXEL_ISA)isa));
+        if (benchSelected(ctx, name) == false)
+        {
+            continue;
+        }
+
+        auto result = benchMeasure(
+            ctx,
+            FRAME_SIZE,
+            [&](uint64_t iterations)
+            {
+                for (uint64_t i = 0; i < iterations; ++i)
+                {
+                    benchKeep(scan(empty, FRAME_STRIDE, FRAME_WIDTH, FRAME_HEIGHT));
+                }
+            });
+        benchEmit(ctx, name, &result);
+    }
+
+    benchFree(empty);
+
+    // fused copy + convert against a copy followed by an in-place pass
+    PIXEL_CONVERT convert = {PIXEL_OP_SWIZZLE | PIXEL_OP_OPACITY, 0, 192};
+
+    if (benchSelected(ctx, "convertFrameBuffer/fused/bottom") != false)
+    {
+        auto result = benchMeasure(
+            ctx,
+            FRAME_STRIDE * 406ull,
+            [&](uint64_t iterations)
+            {
+                for (uint64_t i = 0; i < iterations; ++i)
+                {
+                    convertFrameBuffer(target, source, 0, 106, FRAME_WIDTH, 406, &convert);
+                    benchKeep(target);
+                }
+            });
+        benchEmit(ctx, "convertFrameBuffer/fused/bottom", &result);
+    }
+
+    if (benchSelected(ctx, "convertFrameBuffer/twoPass/bottom") != false)
+    {
+        auto result = benchMeasure(
+            ctx,
+            FRAME_STRIDE * 406ull,
+            [&](uint64_t iterations)
+            {
+                for (uint64_t i = 0; i < iterations; ++i)
+                {
+                    copyFrameBuffer(target, source, 0, 106, FRAME_WIDTH, 406);
+                    auto rect = target + FRAME_STRIDE * 106;
+                    pixelConvertRow(rect, rect, FRAME_WIDTH * 406, &convert);
+                    benchKeep(target);
+                }
+            });
+        benchEmit(ctx, "convertFrameBuffer/twoPass/bottom", &result);
+    }
+
+    benchFree(target);
+    benchFree(source);
+}
@@ -0,0 +1,54 @@
+#include <stdlib.h>
+#include <string.h>
+#include "../src/frame.h"
+#include "../src/pool.h"
+#include "bench.h"
+
+void benchPool(BENCH_CONTEXT *ctx)
+{
+    // what toggling an overlay costs: a zeroed frame buffer comes and goes
+    if (benchSelected(ctx, "poolCycle") != false)
+    {
+        auto result = benchMeasure(
+            ctx,
+            FRAME_SIZE,
+            [&](uint64_t iterations)
+            {
+                for (uint64_t i = 0; i < iterations; ++i)
+                {
+                    auto slot = poolAlloc(true);
+                    benchKeep(slot);
+                    poolFree(slot);
+                }
+            });
+
+        POOL_STATS stats;
+        poolGetStats(&stats);
+        benchEmit(
+            ctx,
+            "poolCycle",
+            &result,
+            {{"reservedBytes", (double)stats.reservedBytes},
+             {"hugePageBytes", (double)stats.hugePageBytes},
+             {"thpBytes", (double)stats.thpBytes},
+             {"reuseRatio", stats.allocCount != 0 ? (double)stats.reuseCount / (double)stats.allocCount : 0.0}});
+    }
+
+    // baseline, the same buffer from the heap
+    if (benchSelected(ctx, "callocCycle") != false)
+    {
+        auto result = benchMeasure(
+            ctx,
+            FRAME_SIZE,
+            [&](uint64_t iterations)
+            {
+                for (uint64_t i = 0; i < iterations; ++i)
+                {
+                    auto ptr = calloc(1, FRAME_SIZE);
+                    benchKeep(ptr);
+                    free(ptr);
+                }
+            });
+        benchEmit(ctx, "callocCycle", &result);
+    }
+}
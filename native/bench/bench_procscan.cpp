@@ -0,0 +1,70 @@
+#include "../src/procscan.h"
+#include "bench.h"
+
+static const char *const names_[] = {"VRChat.exe", "vrserver", "vrcompositor"};
+
+void benchProcscan(BENCH_CONTEXT *ctx)
+{
+    // getRunningApp on a box that's been up a while: every pid is known
+    if (benchSelected(ctx, "procscanUpdate/steady") != false)
+    {
+        PROCSCAN scan;
+        if (procscanInit(&scan, names_, 3) != false)
+        {
+            procscanUpdate(&scan, NULL, NULL);
+            auto openCount = scan.stats.openCount;
+            auto scanCount = scan.stats.scanCount;
+
+            auto result = benchMeasure(
+                ctx,
+                0,
+                [&](uint64_t iterations)
+                {
+                    for (uint64_t i = 0; i < iterations; ++i)
+                    {
+                        procscanUpdate(&scan, NULL, NULL);
+                    }
+                });
+
+            auto scans = scan.stats.scanCount - scanCount;
+            benchEmit(
+                ctx,
+                "procscanUpdate/steady",
+                &result,
+                {{"processes", (double)scan.stats.entryCount},
+                 {"opensPerScan", scans != 0 ? (double)(scan.stats.openCount - openCount) / (double)scans : 0.0}});
+
+            procscanDestroy(&scan);
+        }
+    }
+
+    // baseline, what reading every pid on each call costs
+    if (benchSelected(ctx, "procscanUpdate/cold") != false)
+    {
+        uint32_t processes = 0;
+
+        auto result = benchMeasure(
+            ctx,
+            0,
+            [&](uint64_t iterations)
+            {
+                for (uint64_t i = 0; i < iterations; ++i)
+                {
+                    PROCSCAN scan;
+                    if (procscanInit(&scan, names_, 3) != false)
+                    {
+                        procscanUpdate(&scan, NULL, NULL);
+                        processes = scan.stats.entryCount;
+                        procscanDestroy(&scan);
+                    }
+                }
+            });
+
+        benchEmit(
+            ctx,
+            "procscanUpdate/cold",
+            &result,
+            {{"processes", (double)processes},
+             {"opensPerScan", (double)processes}});
+    }
+}
@@ -0,0 +1,71 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+#include "../src/sampler.h"
+#include "bench.h"
+
+void benchSampler(BENCH_CONTEXT *ctx)
+{
+    // one tick of the sampler thread with one process tracked: three preads
+    // on fds kept open and their parsing
+    if (benchSelected(ctx, "samplerSample") != false)
+    {
+        auto pid = (uint32_t)getpid();
+        samplerTrack(pid, "bench", true);
+
+        auto result = benchMeasure(
+            ctx,
+            0,
+            [&](uint64_t iterations)
+            {
+                for (uint64_t i = 0; i < iterations; ++i)
+                {
+                    samplerSample();
+                }
+            });
+
+        SAMPLER_STATS stats;
+        samplerGetStats(&stats);
+        benchEmit(
+            ctx,
+            "samplerSample",
+            &result,
+            {{"processes", (double)stats.processCount},
+             {"failCount", (double)stats.failCount}});
+
+        samplerTrack(pid, "bench", false);
+    }
+
+    // baseline, opening the three files again for every sample
+    if (benchSelected(ctx, "samplerSample/reopen") != false)
+    {
+        char paths[3][32];
+        const char *files[] = {"stat", "statm", "io"};
+        for (uint32_t i = 0; i < 3; ++i)
+        {
+            snprintf(paths[i], sizeof(paths[i]), "/proc/%u/%s", (uint32_t)getpid(), files[i]);
+        }
+
+        auto result = benchMeasure(
+            ctx,
+            0,
+            [&](uint64_t iterations)
+            {
+                char text[1024];
+                for (uint64_t i = 0; i < iterations; ++i)
+                {
+                    for (auto path : paths)
+                    {
+                        auto fd = open(path, O_RDONLY | O_CLOEXEC);
+                        if (fd >= 0)
+                        {
+                            benchKeep(read(fd, text, sizeof(text)));
+                            close(fd);
+                        }
+                    }
+                }
+            });
+
+        benchEmit(ctx, "samplerSample/reopen", &result);
+    }
+}
@@ -0,0 +1,157 @@
+#include <stdio.h>
+#include <string.h>
+#include "../src/frame.h"
+#include "../src/scale.h"
+#include "bench.h"
+
+typedef struct _SCALE_DERIVE_CASE
+{
+    const char *name;
+    OVERLAY_DERIVE derive;
+} SCALE_DERIVE_CASE;
+
+// wrist-sized placements taken from a full hmd page
+static const SCALE_DERIVE_CASE deriveCases_[] = {
+    {"box2x", {true, 0, {0, 0, 512, 512}, {128, 128, 256, 256}, SCALE_FILTER_BOX}},
+    {"box4x", {true, 0, {0, 0, 512, 512}, {192, 192, 128, 128}, SCALE_FILTER_BOX}},
+    {"bilinear", {true, 0, {0, 0, 512, 512}, {106, 106, 300, 300}, SCALE_FILTER_BILINEAR}},
+    {"bilinearCrop", {true, 0, {0, 256, 512, 256}, {0, 0, 512, 512}, SCALE_FILTER_BILINEAR}}};
+
+void benchScale(BENCH_CONTEXT *ctx)
+{
+    auto source = (uint8_t *)benchAlloc(FRAME_SIZE);
+    auto target = (uint8_t *)benchAlloc(FRAME_SIZE);
+
+    for (uint32_t i = 0; i < FRAME_SIZE; ++i)
+    {
+        source[i] = (uint8_t)(i * 2654435761u >> 24);
+    }
+
+    char name[128];
+
+    for (uint32_t isa = 0; isa < PIXEL_ISA_COUNT; ++isa)
+    {
+        auto kernels = scaleGetKernels((PIXEL_ISA)isa);
+        if (kernels == NULL)
+        {
+            continue;
+        }
+
+        snprintf(name, sizeof(name), "scaleBox2x/%s", pixelIsaName((PIXEL_ISA)isa));
+        if (benchSelected(ctx, name) != false)
+        {
+            auto result = benchMeasure(
+                ctx,
+                FRAME_SIZE,
+                [&](uint64_t iterations)
+                {
+                    for (uint64_t i = 0; i < iterations; ++i)
+                    {
+                        kernels->box2x(target, source, FRAME_WIDTH / 2, FRAME_HEIGHT / 2);
+                        benchKeep(target);
+                    }
+                });
+            benchEmit(ctx, name, &result);
+        }
+
+        snprintf(name, sizeof(name), "scaleBox4x/%s", pixelIsaName((PIXEL_ISA)isa));
+        if (benchSelected(ctx, name) != false)
+        {
+            auto result = benchMeasure(
+                ctx,
+                FRAME_SIZE,
+                [&](uint64_t iterations)
+                {
+                    for (uint64_t i = 0; i < iterations; ++i)
+                    {
+                        kernels->box4x(target, source, FRAME_WIDTH / 4, FRAME_HEIGHT / 4);
+                        benchKeep(target);
+                    }
+                });
+            benchEmit(ctx, name, &result);
+        }
+
+        // 512 -> 300 across, bytes are the target pixels written
+        snprintf(name, sizeof(name), "scaleBilinearRow/%s", pixelIsaName((PIXEL_ISA)isa));
+        if (benchSelected(ctx, name) != false)
+        {
+            uint16_t sx[300];
+            uint16_t fx[300];
+            for (uint32_t i = 0; i < 300; ++i)
+            {
+                auto pos = i * 512 * 256 / 300;
+                sx[i] = (uint16_t)(pos >> 8 < 510 ? pos >> 8 : 510);
+                fx[i] = (uint16_t)(pos & 0xff);
+            }
+
+            auto result = benchMeasure(
+                ctx,
+                300 * 300 * 4ull,
+                [&](uint64_t iterations)
+                {
+                    for (uint64_t i = 0; i < iterations; ++i)
+                    {
+                        for (uint32_t y = 0; y < 300; ++y)
+                        {
+                            auto row0 = source + (y * 512 / 300) * FRAME_STRIDE;
+                            kernels->bilinear(
+                                target + y * FRAME_STRIDE,
+                                row0,
+                                row0 + FRAME_STRIDE,
+                                sx,
+                                fx,
+                                y & 0xff,
+                                300);
+                        }
+                        benchKeep(target);
+                    }
+                });
+            benchEmit(ctx, name, &result);
+        }
+    }
+
+    OVERLAY_DATA sourceData;
+    OVERLAY_DATA targetData;
+    overlayDataInit(&sourceData, source);
+    memset(target, 0, FRAME_SIZE);
+    overlayDataInit(&targetData, target);
+
+    // whole frame against one glyph-sized paint, the dirty-only path
+    for (auto &derive : deriveCases_)
+    {
+        snprintf(name, sizeof(name), "overlayDeriveUpdate/%s/full", derive.name);
+        if (benchSelected(ctx, name) != false)
+        {
+            auto result = benchMeasure(
+                ctx,
+                FRAME_SIZE,
+                [&](uint64_t iterations)
+                {
+                    for (uint64_t i = 0; i < iterations; ++i)
+                    {
+                        overlayDeriveUpdate(&derive.derive, &sourceData, &targetData, 0, 0, FRAME_WIDTH, FRAME_HEIGHT);
+                    }
+                });
+            benchEmit(ctx, name, &result);
+        }
+
+        snprintf(name, sizeof(name), "overlayDeriveUpdate/%s/glyph", derive.name);
+        if (benchSelected(ctx, name) != false)
+        {
+            auto result = benchMeasure(
+                ctx,
+                9 * 16 * 4,
+                [&](uint64_t iterations)
+                {
+                    for (uint64_t i = 0; i < iterations; ++i)
+                    {
+                        overlayDeriveUpdate(&derive.derive, &sourceData, &targetData, 301, 317, 9, 16);
+                    }
+                });
+            benchEmit(ctx, name, &result);
+        }
+    }
+
+    benchFree(target);
+    benchFree(source);
+}
@@ -0,0 +1,103 @@
+#include <stdio.h>
+#include <string.h>
+#include "../src/compositor.h"
+#include "../src/frame.h"
+#include "../src/text.h"
+#include "bench.h"
+
+void benchText(BENCH_CONTEXT *ctx)
+{
+    auto data = (uint8_t *)benchAlloc(FRAME_SIZE);
+    memset(data, 0, FRAME_SIZE);
+
+    OVERLAY_DATA overlayData;
+    overlayDataInit(&overlayData, data);
+
+    // the wrist clock: only the seconds change from one tick to the next
+    TEXT_LABEL clock;
+    TEXT_STYLE style = {TEXT_FONT_CLOCK, TEXT_ALIGN_CENTER, {255, 255, 255, 255}};
+    SPRITE_PROPS props = {64, 64, 0, 255, true};
+    textLabelCreate(&overlayData, &clock, 384, 96, &style, &props);
+    textLabelSet(&overlayData, &clock, "12:34:00", 8);
+
+    if (benchSelected(ctx, "textLabelSet/clockTick") != false)
+    {
+        char time[] = "12:34:00";
+        uint64_t pixels = 0;
+
+        auto result = benchMeasure(
+            ctx,
+            0,
+            [&](uint64_t iterations)
+            {
+                for (uint64_t i = 0; i < iterations; ++i)
+                {
+                    auto second = (uint32_t)(i % 60);
+                    time[6] = (char)('0' + second / 10);
+                    time[7] = (char)('0' + second % 10);
+                    pixels += textLabelSet(&overlayData, &clock, time, 8);
+                    overlayData.dirty.exchange(false);
+                }
+            });
+        benchEmit(
+            ctx,
+            "textLabelSet/clockTick",
+            &result,
+            {{"pixelsPerOp", (double)pixels / (double)result.iterations}});
+    }
+
+    // a status line replaced by different text every time
+    TEXT_LABEL status;
+    style = {TEXT_FONT_TEXT, TEXT_ALIGN_LEFT, {255, 255, 255, 255}};
+    props = {64, 192, 0, 255, true};
+    textLabelCreate(&overlayData, &status, 480, 32, &style, &props);
+
+    if (benchSelected(ctx, "textLabelSet/replace") != false)
+    {
+        const char *lines[] = {
+            "Battery 87% - 3 trackers connected",
+            "Friends online: 12 - Instance: public"};
+        uint64_t pixels = 0;
+
+        auto result = benchMeasure(
+            ctx,
+            0,
+            [&](uint64_t iterations)
+            {
+                for (uint64_t i = 0; i < iterations; ++i)
+                {
+                    auto line = lines[i & 1];
+                    pixels += textLabelSet(&overlayData, &status, line, strlen(line));
+                    overlayData.dirty.exchange(false);
+                }
+            });
+        benchEmit(
+            ctx,
+            "textLabelSet/replace",
+            &result,
+            {{"pixelsPerOp", (double)pixels / (double)result.iterations}});
+    }
+
+    if (benchSelected(ctx, "textMeasure") != false)
+    {
+        auto line = "Friends online: 12 - Instance: public";
+        auto length = strlen(line);
+
+        auto result = benchMeasure(
+            ctx,
+            0,
+            [&](uint64_t iterations)
+            {
+                for (uint64_t i = 0; i < iterations; ++i)
+                {
+                    benchKeep(textMeasure(TEXT_FONT_TEXT, line, length));
+                }
+            });
+        benchEmit(ctx, "textMeasure", &result);
+    }
+
+    textLabelDestroy(&overlayData, &status);
+    textLabelDestroy(&overlayData, &clock);
+
+    benchFree(data);
+}
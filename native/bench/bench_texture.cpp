@@ -0,0 +1,264 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <linux/udmabuf.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include "../src/frame.h"
+#include "../src/staging.h"
+#include "../src/texture.h"
+#include "bench.h"
+
+typedef struct _TEXTURE_ROWS_CASE
+{
+    const char *name;
+    uint32_t dirtyRows;
+} TEXTURE_ROWS_CASE;
+
+// rows of tiles a paint leaves dirty: a caret, a list scrolling, every
+// other row (runs split), everything
+static const TEXTURE_ROWS_CASE rowsCases_[] = {
+    {"row", 1u << 6},
+    {"quarter", 0xfu << 8},
+    {"striped", 0x5555u},
+    {"full", TEXTURE_ALL_ROWS}};
+
+static uint32_t benchRowsBytes(uint32_t dirtyRows)
+{
+    return __builtin_popcount(dirtyRows) * FRAME_TILE_SIZE * FRAME_STRIDE;
+}
+
+static void benchTextureBackend(BENCH_CONTEXT *ctx, const TEXTURE_BACKEND *backend, const uint8_t *frame)
+{
+    char name[128];
+    auto isReady = false;
+
+    for (auto &rows : rowsCases_)
+    {
+        snprintf(name, sizeof(name), "textureUpload/%s/%s", backend->name, rows.name);
+        if (benchSelected(ctx, name) == false)
+        {
+            continue;
+        }
+
+        // the gl backend wants a gpu or mesa's software renderer
+        if (isReady == false)
+        {
+            if (backend->init() == false)
+            {
+                backend->exit();
+                fprintf(stderr, "%s: init failed, skipped\n", backend->name);
+                return;
+            }
+            backend->upload(0, frame, TEXTURE_ALL_ROWS);
+            isReady = true;
+        }
+
+        auto result = benchMeasure(
+            ctx,
+            benchRowsBytes(rows.dirtyRows),
+            [&](uint64_t iterations)
+            {
+                for (uint64_t i = 0; i < iterations; ++i)
+                {
+                    backend->upload(0, frame, rows.dirtyRows);
+                }
+            });
+
+        // SetOverlayRaw sends the whole frame on every submit, whatever
+        // changed. a texture backend submits a handle
+        auto submitBytes = backend == &textureBackendRaw ? FRAME_SIZE : 0;
+        benchEmit(
+            ctx,
+            name,
+            &result,
+            {{"dirtyBytes", (double)benchRowsBytes(rows.dirtyRows)},
+             {"submitBytes", (double)submitBytes}});
+    }
+
+    if (isReady != false)
+    {
+        backend->exit();
+    }
+}
+
+// a dmabuf over plain memory holding frame, what the renderer would share.
+// -1 where the kernel has no udmabuf
+static int benchSharedDmabuf(const uint8_t *frame)
+{
+    auto memfd = memfd_create("bench", MFD_ALLOW_SEALING);
+    if (memfd < 0)
+    {
+        return -1;
+    }
+
+    int dmabuf = -1;
+    if (ftruncate(memfd, FRAME_SIZE) == 0 &&
+        fcntl(memfd, F_ADD_SEALS, F_SEAL_SHRINK) == 0)
+    {
+        auto pixels = mmap(NULL, FRAME_SIZE, PROT_WRITE, MAP_SHARED, memfd, 0);
+        if (pixels != MAP_FAILED)
+        {
+            memcpy(pixels, frame, FRAME_SIZE);
+            munmap(pixels, FRAME_SIZE);
+
+            auto device = open("/dev/udmabuf", O_RDWR | O_CLOEXEC);
+            if (device >= 0)
+            {
+                udmabuf_create create = {};
+                create.memfd = (uint32_t)memfd;
+                create.flags = UDMABUF_FLAGS_CLOEXEC;
+                create.size = FRAME_SIZE;
+                dmabuf = ioctl(device, UDMABUF_CREATE, &create);
+                close(device);
+            }
+        }
+    }
+
+    close(memfd);
+    return dmabuf;
+}
+
+// the gpu copy that replaces a bitmap upload when the renderer shares its
+// texture. linear, so no modifier
+static void benchTextureShared(BENCH_CONTEXT *ctx, const uint8_t *frame)
+{
+    if (benchSelected(ctx, "textureShared/gl/udmabuf") == false)
+    {
+        return;
+    }
+
+    auto dmabuf = benchSharedDmabuf(frame);
+    if (dmabuf < 0)
+    {
+        fprintf(stderr, "textureShared: no udmabuf, skipped\n");
+        return;
+    }
+
+    TEXTURE_SHARED shared;
+    shared.handle = (uint64_t)dmabuf;
+    shared.width = FRAME_WIDTH;
+    shared.height = FRAME_HEIGHT;
+    shared.stride = FRAME_STRIDE;
+    shared.offset = 0;
+    shared.modifier = TEXTURE_MODIFIER_INVALID;
+
+    if (textureBackendGl.init() == false ||
+        textureBackendGl.importShared(0, &shared) == false)
+    {
+        textureBackendGl.exit();
+        close(dmabuf);
+        fprintf(stderr, "textureShared: import failed, skipped\n");
+        return;
+    }
+
+    auto result = benchMeasure(
+        ctx,
+        FRAME_SIZE,
+        [&](uint64_t iterations)
+        {
+            for (uint64_t i = 0; i < iterations; ++i)
+            {
+                textureBackendGl.importShared(0, &shared);
+            }
+        });
+
+    benchEmit(
+        ctx,
+        "textureShared/gl/udmabuf",
+        &result,
+        {{"cpuCopyBytes", 0.0}});
+
+    textureBackendGl.exit();
+    close(dmabuf);
+}
+
+void benchTexture(BENCH_CONTEXT *ctx)
+{
+    auto frame = (uint8_t *)benchAlloc(FRAME_SIZE);
+    for (uint32_t i = 0; i < FRAME_SIZE; ++i)
+    {
+        frame[i] = (uint8_t)(i * 2654435761u >> 24);
+    }
+
+    benchTextureBackend(ctx, &textureBackendRaw, frame);
+    benchTextureBackend(ctx, &textureBackendSoft, frame);
+    benchTextureBackend(ctx, &textureBackendGl, frame);
+    benchTextureShared(ctx, frame);
+
+    // the least SetOverlayRaw costs on top of the raw upload: one copy of
+    // the frame into the runtime's buffer
+    if (benchSelected(ctx, "setOverlayRaw/copy") != false)
+    {
+        auto target = (uint8_t *)benchAlloc(FRAME_SIZE);
+
+        auto result = benchMeasure(
+            ctx,
+            FRAME_SIZE,
+            [&](uint64_t iterations)
+            {
+                for (uint64_t i = 0; i < iterations; ++i)
+                {
+                    memcpy(target, frame, FRAME_SIZE);
+                    benchKeep(target);
+                }
+            });
+
+        benchEmit(ctx, "setOverlayRaw/copy", &result);
+
+        benchFree(target);
+    }
+
+    // the bookkeeping of the d3d11 staging ring, against a gpu that passes
+    // each fence lag uploads after it was issued. busyRate is the share of
+    // uploads that would skip the ring rather than wait
+    static const uint32_t lags[] = {0, 1, 2, 3, 4};
+    for (auto lag : lags)
+    {
+        char name[64];
+        snprintf(name, sizeof(name), "stagingRing/lag%u", lag);
+        if (benchSelected(ctx, name) == false)
+        {
+            continue;
+        }
+
+        STAGING_RING ring;
+        stagingRingInit(&ring, 3);
+        uint64_t fenceTicks[STAGING_MAX_SLOTS] = {};
+        uint64_t tick = 0;
+
+        auto result = benchMeasure(
+            ctx,
+            0,
+            [&](uint64_t iterations)
+            {
+                for (uint64_t i = 0; i < iterations; ++i, ++tick)
+                {
+                    // the poll before every upload
+                    uint32_t slot;
+                    uint64_t fence;
+                    while (stagingRingPending(&ring, &slot, &fence) != false &&
+                           fenceTicks[slot] + lag <= tick)
+                    {
+                        stagingRingComplete(&ring, fence);
+                    }
+
+                    auto acquired = stagingRingAcquire(&ring);
+                    if (acquired >= 0)
+                    {
+                        stagingRingRelease(&ring, (uint32_t)acquired);
+                        fenceTicks[acquired] = tick;
+                    }
+                }
+            });
+
+        benchEmit(
+            ctx,
+            name,
+            &result,
+            {{"busyRate", (double)ring.busyCount / (double)ring.acquireCount}});
+    }
+
+    benchFree(frame);
+}
@@ -0,0 +1,219 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../src/device.h"
+#include "../src/frame.h"
+#include "../src/hud.h"
+#include "../src/pixel.h"
+#include "../src/platform.h"
+#include "../src/pool.h"
+#include "../src/texture.h"
+
+// usage: hud [--minutes <n>] [--tick-ms <ms>] [--out <file.pam>]
+// runs the battery hud against the mock device table without SteamVR: the
+// overlay thread's poll loop fills the table every tick and the hud redraws
+// whenever its state changes. frames go through the soft texture backend,
+// every submit is checked against a hash of the frame it was taken from and
+// a frame marked dirty on a tick where no cell changed counts as a stray
+// redraw. prints what that cost as one JSON document, exits 1 on a hash
+// mismatch or a stray redraw. --out writes the last submitted frame as a
+// PAM image (straight RGBA)
+
+static bool hudWritePam(const char *path, const uint8_t *bgra)
+{
+    auto file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    auto rgba = (uint8_t *)malloc(FRAME_SIZE);
+    if (rgba == NULL)
+    {
+        fclose(file);
+        return false;
+    }
+
+    PIXEL_CONVERT convert = {PIXEL_OP_UNPREMULTIPLY | PIXEL_OP_SWIZZLE, 0, 255};
+    pixelConvertRow(rgba, bgra, FRAME_WIDTH * FRAME_HEIGHT, &convert);
+
+    fprintf(
+        file,
+        "P7\nWIDTH %u\nHEIGHT %u\nDEPTH 4\nMAXVAL 255\nTUPLTYPE RGB_ALPHA\nENDHDR\n",
+        FRAME_WIDTH,
+        FRAME_HEIGHT);
+    auto isWritten = fwrite(rgba, 1, FRAME_SIZE, file) == FRAME_SIZE;
+
+    free(rgba);
+    return fclose(file) == 0 && isWritten != false;
+}
+
+int main(int argc, char **argv)
+{
+    uint64_t minutes = 60;
+    uint64_t tickMs = 10; // the overlay thread polls devices every 10ms
+    const char *outPath = NULL;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--minutes") == 0 && i + 1 < argc)
+        {
+            minutes = strtoull(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--tick-ms") == 0 && i + 1 < argc)
+        {
+            tickMs = strtoull(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+        {
+            outPath = argv[++i];
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--minutes <n>] [--tick-ms <ms>] [--out <file.pam>]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    if (tickMs == 0)
+    {
+        tickMs = 1;
+    }
+
+    auto data = (uint8_t *)poolAlloc(true);
+    if (data == NULL || textureBackendSoft.init() == false)
+    {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    OVERLAY_DATA overlayData;
+    overlayDataInit(&overlayData, data);
+
+    static VR_DEVICE_TABLE table;
+    VR_DEVICE_DATA local[vr::k_unMaxTrackedDeviceCount];
+    deviceTableFillMock(&table, 0);
+
+    HUD_STATE state;
+    hudStateFromDevices(&state, table.data, table.count);
+
+    HUD hud;
+    SPRITE_PROPS props = {16, 16, 0, 255, true};
+    if (hudCreate(&overlayData, &hud, &state, &props) == false)
+    {
+        fprintf(stderr, "cannot create the hud\n");
+        return 1;
+    }
+
+    HUD_STATE posted = state;
+    uint64_t ticks = 0;
+    uint64_t posts = 0;
+    uint64_t uploads = 0;
+    uint64_t uploadBytes = 0;
+    uint64_t mismatches = 0;
+    uint64_t strayRedraws = 0;
+    uint64_t pollNs = 0;
+    uint64_t drawNs = 0;
+
+    for (uint64_t timeMs = 0; timeMs <= minutes * 60000; timeMs += tickMs)
+    {
+        ++ticks;
+
+        // overlay thread: poll, reduce, post on change
+        auto startNs = platformNowNs();
+        table.lock.lock();
+        deviceTableFillMock(&table, timeMs);
+        hudStateFromDevices(&state, table.data, table.count);
+        table.lock.unlock();
+        auto isChanged = hudStateEquals(&state, &posted) == false;
+        pollNs += platformNowNs() - startNs;
+
+        // js thread: draw what changed
+        if (isChanged != false)
+        {
+            posted = state;
+            ++posts;
+
+            startNs = platformNowNs();
+            hudUpdate(&overlayData, &hud, &state);
+            drawNs += platformNowNs() - startNs;
+        }
+
+        // overlay thread: upload the rows the redraw touched and submit
+        uint32_t dirtyRows;
+        if (frameTakeDirty(&overlayData, &dirtyRows) == false)
+        {
+            continue;
+        }
+
+        // only a value crossing a step of the bar may cost a frame, past
+        // the first one hudCreate drew
+        if (isChanged == false && ticks != 1)
+        {
+            ++strayRedraws;
+        }
+
+        textureBackendSoft.upload(0, data, dirtyRows);
+        textureBackendSoft.submit(NULL, 0, 0);
+        ++uploads;
+        uploadBytes += (uint64_t)__builtin_popcount(dirtyRows) * FRAME_TILE_SIZE * FRAME_STRIDE;
+
+        uint64_t hash;
+        uint64_t submitCount;
+        if (textureSoftHash(0, &hash, &submitCount) == false ||
+            submitCount != uploads ||
+            hash != textureHashFrame(data))
+        {
+            ++mismatches;
+        }
+    }
+
+    auto count = deviceTableSnapshot(&table, local);
+
+    printf("{\n");
+    printf("  \"minutes\": %llu,\n", (unsigned long long)minutes);
+    printf("  \"tickMs\": %llu,\n", (unsigned long long)tickMs);
+    printf("  \"ticks\": %llu,\n", (unsigned long long)ticks);
+    printf("  \"devices\": %u,\n", count);
+    printf("  \"cells\": %u,\n", hud.drawn.count);
+    printf("  \"posts\": %llu,\n", (unsigned long long)posts);
+    printf("  \"cellsRedrawn\": %llu,\n", (unsigned long long)hud.redrawCount);
+    printf("  \"uploads\": %llu,\n", (unsigned long long)uploads);
+    printf("  \"uploadBytes\": %llu,\n", (unsigned long long)uploadBytes);
+    printf("  \"hashMismatches\": %llu,\n", (unsigned long long)mismatches);
+    printf("  \"strayRedraws\": %llu,\n", (unsigned long long)strayRedraws);
+    printf("  \"pollNsPerTick\": %.1f,\n", (double)pollNs / (double)ticks);
+    printf("  \"drawNsPerPost\": %.1f\n", posts != 0 ? (double)drawNs / (double)posts : 0.0);
+    printf("}\n");
+
+    auto result = 0;
+    if (mismatches != 0)
+    {
+        fprintf(stderr, "%llu submits didn't hash as their frame\n", (unsigned long long)mismatches);
+        result = 1;
+    }
+    if (strayRedraws != 0)
+    {
+        fprintf(stderr, "%llu frames redrawn without a change\n", (unsigned long long)strayRedraws);
+        result = 1;
+    }
+
+    if (outPath != NULL)
+    {
+        auto texture = (uint8_t *)poolAlloc(false);
+        if (texture == NULL ||
+            textureSoftRead(0, texture) == false ||
+            hudWritePam(outPath, texture) == false)
+        {
+            fprintf(stderr, "cannot write %s\n", outPath);
+            result = 1;
+        }
+        poolFree(texture);
+    }
+
+    textureBackendSoft.exit();
+    hudDestroy(&overlayData, &hud);
+    poolFree(data);
+
+    return result;
+}
@@ -0,0 +1,179 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include "../src/platform.h"
+#include "../src/pool.h"
+#include "bench.h"
+
+// usage: bench [--filter <substring>] [--min-time-ms <ms>] [--samples <n>] [--huge-pages]
+// writes one JSON document to stdout
+
+bool benchSelected(const BENCH_CONTEXT *ctx, const char *name)
+{
+    return ctx->filter == NULL || strstr(name, ctx->filter) != NULL;
+}
+
+BENCH_RESULT benchMeasure(
+    const BENCH_CONTEXT *ctx,
+    uint64_t bytesPerOp,
+    const std::function<void(uint64_t)> &fn)
+{
+    // calibrate so that one sample takes roughly minTime / samples
+    uint64_t iterations = 1;
+    auto sampleNs = ctx->minTimeNs / ctx->samples;
+
+    for (;;)
+    {
+        auto startNs = platformNowNs();
+        fn(iterations);
+        auto elapsedNs = platformNowNs() - startNs;
+
+        if (elapsedNs >= sampleNs / 4 || iterations >= (1ull << 40))
+        {
+            iterations = iterations * sampleNs / (elapsedNs != 0 ? elapsedNs : 1);
+            if (iterations == 0)
+            {
+                iterations = 1;
+            }
+            break;
+        }
+
+        iterations *= 2;
+    }
+
+    std::vector<double> nsPerOp;
+
+    for (uint32_t i = 0; i < ctx->samples; ++i)
+    {
+        auto startNs = platformNowNs();
+        fn(iterations);
+        auto elapsedNs = platformNowNs() - startNs;
+        nsPerOp.push_back((double)elapsedNs / iterations);
+    }
+
+    std::sort(nsPerOp.begin(), nsPerOp.end());
+
+    BENCH_RESULT result;
+    result.iterations = iterations * ctx->samples;
+    result.nsPerOp = nsPerOp.front();
+    result.medianNsPerOp = nsPerOp[nsPerOp.size() / 2];
+    result.bytesPerSecond = bytesPerOp != 0 ? bytesPerOp * 1e9 / result.nsPerOp : 0;
+
+    return result;
+}
+
+void benchEmit(
+    BENCH_CONTEXT *ctx,
+    const char *name,
+    const BENCH_RESULT *result,
+    std::initializer_list<BENCH_COUNTER> counters)
+{
+    printf(
+        "%s\n    {\"name\": \"%s\", \"iterations\": %llu, \"nsPerOp\": %.3f, "
+        "\"medianNsPerOp\": %.3f, \"bytesPerSecond\": %.0f",
+        ctx->emitted != 0 ? "," : "",
+        name,
+        (unsigned long long)result->iterations,
+        result->nsPerOp,
+        result->medianNsPerOp,
+        result->bytesPerSecond);
+
+    for (auto &counter : counters)
+    {
+        printf(", \"%s\": %.6g", counter.name, counter.value);
+    }
+
+    printf("}");
+    fflush(stdout);
+
+    ++ctx->emitted;
+}
+
+void *benchAlloc(size_t size)
+{
+    // 64-byte aligned like the frame buffers the addon hands to SIMD code
+    auto ptr = aligned_alloc(64, (size + 63) & ~(size_t)63);
+    if (ptr == NULL)
+    {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+
+    memset(ptr, 0, size);
+    return ptr;
+}
+
+void benchFree(void *ptr)
+{
+    free(ptr);
+}
+
+int main(int argc, char **argv)
+{
+    BENCH_CONTEXT ctx;
+    ctx.filter = NULL;
+    ctx.minTimeNs = 500000000ull; // 0.5s per case
+    ctx.samples = 5;
+    ctx.emitted = 0;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+        {
+            ctx.filter = argv[++i];
+        }
+        else if (strcmp(argv[i], "--min-time-ms") == 0 && i + 1 < argc)
+        {
+            ctx.minTimeNs = strtoull(argv[++i], NULL, 10) * 1000000ull;
+        }
+        else if (strcmp(argv[i], "--samples") == 0 && i + 1 < argc)
+        {
+            ctx.samples = (uint32_t)strtoul(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--huge-pages") == 0)
+        {
+            poolInit(POOL_FLAG_HUGE_PAGES);
+        }
+        else
+        {
+            fprintf(
+                stderr,
+                "usage: %s [--filter <substring>] [--min-time-ms <ms>] [--samples <n>] [--huge-pages]\n",
+                argv[0]);
+            return 2;
+        }
+    }
+
+    if (ctx.samples == 0)
+    {
+        ctx.samples = 1;
+    }
+
+    printf(
+        "{\n  \"cpuCount\": %u,\n  \"minTimeMs\": %llu,\n  \"samples\": %u,\n  \"benchmarks\": [",
+        std::thread::hardware_concurrency(),
+        (unsigned long long)(ctx.minTimeNs / 1000000ull),
+        ctx.samples);
+
+    benchFrame(&ctx);
+    benchPixel(&ctx);
+    benchScale(&ctx);
+    benchPool(&ctx);
+    benchCompositor(&ctx);
+    benchText(&ctx);
+    benchHud(&ctx);
+    benchGovernor(&ctx);
+    benchFollow(&ctx);
+    benchProcscan(&ctx);
+    benchSampler(&ctx);
+    benchCodec(&ctx);
+    benchDevice(&ctx);
+    benchTexture(&ctx);
+
+    printf("\n  ]\n}\n");
+
+    return 0;
+}
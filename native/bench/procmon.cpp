@@ -0,0 +1,79 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <thread>
+#include "../src/platform.h"
+#include "../src/procmon.h"
+
+// usage: procmon [--seconds <n>] <name>...
+// watches for the named executables like the addon does and prints every
+// start and exit as a JSON line as it happens, then the monitor's stats.
+// e.g. procmon --seconds 60 VRChat.exe vrserver vrcompositor
+
+static uint64_t procmonStartNs_;
+
+static void procmonPrint(const PROCMON_EVENT *event, void *context)
+{
+    printf(
+        "{\"timeMs\": %.1f, \"name\": \"%s\", \"pid\": %u, \"isRunning\": %s}\n",
+        (double)(platformNowNs() - procmonStartNs_) / 1000000.0,
+        event->name,
+        event->pid,
+        event->isRunning != false ? "true" : "false");
+    fflush(stdout);
+}
+
+int main(int argc, char **argv)
+{
+    uint64_t seconds = 10;
+    const char *names[PROCMON_MAX_NAMES];
+    uint32_t count = 0;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc)
+        {
+            seconds = strtoull(argv[++i], NULL, 10);
+        }
+        else if (argv[i][0] != '-' && count < PROCMON_MAX_NAMES)
+        {
+            names[count++] = argv[i];
+        }
+        else
+        {
+            count = 0;
+            break;
+        }
+    }
+
+    if (count == 0)
+    {
+        fprintf(stderr, "usage: %s [--seconds <n>] <name>...\n", argv[0]);
+        return 2;
+    }
+
+    procmonStartNs_ = platformNowNs();
+    if (procmonStart(names, count, procmonPrint, NULL) == false)
+    {
+        fprintf(stderr, "cannot start the monitor\n");
+        return 1;
+    }
+
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+
+    PROCMON_STATS stats;
+    procmonGetStats(&stats);
+    procmonStop();
+
+    printf(
+        "{\"backend\": \"%s\", \"processCount\": %u, \"wakeCount\": %llu, \"scanCount\": %llu, \"eventCount\": %llu, \"errorCount\": %llu}\n",
+        procmonBackendName(stats.backend),
+        stats.processCount,
+        (unsigned long long)stats.wakeCount,
+        (unsigned long long)stats.scanCount,
+        (unsigned long long)stats.eventCount,
+        (unsigned long long)stats.errorCount);
+
+    return 0;
+}
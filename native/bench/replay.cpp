@@ -0,0 +1,376 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "../src/codec.h"
+#include "../src/frame.h"
+#include "../src/pixel.h"
+#include "../src/platform.h"
+#include "../src/pool.h"
+#include "../src/record.h"
+#include "../src/texture.h"
+
+// usage: replay <file> [--realtime] [--tick-ms <ms>] [--verify]
+//               [--ops <mask>] [--opacity <n>] [--alpha-threshold <n>]
+//               [--dump-dir <dir>]
+// feeds a paint stream recorded with startPaintRecord() back through the
+// frame ingest path and prints per-stage timings as one JSON document.
+// --realtime keeps the recorded pacing, the default replays at full speed.
+// --verify uploads through the soft texture backend (dirty rows, best pixel
+// kernel) and checks every upload bit-exact against a reference built
+// with the scalar kernel and whole-frame copies. --ops and friends set the
+// pixel conversion applied on the way in. --dump-dir writes the first
+// mismatching frame of each target as png, both versions
+
+#define REPLAY_TARGET_COUNT 2
+
+typedef struct _REPLAY_TARGET
+{
+    uint8_t *texture; // software stand-in for the overlay texture
+    uint8_t *reference; // --verify: the frame as the scalar kernel writes it
+    OVERLAY_DATA overlayData;
+    uint64_t mismatchCount;
+} REPLAY_TARGET;
+
+typedef struct _REPLAY_VERIFY
+{
+    bool isEnabled;
+    const char *dumpDir; // NULL for no dumps
+    uint64_t frameCount;
+    uint64_t mismatchCount;
+} REPLAY_VERIFY;
+
+static_assert(REPLAY_TARGET_COUNT <= TEXTURE_TARGET_COUNT, "a texture per target");
+
+static double replayPercentile(std::vector<uint64_t> &values, double p)
+{
+    if (values.empty() != false)
+    {
+        return 0;
+    }
+
+    auto index = (size_t)(p * (values.size() - 1));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return (double)values[index];
+}
+
+static bool replayWritePng(const char *dir, uint32_t target, uint64_t frame, const char *kind, const uint8_t *data)
+{
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/target%u-%llu-%s.png", dir, target, (unsigned long long)frame, kind);
+
+    auto out = (uint8_t *)malloc(framePngBound());
+    auto file = fopen(path, "wb");
+    auto isWritten = false;
+
+    if (out != NULL && file != NULL)
+    {
+        auto size = framePngEncode(out, data);
+        isWritten = fwrite(out, 1, size, file) == size;
+    }
+
+    if (file != NULL)
+    {
+        isWritten = fclose(file) == 0 && isWritten != false;
+    }
+    free(out);
+
+    if (isWritten == false)
+    {
+        fprintf(stderr, "cannot write %s\n", path);
+    }
+    return isWritten;
+}
+
+// what the overlay thread does with dirty frames once per tick. returns the
+// number of uploads
+static uint32_t replayTick(REPLAY_TARGET *targets, REPLAY_VERIFY *verify)
+{
+    uint32_t uploadCount = 0;
+
+    for (uint32_t i = 0; i < REPLAY_TARGET_COUNT; ++i)
+    {
+        auto target = &targets[i];
+
+        if (verify->isEnabled == false)
+        {
+            if (target->overlayData.dirty.exchange(false) != false)
+            {
+                memcpy(target->texture, target->overlayData.data, FRAME_SIZE);
+                ++uploadCount;
+            }
+            continue;
+        }
+
+        uint32_t dirtyRows;
+        if (frameTakeDirty(&target->overlayData, &dirtyRows) == false)
+        {
+            continue;
+        }
+
+        textureBackendSoft.upload(i, (const uint8_t *)target->overlayData.data, dirtyRows);
+        textureBackendSoft.submit(NULL, 0, i);
+        ++uploadCount;
+
+        // the reference takes the whole frame every time
+        memcpy(target->texture, target->reference, FRAME_SIZE);
+
+        uint64_t hash;
+        uint64_t submitCount;
+        textureSoftHash(i, &hash, &submitCount);
+        ++verify->frameCount;
+
+        if (hash == textureHashFrame(target->texture))
+        {
+            continue;
+        }
+
+        ++verify->mismatchCount;
+        if (target->mismatchCount++ == 0 && verify->dumpDir != NULL)
+        {
+            auto mirror = (uint8_t *)malloc(FRAME_SIZE);
+            if (mirror != NULL && textureSoftRead(i, mirror) != false)
+            {
+                replayWritePng(verify->dumpDir, i, submitCount, "fast", mirror);
+                replayWritePng(verify->dumpDir, i, submitCount, "reference", target->texture);
+            }
+            free(mirror);
+        }
+    }
+
+    return uploadCount;
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = NULL;
+    bool isRealtime = false;
+    uint64_t tickNs = 50000000ull; // the overlay thread renders at 20fps
+    PIXEL_CONVERT convert = {0, 0, 255};
+    REPLAY_VERIFY verify = {};
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--realtime") == 0)
+        {
+            isRealtime = true;
+        }
+        else if (strcmp(argv[i], "--tick-ms") == 0 && i + 1 < argc)
+        {
+            tickNs = strtoull(argv[++i], NULL, 10) * 1000000ull;
+        }
+        else if (strcmp(argv[i], "--verify") == 0)
+        {
+            verify.isEnabled = true;
+        }
+        else if (strcmp(argv[i], "--ops") == 0 && i + 1 < argc)
+        {
+            convert.ops = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "--opacity") == 0 && i + 1 < argc)
+        {
+            convert.opacity = (uint8_t)strtoul(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--alpha-threshold") == 0 && i + 1 < argc)
+        {
+            convert.alphaThreshold = (uint8_t)strtoul(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--dump-dir") == 0 && i + 1 < argc)
+        {
+            verify.dumpDir = argv[++i];
+        }
+        else if (path == NULL && argv[i][0] != '-')
+        {
+            path = argv[i];
+        }
+        else
+        {
+            path = NULL;
+            break;
+        }
+    }
+
+    if (path == NULL || pixelConvertIsValid(&convert) == false)
+    {
+        fprintf(
+            stderr,
+            "usage: %s <file> [--realtime] [--tick-ms <ms>] [--verify] [--ops <mask>] "
+            "[--opacity <n>] [--alpha-threshold <n>] [--dump-dir <dir>]\n",
+            argv[0]);
+        return 2;
+    }
+
+    auto file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        fprintf(stderr, "cannot open %s\n", path);
+        return 1;
+    }
+
+    PAINT_READER reader;
+    if (paintReaderOpen(&reader, file) == false)
+    {
+        fclose(file);
+        fprintf(stderr, "%s is not a paint stream\n", path);
+        return 1;
+    }
+
+    REPLAY_TARGET targets[REPLAY_TARGET_COUNT];
+    for (auto &target : targets)
+    {
+        target.texture = (uint8_t *)poolAlloc(true);
+        target.reference = verify.isEnabled != false ? (uint8_t *)poolAlloc(true) : NULL;
+        target.mismatchCount = 0;
+        overlayDataInit(&target.overlayData, poolAlloc(true));
+        target.overlayData.convert = convert;
+    }
+
+    if (verify.isEnabled != false && textureBackendSoft.init() == false)
+    {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    auto referenceKernel = pixelGetKernel(PIXEL_ISA_SCALAR);
+
+    std::vector<uint64_t> ingestNs;
+    uint64_t decodeNs = 0;
+    uint64_t uploadNs = 0;
+    uint64_t uploadCount = 0;
+    uint64_t pixelBytes = 0;
+    uint64_t lastEventNs = 0;
+    uint64_t nextTickNs = 0;
+    int status;
+    PAINT_EVENT event;
+
+    auto startNs = platformNowNs();
+
+    for (;;)
+    {
+        auto t0 = platformNowNs();
+        status = paintReaderNext(&reader, &event);
+        decodeNs += platformNowNs() - t0;
+
+        if (status <= 0)
+        {
+            break;
+        }
+
+        if (event.target >= REPLAY_TARGET_COUNT)
+        {
+            continue;
+        }
+
+        if (isRealtime != false)
+        {
+            auto nowNs = platformNowNs() - startNs;
+            if (event.timeNs > nowNs)
+            {
+                std::this_thread::sleep_for(std::chrono::nanoseconds(event.timeNs - nowNs));
+            }
+        }
+
+        auto target = &targets[event.target];
+
+        // the decoded frame stands in for the bitmap Chromium passed
+        t0 = platformNowNs();
+        overlayDataWrite(
+            &target->overlayData,
+            event.frame,
+            event.x,
+            event.y,
+            event.width,
+            event.height);
+        ingestNs.push_back(platformNowNs() - t0);
+
+        if (verify.isEnabled != false)
+        {
+            auto offset = (event.y * FRAME_WIDTH + event.x) * 4;
+            for (uint32_t row = 0; row < event.height; ++row)
+            {
+                referenceKernel(
+                    target->reference + offset + row * FRAME_STRIDE,
+                    event.frame + offset + row * FRAME_STRIDE,
+                    event.width,
+                    &convert);
+            }
+        }
+
+        pixelBytes += event.width * event.height * 4;
+        lastEventNs = event.timeNs;
+
+        // the overlay thread picks up dirty frames once per tick of the
+        // recorded clock, so the upload count matches the live app
+        if (event.timeNs >= nextTickNs)
+        {
+            nextTickNs = event.timeNs + tickNs;
+
+            t0 = platformNowNs();
+            uploadCount += replayTick(targets, &verify);
+            uploadNs += platformNowNs() - t0;
+        }
+    }
+
+    // whatever came after the last tick still gets checked
+    if (verify.isEnabled != false)
+    {
+        uploadCount += replayTick(targets, &verify);
+    }
+
+    auto elapsedNs = platformNowNs() - startNs;
+    paintReaderClose(&reader);
+
+    if (status < 0)
+    {
+        fprintf(stderr, "%s is truncated or corrupt\n", path);
+    }
+
+    uint64_t ingestTotalNs = 0;
+    for (auto ns : ingestNs)
+    {
+        ingestTotalNs += ns;
+    }
+
+    auto eventCount = (double)ingestNs.size();
+
+    printf("{\n");
+    printf("  \"file\": \"%s\",\n", path);
+    printf("  \"mode\": \"%s\",\n", isRealtime != false ? "realtime" : "max");
+    printf("  \"complete\": %s,\n", status == 0 ? "true" : "false");
+    printf("  \"events\": %.0f,\n", eventCount);
+    printf("  \"recordedDurationMs\": %.3f,\n", lastEventNs / 1e6);
+    printf("  \"elapsedMs\": %.3f,\n", elapsedNs / 1e6);
+    printf("  \"pixelBytes\": %llu,\n", (unsigned long long)pixelBytes);
+    printf("  \"decodeNsPerEvent\": %.1f,\n", eventCount != 0 ? decodeNs / eventCount : 0);
+    printf("  \"ingestNsPerEvent\": %.1f,\n", eventCount != 0 ? ingestTotalNs / eventCount : 0);
+    printf("  \"ingestNsP50\": %.0f,\n", replayPercentile(ingestNs, 0.5));
+    printf("  \"ingestNsP99\": %.0f,\n", replayPercentile(ingestNs, 0.99));
+    printf("  \"ingestBytesPerSecond\": %.0f,\n", ingestTotalNs != 0 ? pixelBytes * 1e9 / ingestTotalNs : 0);
+    printf("  \"uploads\": %llu,\n", (unsigned long long)uploadCount);
+    printf("  \"uploadNsPerFrame\": %.1f%s\n", uploadCount != 0 ? (double)uploadNs / uploadCount : 0, verify.isEnabled != false ? "," : "");
+    if (verify.isEnabled != false)
+    {
+        printf("  \"verifiedFrames\": %llu,\n", (unsigned long long)verify.frameCount);
+        printf("  \"mismatches\": %llu\n", (unsigned long long)verify.mismatchCount);
+    }
+    printf("}\n");
+
+    if (verify.isEnabled != false)
+    {
+        textureBackendSoft.exit();
+    }
+
+    for (auto &target : targets)
+    {
+        poolFree(target.texture);
+        if (target.reference != NULL)
+        {
+            poolFree(target.reference);
+        }
+        poolFree(target.overlayData.data);
+    }
+
+    return status < 0 || verify.mismatchCount != 0 ? 1 : 0;
+}
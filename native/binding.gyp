@@ -6,13 +6,133 @@
   },
   'targets': [
     {
+      # alpha8 atlas of the glyphs text.cpp draws, rasterized from the
+      # bundled font into glyph_atlas.h
+      'target_name': 'glyph_atlas',
+      'type': 'none',
+      'hard_dependency': 1,
+      'actions': [
+        {
+          'action_name': 'glyph_atlas',
+          'inputs': [
+            'tools/glyph_atlas.py',
+            'fonts/DejaVuSans.ttf'
+          ],
+          'outputs': [
+            '<(SHARED_INTERMEDIATE_DIR)/glyph_atlas.h'
+          ],
+          'action': [
+            '<(python)',
+            'tools/glyph_atlas.py',
+            'fonts/DejaVuSans.ttf',
+            '<@(_outputs)'
+          ]
+        }
+      ],
+      'direct_dependent_settings': {
+        'include_dirs': [
+          '<(SHARED_INTERMEDIATE_DIR)'
+        ]
+      }
+    },
+    {
+      # everything but the n-api surface: frame store, compositor, governor,
+      # device table, stats, log. linked into the addon and into the bench and
+      # tool executables, so they run the same code
+      'target_name': 'core',
+      'type': 'static_library',
+      'dependencies': [
+        'glyph_atlas'
+      ],
+      'include_dirs': [
+        '<(module_root_dir)/include/'
+      ],
+      'sources': [
+        'src/codec.cpp',
+        'src/compositor.cpp',
+        'src/device.cpp',
+        'src/follow.cpp',
+        'src/frame.cpp',
+        'src/governor.cpp',
+        'src/hud.cpp',
+        'src/log.cpp',
+        'src/pixel.cpp',
+        'src/platform.cpp',
+        'src/pool.cpp',
+        'src/procmon.cpp',
+        'src/props.cpp',
+        'src/record.cpp',
+        'src/sampler.cpp',
+        'src/scale.cpp',
+        'src/staging.cpp',
+        'src/text.cpp',
+        'src/texture.cpp',
+        'src/texture_soft.cpp',
+        'src/watchdog.cpp'
+      ],
+      'cflags!': [
+        '-fno-exceptions'
+      ],
+      'cflags_cc!': [
+        '-fno-exceptions'
+      ],
+      'msvs_settings': {
+        'VCCLCompilerTool': {
+          'ExceptionHandling': 1
+        },
+      },
+      'direct_dependent_settings': {
+        'include_dirs': [
+          '<(module_root_dir)/include/'
+        ]
+      },
+      'conditions': [
+        [
+          'OS == "win"',
+          {
+            'defines': [
+              'WIN32',
+              'NDEBUG'
+            ]
+          }
+        ],
+        [
+          'OS != "win"',
+          {
+            'cflags': [
+              '-fPIC',
+              '-pthread'
+            ],
+            'sources': [
+              'src/procscan.cpp',
+              'src/texture_gl.cpp'
+            ],
+            'link_settings': {
+              'ldflags': [
+                '-pthread'
+              ],
+              'libraries': [
+                '-ldl'
+              ]
+            }
+          }
+        ]
+      ]
+    },
+    {
+      # the n-api surface (addon.cpp) and the platform's backends
       'target_name': '<(module_name)',
+      'dependencies': [
+        'core'
+      ],
       'defines': [
         'NAPI_DISABLE_CPP_EXCEPTIONS'
       ],
       'include_dirs': [
-        '<!(node -p "require(\'node-addon-api\').include_dir")',
-        '<(module_root_dir)/include/'
+        '<!(node -p "require(\'node-addon-api\').include_dir")'
+      ],
+      'sources': [
+        'src/addon.cpp'
       ],
       'cflags!': [
         '-fno-exceptions'
@@ -64,7 +184,7 @@
           'OS != "win"',
           {
             'sources': [
-              'src/main_linux.cpp',
+              'src/main_linux.cpp'
             ]
           }
         ]
@@ -85,5 +205,99 @@
         }
       ]
     }
+  ],
+  'conditions': [
+    [
+      'OS == "linux"',
+      {
+        'targets': [
+          {
+            # standalone benchmark for the addon's hot paths, linked against
+            # the same core. run: build/Release/bench [--filter copyFrameBuffer]
+            'target_name': 'bench',
+            'type': 'executable',
+            'dependencies': [
+              'core'
+            ],
+            'sources': [
+              'bench/main.cpp',
+              'bench/bench_codec.cpp',
+              'bench/bench_compositor.cpp',
+              'bench/bench_device.cpp',
+              'bench/bench_follow.cpp',
+              'bench/bench_frame.cpp',
+              'bench/bench_governor.cpp',
+              'bench/bench_hud.cpp',
+              'bench/bench_pixel.cpp',
+              'bench/bench_pool.cpp',
+              'bench/bench_procscan.cpp',
+              'bench/bench_sampler.cpp',
+              'bench/bench_scale.cpp',
+              'bench/bench_text.cpp',
+              'bench/bench_texture.cpp'
+            ]
+          },
+          {
+            # checks of the core's platform-neutral modules, exits 1 on a
+            # failure. run: build/Release/test [--filter governor]
+            'target_name': 'test',
+            'type': 'executable',
+            'dependencies': [
+              'core'
+            ],
+            'sources': [
+              'test/main.cpp',
+              'test/test_codec.cpp',
+              'test/test_compositor.cpp',
+              'test/test_follow.cpp',
+              'test/test_frame.cpp',
+              'test/test_governor.cpp',
+              'test/test_pool.cpp',
+              'test/test_props.cpp',
+              'test/test_scale.cpp',
+              'test/test_staging.cpp',
+              'test/test_text.cpp'
+            ]
+          },
+          {
+            # the battery hud on mock devices through the soft texture backend,
+            # no SteamVR needed. exits 1 on a bad submit or a stray redraw.
+            # run: build/Release/hud [--minutes 60] [--out hud.pam]
+            'target_name': 'hud',
+            'type': 'executable',
+            'dependencies': [
+              'core'
+            ],
+            'sources': [
+              'bench/hud.cpp'
+            ]
+          },
+          {
+            # feeds a paint stream captured with startPaintRecord() back
+            # through the ingest path. run: build/Release/replay <file>
+            'target_name': 'replay',
+            'type': 'executable',
+            'dependencies': [
+              'core'
+            ],
+            'sources': [
+              'bench/replay.cpp'
+            ]
+          },
+          {
+            # the process monitor on its own, prints starts and exits.
+            # run: build/Release/procmon [--seconds 60] vrserver
+            'target_name': 'procmon',
+            'type': 'executable',
+            'dependencies': [
+              'core'
+            ],
+            'sources': [
+              'bench/procmon.cpp'
+            ]
+          }
+        ]
+      }
+    ]
   ]
 }
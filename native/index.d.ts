@@ -42,8 +42,185 @@ declare module 'native' {
     buttonPressedMask: number;
     buttonTouchedMask: number;
   }
+  export interface ProcessEvent {
+    name: string; // as passed to setProcessMonitor
+    pid: number;
+    isRunning: boolean;
+  }
+  export interface ResourceProcess {
+    name: string; // as passed to setProcessMonitor
+    pid: number;
+    isRunning: boolean;
+    hasIo: boolean; // linux: false for processes of another user
+    // rows of [timeMs, cpuMs, rssBytes, threads, readBytes, writeBytes],
+    // oldest first. cpu and i/o are totals since the process started,
+    // threads is 0 on windows
+    samples: Float64Array;
+  }
+  export interface ResourceSamples {
+    intervalMs: number; // 0 when stopped
+    sampleCount: number;
+    failCount: number;
+    nsPerSample: number;
+    processes: ResourceProcess[];
+  }
+  export interface GameLaunch {
+    isLaunched: boolean;
+    pid: number; // of steam, which hands the launch on
+    spawnMs: number; // from the call until steam was started
+  }
+  export interface OverlayStall {
+    phase: string;
+    durationMs: number;
+    isResolved: boolean;
+  }
+  export interface OverlayStats {
+    watchdog: {
+      phase: string;
+      heartbeatAgeMs: number;
+      stallCount: number;
+    };
+    log: {
+      written: number;
+      dropped: number;
+      suppressed: number;
+    };
+    hmd: {
+      filledTiles: number;
+      isHidden: boolean;
+    };
+    hud: {
+      isEnabled: boolean;
+      updateCount: number;
+      redrawCount: number;
+    };
+    props: {
+      setCount: number;
+      applyCount: number;
+      pushCount: number;
+    };
+    follow: {
+      isEnabled: boolean;
+      isMoving: boolean;
+      submitCount: number;
+    };
+    governor: OverlayGovernorState & { modeChanges: number };
+    pool: {
+      reservedBytes: number;
+      hugePageBytes: number; // these two stay 0 without VRCX_HUGE_PAGES=1
+      thpBytes: number;
+      slotCount: number;
+      inUse: number;
+      peakInUse: number;
+      allocCount: number;
+      reuseCount: number;
+      failCount: number;
+    };
+    texture: {
+      backend: "d3d11" | "gl" | "raw" | "soft";
+      isMockVr: boolean;
+      uploadCount: number;
+      uploadBytes: number;
+      submitCount: number;
+      sharedCount: number;
+    };
+    pixelIsa: "scalar" | "sse2" | "avx2";
+  }
+  // a paint left in gpu memory, bgra premultiplied at the frame size
+  export interface OverlaySharedTexture {
+    handle: Buffer | number; // nt handle bytes on windows, dmabuf fd on linux
+    width: number;
+    height: number;
+    stride?: number; // dmabuf only, and required there
+    offset?: number; // dmabuf only
+    modifier?: string; // dmabuf only, e.g. "0x0"
+  }
+  export interface OverlayTextureHash {
+    hash: string; // 16 hex digits
+    submitCount: number;
+  }
+  export interface OverlayGovernorConfig {
+    maxFps?: number;
+    lowFps?: number;
+    idleFps?: number;
+    maxUploadFps?: number;
+    activeRate?: number;
+    holdMs?: number;
+  }
+  export interface OverlayGovernorState {
+    mode: "active" | "low" | "idle" | "hidden" | "asleep";
+    ingestFps: number;
+    uploadFps: number;
+    damageRate: number;
+  }
+  export interface OverlayFollowConfig {
+    dampingMs?: number;
+    deadzoneDeg?: number;
+    deadzoneMeters?: number;
+    epsilon?: number;
+    upright?: boolean;
+  }
+  export interface OverlayPixelConvert {
+    premultiply?: boolean;
+    unpremultiply?: boolean;
+    swizzle?: boolean;
+    alphaThreshold?: number;
+    opacity?: number;
+  }
+  export interface OverlayRect {
+    x: number;
+    y: number;
+    width: number;
+    height: number;
+  }
+  export interface OverlayDerive {
+    source: OverlayTarget;
+    crop: OverlayRect;
+    place?: OverlayRect;
+    filter?: "box" | "bilinear";
+  }
+  export interface OverlayProps {
+    alpha?: number;
+    width?: number; // meters
+    transform?: number[]; // row-major 3x4, relative to the hmd
+    color?: number; // 0xrrggbb tint
+    sortOrder?: number;
+    visible?: boolean;
+  }
+  export interface OverlaySpriteProps {
+    x?: number;
+    y?: number;
+    z?: number;
+    opacity?: number;
+    visible?: boolean;
+  }
+  export interface OverlayTextStyle {
+    font?: "text" | "clock";
+    align?: "left" | "center" | "right";
+    color?: number; // 0xrrggbb
+  }
+  export interface PaintRecordStats {
+    frameCount: number;
+    rawBytes: number;
+    storedBytes: number;
+  }
+  export interface NativeLogRecord {
+    time: number;
+    level: "debug" | "info" | "warn" | "error";
+    code: string;
+    args: number[];
+    count: number;
+  }
   export function getRunningApp(): RunningApp;
-  export function playGame(arg: string): boolean;
+  export function setProcessMonitor(
+    names?: string[],
+    callback?: (event: ProcessEvent) => void
+  ): boolean;
+  // samples the processes the process monitor reports every intervalMs,
+  // none stops
+  export function setResourceSampler(intervalMs?: number): boolean;
+  export function getResourceSamples(): ResourceSamples;
+  export function playGame(arg: string): Promise<GameLaunch>;
   export function startOverlay(): boolean;
   export function stopOverlay(): void;
   export function setOverlayFrameBuffer(
@@ -54,5 +231,95 @@ declare module 'native' {
     height: number,
     data: Uint8Array
   ): void;
+  // copied on the gpu instead of through a bitmap. the handle is duplicated,
+  // release the texture whenever. false when it can't be taken (no running
+  // overlay, a backend without it, sprites or derive in use, three imports
+  // in a row that failed): send the bitmap and invalidate for a full one
+  // instead. throws a TypeError for a dmabuf without a stride
+  export function setOverlaySharedTexture(
+    target: OverlayTarget,
+    texture: OverlaySharedTexture
+  ): boolean;
+  export function setOverlayPixelConvert(
+    target: OverlayTarget,
+    convert: OverlayPixelConvert
+  ): boolean;
+  export function setOverlayDerive(
+    target: OverlayTarget,
+    derive?: OverlayDerive
+  ): boolean;
+  export function setOverlayProps(
+    target: OverlayTarget,
+    props: OverlayProps
+  ): boolean;
+  export function createOverlaySprite(
+    target: OverlayTarget,
+    width: number,
+    height: number,
+    rgba: Uint8Array,
+    props?: OverlaySpriteProps
+  ): number | undefined;
+  export function updateOverlaySprite(
+    target: OverlayTarget,
+    id: number,
+    props: OverlaySpriteProps
+  ): boolean;
+  export function setOverlaySpritePixels(
+    target: OverlayTarget,
+    id: number,
+    rgba: Uint8Array
+  ): boolean;
+  export function destroyOverlaySprite(
+    target: OverlayTarget,
+    id: number
+  ): boolean;
+  export function createOverlayText(
+    target: OverlayTarget,
+    width: number,
+    height: number,
+    style?: OverlayTextStyle,
+    props?: OverlaySpriteProps
+  ): number | undefined;
+  export function setOverlayText(
+    target: OverlayTarget,
+    id: number,
+    text: string
+  ): boolean;
+  export function measureOverlayText(
+    style: OverlayTextStyle | undefined,
+    text: string
+  ): { width: number; height: number } | undefined;
+  export function setOverlayHud(
+    target: OverlayTarget,
+    props?: OverlaySpriteProps
+  ): boolean;
   export function getVRDeviceList(): VRDevice[];
+  export function setOverlayGovernor(
+    config?: OverlayGovernorConfig,
+    callback?: (state: OverlayGovernorState) => void
+  ): boolean;
+  export function setOverlayFollow(
+    target: OverlayTarget,
+    config?: OverlayFollowConfig
+  ): boolean;
+  export function setOverlayWatchdog(
+    thresholdMs: number,
+    callback?: (stall: OverlayStall) => void
+  ): void;
+  export function getOverlayStats(): OverlayStats;
+  export function drainNativeLog(): NativeLogRecord[];
+  export function startPaintRecord(path: string): boolean;
+  export function stopPaintRecord(): PaintRecordStats | undefined;
+  export function captureOverlayFrame(
+    target: OverlayTarget
+  ): Uint8Array | undefined;
+  export function decodeOverlayFrame(data: Uint8Array): Uint8Array | undefined;
+  // only with the soft texture backend (VRCX_MOCK_VR=1), undefined otherwise
+  export function getOverlayTextureHash(
+    target: OverlayTarget
+  ): OverlayTextureHash | undefined;
+  export function dumpOverlayTexture(
+    target: OverlayTarget,
+    path: string
+  ): boolean;
 }
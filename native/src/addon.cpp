@@ -0,0 +1,3221 @@
+#include <stdlib.h>
+#include <string.h>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <openvr/openvr.h>
+#include "napi.h"
+#include "backend.h"
+#include "codec.h"
+#include "compositor.h"
+#include "device.h"
+#include "follow.h"
+#include "frame.h"
+#include "governor.h"
+#include "hud.h"
+#include "log.h"
+#include "pixel.h"
+#include "platform.h"
+#include "pool.h"
+#include "procmon.h"
+#include "props.h"
+#include "record.h"
+#include "sampler.h"
+#include "scale.h"
+#include "text.h"
+#include "texture.h"
+#include "watchdog.h"
+
+std::atomic<bool> isOverlayRunning_;
+std::atomic<bool> hasOverlayThread_;
+bool isMockVr_; // VRCX_MOCK_VR, read when the overlay starts
+const TEXTURE_BACKEND *textureBackend_;
+std::atomic<bool> isSharedReady_; // the running backend imports shared textures
+uint32_t sharedFailCount_;        // imports failed in a row, overlay thread only
+std::mutex sharedLock_;           // guards the pending shared frames
+TEXTURE_SHARED sharedPending_[TEXTURE_TARGET_COUNT];
+bool hasSharedPending_[TEXTURE_TARGET_COUNT];
+OVERLAY_DATA overlayDataHmd_;
+OVERLAY_DATA overlayDataWrist_;
+OVERLAY_DERIVE overlayDerive_[2]; // by target, js thread only
+std::atomic<bool> overlayHiddenHmd_; // read by getOverlayStats
+PROPS_BLOCK overlayPropsHmd_;
+OVERLAY_PROPS overlayPropsAppliedHmd_; // overlay thread only
+uint32_t overlayPropsVersionHmd_;      // overlay thread only
+std::atomic<uint64_t> overlayPropsApplyCount_;
+std::atomic<uint64_t> overlayPropsPushCount_;
+std::mutex followLock_; // guards everything follow below
+FOLLOW_CONFIG followConfig_;
+bool isFollowEnabled_;
+bool isFollowConfigChanged_;
+FOLLOW followHmd_;
+bool isFollowingHmd_;
+std::mutex procmonLock_;
+Napi::ThreadSafeFunction procmonCallback_;
+bool hasProcmonCallback_;
+VR_DEVICE_TABLE vrDeviceTable_;
+VR_DEVICE_DATA vrDeviceDataLocal_[vr::k_unMaxTrackedDeviceCount];
+vr::VROverlayHandle_t overlayHandleHmd_ = vr::k_ulOverlayHandleInvalid;
+vr::VROverlayHandle_t overlayHandleWrist_ = vr::k_ulOverlayHandleInvalid;
+std::atomic<bool> hasWatchdogThread_;
+std::mutex watchdogLock_;
+Napi::ThreadSafeFunction watchdogCallback_;
+bool hasWatchdogCallback_;
+std::atomic<uint32_t> watchdogThresholdMs_{1000};
+WATCHDOG watchdog_;
+PAINT_RECORDER paintRecorder_;
+TEXT_LABEL overlayTextLabels_[2][COMPOSITOR_MAX_SPRITES]; // js thread only
+HUD hud_;             // js thread only
+uint32_t hudTarget_;  // js thread only
+HUD_STATE hudPosted_; // overlay thread only
+std::mutex hudLock_;
+Napi::ThreadSafeFunction hudCallback_;
+bool hasHudCallback_;
+std::mutex governorLock_; // guards everything governor below
+GOVERNOR governorHmd_;
+GOVERNOR_CONFIG governorConfig_;
+bool isGovernorConfigChanged_;
+Napi::ThreadSafeFunction governorCallback_;
+bool hasGovernorCallback_;
+
+NOINLINE bool overlayInit(void)
+{
+    // each backend logs what failed itself. mock vr has no runtime to
+    // submit to, its frames go into the cpu mirror
+    for (textureBackend_ = isMockVr_ != false ? &textureBackendSoft : backendTexture();
+         textureBackend_ != NULL;
+         textureBackend_ = textureBackend_->fallback)
+    {
+        if (textureBackend_->init() != false)
+        {
+            textureSetBackend(textureBackend_);
+            isSharedReady_ = textureBackend_->importShared != NULL;
+            sharedFailCount_ = 0;
+            return true;
+        }
+        textureBackend_->exit();
+    }
+
+    return false;
+}
+
+// closes a shared frame the overlay thread hasn't taken yet
+void overlayDropShared(uint32_t target)
+{
+    std::lock_guard<std::mutex> guard(sharedLock_);
+
+    if (hasSharedPending_[target] != false)
+    {
+        backendSharedClose(sharedPending_[target].handle);
+        hasSharedPending_[target] = false;
+    }
+}
+
+NOINLINE void overlayExit(void)
+{
+    isSharedReady_ = false;
+    for (uint32_t target = 0; target < TEXTURE_TARGET_COUNT; ++target)
+    {
+        overlayDropShared(target);
+    }
+
+    textureBackend_->exit();
+}
+
+// true when the texture of target got a shared frame, which replaces
+// whatever the cpu frame had
+bool overlayImportShared(uint32_t target)
+{
+    TEXTURE_SHARED shared;
+
+    sharedLock_.lock();
+    auto hasShared = hasSharedPending_[target];
+    shared = sharedPending_[target];
+    hasSharedPending_[target] = false;
+    sharedLock_.unlock();
+
+    if (hasShared == false)
+    {
+        return false;
+    }
+
+    auto isImported = textureBackend_->importShared(target, &shared);
+    backendSharedClose(shared.handle);
+
+    // one bad frame costs that frame. refused from TEXTURE_SHARED_MAX_FAILS
+    // in a row on, js goes back to bitmaps
+    if (isImported == false)
+    {
+        logWrite(LOG_LEVEL_WARN, LOG_CODE_IMPORT_SHARED, target, sharedFailCount_);
+        if (++sharedFailCount_ >= TEXTURE_SHARED_MAX_FAILS)
+        {
+            isSharedReady_ = false;
+        }
+    }
+    else
+    {
+        sharedFailCount_ = 0;
+    }
+
+    return isImported;
+}
+
+NOINLINE bool overlaySetTexture(
+    vr::IVROverlay *pVROverlay,
+    vr::VROverlayHandle_t overlayHandle,
+    uint32_t target,
+    OVERLAY_DATA *overlayData)
+{
+    uint32_t dirtyRows;
+    auto isDirty = frameTakeDirty(overlayData, &dirtyRows);
+    if (overlayImportShared(target) == false && isDirty != false)
+    {
+        textureBackend_->upload(target, (const uint8_t *)overlayData->data, dirtyRows);
+    }
+
+    auto overlayError = textureBackend_->submit(pVROverlay, overlayHandle, target);
+    if (overlayError != vr::EVROverlayError::VROverlayError_None)
+    {
+        logWrite(LOG_LEVEL_ERROR, LOG_CODE_SET_OVERLAY_TEXTURE, overlayError);
+        return false;
+    }
+
+    return true;
+}
+
+NOINLINE bool overlaySetVisibleHmd(
+    vr::IVROverlay *pVROverlay,
+    bool isVisible)
+{
+    if ((isVisible != false) == (overlayHiddenHmd_ == false))
+    {
+        return true;
+    }
+
+    if (isVisible != false)
+    {
+        auto overlayError = pVROverlay->ShowOverlay(overlayHandleHmd_);
+        if (overlayError != vr::EVROverlayError::VROverlayError_None)
+        {
+            logWrite(LOG_LEVEL_ERROR, LOG_CODE_SHOW_OVERLAY, overlayError);
+            return false;
+        }
+    }
+    else
+    {
+        auto overlayError = pVROverlay->HideOverlay(overlayHandleHmd_);
+        if (overlayError != vr::EVROverlayError::VROverlayError_None)
+        {
+            logWrite(LOG_LEVEL_ERROR, LOG_CODE_HIDE_OVERLAY, overlayError);
+            return false;
+        }
+    }
+
+    overlayHiddenHmd_ = isVisible == false;
+    return true;
+}
+
+NOINLINE void overlayRenderHmdCleanup(vr::IVROverlay *pVROverlay)
+{
+    pVROverlay->DestroyOverlay(overlayHandleHmd_);
+    overlayHandleHmd_ = vr::k_ulOverlayHandleInvalid;
+}
+
+// pushes the PROPS_* in mask from overlayPropsAppliedHmd_
+NOINLINE bool overlayApplyPropsHmd(
+    vr::IVROverlay *pVROverlay,
+    uint32_t mask)
+{
+    auto props = &overlayPropsAppliedHmd_;
+
+    if ((mask & PROPS_ALPHA) != 0)
+    {
+        auto overlayError = pVROverlay->SetOverlayAlpha(
+            overlayHandleHmd_,
+            props->alpha);
+        if (overlayError != vr::EVROverlayError::VROverlayError_None)
+        {
+            logWrite(LOG_LEVEL_ERROR, LOG_CODE_SET_OVERLAY_ALPHA, overlayError);
+            return false;
+        }
+        ++overlayPropsPushCount_;
+    }
+
+    if ((mask & PROPS_WIDTH) != 0)
+    {
+        auto overlayError = pVROverlay->SetOverlayWidthInMeters(
+            overlayHandleHmd_,
+            props->widthInMeters);
+        if (overlayError != vr::EVROverlayError::VROverlayError_None)
+        {
+            logWrite(LOG_LEVEL_ERROR, LOG_CODE_SET_OVERLAY_WIDTH_IN_METERS, overlayError);
+            return false;
+        }
+        ++overlayPropsPushCount_;
+    }
+
+    // following: the offset is picked up by the next follow update
+    if ((mask & PROPS_TRANSFORM) != 0 && isFollowingHmd_ != false)
+    {
+        followLock_.lock();
+        followRetarget(&followHmd_);
+        followLock_.unlock();
+    }
+    else if ((mask & PROPS_TRANSFORM) != 0)
+    {
+        vr::HmdMatrix34_t hmdMatrix34;
+        memcpy(hmdMatrix34.m, props->transform, sizeof(hmdMatrix34.m));
+
+        auto overlayError = pVROverlay->SetOverlayTransformTrackedDeviceRelative(
+            overlayHandleHmd_,
+            vr::k_unTrackedDeviceIndex_Hmd,
+            &hmdMatrix34);
+        if (overlayError != vr::EVROverlayError::VROverlayError_None)
+        {
+            logWrite(LOG_LEVEL_ERROR, LOG_CODE_SET_OVERLAY_TRANSFORM, overlayError);
+            return false;
+        }
+        ++overlayPropsPushCount_;
+    }
+
+    if ((mask & PROPS_COLOR) != 0)
+    {
+        auto overlayError = pVROverlay->SetOverlayColor(
+            overlayHandleHmd_,
+            props->color[0],
+            props->color[1],
+            props->color[2]);
+        if (overlayError != vr::EVROverlayError::VROverlayError_None)
+        {
+            logWrite(LOG_LEVEL_ERROR, LOG_CODE_SET_OVERLAY_COLOR, overlayError);
+            return false;
+        }
+        ++overlayPropsPushCount_;
+    }
+
+    if ((mask & PROPS_SORT_ORDER) != 0)
+    {
+        auto overlayError = pVROverlay->SetOverlaySortOrder(
+            overlayHandleHmd_,
+            props->sortOrder);
+        if (overlayError != vr::EVROverlayError::VROverlayError_None)
+        {
+            logWrite(LOG_LEVEL_ERROR, LOG_CODE_SET_OVERLAY_SORT_ORDER, overlayError);
+            return false;
+        }
+        ++overlayPropsPushCount_;
+    }
+
+    // show or hide with the next render, which also knows about the frame
+    if ((mask & PROPS_VISIBLE) != 0)
+    {
+        overlayDataHmd_.dirty = true;
+    }
+
+    return true;
+}
+
+NOINLINE bool overlayRenderHmdInit(vr::IVROverlay *pVROverlay)
+{
+    auto overlayError = pVROverlay->FindOverlay(
+        "VRCX_HMD",
+        &overlayHandleHmd_);
+
+    if (overlayError != vr::EVROverlayError::VROverlayError_None)
+    {
+        if (overlayError != vr::EVROverlayError::VROverlayError_UnknownOverlay)
+        {
+            logWrite(LOG_LEVEL_ERROR, LOG_CODE_FIND_OVERLAY, overlayError);
+            return false;
+        }
+
+        overlayError = pVROverlay->CreateOverlay(
+            "VRCX_HMD",
+            "VRCX_HMD",
+            &overlayHandleHmd_);
+        if (overlayError != vr::EVROverlayError::VROverlayError_None)
+        {
+            logWrite(LOG_LEVEL_ERROR, LOG_CODE_CREATE_OVERLAY, overlayError);
+            return false;
+        }
+    }
+
+    overlayError = pVROverlay->SetOverlayInputMethod(
+        overlayHandleHmd_,
+        vr::VROverlayInputMethod::VROverlayInputMethod_None);
+    if (overlayError != vr::EVROverlayError::VROverlayError_None)
+    {
+        logWrite(LOG_LEVEL_ERROR, LOG_CODE_SET_OVERLAY_INPUT_METHOD, overlayError);
+        overlayRenderHmdCleanup(pVROverlay);
+        return false;
+    }
+
+    // a new overlay gets everything, whatever was applied before
+    overlayPropsVersionHmd_ = UINT32_MAX;
+    propsBlockTake(&overlayPropsHmd_, &overlayPropsAppliedHmd_, &overlayPropsVersionHmd_);
+    ++overlayPropsApplyCount_;
+
+    if (overlayApplyPropsHmd(pVROverlay, PROPS_ALL & ~PROPS_VISIBLE) == false)
+    {
+        overlayRenderHmdCleanup(pVROverlay);
+        return false;
+    }
+
+    // nothing drawn yet or hidden by js, stay hidden until that changes
+    if (frameIsEmpty(&overlayDataHmd_) != false ||
+        overlayPropsAppliedHmd_.isVisible == false)
+    {
+        overlayDataHmd_.dirty = false;
+        overlayHiddenHmd_ = false; // a found overlay may still be showing
+        if (overlaySetVisibleHmd(pVROverlay, false) == false)
+        {
+            overlayRenderHmdCleanup(pVROverlay);
+            return false;
+        }
+        return true;
+    }
+
+    if (overlaySetTexture(
+            pVROverlay,
+            overlayHandleHmd_,
+            0,
+            &overlayDataHmd_) == false)
+    {
+        overlayRenderHmdCleanup(pVROverlay);
+        return false;
+    }
+
+    overlayHiddenHmd_ = true; // force the ShowOverlay call
+    if (overlaySetVisibleHmd(pVROverlay, true) == false)
+    {
+        overlayRenderHmdCleanup(pVROverlay);
+        return false;
+    }
+
+    return true;
+}
+
+NOINLINE void overlayRenderHmd(vr::IVROverlay *pVROverlay)
+{
+    if (overlayHandleHmd_ == vr::k_ulOverlayHandleInvalid)
+    {
+        overlayRenderHmdInit(pVROverlay);
+        return;
+    }
+
+    if (overlayDataHmd_.dirty == false)
+    {
+        return;
+    }
+
+    // fully transparent: hide rather than submit a texture of nothing.
+    // hidden by js: no point uploading either
+    if (frameIsEmpty(&overlayDataHmd_) != false ||
+        overlayPropsAppliedHmd_.isVisible == false)
+    {
+        overlayDataHmd_.dirty = false;
+        if (overlaySetVisibleHmd(pVROverlay, false) == false)
+        {
+            overlayRenderHmdCleanup(pVROverlay);
+        }
+        return;
+    }
+
+    if (overlaySetTexture(
+            pVROverlay,
+            overlayHandleHmd_,
+            0,
+            &overlayDataHmd_) == false)
+    {
+        overlayRenderHmdCleanup(pVROverlay);
+        return;
+    }
+
+    if (overlaySetVisibleHmd(pVROverlay, true) == false)
+    {
+        overlayRenderHmdCleanup(pVROverlay);
+    }
+}
+
+// returns true when the change needs a render to show, i.e. visibility
+NOINLINE bool overlayUpdatePropsHmd(vr::IVROverlay *pVROverlay)
+{
+    if (overlayHandleHmd_ == vr::k_ulOverlayHandleInvalid)
+    {
+        return false;
+    }
+
+    OVERLAY_PROPS props;
+    if (propsBlockTake(&overlayPropsHmd_, &props, &overlayPropsVersionHmd_) == false)
+    {
+        return false;
+    }
+
+    auto mask = propsDiff(&overlayPropsAppliedHmd_, &props);
+    if (mask == 0)
+    {
+        return false;
+    }
+
+    overlayPropsAppliedHmd_ = props;
+    ++overlayPropsApplyCount_;
+
+    if (overlayApplyPropsHmd(pVROverlay, mask) == false)
+    {
+        overlayRenderHmdCleanup(pVROverlay);
+        return false;
+    }
+
+    return (mask & PROPS_VISIBLE) != 0 ? true : false;
+}
+
+// moves a following overlay after the head, called every poll
+NOINLINE void overlayUpdateFollowHmd(
+    vr::IVRSystem *pVRSystem,
+    vr::IVROverlay *pVROverlay)
+{
+    if (overlayHandleHmd_ == vr::k_ulOverlayHandleInvalid)
+    {
+        return;
+    }
+
+    followLock_.lock();
+
+    if (isFollowConfigChanged_ != false)
+    {
+        isFollowConfigChanged_ = false;
+        followInit(&followHmd_, &followConfig_);
+
+        // back to riding along with the hmd
+        if (isFollowEnabled_ == false && isFollowingHmd_ != false)
+        {
+            isFollowingHmd_ = false;
+            if (overlayApplyPropsHmd(pVROverlay, PROPS_TRANSFORM) == false)
+            {
+                overlayRenderHmdCleanup(pVROverlay);
+            }
+        }
+
+        isFollowingHmd_ = isFollowEnabled_;
+    }
+
+    vr::TrackedDevicePose_t pose;
+    float transform[12];
+
+    if (isFollowingHmd_ != false &&
+        overlayHandleHmd_ != vr::k_ulOverlayHandleInvalid)
+    {
+        pVRSystem->GetDeviceToAbsoluteTrackingPose(
+            vr::ETrackingUniverseOrigin::TrackingUniverseStanding,
+            0.0f,
+            &pose,
+            1);
+
+        if (pose.bPoseIsValid != false &&
+            followUpdate(
+                &followHmd_,
+                &pose.mDeviceToAbsoluteTracking.m[0][0],
+                overlayPropsAppliedHmd_.transform,
+                platformNowNs(),
+                transform) != false)
+        {
+            vr::HmdMatrix34_t hmdMatrix34;
+            memcpy(hmdMatrix34.m, transform, sizeof(hmdMatrix34.m));
+
+            auto overlayError = pVROverlay->SetOverlayTransformAbsolute(
+                overlayHandleHmd_,
+                vr::ETrackingUniverseOrigin::TrackingUniverseStanding,
+                &hmdMatrix34);
+            if (overlayError != vr::EVROverlayError::VROverlayError_None)
+            {
+                logWrite(LOG_LEVEL_ERROR, LOG_CODE_SET_OVERLAY_TRANSFORM, overlayError);
+                overlayRenderHmdCleanup(pVROverlay);
+            }
+            else
+            {
+                ++overlayPropsPushCount_;
+            }
+        }
+    }
+
+    followLock_.unlock();
+}
+
+NOINLINE bool overlayPollEvent(vr::IVRSystem *pVRSystem)
+{
+    vr::VREvent_t event;
+
+    while (pVRSystem->PollNextEvent(&event, sizeof(event)) != false)
+    {
+        logWrite(
+            LOG_LEVEL_DEBUG,
+            LOG_CODE_VR_EVENT,
+            event.eventType,
+            event.trackedDeviceIndex);
+        if (event.eventType == vr::EVREventType::VREvent_Quit)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+NOINLINE void overlayUpdateTrackedDevices(vr::IVRSystem *pVRSystem)
+{
+    vr::VRControllerState_t state;
+
+    vrDeviceTable_.count = 0;
+
+    for (uint32_t devIndex = 0u; devIndex < vr::k_unMaxTrackedDeviceCount; ++devIndex)
+    {
+        auto devClass = pVRSystem->GetTrackedDeviceClass(devIndex);
+        if (devClass == vr::ETrackedDeviceClass::TrackedDeviceClass_Invalid)
+        {
+            continue;
+        }
+
+        auto deviceData = &vrDeviceTable_.data[vrDeviceTable_.count++];
+        deviceData->deviceClass = devClass;
+
+        deviceData->isConnected =
+            pVRSystem->IsTrackedDeviceConnected(devIndex);
+
+        deviceData->isCharging =
+            pVRSystem->GetBoolTrackedDeviceProperty(
+                devIndex,
+                vr::ETrackedDeviceProperty::Prop_DeviceIsCharging_Bool);
+
+        deviceData->batteryPercentage =
+            pVRSystem->GetFloatTrackedDeviceProperty(
+                devIndex,
+                vr::ETrackedDeviceProperty::Prop_DeviceBatteryPercentage_Float);
+
+        if (devClass == vr::ETrackedDeviceClass::TrackedDeviceClass_Controller)
+        {
+            deviceData->controllerRole =
+                pVRSystem->GetControllerRoleForTrackedDeviceIndex(devIndex);
+
+            if (pVRSystem->GetControllerState(
+                    devIndex,
+                    &state,
+                    sizeof(state)) == false)
+            {
+                deviceData->buttonPressedMask = 0;
+                deviceData->buttonTouchedMask = 0;
+            }
+            else
+            {
+                deviceData->buttonPressedMask = state.ulButtonPressed;
+                deviceData->buttonTouchedMask = state.ulButtonTouched;
+            }
+        }
+        else
+        {
+            deviceData->controllerRole =
+                vr::ETrackedControllerRole::TrackedControllerRole_Invalid;
+            deviceData->buttonPressedMask = 0;
+            deviceData->buttonTouchedMask = 0;
+        }
+    }
+}
+
+OVERLAY_DATA *overlayDataFromTarget(uint32_t id)
+{
+    return id == 0 ? &overlayDataHmd_ : &overlayDataWrist_;
+}
+
+// after anything on the js thread that may have written the frame of id
+// (paints, sprites, text, the hud): the overlays derived from it resample
+// what changed
+void overlayDeriveFlush(uint32_t id)
+{
+    auto overlayData = overlayDataFromTarget(id);
+
+    uint32_t x, y, width, height;
+    if (frameTakeDamage(overlayData, &x, &y, &width, &height) == false)
+    {
+        return;
+    }
+
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        auto derive = &overlayDerive_[i];
+        if (derive->isEnabled != false && derive->source == id)
+        {
+            overlayDeriveUpdate(
+                derive,
+                overlayData,
+                overlayDataFromTarget(i),
+                x,
+                y,
+                width,
+                height);
+        }
+    }
+}
+
+void hudCallJs(Napi::Env env, Napi::Function callback, HUD_STATE *state)
+{
+    if (env != nullptr && hud_.spriteId != 0)
+    {
+        hudUpdate(overlayDataFromTarget(hudTarget_), &hud_, state);
+        overlayDeriveFlush(hudTarget_);
+    }
+
+    delete state;
+}
+
+// hands the hud's view of the device table to the js thread when it changed.
+// called with the table locked
+void overlayPostHud(void)
+{
+    HUD_STATE state;
+    hudStateFromDevices(&state, vrDeviceTable_.data, vrDeviceTable_.count);
+
+    if (hudStateEquals(&state, &hudPosted_) != false)
+    {
+        return;
+    }
+
+    hudLock_.lock();
+
+    if (hasHudCallback_ != false)
+    {
+        auto data = new HUD_STATE(state);
+        if (hudCallback_.NonBlockingCall(data, hudCallJs) != napi_ok)
+        {
+            delete data;
+        }
+        else
+        {
+            hudPosted_ = state;
+        }
+    }
+
+    hudLock_.unlock();
+}
+
+void governorCallJs(Napi::Env env, Napi::Function callback, GOVERNOR *governor)
+{
+    if (env != nullptr && callback != nullptr)
+    {
+        auto obj = Napi::Object::New(env);
+
+        obj.Set(
+            "mode",
+            Napi::String::New(
+                env,
+                governorModeName(governor->mode)));
+
+        obj.Set(
+            "ingestFps",
+            Napi::Number::New(
+                env,
+                governor->ingestFps));
+
+        obj.Set(
+            "uploadFps",
+            Napi::Number::New(
+                env,
+                governor->uploadFps));
+
+        obj.Set(
+            "damageRate",
+            Napi::Number::New(
+                env,
+                governorDamageRate(governor)));
+
+        callback.Call({obj});
+    }
+
+    delete governor;
+}
+
+bool overlayIsHmdWorn(vr::IVRSystem *pVRSystem)
+{
+    // unknown counts as worn, better too fast than frozen
+    auto level = pVRSystem->GetTrackedDeviceActivityLevel(vr::k_unTrackedDeviceIndex_Hmd);
+    return level != vr::EDeviceActivityLevel::k_EDeviceActivityLevel_Idle &&
+           level != vr::EDeviceActivityLevel::k_EDeviceActivityLevel_Idle_Timeout &&
+           level != vr::EDeviceActivityLevel::k_EDeviceActivityLevel_Standby;
+}
+
+// returns true when the hmd overlay's rates changed
+NOINLINE bool overlayUpdateGovernor(bool isWorn)
+{
+    auto nowNs = platformNowNs();
+    auto damageCount = overlayDataHmd_.damageCount.load(std::memory_order_relaxed);
+    auto isChanged = false;
+
+    governorLock_.lock();
+
+    if (isGovernorConfigChanged_ != false)
+    {
+        governorInit(&governorHmd_, &governorConfig_, nowNs, damageCount);
+        isGovernorConfigChanged_ = false;
+        isChanged = true;
+    }
+
+    if (governorUpdate(
+            &governorHmd_,
+            nowNs,
+            damageCount,
+            frameIsEmpty(&overlayDataHmd_),
+            isWorn) != false)
+    {
+        isChanged = true;
+    }
+
+    if (isChanged != false && hasGovernorCallback_ != false)
+    {
+        auto data = new GOVERNOR(governorHmd_);
+        if (governorCallback_.NonBlockingCall(data, governorCallJs) != napi_ok)
+        {
+            delete data;
+        }
+    }
+
+    governorLock_.unlock();
+
+    return isChanged;
+}
+
+NOINLINE void overlayShutdown(void)
+{
+    watchdogBeat(&watchdog_, OVERLAY_PHASE_SHUTDOWN);
+
+    auto pVROverlay = vr::VROverlay();
+    if (pVROverlay != NULL)
+    {
+        overlayRenderHmdCleanup(pVROverlay);
+    }
+
+    overlayHandleHmd_ = vr::k_ulOverlayHandleInvalid;
+    overlayHandleWrist_ = vr::k_ulOverlayHandleInvalid;
+    vrDeviceTable_.count = 0;
+
+    vr::VR_Shutdown();
+}
+
+NOINLINE void overlayLoop(void)
+{
+    uint64_t nextRenderNs = 0;
+
+    while (isOverlayRunning_ != false)
+    {
+        auto pVRSystem = vr::VRSystem();
+        if (pVRSystem == NULL)
+        {
+            watchdogBeat(&watchdog_, OVERLAY_PHASE_INIT);
+
+            auto initError = vr::EVRInitError::VRInitError_None;
+
+            pVRSystem = vr::VR_Init(
+                &initError,
+                vr::EVRApplicationType::VRApplication_Overlay);
+
+            if (initError != vr::EVRInitError::VRInitError_None)
+            {
+                logWrite(LOG_LEVEL_WARN, LOG_CODE_VR_INIT, initError);
+                watchdogBeat(&watchdog_, OVERLAY_PHASE_SLEEP, 5000000000ull);
+                platformSleepMs(5000); // 5s
+                continue;
+            }
+        }
+
+        watchdogBeat(&watchdog_, OVERLAY_PHASE_POLL_EVENT);
+
+        if (overlayPollEvent(pVRSystem) == false)
+        {
+            logWrite(LOG_LEVEL_INFO, LOG_CODE_VR_QUIT);
+            overlayShutdown();
+            watchdogBeat(&watchdog_, OVERLAY_PHASE_SLEEP, 10000000000ull);
+            platformSleepMs(10000); // 10s
+            continue;
+        }
+
+        if (vrDeviceTable_.lock.try_lock() != false)
+        {
+            watchdogBeat(&watchdog_, OVERLAY_PHASE_UPDATE_DEVICES);
+            overlayUpdateTrackedDevices(pVRSystem);
+            overlayPostHud();
+            vrDeviceTable_.lock.unlock();
+        }
+
+        // a rate change renders right away, e.g. from 1fps back to 20fps
+        if (overlayUpdateGovernor(overlayIsHmdWorn(pVRSystem)) != false)
+        {
+            nextRenderNs = 0;
+        }
+
+        auto pVROverlay = vr::VROverlay();
+        if (pVROverlay != NULL)
+        {
+            watchdogBeat(&watchdog_, OVERLAY_PHASE_UPDATE_PROPS);
+            if (overlayUpdatePropsHmd(pVROverlay) != false)
+            {
+                nextRenderNs = 0;
+            }
+            overlayUpdateFollowHmd(pVRSystem, pVROverlay);
+        }
+
+        auto nowNs = platformNowNs();
+        if (nowNs >= nextRenderNs)
+        {
+            governorLock_.lock();
+            nextRenderNs = nowNs + governorUploadIntervalNs(&governorHmd_);
+            governorLock_.unlock();
+
+            if (pVROverlay != NULL)
+            {
+                watchdogBeat(&watchdog_, OVERLAY_PHASE_RENDER);
+                overlayRenderHmd(pVROverlay);
+            }
+        }
+
+        watchdogBeat(&watchdog_, OVERLAY_PHASE_SLEEP, 10000000ull);
+        platformSleepMs(10); // 0.01s
+    }
+
+    overlayShutdown();
+}
+
+// VRCX_MOCK_VR=1: the loop above without a runtime. the mock device table
+// stands in for the trackers and frames go to textureBackendSoft
+NOINLINE void overlayLoopMock(void)
+{
+    auto startNs = platformNowNs();
+    uint64_t nextRenderNs = 0;
+
+    while (isOverlayRunning_ != false)
+    {
+        watchdogBeat(&watchdog_, OVERLAY_PHASE_UPDATE_DEVICES);
+
+        vrDeviceTable_.lock.lock();
+        deviceTableFillMock(&vrDeviceTable_, (platformNowNs() - startNs) / 1000000ull);
+        overlayPostHud();
+        vrDeviceTable_.lock.unlock();
+
+        if (overlayUpdateGovernor(true) != false)
+        {
+            nextRenderNs = 0;
+        }
+
+        watchdogBeat(&watchdog_, OVERLAY_PHASE_UPDATE_PROPS);
+
+        OVERLAY_PROPS props;
+        if (propsBlockTake(&overlayPropsHmd_, &props, &overlayPropsVersionHmd_) != false)
+        {
+            if ((propsDiff(&overlayPropsAppliedHmd_, &props) & PROPS_VISIBLE) != 0)
+            {
+                overlayDataHmd_.dirty = true;
+                nextRenderNs = 0;
+            }
+            overlayPropsAppliedHmd_ = props;
+            ++overlayPropsApplyCount_;
+        }
+
+        auto nowNs = platformNowNs();
+        if (nowNs >= nextRenderNs)
+        {
+            governorLock_.lock();
+            nextRenderNs = nowNs + governorUploadIntervalNs(&governorHmd_);
+            governorLock_.unlock();
+
+            watchdogBeat(&watchdog_, OVERLAY_PHASE_RENDER);
+
+            uint32_t dirtyRows;
+            if (overlayDataHmd_.dirty != false)
+            {
+                auto isVisible =
+                    frameIsEmpty(&overlayDataHmd_) == false &&
+                    overlayPropsAppliedHmd_.isVisible != false;
+                if (isVisible == false)
+                {
+                    overlayDataHmd_.dirty = false; // rows stay for the next upload
+                }
+                else if (frameTakeDirty(&overlayDataHmd_, &dirtyRows) != false)
+                {
+                    textureBackend_->upload(0, (const uint8_t *)overlayDataHmd_.data, dirtyRows);
+                    textureBackend_->submit(NULL, vr::k_ulOverlayHandleInvalid, 0);
+                }
+                overlayHiddenHmd_ = isVisible == false;
+            }
+        }
+
+        watchdogBeat(&watchdog_, OVERLAY_PHASE_SLEEP, 10000000ull);
+        platformSleepMs(10); // 0.01s
+    }
+
+    watchdogBeat(&watchdog_, OVERLAY_PHASE_SHUTDOWN);
+    vrDeviceTable_.count = 0;
+}
+
+void overlayThreadRoutine(void)
+{
+    logWrite(LOG_LEVEL_INFO, LOG_CODE_OVERLAY_INIT);
+
+    watchdogBeat(&watchdog_, OVERLAY_PHASE_INIT);
+
+    if (overlayInit() != false)
+    {
+        if (isMockVr_ != false)
+        {
+            overlayLoopMock();
+        }
+        else
+        {
+            overlayLoop();
+        }
+        overlayExit();
+    }
+
+    watchdogReset(&watchdog_);
+
+    logWrite(LOG_LEVEL_INFO, LOG_CODE_OVERLAY_SHUTDOWN);
+
+    hasOverlayThread_ = false;
+}
+
+void watchdogCallJs(Napi::Env env, Napi::Function callback, WATCHDOG_STALL *stall)
+{
+    if (env != nullptr && callback != nullptr)
+    {
+        auto obj = Napi::Object::New(env);
+
+        obj.Set(
+            "phase",
+            Napi::String::New(
+                env,
+                watchdogPhaseName(stall->phase)));
+
+        obj.Set(
+            "durationMs",
+            Napi::Number::New(
+                env,
+                stall->durationNs / 1000000.0));
+
+        obj.Set(
+            "isResolved",
+            Napi::Boolean::New(
+                env,
+                stall->isResolved));
+
+        callback.Call({obj});
+    }
+
+    delete stall;
+}
+
+void watchdogThreadRoutine(void)
+{
+    WATCHDOG_STALL stall;
+
+    while (isOverlayRunning_ != false)
+    {
+        auto thresholdMs = watchdogThresholdMs_.load(std::memory_order_relaxed);
+
+        if (watchdogCheck(
+                &watchdog_,
+                platformNowNs(),
+                thresholdMs * 1000000ull,
+                &stall) != false)
+        {
+            watchdogLock_.lock();
+
+            if (hasWatchdogCallback_ != false)
+            {
+                auto data = new WATCHDOG_STALL(stall);
+                if (watchdogCallback_.NonBlockingCall(data, watchdogCallJs) != napi_ok)
+                {
+                    delete data;
+                }
+            }
+
+            watchdogLock_.unlock();
+        }
+
+        // check a few times per threshold so a stall is reported close to it
+        auto intervalMs = thresholdMs / 4;
+        platformSleepMs(intervalMs < 10 ? 10 : intervalMs > 250 ? 250 : intervalMs);
+    }
+
+    hasWatchdogThread_ = false;
+}
+
+Napi::Value getRunningApp(const Napi::CallbackInfo &info)
+{
+    auto env = info.Env();
+    auto obj = Napi::Object::New(env);
+
+    bool isVrchat;
+    bool isSteamvr;
+    backendGetRunningApp(&isVrchat, &isSteamvr);
+
+    obj.Set(
+        "vrchat",
+        Napi::Boolean::New(
+            env,
+            isVrchat));
+
+    obj.Set(
+        "steamvr",
+        Napi::Boolean::New(
+            env,
+            isSteamvr));
+
+    return obj;
+}
+
+void procmonCallJs(Napi::Env env, Napi::Function callback, PROCMON_EVENT *event)
+{
+    if (env != nullptr && callback != nullptr)
+    {
+        auto obj = Napi::Object::New(env);
+
+        obj.Set(
+            "name",
+            Napi::String::New(
+                env,
+                event->name));
+
+        obj.Set(
+            "pid",
+            Napi::Number::New(
+                env,
+                event->pid));
+
+        obj.Set(
+            "isRunning",
+            Napi::Boolean::New(
+                env,
+                event->isRunning));
+
+        callback.Call({obj});
+    }
+
+    delete event;
+}
+
+// runs on the monitor thread
+void procmonPost(const PROCMON_EVENT *event, void *context)
+{
+    // the game and the runtime get sampled while they run
+    samplerTrack(event->pid, event->name, event->isRunning);
+
+    procmonLock_.lock();
+
+    if (hasProcmonCallback_ != false)
+    {
+        auto data = new PROCMON_EVENT(*event);
+        if (procmonCallback_.NonBlockingCall(data, procmonCallJs) != napi_ok)
+        {
+            delete data;
+        }
+    }
+
+    procmonLock_.unlock();
+}
+
+Napi::Value setProcessMonitor(const Napi::CallbackInfo &info)
+{
+    auto env = info.Env();
+
+    std::string names[PROCMON_MAX_NAMES];
+    const char *namePointers[PROCMON_MAX_NAMES];
+    uint32_t count = 0;
+
+    // no names: stop watching
+    auto arg0 = info[0];
+    if (arg0.IsArray() != false)
+    {
+        auto arr = arg0.As<Napi::Array>();
+        count = arr.Length();
+        if (count == 0 || count > PROCMON_MAX_NAMES || info[1].IsFunction() == false)
+        {
+            return Napi::Boolean::New(env, false);
+        }
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            auto value = arr.Get(i);
+            if (value.IsString() == false)
+            {
+                return Napi::Boolean::New(env, false);
+            }
+            names[i] = value.ToString().Utf8Value();
+            namePointers[i] = names[i].c_str();
+        }
+    }
+    else if (arg0.IsUndefined() == false)
+    {
+        return Napi::Boolean::New(env, false);
+    }
+
+    // nothing is posted once this returns
+    procmonStop();
+
+    procmonLock_.lock();
+
+    if (hasProcmonCallback_ != false)
+    {
+        procmonCallback_.Release();
+        hasProcmonCallback_ = false;
+    }
+
+    if (count != 0)
+    {
+        procmonCallback_ = Napi::ThreadSafeFunction::New(
+            env,
+            info[1].As<Napi::Function>(),
+            "processMonitor",
+            0,
+            1);
+        procmonCallback_.Unref(env);
+        hasProcmonCallback_ = true;
+    }
+
+    procmonLock_.unlock();
+
+    if (count != 0 &&
+        procmonStart(namePointers, count, procmonPost, NULL) == false)
+    {
+        procmonLock_.lock();
+        procmonCallback_.Release();
+        hasProcmonCallback_ = false;
+        procmonLock_.unlock();
+        return Napi::Boolean::New(env, false);
+    }
+
+    return Napi::Boolean::New(env, true);
+}
+
+Napi::Value setResourceSampler(const Napi::CallbackInfo &info)
+{
+    auto env = info.Env();
+
+    // no interval: stop sampling, what was sampled stays readable
+    auto arg0 = info[0];
+    if (arg0.IsNumber() == false)
+    {
+        samplerStop();
+        return Napi::Boolean::New(env, true);
+    }
+
+    auto intervalMs = arg0.As<Napi::Number>().Uint32Value();
+
+    return Napi::Boolean::New(env, samplerStart(intervalMs));
+}
+
+Napi::Value getResourceSamples(const Napi::CallbackInfo &info)
+{
+    auto env = info.Env();
+    auto obj = Napi::Object::New(env);
+
+    SAMPLER_STATS stats;
+    samplerGetStats(&stats);
+
+    obj.Set(
+        "intervalMs",
+        Napi::Number::New(
+            env,
+            stats.intervalMs));
+
+    obj.Set(
+        "sampleCount",
+        Napi::Number::New(
+            env,
+            (double)stats.sampleCount));
+
+    obj.Set(
+        "failCount",
+        Napi::Number::New(
+            env,
+            (double)stats.failCount));
+
+    obj.Set(
+        "nsPerSample",
+        Napi::Number::New(
+            env,
+            stats.sampleCount != 0 ? (double)stats.sampleNs / (double)stats.sampleCount : 0.0));
+
+    auto processes = Napi::Array::New(env);
+    uint32_t length = 0;
+    Napi::ArrayBuffer buffer;
+
+    for (uint32_t i = 0; i < SAMPLER_MAX_PROCESSES; ++i)
+    {
+        // the ring is copied straight into the array's memory
+        if (buffer.IsEmpty() != false)
+        {
+            buffer = Napi::ArrayBuffer::New(env, SAMPLER_RING_SIZE * SAMPLER_FIELD_COUNT * sizeof(double));
+        }
+
+        SAMPLER_PROCESS_INFO processInfo;
+        uint32_t count;
+        if (samplerRead(i, &processInfo, (double *)buffer.Data(), &count) == false)
+        {
+            continue;
+        }
+
+        auto process = Napi::Object::New(env);
+
+        process.Set(
+            "name",
+            Napi::String::New(
+                env,
+                processInfo.name));
+
+        process.Set(
+            "pid",
+            Napi::Number::New(
+                env,
+                processInfo.pid));
+
+        process.Set(
+            "isRunning",
+            Napi::Boolean::New(
+                env,
+                processInfo.isRunning));
+
+        process.Set(
+            "hasIo",
+            Napi::Boolean::New(
+                env,
+                processInfo.hasIo));
+
+        process.Set(
+            "samples",
+            Napi::Float64Array::New(
+                env,
+                count * SAMPLER_FIELD_COUNT,
+                buffer,
+                0,
+                napi_float64_array));
+
+        processes.Set(length++, process);
+        buffer = Napi::ArrayBuffer();
+    }
+
+    obj.Set("processes", processes);
+
+    return obj;
+}
+
+typedef struct _PLAY_GAME
+{
+    Napi::Promise::Deferred deferred;
+    Napi::ThreadSafeFunction resolver;
+    std::string launchOption; // utf-8
+    bool isLaunched;
+    uint32_t pid;
+    uint64_t requestNs;
+    uint64_t spawnNs;
+} PLAY_GAME;
+
+Napi::Object playGameResult(Napi::Env env, const PLAY_GAME *launch)
+{
+    auto obj = Napi::Object::New(env);
+
+    obj.Set(
+        "isLaunched",
+        Napi::Boolean::New(
+            env,
+            launch->isLaunched));
+
+    obj.Set(
+        "pid",
+        Napi::Number::New(
+            env,
+            launch->pid));
+
+    obj.Set(
+        "spawnMs",
+        Napi::Number::New(
+            env,
+            launch->isLaunched != false ? (double)(launch->spawnNs - launch->requestNs) / 1e6 : 0.0));
+
+    return obj;
+}
+
+// the resolver only carries the result back, it has nothing to call
+Napi::Value playGameNoop(const Napi::CallbackInfo &info)
+{
+    return info.Env().Undefined();
+}
+
+void playGameCallJs(Napi::Env env, Napi::Function callback, PLAY_GAME *launch)
+{
+    if (env != nullptr)
+    {
+        launch->deferred.Resolve(playGameResult(env, launch));
+    }
+
+    delete launch;
+}
+
+void playGameThreadRoutine(PLAY_GAME *launch)
+{
+    if (backendSpawnGame(launch->launchOption.c_str(), &launch->pid) != false)
+    {
+        launch->isLaunched = true;
+        launch->spawnNs = platformNowNs();
+    }
+
+    auto resolver = launch->resolver;
+    if (resolver.BlockingCall(launch, playGameCallJs) != napi_ok)
+    {
+        delete launch;
+    }
+    resolver.Release();
+}
+
+Napi::Value playGame(const Napi::CallbackInfo &info)
+{
+    auto env = info.Env();
+
+    auto launch = new PLAY_GAME{
+        Napi::Promise::Deferred::New(env),
+        Napi::ThreadSafeFunction(),
+        std::string(),
+        false,
+        0,
+        platformNowNs(),
+        0};
+    auto promise = launch->deferred.Promise();
+
+    auto arg0 = info[0];
+    if (arg0.IsString() == false)
+    {
+        launch->deferred.Resolve(playGameResult(env, launch));
+        delete launch;
+        return promise;
+    }
+    launch->launchOption = arg0.ToString().Utf8Value();
+
+    // spawning blocks for as long as the os takes, off the main thread
+    launch->resolver = Napi::ThreadSafeFunction::New(
+        env,
+        Napi::Function::New(env, playGameNoop),
+        "playGame",
+        0,
+        1);
+
+    std::thread(playGameThreadRoutine, launch).detach();
+
+    return promise;
+}
+
+Napi::Value startOverlay(const Napi::CallbackInfo &info)
+{
+    auto env = info.Env();
+
+    if (hasOverlayThread_ == false)
+    {
+        // no runtime at all: mock devices and frames that go nowhere
+        auto mockVr = getenv("VRCX_MOCK_VR");
+        isMockVr_ = mockVr != NULL && strcmp(mockVr, "1") == 0;
+
+        isOverlayRunning_ = true;
+        hasOverlayThread_ = true;
+        std::thread(overlayThreadRoutine).detach();
+    }
+
+    if (hasWatchdogThread_ == false)
+    {
+        hasWatchdogThread_ = true;
+        std::thread(watchdogThreadRoutine).detach();
+    }
+
+    return Napi::Boolean::New(env, true);
+}
+
+Napi::Value stopOverlay(const Napi::CallbackInfo &info)
+{
+    auto env = info.Env();
+
+    isOverlayRunning_ = false;
+
+    return env.Undefined();
+}
+
+Napi::Value setOverlayFrameBuffer(const Napi::CallbackInfo &info)
+{
+    auto env = info.Env();
+
+    if (info.Length() != 6)
+    {
+        return env.Undefined();
+    }
+
+    auto x = info[1].ToNumber().Uint32Value();
+    auto y = info[2].ToNumber().Uint32Value();
+    auto width = info[3].ToNumber().Uint32Value();
+    auto height = info[4].ToNumber().Uint32Value();
+
+    // sanity check
+    if (frameIsValidRect(x, y, width, height) == false)
+    {
+        return env.Undefined();
+    }
+
+    auto arg5 = info[5];
+    if (arg5.IsTypedArray() == false)
+    {
+        return env.Undefined();
+    }
+
+    auto data = arg5.As<Napi::Uint8Array>();
+    if (data.ByteLength() != FRAME_SIZE)
+    {
+        return env.Undefined();
+    }
+
+    auto id = info[0].ToNumber().Uint32Value();
+
+    if (paintRecorder_.file != NULL && id <= 1)
+    {
+        paintRecorderWrite(
+            &paintRecorder_,
+            id,
+            data.Data(),
+            x,
+            y,
+            width,
+            height);
+    }
+
+    // a derived overlay is drawn from its source only
+    if (id > 1 || overlayDerive_[id].isEnabled != false)
+    {
+        return env.Undefined();
+    }
+
+    auto overlayData = overlayDataFromTarget(id);
+
+    // back on bitmaps, a shared frame still pending would hide this one.
+    // overlayDataWrite takes the whole bitmap this time
+    if (overlayData->isShared != false)
+    {
+        overlayDropShared(id);
+    }
+
+    overlayDataWrite(
+        overlayData,
+        data.Data(),
+        x,
+        y,
+        width,
+        height);
+    overlayDeriveFlush(id);
+
+    return env.Undefined();
+}
+
+bool textureSharedFromValue(Napi::Value value, TEXTURE_SHARED *shared)
+{
+    if (value.IsObject() == false)
+    {
+        return false;
+    }
+
+    auto obj = value.As<Napi::Object>();
+
+    // electron hands the nt handle over as a buffer of its bytes
+    auto handle = obj.Get("handle");
+    if (handle.IsBuffer() != false)
+    {
+        auto buffer = handle.As<Napi::Buffer<uint8_t>>();
+        if (buffer.Length() != sizeof(void *))
+        {
+            return false;
+        }
+        shared->handle = 0;
+        memcpy(&shared->handle, buffer.Data(), sizeof(void *));
+    }
+    else if (handle.IsNumber() != false)
+    {
+        shared->handle = (uint64_t)handle.ToNumber().Int64Value();
+    }
+    else
+    {
+        return false;
+    }
+
+    shared->width = obj.Get("width").ToNumber().Uint32Value();
+    shared->height = obj.Get("height").ToNumber().Uint32Value();
+    shared->stride = 0;
+    shared->offset = 0;
+    shared->modifier = TEXTURE_MODIFIER_INVALID;
+
+    auto stride = obj.Get("stride");
+    if (stride.IsNumber() != false)
+    {
+        shared->stride = stride.ToNumber().Uint32Value();
+    }
+
+    // a dmabuf doesn't know its own pitch, an import without one can only fail
+    if (TEXTURE_SHARED_IS_DMABUF != false && shared->stride == 0)
+    {
+        throw Napi::TypeError::New(value.Env(), "stride is required for a dmabuf");
+    }
+
+    auto offset = obj.Get("offset");
+    if (offset.IsNumber() != false)
+    {
+        shared->offset = offset.ToNumber().Uint32Value();
+    }
+
+    // a string, 64 bits don't fit a number
+    auto modifier = obj.Get("modifier");
+    if (modifier.IsString() != false)
+    {
+        auto text = modifier.ToString().Utf8Value();
+        char *end;
+        shared->modifier = strtoull(text.c_str(), &end, 0);
+        if (text.empty() != false || *end != 0)
+        {
+            return false;
+        }
+    }
+
+    return shared->width == FRAME_WIDTH && shared->height == FRAME_HEIGHT;
+}
+
+Napi::Value setOverlaySharedTexture(const Napi::CallbackInfo &info)
+{
+    auto env = info.Env();
+
+    auto id = info[0].ToNumber().Uint32Value();
+    if (id > 1 || isSharedReady_ == false)
+    {
+        return Napi::Boolean::New(env, false);
+    }
+
+    // derived overlays, sprites and the rest are drawn into the cpu frame,
+    // which a shared frame never reaches
+    auto overlayData = overlayDataFromTarget(id);
+    if (overlayData->compositor != NULL ||
+        overlayDerive_[0].isEnabled != false ||
+        overlayDerive_[1].isEnabled != false)
+    {
+        return Napi::Boolean::New(env, false);
+    }
+
+    TEXTURE_SHARED shared;
+    if (textureSharedFromValue(info[1], &shared) == false)
+    {
+        return Napi::Boolean::New(env, false);
+    }
+
+    // the renderer's handle is only good until the paint returns
+    if (backendSharedDup(shared.handle, &shared.handle) == false)
+    {
+        return Napi::Boolean::New(env, false);
+    }
+
+    sharedLock_.lock();
+    if (hasSharedPending_[id] != false)
+    {
+        backendSharedClose(sharedPending_[id].handle);
+    }
+    sharedPending_[id] = shared;
+    hasSharedPending_[id] = true;
+    sharedLock_.unlock();
+
+    overlayData->isShared = true;
+    frameMarkDirty(overlayData);
+
+    return Napi::Boolean::New(env, true);
+}
+
+Napi::Value setOverlayPixelConvert(const Napi::CallbackInfo &info)
+{
+    auto env = info.Env();
+
+    auto id = info[0].ToNumber().Uint32Value();
+    auto arg1 = info[1];
+    if (id > 1 || arg1.IsObject() == false)
+    {
+        return Napi::Boolean::New(env, false);
+    }
+
+    auto options = arg1.As<Napi::Object>();
+    PIXEL_CONVERT convert = {};
+
+    if (options.Get("premultiply").ToBoolean().Value() != false)
+    {
+        convert.ops |= PIXEL_OP_PREMULTIPLY;
+    }
+
+    if (options.Get("unpremultiply").ToBoolean().Value() != false)
+    {
+        convert.ops |= PIXEL_OP_UNPREMULTIPLY;
+    }
+
+    if (options.Get("swizzle").ToBoolean().Value() != false)
+    {
+        convert.ops |= PIXEL_OP_SWIZZLE;
+    }
+
+    auto alphaThreshold = options.Get("alphaThreshold");
+    if (alphaThreshold.IsNumber() != false)
+    {
+        auto value = alphaThreshold.ToNumber().Uint32Value();
+        if (value > 255)
+        {
+            return Napi::Boolean::New(env, false);
+        }
+        convert.ops |= PIXEL_OP_ALPHA_THRESHOLD;
+        convert.alphaThreshold = (uint8_t)value;
+    }
+
+    convert.opacity = 255;
+    auto opacity = options.Get("opacity");
+    if (opacity.IsNumber() != false)
+    {
+        auto value = opacity.ToNumber().DoubleValue();
+        if (!(value >= 0.0 && value <= 1.0))
+        {
+            return Napi::Boolean::New(env, false);
+        }
+        convert.ops |= PIXEL_OP_OPACITY;
+        convert.opacity = (uint8_t)(value * 255.0 + 0.5);
+    }
+
+    if (pixelConvertIsValid(&convert) == false)
+    {
+        return Napi::Boolean::New(env, false);
+    }
+
+    // only takes effect for rects painted from now on
+    overlayDataFromTarget(id)->convert = convert;
+
+    return Napi::Boolean::New(env, true);
+}
+
+bool scaleRectFromValue(Napi::Value value, SCALE_RECT *rect)
+{
+    if (value.IsObject() == false)
+    {
+        return false;
+    }
+
+    auto obj = value.As<Napi::Object>();
+    rect->x = obj.Get("x").ToNumber().Uint32Value();
+    rect->y = obj.Get("y").ToNumber().Uint32Value();
+    rect->width = obj.Get("width").ToNumber().Uint32Value();
+    rect->height = obj.Get("height").ToNumber().Uint32Value();
+    return true;
+}
+
+Napi::Value setOverlayDerive(const Napi::CallbackInfo &info)
+{
+    auto env = info.Env();
+
+    auto id = info[0].ToNumber().Uint32Value();
+    if (id > 1)
+    {
+        return Napi::Boolean::New(env, false);
+    }
+
+    // no options: the overlay takes its own paints again
+    auto arg1 = info[1];
+    if (arg1.IsObject() == false)
+    {
+        overlayDerive_[id].isEnabled = false;
+        return Napi::Boolean::New(env, true);
+    }
+
+    auto options = arg1.As<Napi::Object>();
+    OVERLAY_DERIVE derive = {};
+    derive.isEnabled = true;
+    derive.source = options.Get("source").ToNumber().Uint32Value();
+    derive.place = {0, 0, FRAME_WIDTH, FRAME_HEIGHT};
+    derive.filter = SCALE_FILTER_BILINEAR;
+
+    // no chains: the source must be painted directly
+    if (derive.source > 1 ||
+        derive.source == id ||
+        overlayDerive_[derive.source].isEnabled != false)
+    {
+        return Napi::Boolean::New(env, false);
+    }
+
+    if (scaleRectFromValue(options.Get("crop"), &derive.crop) == false)
+    {
+        return Napi::Boolean::New(env, false);
+    }
+
+    auto place = options.Get("place");
+    if (place.IsUndefined() == false &&
+        scaleRectFromValue(place, &derive.place) == false)
+    {
+        return Napi::Boolean::New(env, false);
+    }
+
+    auto filter = options.Get("filter");
+    if (filter.IsString() != false)
+    {
+        auto name = filter.ToString().Utf8Value();
+        if (name == "box")
+        {
+            derive.filter = SCALE_FILTER_BOX;
+        }
+        else if (name != "bilinear")
+        {
+            return Napi::Boolean::New(env, false);
+        }
+    }
+
+    if (overlayDeriveIsValid(&derive) == false)
+    {
+        return Napi::Boolean::New(env, false);
+    }
+
+    overlayDerive_[id] = derive;
+    overlayDeriveRefresh(
+        &derive,
+        overlayDataFromTarget(derive.source),
+        overlayDataFromTarget(id));
+
+    return Napi::Boolean::New(env, true);
+}
+
+// only the fields present in the object are changed
+bool overlayPropsFromValue(Napi::Value value, OVERLAY_PROPS *props)
+{
+    if (value.IsObject() == false)
+    {
+        return false;
+    }
+
+    auto obj = value.As<Napi::Object>();
+
+    auto alpha = obj.Get("alpha");
+    if (alpha.IsNumber() != false)
+    {
+        props->alpha = alpha.ToNumber().FloatValue();
+    }
+
+    auto width = obj.Get("width");
+    if (width.IsNumber() != false)
+    {
+        props->widthInMeters = width.ToNumber().FloatValue();
+    }
+
+    auto transform = obj.Get("transform");
+    if (transform.IsArray() != false)
+    {
+        auto arr = transform.As<Napi::Array>();
+        if (arr.Length() != 12)
+        {
+            return false;
+        }
+
+        for (uint32_t i = 0; i < 12; ++i)
+        {
+            props->transform[i] = arr.Get(i).ToNumber().FloatValue();
+        }
+    }
+    else if (transform.IsUndefined() == false)
+    {
+        return false;
+    }
+
+    auto color = obj.Get("color");
+    if (color.IsNumber() != false)
+    {
+        auto rgb = color.ToNumber().Uint32Value();
+        props->color[0] = ((rgb >> 16) & 0xff) / 255.0f;
+        props->color[1] = ((rgb >> 8) & 0xff) / 255.0f;
+        props->color[2] = (rgb & 0xff) / 255.0f;
+    }
+
+    auto sortOrder = obj.Get("sortOrder");
+    if (sortOrder.IsNumber() != false)
+    {
+        props->sortOrder = sortOrder.ToNumber().Uint32Value();
+    }
+
+    auto visible = obj.Get("visible");
+    if (visible.IsBoolean() != false)
+    {
+        props->isVisible = visible.ToBoolean().Value();
+    }
+
+    return propsIsValid(props);
+}
+
+Napi::Value setOverlayProps(const Napi::CallbackInfo &info)
+{
+    auto env = info.Env();
+
+    // the wrist page has no overlay of its own in vr
+    auto id = info[0].ToNumber().Uint32Value();
+    if (id != 0)
+    {
+        return Napi::Boolean::New(env, false);
+    }
+
+    OVERLAY_PROPS props;
+    propsBlockGet(&overlayPropsHmd_, &props);
+    if (overlayPropsFromValue(info[1], &props) == false)
+    {
+        return Napi::Boolean::New(env, false);
+    }
+
+    // applied by the overlay thread on its next poll
+    propsBlockSet(&overlayPropsHmd_, &props);
+
+    return Napi::Boolean::New(env, true);
+}
+
+// only the fields present in the object are changed
+bool spritePropsFromValue(Napi::Value value, SPRITE_PROPS *props)
+{
+    if (value.IsObject() == false)
+    {
+        return value.IsUndefined();
+    }
+
+    auto obj = value.As<Napi::Object>();
+
+    auto x = obj.Get("x");
+    if (x.IsNumber() != false)
+    {
+        props->x = x.ToNumber().Int32Value();
+    }
+
+    auto y = obj.Get("y");
+    if (y.IsNumber() != false)
+    {
+        props->y = y.ToNumber().Int32Value();
+    }
+
+    auto z = obj.Get("z");
+    if (z.IsNumber() != false)
+    {
+        props->z = z.ToNumber().Int32Value();
+    }
+
+    auto opacity = obj.Get("opacity");
+    if (opacity.IsNumber() != false)
+    {
+        auto value = opacity.ToNumber().DoubleValue();
+        if (!(value >= 0.0 && value <= 1.0))
+        {
+            return false;
+        }
+        props->opacity = (uint8_t)(value * 255.0 + 0.5);
+    }
+
+    auto visible = obj.Get("visible");
+    if (visible.IsBoolean() != false)
+    {
+        props->isVisible = visible.ToBoolean().Value();
+    }
+
+    return true;
+}
+
+Napi::Value createOverlaySprite(const Napi::CallbackInfo &info)
+{
+    auto env = info.Env();
+
+    auto id = info[0].ToNumber().Uint32Value();
+    auto width = info[1].ToNumber().Uint32Value();
+    auto height = info[2].ToNumber().Uint32Value();
+    auto arg3 = info[3];
+    if (id > 1 || arg3.IsTypedArray() == false)
+    {
+        return env.Undefined();
+    }
+
+    auto rgba = arg3.As<Napi::Uint8Array>();
+    if (width == 0 || width > FRAME_WIDTH ||
+        height == 0 || height > FRAME_HEIGHT ||
+        rgba.ByteLength() != width * height * 4)
+    {
+        return env.Undefined();
+    }
+
+    SPRITE_PROPS props = {0, 0, 0, 255, true};
+    if (spritePropsFromValue(info[4], &props) == false)
+    {
+        return env.Undefined();
+    }
+
+    auto spriteId = compositorCreateSprite(
+        overlayDataFromTarget(id),
+        rgba.Data(),
+        width,
+        height,
+        &props);
+    overlayDeriveFlush(id);
+    if (spriteId == 0)
+    {
+        return env.Undefined();
+    }
+
+    return Napi::Number::New(env, spriteId);
+}
+
+Napi::Value updateOverlaySprite(const Napi::CallbackInfo &info)
+{
+    auto env = info.Env();
+
+    auto id = info[0].ToNumber().Uint32Value();
+    auto spriteId = info[1].ToNumber().Uint32Value();
+    if (id > 1)
+    {
+        return Napi::Boolean::New(env, false);
+    }
+
+    auto overlayData = overlayDataFromTarget(id);
+
+    SPRITE_PROPS props;
+    if (compositorGetSprite(overlayData, spriteId, &props) == false ||
+        spritePropsFromValue(info[2], &props) == false)
+    {
+        return Napi::Boolean::New(env, false);
+    }
+
+    auto isUpdated = compositorUpdateSprite(overlayData, spriteId, &props);
+    overlayDeriveFlush(id);
+    return Napi::Boolean::New(env, isUpdated);
+}
+
+TEXT_LABEL *overlayTextLabelFind(uint32_t id, uint32_t spriteId)
+{
+    if (spriteId == 0)
+    {
+        return NULL;
+    }
+
+    for (auto &label : overlayTextLabels_[id])
+    {
+        if (label.spriteId == spriteId)
+        {
+            return &label;
+        }
+    }
+
+    return NULL;
+}
+
+Napi::Value setOverlaySpritePixels(const Napi::CallbackInfo &info)
+{
+    auto env = info.Env();
+
+    auto id = info[0].ToNumber().Uint32Value();
+    auto spriteId = info[1].ToNumber().Uint32Value();
+    auto arg2 = info[2];
+    if (id > 1 || arg2.IsTypedArray() == false)
+    {
+        return Napi::Boolean::New(env, false);
+    }
+
+    // text and hud sprites are drawn natively only
+    if (overlayTextLabelFind(id, spriteId) != NULL ||
+        (id == hudTarget_ && spriteId == hud_.spriteId))
+    {
+        return Napi::Boolean::New(env, false);
+    }
+
+    auto rgba = arg2.As<Napi::Uint8Array>();
+    auto isSet = compositorSetSpritePixels(
+        overlayDataFromTarget(id),
+        spriteId,
+        rgba.Data(),
+        (uint32_t)rgba.ByteLength());
+    overlayDeriveFlush(id);
+    return Napi::Boolean::New(env, isSet);
+}
+
+Napi::Value destroyOverlaySprite(const Napi::CallbackInfo &info)
+{
+    auto env = info.Env();
+
+    auto id = info[0].ToNumber().Uint32Value();
+    auto spriteId = info[1].ToNumber().Uint32Value();
+    if (id > 1)
+    {
+        return Napi::Boolean::New(env, false);
+    }
+
+    auto overlayData = overlayDataFromTarget(id);
+    bool isDestroyed;
+
+    auto label = overlayTextLabelFind(id, spriteId);
+    if (label != NULL)
+    {
+        isDestroyed = textLabelDestroy(overlayData, label);
+    }
+    // turned off with setOverlayHud only
+    else if (id == hudTarget_ && spriteId == hud_.spriteId)
+    {
+        return Napi::Boolean::New(env, false);
+    }
+    else
+    {
+        isDestroyed = compositorDestroySprite(overlayData, spriteId);
+    }
+
+    overlayDeriveFlush(id);
+    return Napi::Boolean::New(env, isDestroyed);
+}
+
+bool textStyleFromValue(Napi::Value value, TEXT_STYLE *style)
+{
+    if (value.IsObject() == false)
+    {
+        return value.IsUndefined();
+    }
+
+    auto obj = value.As<Napi::Object>();
+
+    auto font = obj.Get("font");
+    if (font.IsString() != false)
+    {
+        auto name = font.ToString().Utf8Value();
+        style->font = TEXT_FONT_COUNT;
+        for (uint32_t i = 0; i < TEXT_FONT_COUNT; ++i)
+        {
+            if (name == textFontName((TEXT_FONT)i))
+            {
+                style->font = (TEXT_FONT)i;
+            }
+        }
+    }
+
+    auto align = obj.Get("align");
+    if (align.IsString() != false)
+    {
+        auto name = align.ToString().Utf8Value();
+        style->align = TEXT_ALIGN_COUNT;
+        for (uint32_t i = 0; i < TEXT_ALIGN_COUNT; ++i)
+        {
+            if (name == textAlignName((TEXT_ALIGN)i))
+            {
+                style->align = (TEXT_ALIGN)i;
+            }
+        }
+    }
+
+    // 0xrrggbb, the sprite's opacity applies on top
+    auto color = obj.Get("color");
+    if (color.IsNumber() != false)
+    {
+        auto rgb = color.ToNumber().Uint32Value();
+        style->color[0] = (uint8_t)(rgb >> 16);
+        style->color[1] = (uint8_t)(rgb >> 8);
+        style->color[2] = (uint8_t)rgb;
+    }
+
+    return style->font < TEXT_FONT_COUNT && style->align < TEXT_ALIGN_COUNT;
+}
+
+Napi::Value createOverlayText(const Napi::CallbackInfo &info)
+{
+    auto env = info.Env();
+
+    auto id = info[0].ToNumber().Uint32Value();
+    auto width = info[1].ToNumber().Uint32Value();
+    auto height = info[2].ToNumber().Uint32Value();
+    if (id > 1)
+    {
+        return env.Undefined();
+    }
+
+    TEXT_STYLE style = {TEXT_FONT_TEXT, TEXT_ALIGN_LEFT, {255, 255, 255, 255}};
+    SPRITE_PROPS props = {0, 0, 0, 255, true};
+    if (textStyleFromValue(info[3], &style) == false ||
+        spritePropsFromValue(info[4], &props) == false)
+    {
+        return env.Undefined();
+    }
+
+    TEXT_LABEL *label = NULL;
+    for (auto &slot : overlayTextLabels_[id])
+    {
+        if (slot.spriteId == 0)
+        {
+            label = &slot;
+            break;
+        }
+    }
+
+    if (label == NULL ||
+        textLabelCreate(
+            overlayDataFromTarget(id),
+            label,
+            width,
+            height,
+            &style,
+            &props) == false)
+    {
+        return env.Undefined();
+    }
+    overlayDeriveFlush(id);
+
+    return Napi::Number::New(env, label->spriteId);
+}
+
+Napi::Value setOverlayText(const Napi::CallbackInfo &info)
+{
+    auto env = info.Env();
+
+    auto id = info[0].ToNumber().Uint32Value();
+    auto spriteId = info[1].ToNumber().Uint32Value();
+    auto arg2 = info[2];
+    if (id > 1 || arg2.IsString() == false)
+    {
+        return Napi::Boolean::New(env, false);
+    }
+
+    auto label = overlayTextLabelFind(id, spriteId);
+    if (label == NULL)
+    {
+        return Napi::Boolean::New(env, false);
+    }
+
+    auto text = arg2.ToString().Utf8Value();
+    textLabelSet(overlayDataFromTarget(id), label, text.data(), text.size());
+    overlayDeriveFlush(id);
+
+    return Napi::Boolean::New(env, true);
+}
+
+Napi::Value measureOverlayText(const Napi::CallbackInfo &info)
+{
+    auto env = info.Env();
+
+    TEXT_STYLE style = {TEXT_FONT_TEXT, TEXT_ALIGN_LEFT, {255, 255, 255, 255}};
+    auto arg1 = info[1];
+    if (arg1.IsString() == false ||
+        textStyleFromValue(info[0], &style) == false)
+    {
+        return env.Undefined();
+    }
+
+    auto text = arg1.ToString().Utf8Value();
+    auto font = textGetFont(style.font);
+
+    auto obj = Napi::Object::New(env);
+    obj.Set(
+        "width",
+        Napi::Number::New(env, textMeasure(style.font, text.data(), text.size())));
+    obj.Set(
+        "height",
+        Napi::Number::New(env, font->ascent + font->descent));
+    return obj;
+}
+
+Napi::Value hudNoop(const Napi::CallbackInfo &info)
+{
+    return info.Env().Undefined();
+}
+
+Napi::Value setOverlayHud(const Napi::CallbackInfo &info)
+{
+    auto env = info.Env();
+
+    auto id = info[0].ToNumber().Uint32Value();
+    if (id > 1)
+    {
+        return Napi::Boolean::New(env, false);
+    }
+
+    hudLock_.lock();
+
+    if (hasHudCallback_ != false)
+    {
+        hudCallback_.Release();
+        hasHudCallback_ = false;
+    }
+
+    hudLock_.unlock();
+
+    if (hud_.spriteId != 0)
+    {
+        hudDestroy(overlayDataFromTarget(hudTarget_), &hud_);
+        overlayDeriveFlush(hudTarget_);
+    }
+
+    // no options: the hud is off
+    auto arg1 = info[1];
+    if (arg1.IsObject() == false)
+    {
+        return Napi::Boolean::New(env, true);
+    }
+
+    SPRITE_PROPS props = {0, 0, 0, 255, true};
+    if (spritePropsFromValue(arg1, &props) == false)
+    {
+        return Napi::Boolean::New(env, false);
+    }
+
+    HUD_STATE state;
+    auto count = deviceTableSnapshot(&vrDeviceTable_, vrDeviceDataLocal_);
+    hudStateFromDevices(&state, vrDeviceDataLocal_, count);
+
+    auto isCreated = hudCreate(overlayDataFromTarget(id), &hud_, &state, &props);
+    overlayDeriveFlush(id);
+    if (isCreated == false)
+    {
+        return Napi::Boolean::New(env, false);
+    }
+
+    hudTarget_ = id;
+
+    // the callback runs native code only, the function is never called
+    hudLock_.lock();
+
+    hudCallback_ = Napi::ThreadSafeFunction::New(
+        env,
+        Napi::Function::New(env, hudNoop),
+        "overlayHud",
+        0,
+        1);
+    hudCallback_.Unref(env);
+    hasHudCallback_ = true;
+
+    hudLock_.unlock();
+
+    return Napi::Boolean::New(env, true);
+}
+
+Napi::Value setOverlayGovernor(const Napi::CallbackInfo &info)
+{
+    auto env = info.Env();
+
+    GOVERNOR_CONFIG config;
+    governorDefaultConfig(&config);
+
+    // only the fields present in the object differ from the defaults
+    auto arg0 = info[0];
+    if (arg0.IsObject() != false)
+    {
+        auto options = arg0.As<Napi::Object>();
+        struct
+        {
+            const char *name;
+            uint32_t *value;
+        } fields[] = {
+            {"maxFps", &config.maxFps},
+            {"lowFps", &config.lowFps},
+            {"idleFps", &config.idleFps},
+            {"maxUploadFps", &config.maxUploadFps},
+            {"activeRate", &config.activeRate},
+            {"holdMs", &config.holdMs},
+        };
+
+        for (auto &field : fields)
+        {
+            auto value = options.Get(field.name);
+            if (value.IsNumber() != false)
+            {
+                *field.value = value.ToNumber().Uint32Value();
+            }
+        }
+    }
+    else if (arg0.IsUndefined() == false)
+    {
+        return Napi::Boolean::New(env, false);
+    }
+
+    if (governorConfigIsValid(&config) == false)
+    {
+        return Napi::Boolean::New(env, false);
+    }
+
+    governorLock_.lock();
+
+    governorConfig_ = config;
+    isGovernorConfigChanged_ = true;
+
+    if (hasGovernorCallback_ != false)
+    {
+        governorCallback_.Release();
+        hasGovernorCallback_ = false;
+    }
+
+    auto arg1 = info[1];
+    if (arg1.IsFunction() != false)
+    {
+        governorCallback_ = Napi::ThreadSafeFunction::New(
+            env,
+            arg1.As<Napi::Function>(),
+            "overlayGovernor",
+            0,
+            1);
+        governorCallback_.Unref(env);
+        hasGovernorCallback_ = true;
+    }
+
+    governorLock_.unlock();
+
+    return Napi::Boolean::New(env, true);
+}
+
+Napi::Value setOverlayFollow(const Napi::CallbackInfo &info)
+{
+    auto env = info.Env();
+
+    // the wrist page has no overlay of its own in vr
+    auto id = info[0].ToNumber().Uint32Value();
+    if (id != 0)
+    {
+        return Napi::Boolean::New(env, false);
+    }
+
+    FOLLOW_CONFIG config;
+    followDefaultConfig(&config);
+
+    // no options: ride along with the hmd again
+    auto arg1 = info[1];
+    if (arg1.IsObject() != false)
+    {
+        auto options = arg1.As<Napi::Object>();
+        struct
+        {
+            const char *name;
+            float *value;
+        } fields[] = {
+            {"dampingMs", &config.dampingMs},
+            {"deadzoneDeg", &config.deadzoneDeg},
+            {"deadzoneMeters", &config.deadzoneMeters},
+            {"epsilon", &config.epsilon},
+        };
+
+        for (auto &field : fields)
+        {
+            auto value = options.Get(field.name);
+            if (value.IsNumber() != false)
+            {
+                *field.value = value.ToNumber().FloatValue();
+            }
+        }
+
+        auto upright = options.Get("upright");
+        if (upright.IsBoolean() != false)
+        {
+            config.isUpright = upright.ToBoolean().Value();
+        }
+    }
+    else if (arg1.IsUndefined() == false)
+    {
+        return Napi::Boolean::New(env, false);
+    }
+
+    if (followConfigIsValid(&config) == false)
+    {
+        return Napi::Boolean::New(env, false);
+    }
+
+    // picked up by the overlay thread on its next poll
+    followLock_.lock();
+    followConfig_ = config;
+    isFollowEnabled_ = arg1.IsObject() != false ? true : false;
+    isFollowConfigChanged_ = true;
+    followLock_.unlock();
+
+    return Napi::Boolean::New(env, true);
+}
+
+Napi::Value setOverlayWatchdog(const Napi::CallbackInfo &info)
+{
+    auto env = info.Env();
+
+    auto thresholdMs = info[0].ToNumber().Uint32Value();
+    if (thresholdMs < 50)
+    {
+        thresholdMs = 50;
+    }
+
+    watchdogThresholdMs_.store(thresholdMs, std::memory_order_relaxed);
+
+    watchdogLock_.lock();
+
+    if (hasWatchdogCallback_ != false)
+    {
+        watchdogCallback_.Release();
+        hasWatchdogCallback_ = false;
+    }
+
+    auto arg1 = info[1];
+    if (arg1.IsFunction() != false)
+    {
+        watchdogCallback_ = Napi::ThreadSafeFunction::New(
+            env,
+            arg1.As<Napi::Function>(),
+            "overlayWatchdog",
+            0,
+            1);
+        watchdogCallback_.Unref(env);
+        hasWatchdogCallback_ = true;
+    }
+
+    watchdogLock_.unlock();
+
+    return env.Undefined();
+}
+
+Napi::Value getOverlayStats(const Napi::CallbackInfo &info)
+{
+    auto env = info.Env();
+    auto obj = Napi::Object::New(env);
+
+    auto beatNs = watchdog_.beatNs.load(std::memory_order_acquire);
+    auto nowNs = platformNowNs();
+
+    auto watchdog = Napi::Object::New(env);
+
+    watchdog.Set(
+        "phase",
+        Napi::String::New(
+            env,
+            watchdogPhaseName(watchdog_.phase.load(std::memory_order_relaxed))));
+
+    watchdog.Set(
+        "heartbeatAgeMs",
+        Napi::Number::New(
+            env,
+            beatNs != 0 && nowNs > beatNs ? (nowNs - beatNs) / 1000000.0 : 0.0));
+
+    watchdog.Set(
+        "stallCount",
+        Napi::Number::New(
+            env,
+            watchdog_.stallCount.load(std::memory_order_relaxed)));
+
+    obj.Set("watchdog", watchdog);
+
+    LOG_STATS logStats;
+    logGetStats(&logStats);
+
+    auto log = Napi::Object::New(env);
+
+    log.Set(
+        "written",
+        Napi::Number::New(
+            env,
+            (double)logStats.written));
+
+    log.Set(
+        "dropped",
+        Napi::Number::New(
+            env,
+            (double)logStats.dropped));
+
+    log.Set(
+        "suppressed",
+        Napi::Number::New(
+            env,
+            (double)logStats.suppressed));
+
+    obj.Set("log", log);
+
+    auto hmd = Napi::Object::New(env);
+
+    hmd.Set(
+        "filledTiles",
+        Napi::Number::New(
+            env,
+            overlayDataHmd_.filledTiles.load(std::memory_order_relaxed)));
+
+    hmd.Set(
+        "isHidden",
+        Napi::Boolean::New(
+            env,
+            overlayHiddenHmd_.load()));
+
+    obj.Set("hmd", hmd);
+
+    auto props = Napi::Object::New(env);
+
+    props.Set(
+        "setCount",
+        Napi::Number::New(
+            env,
+            overlayPropsHmd_.version.load(std::memory_order_relaxed)));
+
+    props.Set(
+        "applyCount",
+        Napi::Number::New(
+            env,
+            (double)overlayPropsApplyCount_.load(std::memory_order_relaxed)));
+
+    props.Set(
+        "pushCount",
+        Napi::Number::New(
+            env,
+            (double)overlayPropsPushCount_.load(std::memory_order_relaxed)));
+
+    obj.Set("props", props);
+
+    followLock_.lock();
+    auto isFollowing = isFollowingHmd_;
+    auto followState = followHmd_;
+    followLock_.unlock();
+
+    auto follow = Napi::Object::New(env);
+
+    follow.Set(
+        "isEnabled",
+        Napi::Boolean::New(
+            env,
+            isFollowing != false));
+
+    follow.Set(
+        "isMoving",
+        Napi::Boolean::New(
+            env,
+            isFollowing != false && followState.isMoving));
+
+    follow.Set(
+        "submitCount",
+        Napi::Number::New(
+            env,
+            (double)followState.submitCount));
+
+    obj.Set("follow", follow);
+
+    auto hud = Napi::Object::New(env);
+
+    hud.Set(
+        "isEnabled",
+        Napi::Boolean::New(
+            env,
+            hud_.spriteId != 0));
+
+    hud.Set(
+        "updateCount",
+        Napi::Number::New(
+            env,
+            (double)hud_.updateCount));
+
+    hud.Set(
+        "redrawCount",
+        Napi::Number::New(
+            env,
+            (double)hud_.redrawCount));
+
+    obj.Set("hud", hud);
+
+    governorLock_.lock();
+    auto governorState = governorHmd_;
+    governorLock_.unlock();
+
+    auto governor = Napi::Object::New(env);
+
+    governor.Set(
+        "mode",
+        Napi::String::New(
+            env,
+            governorModeName(governorState.mode)));
+
+    governor.Set(
+        "ingestFps",
+        Napi::Number::New(
+            env,
+            governorState.ingestFps));
+
+    governor.Set(
+        "uploadFps",
+        Napi::Number::New(
+            env,
+            governorState.uploadFps));
+
+    governor.Set(
+        "damageRate",
+        Napi::Number::New(
+            env,
+            governorDamageRate(&governorState)));
+
+    governor.Set(
+        "modeChanges",
+        Napi::Number::New(
+            env,
+            (double)governorState.modeChanges));
+
+    obj.Set("governor", governor);
+
+    POOL_STATS poolStats;
+    poolGetStats(&poolStats);
+
+    auto pool = Napi::Object::New(env);
+
+    pool.Set(
+        "reservedBytes",
+        Napi::Number::New(
+            env,
+            (double)poolStats.reservedBytes));
+
+    pool.Set(
+        "hugePageBytes",
+        Napi::Number::New(
+            env,
+            (double)poolStats.hugePageBytes));
+
+    pool.Set(
+        "thpBytes",
+        Napi::Number::New(
+            env,
+            (double)poolStats.thpBytes));
+
+    pool.Set(
+        "slotCount",
+        Napi::Number::New(
+            env,
+            (double)poolStats.slotCount));
+
+    pool.Set(
+        "inUse",
+        Napi::Number::New(
+            env,
+            (double)poolStats.inUse));
+
+    pool.Set(
+        "peakInUse",
+        Napi::Number::New(
+            env,
+            (double)poolStats.peakInUse));
+
+    pool.Set(
+        "allocCount",
+        Napi::Number::New(
+            env,
+            (double)poolStats.allocCount));
+
+    pool.Set(
+        "reuseCount",
+        Napi::Number::New(
+            env,
+            (double)poolStats.reuseCount));
+
+    pool.Set(
+        "failCount",
+        Napi::Number::New(
+            env,
+            (double)poolStats.failCount));
+
+    obj.Set("pool", pool);
+
+    TEXTURE_STATS textureStats;
+    textureGetStats(&textureStats);
+
+    auto texture = Napi::Object::New(env);
+
+    texture.Set(
+        "backend",
+        Napi::String::New(
+            env,
+            textureStats.backend != NULL ? textureStats.backend : backendTexture()->name));
+
+    texture.Set(
+        "isMockVr",
+        Napi::Boolean::New(
+            env,
+            isMockVr_));
+
+    texture.Set(
+        "uploadCount",
+        Napi::Number::New(
+            env,
+            (double)textureStats.uploadCount));
+
+    texture.Set(
+        "uploadBytes",
+        Napi::Number::New(
+            env,
+            (double)textureStats.uploadBytes));
+
+    texture.Set(
+        "submitCount",
+        Napi::Number::New(
+            env,
+            (double)textureStats.submitCount));
+
+    texture.Set(
+        "sharedCount",
+        Napi::Number::New(
+            env,
+            (double)textureStats.sharedCount));
+
+    obj.Set("texture", texture);
+
+    obj.Set(
+        "pixelIsa",
+        Napi::String::New(
+            env,
+            pixelIsaName(pixelDetectIsa())));
+
+    return obj;
+}
+
+Napi::Value drainNativeLog(const Napi::CallbackInfo &info)
+{
+    auto env = info.Env();
+
+    LOG_RECORD records[256];
+    auto nowNs = platformNowNs();
+    auto count = logDrain(records, 256, nowNs);
+
+    // monotonic -> epoch so records line up with the JS side logs
+    auto nowMs = platformWallMs();
+
+    auto arr = Napi::Array::New(env, count);
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        auto record = &records[i];
+        auto obj = Napi::Object::New(env);
+
+        obj.Set(
+            "time",
+            Napi::Number::New(
+                env,
+                nowMs - (nowNs - record->timeNs) / 1000000.0));
+
+        obj.Set(
+            "level",
+            Napi::String::New(
+                env,
+                logLevelName(record->level)));
+
+        obj.Set(
+            "code",
+            Napi::String::New(
+                env,
+                logCodeName(record->code)));
+
+        auto args = Napi::Array::New(env, LOG_MAX_ARGS);
+        for (uint32_t j = 0; j < LOG_MAX_ARGS; ++j)
+        {
+            args.Set(j, Napi::Number::New(env, (double)record->args[j]));
+        }
+        obj.Set("args", args);
+
+        obj.Set(
+            "count",
+            Napi::Number::New(
+                env,
+                record->count));
+
+        arr.Set(i, obj);
+    }
+
+    return arr;
+}
+
+Napi::Value startPaintRecord(const Napi::CallbackInfo &info)
+{
+    auto env = info.Env();
+
+    auto arg0 = info[0];
+    if (arg0.IsString() == false || paintRecorder_.file != NULL)
+    {
+        return Napi::Boolean::New(env, false);
+    }
+
+    auto path = arg0.ToString().Utf8Value(); // pin to stack
+    auto file = platformOpenFile(path.c_str(), "wb");
+
+    if (file == NULL)
+    {
+        return Napi::Boolean::New(env, false);
+    }
+
+    if (paintRecorderOpen(&paintRecorder_, file) == false)
+    {
+        fclose(file);
+        return Napi::Boolean::New(env, false);
+    }
+
+    return Napi::Boolean::New(env, true);
+}
+
+Napi::Value stopPaintRecord(const Napi::CallbackInfo &info)
+{
+    auto env = info.Env();
+
+    if (paintRecorder_.file == NULL)
+    {
+        return env.Undefined();
+    }
+
+    auto obj = Napi::Object::New(env);
+
+    obj.Set(
+        "frameCount",
+        Napi::Number::New(
+            env,
+            (double)paintRecorder_.frameCount));
+
+    obj.Set(
+        "rawBytes",
+        Napi::Number::New(
+            env,
+            (double)paintRecorder_.rawBytes));
+
+    obj.Set(
+        "storedBytes",
+        Napi::Number::New(
+            env,
+            (double)paintRecorder_.storedBytes));
+
+    paintRecorderClose(&paintRecorder_);
+
+    return obj;
+}
+
+Napi::Value getVRDeviceList(const Napi::CallbackInfo &info)
+{
+    auto env = info.Env();
+
+    auto count = deviceTableSnapshot(&vrDeviceTable_, vrDeviceDataLocal_);
+
+    auto arr = Napi::Array::New(env, count);
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        auto deviceData = &vrDeviceDataLocal_[i];
+        auto obj = Napi::Object::New(env);
+
+        obj.Set(
+            "deviceClass",
+            Napi::Number::New(
+                env,
+                deviceData->deviceClass));
+
+        obj.Set(
+            "isConnected",
+            Napi::Boolean::New(
+                env,
+                deviceData->isConnected));
+
+        obj.Set(
+            "isCharging",
+            Napi::Boolean::New(
+                env,
+                deviceData->isCharging));
+
+        obj.Set(
+            "batteryPercentage",
+            Napi::Number::New(
+                env,
+                deviceData->batteryPercentage));
+
+        obj.Set(
+            "controllerRole",
+            Napi::Number::New(
+                env,
+                deviceData->controllerRole));
+
+        obj.Set(
+            "buttonPressedMask",
+            Napi::Number::New(
+                env,
+                deviceData->buttonPressedMask));
+
+        obj.Set(
+            "buttonTouchedMask",
+            Napi::Number::New(
+                env,
+                deviceData->buttonTouchedMask));
+
+        arr.Set(i, obj);
+    }
+
+    return arr;
+}
+
+Napi::Value captureOverlayFrame(const Napi::CallbackInfo &info)
+{
+    auto env = info.Env();
+
+    auto id = info[0].ToNumber().Uint32Value();
+    if (id > 1)
+    {
+        return env.Undefined();
+    }
+
+    auto overlayData = overlayDataFromTarget(id);
+    if (overlayData->data == NULL)
+    {
+        return env.Undefined();
+    }
+
+    auto out = (uint8_t *)malloc(frameImageBound());
+    if (out == NULL)
+    {
+        return env.Undefined();
+    }
+
+    auto size = frameImageEncode(out, (const uint8_t *)overlayData->data);
+    auto buffer = Napi::Buffer<uint8_t>::Copy(env, out, size);
+    free(out);
+
+    return buffer;
+}
+
+Napi::Value decodeOverlayFrame(const Napi::CallbackInfo &info)
+{
+    auto env = info.Env();
+
+    auto arg0 = info[0];
+    if (arg0.IsTypedArray() == false)
+    {
+        return env.Undefined();
+    }
+
+    auto data = arg0.As<Napi::Uint8Array>();
+    auto frame = Napi::Buffer<uint8_t>::New(env, FRAME_SIZE);
+
+    if (frameImageDecode(
+            frame.Data(),
+            data.Data(),
+            (uint32_t)data.ByteLength()) == false)
+    {
+        return env.Undefined();
+    }
+
+    return frame;
+}
+
+Napi::Value getOverlayTextureHash(const Napi::CallbackInfo &info)
+{
+    auto env = info.Env();
+
+    auto id = info[0].ToNumber().Uint32Value();
+
+    uint64_t hash;
+    uint64_t submitCount;
+    if (textureSoftHash(id, &hash, &submitCount) == false)
+    {
+        return env.Undefined();
+    }
+
+    // hex, a double can't hold 64 bits
+    char text[17];
+    snprintf(text, sizeof(text), "%016llx", (unsigned long long)hash);
+
+    auto obj = Napi::Object::New(env);
+
+    obj.Set(
+        "hash",
+        Napi::String::New(
+            env,
+            text));
+
+    obj.Set(
+        "submitCount",
+        Napi::Number::New(
+            env,
+            (double)submitCount));
+
+    return obj;
+}
+
+Napi::Value dumpOverlayTexture(const Napi::CallbackInfo &info)
+{
+    auto env = info.Env();
+
+    auto id = info[0].ToNumber().Uint32Value();
+    auto arg1 = info[1];
+    if (arg1.IsString() == false)
+    {
+        return Napi::Boolean::New(env, false);
+    }
+
+    auto frame = (uint8_t *)malloc(FRAME_SIZE);
+    auto out = (uint8_t *)malloc(framePngBound());
+    auto isWritten = false;
+
+    if (frame != NULL && out != NULL && textureSoftRead(id, frame) != false)
+    {
+        auto size = framePngEncode(out, frame);
+
+        auto path = arg1.ToString().Utf8Value(); // pin to stack
+        auto file = platformOpenFile(path.c_str(), "wb");
+        if (file != NULL)
+        {
+            isWritten = fwrite(out, 1, size, file) == size;
+            isWritten = fclose(file) == 0 && isWritten != false;
+        }
+    }
+
+    free(out);
+    free(frame);
+
+    return Napi::Boolean::New(env, isWritten);
+}
+
+Napi::Object init(Napi::Env env, Napi::Object exports)
+{
+    logInit();
+
+    propsBlockInit(&overlayPropsHmd_);
+
+    // picked up by the overlay thread on its first poll
+    governorDefaultConfig(&governorConfig_);
+    governorInit(&governorHmd_, &governorConfig_, platformNowNs(), 0);
+    isGovernorConfigChanged_ = true;
+
+    // VRCX_HUGE_PAGES=1: frame buffers on huge pages (MAP_HUGETLB when pages
+    // are reserved, THP otherwise, linux only). before the first allocation
+    auto hugePages = getenv("VRCX_HUGE_PAGES");
+    if (hugePages != NULL && strcmp(hugePages, "1") == 0)
+    {
+        poolInit(POOL_FLAG_HUGE_PAGES);
+    }
+
+    overlayDataHmd_.data = poolAlloc(true);
+
+    if (overlayDataHmd_.data == NULL)
+    {
+        throw Napi::Error::New(env, "out of memory");
+    }
+
+    overlayDataWrist_.data = poolAlloc(true);
+
+    if (overlayDataWrist_.data == NULL)
+    {
+        throw Napi::Error::New(env, "out of memory");
+    }
+
+    exports.Set(
+        "getRunningApp",
+        Napi::Function::New(env, getRunningApp));
+
+    exports.Set(
+        "setProcessMonitor",
+        Napi::Function::New(env, setProcessMonitor));
+
+    exports.Set(
+        "setResourceSampler",
+        Napi::Function::New(env, setResourceSampler));
+
+    exports.Set(
+        "getResourceSamples",
+        Napi::Function::New(env, getResourceSamples));
+
+    exports.Set(
+        "playGame",
+        Napi::Function::New(env, playGame));
+
+    exports.Set(
+        "startOverlay",
+        Napi::Function::New(env, startOverlay));
+
+    exports.Set(
+        "stopOverlay",
+        Napi::Function::New(env, stopOverlay));
+
+    exports.Set(
+        "setOverlayFrameBuffer",
+        Napi::Function::New(env, setOverlayFrameBuffer));
+
+    exports.Set(
+        "setOverlaySharedTexture",
+        Napi::Function::New(env, setOverlaySharedTexture));
+
+    exports.Set(
+        "setOverlayPixelConvert",
+        Napi::Function::New(env, setOverlayPixelConvert));
+
+    exports.Set(
+        "setOverlayDerive",
+        Napi::Function::New(env, setOverlayDerive));
+
+    exports.Set(
+        "setOverlayProps",
+        Napi::Function::New(env, setOverlayProps));
+
+    exports.Set(
+        "createOverlaySprite",
+        Napi::Function::New(env, createOverlaySprite));
+
+    exports.Set(
+        "updateOverlaySprite",
+        Napi::Function::New(env, updateOverlaySprite));
+
+    exports.Set(
+        "setOverlaySpritePixels",
+        Napi::Function::New(env, setOverlaySpritePixels));
+
+    exports.Set(
+        "destroyOverlaySprite",
+        Napi::Function::New(env, destroyOverlaySprite));
+
+    exports.Set(
+        "createOverlayText",
+        Napi::Function::New(env, createOverlayText));
+
+    exports.Set(
+        "setOverlayText",
+        Napi::Function::New(env, setOverlayText));
+
+    exports.Set(
+        "measureOverlayText",
+        Napi::Function::New(env, measureOverlayText));
+
+    exports.Set(
+        "setOverlayHud",
+        Napi::Function::New(env, setOverlayHud));
+
+    exports.Set(
+        "setOverlayGovernor",
+        Napi::Function::New(env, setOverlayGovernor));
+
+    exports.Set(
+        "setOverlayFollow",
+        Napi::Function::New(env, setOverlayFollow));
+
+    exports.Set(
+        "getVRDeviceList",
+        Napi::Function::New(env, getVRDeviceList));
+
+    exports.Set(
+        "setOverlayWatchdog",
+        Napi::Function::New(env, setOverlayWatchdog));
+
+    exports.Set(
+        "getOverlayStats",
+        Napi::Function::New(env, getOverlayStats));
+
+    exports.Set(
+        "drainNativeLog",
+        Napi::Function::New(env, drainNativeLog));
+
+    exports.Set(
+        "startPaintRecord",
+        Napi::Function::New(env, startPaintRecord));
+
+    exports.Set(
+        "stopPaintRecord",
+        Napi::Function::New(env, stopPaintRecord));
+
+    exports.Set(
+        "captureOverlayFrame",
+        Napi::Function::New(env, captureOverlayFrame));
+
+    exports.Set(
+        "decodeOverlayFrame",
+        Napi::Function::New(env, decodeOverlayFrame));
+
+    exports.Set(
+        "getOverlayTextureHash",
+        Napi::Function::New(env, getOverlayTextureHash));
+
+    exports.Set(
+        "dumpOverlayTexture",
+        Napi::Function::New(env, dumpOverlayTexture));
+
+    return exports;
+}
+
+NODE_API_MODULE(NODE_GYP_MODULE_NAME, init);
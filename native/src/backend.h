@@ -0,0 +1,20 @@
+#pragma once
+
+#include <stdint.h>
+#include "texture.h"
+
+// the parts of the addon that differ by platform, implemented once by
+// main_win.cpp and once by main_linux.cpp. everything else (addon.cpp) is
+// the same on both
+
+const TEXTURE_BACKEND *backendTexture(void);
+// window titles on windows, a cached /proc scan on linux
+void backendGetRunningApp(bool *isVrchat, bool *isSteamvr);
+// starts steam -applaunch 438100 -- <launchOption> (utf-8), from a thread
+// of its own. false when steam couldn't be started
+bool backendSpawnGame(const char *launchOption, uint32_t *pid);
+// takes a handle of a shared texture (TEXTURE_SHARED::handle) for the
+// overlay thread, which closes it once imported. false for one that isn't
+// valid in this process
+bool backendSharedDup(uint64_t handle, uint64_t *dup);
+void backendSharedClose(uint64_t handle);
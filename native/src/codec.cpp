@@ -0,0 +1,627 @@
+#include <stdlib.h>
+#include <string.h>
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define CODEC_SSE2
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#include "frame.h"
+#include "pixel.h"
+#include "pool.h"
+#include "platform.h"
+#include "codec.h"
+
+#define OP_INDEX 0x00
+#define OP_DIFF 0x40
+#define OP_LUMA 0x80
+#define OP_RUN 0xc0
+#define OP_REF 0xe0
+#define OP_REF_LONG 0xfc
+#define OP_RUN_LONG 0xfd
+#define OP_BGR 0xfe
+#define OP_BGRA 0xff
+
+#define RUN_SHORT_MAX 32
+#define REF_SHORT_MAX 28
+#define LONG_MAX_EXTRA 65535
+
+static inline uint32_t codecCtz(uint32_t value)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, value);
+    return index;
+#else
+    return __builtin_ctz(value);
+#endif
+}
+
+static inline uint32_t codecHash(uint32_t pixel)
+{
+    // QOI's r * 3 + g * 5 + b * 7 + a * 11 on BGRA
+    return ((pixel >> 16 & 0xff) * 3 +
+            (pixel >> 8 & 0xff) * 5 +
+            (pixel & 0xff) * 7 +
+            (pixel >> 24) * 11) &
+           63;
+}
+
+static inline uint32_t codecAddBgr(uint32_t pixel, int32_t dr, int32_t dg, int32_t db)
+{
+    return (pixel & 0xff000000u) |
+           (((pixel >> 16) + dr) & 0xff) << 16 |
+           (((pixel >> 8) + dg) & 0xff) << 8 |
+           ((pixel + db) & 0xff);
+}
+
+// number of leading pixels of a that equal b
+static inline uint32_t codecMatchRef(const uint32_t *a, const uint32_t *b, uint32_t count)
+{
+    uint32_t i = 0;
+
+#ifdef CODEC_SSE2
+    for (; i + 4 <= count; i += 4)
+    {
+        auto eq = _mm_cmpeq_epi32(
+            _mm_loadu_si128((const __m128i *)(a + i)),
+            _mm_loadu_si128((const __m128i *)(b + i)));
+        auto mask = (uint32_t)_mm_movemask_epi8(eq);
+        if (mask != 0xffff)
+        {
+            return i + codecCtz(~mask) / 4;
+        }
+    }
+#endif
+
+    while (i < count && a[i] == b[i])
+    {
+        ++i;
+    }
+
+    return i;
+}
+
+// number of leading pixels of a that equal value
+static inline uint32_t codecMatchRun(const uint32_t *a, uint32_t value, uint32_t count)
+{
+    uint32_t i = 0;
+
+#ifdef CODEC_SSE2
+    auto v = _mm_set1_epi32((int)value);
+    for (; i + 4 <= count; i += 4)
+    {
+        auto eq = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)(a + i)), v);
+        auto mask = (uint32_t)_mm_movemask_epi8(eq);
+        if (mask != 0xffff)
+        {
+            return i + codecCtz(~mask) / 4;
+        }
+    }
+#endif
+
+    while (i < count && a[i] == value)
+    {
+        ++i;
+    }
+
+    return i;
+}
+
+static inline uint8_t *codecPutRun(
+    uint8_t *out,
+    uint32_t count,
+    uint8_t shortOp,
+    uint32_t shortMax,
+    uint8_t longOp)
+{
+    while (count != 0)
+    {
+        if (count <= shortMax)
+        {
+            *out++ = (uint8_t)(shortOp | (count - 1));
+            break;
+        }
+
+        auto n = count - (shortMax + 1);
+        if (n > LONG_MAX_EXTRA)
+        {
+            n = LONG_MAX_EXTRA;
+        }
+
+        out[0] = longOp;
+        out[1] = (uint8_t)n;
+        out[2] = (uint8_t)(n >> 8);
+        out += 3;
+        count -= n + shortMax + 1;
+    }
+
+    return out;
+}
+
+bool frameCodecInit(FRAME_CODEC *codec)
+{
+    codec->reference = (uint8_t *)poolAlloc(true);
+    if (codec->reference == NULL)
+    {
+        return false;
+    }
+
+    memset(codec->index, 0, sizeof(codec->index));
+
+    return true;
+}
+
+void frameCodecExit(FRAME_CODEC *codec)
+{
+    poolFree(codec->reference);
+    codec->reference = NULL;
+}
+
+void frameCodecReset(FRAME_CODEC *codec)
+{
+    // the addon's frame buffers start out zeroed, so does the reference
+    memset(codec->reference, 0, FRAME_SIZE);
+}
+
+uint32_t frameCodecBound(uint32_t width, uint32_t height)
+{
+    return width * height * 5;
+}
+
+NOINLINE uint32_t frameEncode(
+    FRAME_CODEC *codec,
+    uint8_t *out,
+    const uint8_t *frame,
+    uint32_t x,
+    uint32_t y,
+    uint32_t width,
+    uint32_t height)
+{
+    auto start = out;
+    auto index = codec->index;
+    uint32_t prev = 0;
+    uint32_t run = 0;
+    uint32_t refRun = 0;
+
+    memset(index, 0, sizeof(codec->index));
+
+    for (uint32_t row = 0; row < height; ++row)
+    {
+        auto offset = ((y + row) * FRAME_WIDTH + x) * 4;
+        auto pixels = (const uint32_t *)(frame + offset);
+        auto refs = (uint32_t *)(codec->reference + offset);
+        uint32_t i = 0;
+
+        while (i < width)
+        {
+            auto pixel = pixels[i];
+
+            if (pixel == refs[i])
+            {
+                if (run != 0)
+                {
+                    out = codecPutRun(out, run, OP_RUN, RUN_SHORT_MAX, OP_RUN_LONG);
+                    run = 0;
+                }
+
+                auto n = codecMatchRef(pixels + i, refs + i, width - i);
+                refRun += n;
+                i += n;
+                prev = pixels[i - 1];
+                continue;
+            }
+
+            if (refRun != 0)
+            {
+                out = codecPutRun(out, refRun, OP_REF, REF_SHORT_MAX, OP_REF_LONG);
+                refRun = 0;
+            }
+
+            if (pixel == prev)
+            {
+                auto n = codecMatchRun(pixels + i, prev, width - i);
+                run += n;
+                i += n;
+                continue;
+            }
+
+            if (run != 0)
+            {
+                out = codecPutRun(out, run, OP_RUN, RUN_SHORT_MAX, OP_RUN_LONG);
+                run = 0;
+            }
+
+            auto hash = codecHash(pixel);
+
+            if (index[hash] == pixel)
+            {
+                *out++ = (uint8_t)(OP_INDEX | hash);
+            }
+            else
+            {
+                index[hash] = pixel;
+
+                if ((pixel >> 24) == (prev >> 24))
+                {
+                    auto db = (int8_t)((pixel & 0xff) - (prev & 0xff));
+                    auto dg = (int8_t)((pixel >> 8 & 0xff) - (prev >> 8 & 0xff));
+                    auto dr = (int8_t)((pixel >> 16 & 0xff) - (prev >> 16 & 0xff));
+                    auto drdg = (int8_t)(dr - dg);
+                    auto dbdg = (int8_t)(db - dg);
+
+                    if (dr >= -2 && dr <= 1 &&
+                        dg >= -2 && dg <= 1 &&
+                        db >= -2 && db <= 1)
+                    {
+                        *out++ = (uint8_t)(OP_DIFF | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2));
+                    }
+                    else if (dg >= -32 && dg <= 31 &&
+                             drdg >= -8 && drdg <= 7 &&
+                             dbdg >= -8 && dbdg <= 7)
+                    {
+                        out[0] = (uint8_t)(OP_LUMA | (dg + 32));
+                        out[1] = (uint8_t)((drdg + 8) << 4 | (dbdg + 8));
+                        out += 2;
+                    }
+                    else
+                    {
+                        out[0] = OP_BGR;
+                        out[1] = (uint8_t)pixel;
+                        out[2] = (uint8_t)(pixel >> 8);
+                        out[3] = (uint8_t)(pixel >> 16);
+                        out += 4;
+                    }
+                }
+                else
+                {
+                    out[0] = OP_BGRA;
+                    memcpy(out + 1, &pixel, 4);
+                    out += 5;
+                }
+            }
+
+            prev = pixel;
+            ++i;
+        }
+
+        // the reference becomes this frame
+        memcpy(refs, pixels, width * 4);
+    }
+
+    if (run != 0)
+    {
+        out = codecPutRun(out, run, OP_RUN, RUN_SHORT_MAX, OP_RUN_LONG);
+    }
+
+    if (refRun != 0)
+    {
+        out = codecPutRun(out, refRun, OP_REF, REF_SHORT_MAX, OP_REF_LONG);
+    }
+
+    return (uint32_t)(out - start);
+}
+
+NOINLINE bool frameDecode(
+    FRAME_CODEC *codec,
+    const uint8_t *data,
+    uint32_t size,
+    uint32_t x,
+    uint32_t y,
+    uint32_t width,
+    uint32_t height)
+{
+    auto end = data + size;
+    auto index = codec->index;
+    uint32_t prev = 0;
+    uint32_t run = 0; // pending copies of prev
+    uint32_t refRun = 0; // pending pixels to leave untouched
+
+    memset(index, 0, sizeof(codec->index));
+
+    // decode in place, the reference becomes the new frame
+    for (uint32_t row = 0; row < height; ++row)
+    {
+        auto pixels = (uint32_t *)(codec->reference + ((y + row) * FRAME_WIDTH + x) * 4);
+        uint32_t i = 0;
+
+        while (i < width)
+        {
+            if (refRun != 0)
+            {
+                auto n = width - i < refRun ? width - i : refRun;
+                refRun -= n;
+                i += n;
+                prev = pixels[i - 1];
+                continue;
+            }
+
+            if (run != 0)
+            {
+                auto n = width - i < run ? width - i : run;
+                run -= n;
+                for (auto stop = i + n; i < stop; ++i)
+                {
+                    pixels[i] = prev;
+                }
+                continue;
+            }
+
+            if (data >= end)
+            {
+                return false;
+            }
+
+            auto op = *data++;
+
+            if (op < OP_DIFF)
+            {
+                prev = index[op];
+            }
+            else if (op < OP_LUMA)
+            {
+                auto dr = (int32_t)(op >> 4 & 3) - 2;
+                auto dg = (int32_t)(op >> 2 & 3) - 2;
+                auto db = (int32_t)(op & 3) - 2;
+                prev = codecAddBgr(prev, dr, dg, db);
+                index[codecHash(prev)] = prev;
+            }
+            else if (op < OP_RUN)
+            {
+                if (data >= end)
+                {
+                    return false;
+                }
+
+                auto dg = (int32_t)(op & 0x3f) - 32;
+                auto dr = dg + (int32_t)(*data >> 4) - 8;
+                auto db = dg + (int32_t)(*data & 0x0f) - 8;
+                ++data;
+                prev = codecAddBgr(prev, dr, dg, db);
+                index[codecHash(prev)] = prev;
+            }
+            else if (op < OP_REF)
+            {
+                run = (op & 0x1f) + 1;
+                continue;
+            }
+            else if (op < OP_REF_LONG)
+            {
+                refRun = (op & 0x1f) + 1;
+                continue;
+            }
+            else if (op <= OP_RUN_LONG)
+            {
+                if (end - data < 2)
+                {
+                    return false;
+                }
+
+                uint32_t n = data[0] | data[1] << 8;
+                data += 2;
+
+                if (op == OP_REF_LONG)
+                {
+                    refRun = n + REF_SHORT_MAX + 1;
+                }
+                else
+                {
+                    run = n + RUN_SHORT_MAX + 1;
+                }
+                continue;
+            }
+            else if (op == OP_BGR)
+            {
+                if (end - data < 3)
+                {
+                    return false;
+                }
+
+                prev = (prev & 0xff000000u) | data[2] << 16 | data[1] << 8 | data[0];
+                data += 3;
+                index[codecHash(prev)] = prev;
+            }
+            else
+            {
+                if (end - data < 4)
+                {
+                    return false;
+                }
+
+                memcpy(&prev, data, 4);
+                data += 4;
+                index[codecHash(prev)] = prev;
+            }
+
+            pixels[i++] = prev;
+        }
+    }
+
+    return data == end && run == 0 && refRun == 0;
+}
+
+uint32_t frameImageBound(void)
+{
+    return sizeof(FRAME_IMAGE_HEADER) + frameCodecBound(FRAME_WIDTH, FRAME_HEIGHT);
+}
+
+uint32_t frameImageEncode(uint8_t *out, const uint8_t *frame)
+{
+    FRAME_CODEC codec;
+    if (frameCodecInit(&codec) == false)
+    {
+        return 0;
+    }
+
+    FRAME_IMAGE_HEADER header;
+    header.magic = FRAME_IMAGE_MAGIC;
+    header.width = FRAME_WIDTH;
+    header.height = FRAME_HEIGHT;
+    header.size = frameEncode(
+        &codec,
+        out + sizeof(header),
+        frame,
+        0,
+        0,
+        FRAME_WIDTH,
+        FRAME_HEIGHT);
+    memcpy(out, &header, sizeof(header));
+
+    frameCodecExit(&codec);
+
+    return sizeof(header) + header.size;
+}
+
+bool frameImageDecode(uint8_t *frame, const uint8_t *data, uint32_t size)
+{
+    FRAME_IMAGE_HEADER header;
+    if (size < sizeof(header))
+    {
+        return false;
+    }
+
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != FRAME_IMAGE_MAGIC ||
+        header.width != FRAME_WIDTH ||
+        header.height != FRAME_HEIGHT ||
+        header.size != size - sizeof(header))
+    {
+        return false;
+    }
+
+    FRAME_CODEC codec;
+    codec.reference = frame;
+    memset(frame, 0, FRAME_SIZE);
+
+    return frameDecode(
+        &codec,
+        data + sizeof(header),
+        header.size,
+        0,
+        0,
+        FRAME_WIDTH,
+        FRAME_HEIGHT);
+}
+
+#define PNG_ROW_SIZE (1 + FRAME_STRIDE) // filter byte, none
+#define PNG_RAW_SIZE (PNG_ROW_SIZE * FRAME_HEIGHT)
+#define PNG_BLOCK_MAX 65535 // stored deflate block
+#define PNG_BLOCK_COUNT ((PNG_RAW_SIZE + PNG_BLOCK_MAX - 1) / PNG_BLOCK_MAX)
+#define PNG_IDAT_SIZE (2 + PNG_BLOCK_COUNT * 5 + PNG_RAW_SIZE + 4)
+
+static uint32_t pngCrc(uint32_t crc, const uint8_t *data, uint32_t size)
+{
+    static uint32_t table[256];
+    if (table[1] == 0)
+    {
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            auto c = i;
+            for (uint32_t k = 0; k < 8; ++k)
+            {
+                c = (c & 1) != 0 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            }
+            table[i] = c;
+        }
+    }
+
+    crc = ~crc;
+    for (uint32_t i = 0; i < size; ++i)
+    {
+        crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+static uint8_t *pngPut32(uint8_t *out, uint32_t value)
+{
+    out[0] = (uint8_t)(value >> 24);
+    out[1] = (uint8_t)(value >> 16);
+    out[2] = (uint8_t)(value >> 8);
+    out[3] = (uint8_t)value;
+    return out + 4;
+}
+
+// length, type and data already at out, appends the crc
+static uint8_t *pngEndChunk(uint8_t *out, uint32_t size)
+{
+    return pngPut32(out + 8 + size, pngCrc(0, out + 4, 4 + size));
+}
+
+uint32_t framePngBound(void)
+{
+    return 8 + (12 + 13) + (12 + PNG_IDAT_SIZE) + 12;
+}
+
+uint32_t framePngEncode(uint8_t *out, const uint8_t *frame)
+{
+    static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    auto ptr = out;
+
+    memcpy(ptr, signature, 8);
+    ptr += 8;
+
+    auto chunk = ptr;
+    ptr = pngPut32(ptr, 13);
+    memcpy(ptr, "IHDR", 4);
+    ptr = pngPut32(ptr + 4, FRAME_WIDTH);
+    ptr = pngPut32(ptr, FRAME_HEIGHT);
+    *ptr++ = 8; // bits per channel
+    *ptr++ = 6; // rgba
+    *ptr++ = 0; // deflate
+    *ptr++ = 0; // adaptive filters
+    *ptr++ = 0; // not interlaced
+    ptr = pngEndChunk(chunk, 13);
+
+    chunk = ptr;
+    ptr = pngPut32(ptr, PNG_IDAT_SIZE);
+    memcpy(ptr, "IDAT", 4);
+    ptr += 4;
+    *ptr++ = 0x78; // zlib, 32k window
+    *ptr++ = 0x01;
+
+    // the rows as png wants them, straight alpha, behind room for the
+    // block headers. then split into blocks in place, front to back
+    auto raw = ptr + PNG_BLOCK_COUNT * 5;
+    PIXEL_CONVERT convert = {PIXEL_OP_UNPREMULTIPLY | PIXEL_OP_SWIZZLE, 0, 255};
+    for (uint32_t y = 0; y < FRAME_HEIGHT; ++y)
+    {
+        auto row = raw + y * PNG_ROW_SIZE;
+        row[0] = 0;
+        pixelConvertRow(row + 1, frame + y * FRAME_STRIDE, FRAME_WIDTH, &convert);
+    }
+
+    uint32_t adlerA = 1;
+    uint32_t adlerB = 0;
+    for (uint32_t i = 0; i < PNG_RAW_SIZE; ++i)
+    {
+        adlerA = (adlerA + raw[i]) % 65521;
+        adlerB = (adlerB + adlerA) % 65521;
+    }
+
+    for (uint32_t block = 0; block < PNG_BLOCK_COUNT; ++block)
+    {
+        auto offset = block * PNG_BLOCK_MAX;
+        auto size = PNG_RAW_SIZE - offset < PNG_BLOCK_MAX ? PNG_RAW_SIZE - offset : PNG_BLOCK_MAX;
+
+        // each block moves left to just after its own header
+        auto header = ptr + offset + block * 5;
+        memmove(header + 5, raw + offset, size);
+        header[0] = block + 1 == PNG_BLOCK_COUNT ? 1 : 0;
+        header[1] = (uint8_t)size;
+        header[2] = (uint8_t)(size >> 8);
+        header[3] = (uint8_t)~size;
+        header[4] = (uint8_t)(~size >> 8);
+    }
+    ptr += PNG_BLOCK_COUNT * 5 + PNG_RAW_SIZE;
+    ptr = pngPut32(ptr, adlerB << 16 | adlerA);
+    ptr = pngEndChunk(chunk, PNG_IDAT_SIZE);
+
+    chunk = ptr;
+    ptr = pngPut32(ptr, 0);
+    memcpy(ptr, "IEND", 4);
+    ptr = pngEndChunk(chunk, 0);
+
+    return (uint32_t)(ptr - out);
+}
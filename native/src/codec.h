@@ -0,0 +1,67 @@
+#pragma once
+
+#include <stdint.h>
+
+// lossless frame codec: QOI ops plus runs of pixels unchanged since the
+// previous frame. encoder and decoder each keep that previous frame, so a
+// stream of dirty rects only pays for what actually changed.
+//
+//   00xxxxxx          index into the 64 entry hash of recent pixels
+//   01rrggbb          b/g/r delta -2..1 against the previous pixel
+//   10gggggg rrrrbbbb g delta -32..31, r/b delta -8..7 relative to g
+//   110xxxxx          1..32 copies of the previous pixel
+//   111xxxxx          1..28 pixels unchanged from the reference (< 0xfc)
+//   0xfc n16          29..65564 pixels unchanged from the reference
+//   0xfd n16          33..65568 copies of the previous pixel
+//   0xfe b g r        new pixel, alpha unchanged
+//   0xff b g r a      new pixel
+//
+// pixels are BGRA as they come from Chromium. the previous pixel and the
+// hash are reset for every rect, the reference frame carries over.
+
+#define FRAME_IMAGE_MAGIC 0x494f5153u // "SQOI"
+
+typedef struct _FRAME_CODEC
+{
+    uint8_t *reference; // FRAME_SIZE, the frame as of the last rect
+    uint32_t index[64];
+} FRAME_CODEC;
+
+typedef struct _FRAME_IMAGE_HEADER
+{
+    uint32_t magic;
+    uint16_t width;
+    uint16_t height;
+    uint32_t size;
+} FRAME_IMAGE_HEADER;
+
+bool frameCodecInit(FRAME_CODEC *codec);
+void frameCodecExit(FRAME_CODEC *codec);
+void frameCodecReset(FRAME_CODEC *codec);
+uint32_t frameCodecBound(uint32_t width, uint32_t height);
+uint32_t frameEncode(
+    FRAME_CODEC *codec,
+    uint8_t *out,
+    const uint8_t *frame,
+    uint32_t x,
+    uint32_t y,
+    uint32_t width,
+    uint32_t height);
+bool frameDecode(
+    FRAME_CODEC *codec,
+    const uint8_t *data,
+    uint32_t size,
+    uint32_t x,
+    uint32_t y,
+    uint32_t width,
+    uint32_t height);
+
+// self-contained image of a whole frame, for screenshots and bug reports
+uint32_t frameImageBound(void);
+uint32_t frameImageEncode(uint8_t *out, const uint8_t *frame);
+bool frameImageDecode(uint8_t *frame, const uint8_t *data, uint32_t size);
+
+// a whole frame as png (straight rgba, stored deflate), for looking at with
+// anything. not compressed, about FRAME_SIZE
+uint32_t framePngBound(void);
+uint32_t framePngEncode(uint8_t *out, const uint8_t *frame);
@@ -0,0 +1,491 @@
+#include <stdlib.h>
+#include <string.h>
+#include "pixel.h"
+#include "pool.h"
+#include "compositor.h"
+
+static SPRITE *compositorFind(COMPOSITOR *compositor, uint32_t id)
+{
+    if (id == 0)
+    {
+        return NULL;
+    }
+
+    for (auto &sprite : compositor->sprites)
+    {
+        if (sprite.id == id)
+        {
+            return &sprite;
+        }
+    }
+
+    return NULL;
+}
+
+// bottom to top by z, ties in creation order
+static void compositorSort(COMPOSITOR *compositor)
+{
+    auto order = compositor->order;
+    auto sprites = compositor->sprites;
+
+    for (uint32_t i = 1; i < compositor->count; ++i)
+    {
+        auto slot = order[i];
+        auto j = i;
+        while (j > 0 &&
+               (sprites[order[j - 1]].z > sprites[slot].z ||
+                (sprites[order[j - 1]].z == sprites[slot].z &&
+                 sprites[order[j - 1]].id > sprites[slot].id)))
+        {
+            order[j] = order[j - 1];
+            --j;
+        }
+        order[j] = slot;
+    }
+}
+
+static void compositorMark(
+    COMPOSITOR *compositor,
+    int64_t x,
+    int64_t y,
+    int64_t width,
+    int64_t height)
+{
+    auto x0 = x > 0 ? x : 0;
+    auto y0 = y > 0 ? y : 0;
+    auto x1 = x + width < FRAME_WIDTH ? x + width : FRAME_WIDTH;
+    auto y1 = y + height < FRAME_HEIGHT ? y + height : FRAME_HEIGHT;
+
+    if (x0 >= x1 || y0 >= y1)
+    {
+        return;
+    }
+
+    for (auto ty = y0 / FRAME_TILE_SIZE; ty <= (y1 - 1) / FRAME_TILE_SIZE; ++ty)
+    {
+        for (auto tx = x0 / FRAME_TILE_SIZE; tx <= (x1 - 1) / FRAME_TILE_SIZE; ++tx)
+        {
+            compositor->damage[ty * FRAME_TILES_X + tx] = 1;
+        }
+    }
+}
+
+static void compositorMarkSprite(COMPOSITOR *compositor, const SPRITE *sprite)
+{
+    compositorMark(compositor, sprite->x, sprite->y, sprite->width, sprite->height);
+}
+
+// page, then every visible sprite over it, for [x0, x1) x [y0, y1)
+static void compositorCompose(
+    OVERLAY_DATA *overlayData,
+    uint32_t x0,
+    uint32_t y0,
+    uint32_t x1,
+    uint32_t y1)
+{
+    auto compositor = overlayData->compositor;
+    auto target = (uint8_t *)overlayData->data;
+
+    for (auto y = y0; y < y1; ++y)
+    {
+        auto offset = (y * FRAME_WIDTH + x0) * 4;
+        memcpy(target + offset, compositor->page + offset, (x1 - x0) * 4);
+    }
+
+    for (uint32_t i = 0; i < compositor->count; ++i)
+    {
+        auto sprite = &compositor->sprites[compositor->order[i]];
+        if (sprite->isVisible == false || sprite->opacity == 0)
+        {
+            continue;
+        }
+
+        auto sx0 = (int64_t)x0 > sprite->x ? (int64_t)x0 : sprite->x;
+        auto sy0 = (int64_t)y0 > sprite->y ? (int64_t)y0 : sprite->y;
+        auto sx1 = (int64_t)sprite->x + sprite->width;
+        auto sy1 = (int64_t)sprite->y + sprite->height;
+        sx1 = sx1 < x1 ? sx1 : x1;
+        sy1 = sy1 < y1 ? sy1 : y1;
+
+        if (sx0 >= sx1 || sy0 >= sy1)
+        {
+            continue;
+        }
+
+        for (auto y = sy0; y < sy1; ++y)
+        {
+            pixelBlendRow(
+                target + (y * FRAME_WIDTH + sx0) * 4,
+                sprite->pixels + ((y - sprite->y) * sprite->width + (sx0 - sprite->x)) * 4,
+                (uint32_t)(sx1 - sx0),
+                sprite->opacity);
+        }
+    }
+}
+
+// composites runs of damaged tiles, one rect per run
+static void compositorFlush(OVERLAY_DATA *overlayData)
+{
+    auto compositor = overlayData->compositor;
+    auto isDirty = false;
+
+    for (uint32_t ty = 0; ty < FRAME_TILES_Y; ++ty)
+    {
+        auto damage = &compositor->damage[ty * FRAME_TILES_X];
+
+        for (uint32_t tx = 0; tx < FRAME_TILES_X;)
+        {
+            if (damage[tx] == 0)
+            {
+                ++tx;
+                continue;
+            }
+
+            auto start = tx;
+            while (tx < FRAME_TILES_X && damage[tx] != 0)
+            {
+                damage[tx++] = 0;
+            }
+
+            auto x = start * FRAME_TILE_SIZE;
+            auto y = ty * FRAME_TILE_SIZE;
+            auto width = (tx - start) * FRAME_TILE_SIZE;
+
+            compositorCompose(overlayData, x, y, x + width, y + FRAME_TILE_SIZE);
+            frameUpdateTiles(overlayData, x, y, width, FRAME_TILE_SIZE);
+            isDirty = true;
+        }
+    }
+
+    if (isDirty != false)
+    {
+        frameMarkDirty(overlayData);
+    }
+}
+
+static bool compositorActivate(OVERLAY_DATA *overlayData)
+{
+    if (overlayData->compositor != NULL)
+    {
+        return true;
+    }
+
+    auto compositor = (COMPOSITOR *)calloc(1, sizeof(COMPOSITOR));
+    if (compositor == NULL)
+    {
+        return false;
+    }
+
+    compositor->page = (uint8_t *)poolAlloc(false);
+    if (compositor->page == NULL)
+    {
+        free(compositor);
+        return false;
+    }
+
+    // up to now the upload buffer was the page
+    memcpy(compositor->page, overlayData->data, FRAME_SIZE);
+    compositor->nextId = 1;
+    overlayData->compositor = compositor;
+    return true;
+}
+
+// the last sprite is gone and composited away, data equals the page again
+static void compositorDeactivate(OVERLAY_DATA *overlayData)
+{
+    auto compositor = overlayData->compositor;
+    overlayData->compositor = NULL;
+    poolFree(compositor->page);
+    free(compositor);
+}
+
+static void compositorLoadPixels(SPRITE *sprite, const uint8_t *rgba)
+{
+    if (rgba == NULL)
+    {
+        memset(sprite->pixels, 0, sprite->width * sprite->height * 4);
+        return;
+    }
+
+    PIXEL_CONVERT convert = {PIXEL_OP_PREMULTIPLY | PIXEL_OP_SWIZZLE, 0, 255};
+    pixelConvertRow(sprite->pixels, rgba, sprite->width * sprite->height, &convert);
+}
+
+static void compositorApplyProps(SPRITE *sprite, const SPRITE_PROPS *props)
+{
+    sprite->x = props->x;
+    sprite->y = props->y;
+    sprite->z = props->z;
+    sprite->opacity = props->opacity;
+    sprite->isVisible = props->isVisible;
+}
+
+bool compositorIsActive(const OVERLAY_DATA *overlayData)
+{
+    return overlayData->compositor != NULL;
+}
+
+uint32_t compositorCreateSprite(
+    OVERLAY_DATA *overlayData,
+    const uint8_t *rgba,
+    uint32_t width,
+    uint32_t height,
+    const SPRITE_PROPS *props)
+{
+    if (width == 0 || width > FRAME_WIDTH ||
+        height == 0 || height > FRAME_HEIGHT)
+    {
+        return 0;
+    }
+
+    if (compositorActivate(overlayData) == false)
+    {
+        return 0;
+    }
+
+    auto compositor = overlayData->compositor;
+    SPRITE *sprite = NULL;
+
+    for (auto &slot : compositor->sprites)
+    {
+        if (slot.id == 0)
+        {
+            sprite = &slot;
+            break;
+        }
+    }
+
+    if (sprite != NULL)
+    {
+        sprite->pixels = (uint8_t *)malloc(width * height * 4);
+    }
+
+    if (sprite == NULL || sprite->pixels == NULL)
+    {
+        if (compositor->count == 0)
+        {
+            compositorDeactivate(overlayData);
+        }
+        return 0;
+    }
+
+    sprite->id = compositor->nextId++;
+    if (compositor->nextId == 0)
+    {
+        compositor->nextId = 1;
+    }
+
+    sprite->width = width;
+    sprite->height = height;
+    compositorApplyProps(sprite, props);
+    compositorLoadPixels(sprite, rgba);
+
+    compositor->order[compositor->count++] = (uint32_t)(sprite - compositor->sprites);
+    compositorSort(compositor);
+
+    compositorMarkSprite(compositor, sprite);
+    compositorFlush(overlayData);
+
+    return sprite->id;
+}
+
+bool compositorUpdateSprite(
+    OVERLAY_DATA *overlayData,
+    uint32_t id,
+    const SPRITE_PROPS *props)
+{
+    auto compositor = overlayData->compositor;
+    if (compositor == NULL)
+    {
+        return false;
+    }
+
+    auto sprite = compositorFind(compositor, id);
+    if (sprite == NULL)
+    {
+        return false;
+    }
+
+    auto z = sprite->z;
+
+    // damage where it was and where it is now
+    compositorMarkSprite(compositor, sprite);
+    compositorApplyProps(sprite, props);
+    compositorMarkSprite(compositor, sprite);
+
+    if (sprite->z != z)
+    {
+        compositorSort(compositor);
+    }
+
+    compositorFlush(overlayData);
+    return true;
+}
+
+bool compositorGetSprite(
+    const OVERLAY_DATA *overlayData,
+    uint32_t id,
+    SPRITE_PROPS *props)
+{
+    auto compositor = overlayData->compositor;
+    if (compositor == NULL)
+    {
+        return false;
+    }
+
+    auto sprite = compositorFind(compositor, id);
+    if (sprite == NULL)
+    {
+        return false;
+    }
+
+    props->x = sprite->x;
+    props->y = sprite->y;
+    props->z = sprite->z;
+    props->opacity = sprite->opacity;
+    props->isVisible = sprite->isVisible;
+    return true;
+}
+
+bool compositorSetSpritePixels(
+    OVERLAY_DATA *overlayData,
+    uint32_t id,
+    const uint8_t *rgba,
+    uint32_t size)
+{
+    auto compositor = overlayData->compositor;
+    if (compositor == NULL)
+    {
+        return false;
+    }
+
+    auto sprite = compositorFind(compositor, id);
+    if (sprite == NULL || size != sprite->width * sprite->height * 4)
+    {
+        return false;
+    }
+
+    compositorLoadPixels(sprite, rgba);
+    compositorMarkSprite(compositor, sprite);
+    compositorFlush(overlayData);
+    return true;
+}
+
+bool compositorDestroySprite(OVERLAY_DATA *overlayData, uint32_t id)
+{
+    auto compositor = overlayData->compositor;
+    if (compositor == NULL)
+    {
+        return false;
+    }
+
+    auto sprite = compositorFind(compositor, id);
+    if (sprite == NULL)
+    {
+        return false;
+    }
+
+    compositorMarkSprite(compositor, sprite);
+
+    auto slot = (uint32_t)(sprite - compositor->sprites);
+    for (uint32_t i = 0, j = 0; i < compositor->count; ++i)
+    {
+        if (compositor->order[i] != slot)
+        {
+            compositor->order[j++] = compositor->order[i];
+        }
+    }
+    --compositor->count;
+
+    free(sprite->pixels);
+    memset(sprite, 0, sizeof(SPRITE));
+
+    compositorFlush(overlayData);
+
+    if (compositor->count == 0)
+    {
+        compositorDeactivate(overlayData);
+    }
+
+    return true;
+}
+
+uint8_t *compositorSpritePixels(OVERLAY_DATA *overlayData, uint32_t id)
+{
+    auto compositor = overlayData->compositor;
+    if (compositor == NULL)
+    {
+        return NULL;
+    }
+
+    auto sprite = compositorFind(compositor, id);
+    if (sprite == NULL)
+    {
+        return NULL;
+    }
+
+    return sprite->pixels;
+}
+
+bool compositorDamageSprite(
+    OVERLAY_DATA *overlayData,
+    uint32_t id,
+    uint32_t x,
+    uint32_t y,
+    uint32_t width,
+    uint32_t height)
+{
+    auto compositor = overlayData->compositor;
+    if (compositor == NULL)
+    {
+        return false;
+    }
+
+    auto sprite = compositorFind(compositor, id);
+    if (sprite == NULL)
+    {
+        return false;
+    }
+
+    if (sprite->isVisible != false && sprite->opacity != 0)
+    {
+        compositorMark(
+            compositor,
+            (int64_t)sprite->x + x,
+            (int64_t)sprite->y + y,
+            width,
+            height);
+        compositorFlush(overlayData);
+    }
+
+    return true;
+}
+
+uint8_t *compositorPage(OVERLAY_DATA *overlayData)
+{
+    if (overlayData->compositor != NULL)
+    {
+        return overlayData->compositor->page;
+    }
+
+    return (uint8_t *)overlayData->data;
+}
+
+void compositorDamage(
+    OVERLAY_DATA *overlayData,
+    uint32_t x,
+    uint32_t y,
+    uint32_t width,
+    uint32_t height)
+{
+    auto compositor = overlayData->compositor;
+    if (compositor == NULL)
+    {
+        frameUpdateTiles(overlayData, x, y, width, height);
+        frameMarkDirty(overlayData);
+        return;
+    }
+
+    compositorMark(compositor, x, y, width, height);
+    compositorFlush(overlayData);
+}
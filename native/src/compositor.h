@@ -0,0 +1,89 @@
+#pragma once
+
+#include <stdint.h>
+#include "frame.h"
+
+// layers an overlay's chromium page with native sprites. once a sprite
+// exists the page is kept in its own buffer and OVERLAY_DATA::data holds
+// the composite; only tiles damaged by a paint or a sprite change are
+// composited again. everything here runs on the js thread.
+
+#define COMPOSITOR_MAX_SPRITES 32
+
+typedef struct _SPRITE
+{
+    uint32_t id; // 0 = free slot
+    int32_t x;
+    int32_t y;
+    int32_t z; // higher draws on top, the page is below every sprite
+    uint32_t width;
+    uint32_t height;
+    uint8_t opacity;
+    bool isVisible;
+    uint8_t *pixels; // premultiplied BGRA, width * height
+} SPRITE;
+
+typedef struct _SPRITE_PROPS
+{
+    int32_t x;
+    int32_t y;
+    int32_t z;
+    uint8_t opacity;
+    bool isVisible;
+} SPRITE_PROPS;
+
+typedef struct _COMPOSITOR
+{
+    uint8_t *page; // FRAME_SIZE
+    uint32_t nextId;
+    uint32_t count;
+    uint32_t order[COMPOSITOR_MAX_SPRITES]; // slots, bottom to top
+    SPRITE sprites[COMPOSITOR_MAX_SPRITES];
+    uint8_t damage[FRAME_TILE_COUNT];
+} COMPOSITOR;
+
+// allocated on the first sprite, freed with the last
+bool compositorIsActive(const OVERLAY_DATA *overlayData);
+// rgba is straight alpha as canvas ImageData hands it out, NULL for a
+// transparent sprite. returns the sprite id, 0 on failure
+uint32_t compositorCreateSprite(
+    OVERLAY_DATA *overlayData,
+    const uint8_t *rgba,
+    uint32_t width,
+    uint32_t height,
+    const SPRITE_PROPS *props);
+bool compositorUpdateSprite(
+    OVERLAY_DATA *overlayData,
+    uint32_t id,
+    const SPRITE_PROPS *props);
+bool compositorGetSprite(
+    const OVERLAY_DATA *overlayData,
+    uint32_t id,
+    SPRITE_PROPS *props);
+bool compositorSetSpritePixels(
+    OVERLAY_DATA *overlayData,
+    uint32_t id,
+    const uint8_t *rgba,
+    uint32_t size);
+bool compositorDestroySprite(OVERLAY_DATA *overlayData, uint32_t id);
+// for drawing into a sprite natively; follow up with compositorDamageSprite
+uint8_t *compositorSpritePixels(OVERLAY_DATA *overlayData, uint32_t id);
+// recomposites a rect of the sprite, in sprite pixels
+bool compositorDamageSprite(
+    OVERLAY_DATA *overlayData,
+    uint32_t id,
+    uint32_t x,
+    uint32_t y,
+    uint32_t width,
+    uint32_t height);
+// where page content for this overlay goes: the page buffer while sprites
+// exist, the upload buffer otherwise
+uint8_t *compositorPage(OVERLAY_DATA *overlayData);
+// recomposites the tiles under a rect of the page that just changed,
+// updates coverage and marks the overlay dirty
+void compositorDamage(
+    OVERLAY_DATA *overlayData,
+    uint32_t x,
+    uint32_t y,
+    uint32_t width,
+    uint32_t height);
@@ -0,0 +1,105 @@
+#include <string.h>
+#include "device.h"
+
+uint32_t deviceTableSnapshot(VR_DEVICE_TABLE *table, VR_DEVICE_DATA *data)
+{
+    table->lock.lock();
+
+    auto count = table->count;
+    memcpy(data, table->data, sizeof(VR_DEVICE_DATA) * count);
+
+    table->lock.unlock();
+
+    return count;
+}
+
+static void deviceMockAdd(
+    VR_DEVICE_TABLE *table,
+    vr::ETrackedDeviceClass deviceClass,
+    vr::ETrackedControllerRole controllerRole,
+    bool isConnected,
+    bool isCharging,
+    float batteryPercentage)
+{
+    auto deviceData = &table->data[table->count++];
+    deviceData->deviceClass = deviceClass;
+    deviceData->isConnected = isConnected;
+    deviceData->isCharging = isCharging;
+    deviceData->batteryPercentage =
+        batteryPercentage < 0.0f   ? 0.0f
+        : batteryPercentage > 1.0f ? 1.0f
+                                   : batteryPercentage;
+    deviceData->controllerRole = controllerRole;
+    deviceData->buttonPressedMask = 0;
+    deviceData->buttonTouchedMask = 0;
+}
+
+void deviceTableFillMock(VR_DEVICE_TABLE *table, uint64_t timeMs)
+{
+    auto minutes = (float)timeMs / 60000.0f;
+    auto charging = minutes < 20.0f;
+
+    table->count = 0;
+
+    deviceMockAdd(
+        table,
+        vr::TrackedDeviceClass_HMD,
+        vr::TrackedControllerRole_Invalid,
+        true,
+        false,
+        0.0f);
+
+    // drains 1% a minute
+    deviceMockAdd(
+        table,
+        vr::TrackedDeviceClass_Controller,
+        vr::TrackedControllerRole_LeftHand,
+        true,
+        false,
+        0.95f - minutes * 0.01f);
+
+    // on the cable for the first 20 minutes
+    deviceMockAdd(
+        table,
+        vr::TrackedDeviceClass_Controller,
+        vr::TrackedControllerRole_RightHand,
+        true,
+        charging,
+        charging ? 0.4f + minutes * 0.01f : 0.6f - (minutes - 20.0f) * 0.01f);
+
+    deviceMockAdd(
+        table,
+        vr::TrackedDeviceClass_GenericTracker,
+        vr::TrackedControllerRole_Invalid,
+        true,
+        false,
+        0.8f - minutes * 0.003f);
+
+    deviceMockAdd(
+        table,
+        vr::TrackedDeviceClass_GenericTracker,
+        vr::TrackedControllerRole_Invalid,
+        true,
+        false,
+        0.6f - minutes * 0.003f);
+
+    // loses tracking for 10s every 2 minutes
+    deviceMockAdd(
+        table,
+        vr::TrackedDeviceClass_GenericTracker,
+        vr::TrackedControllerRole_Invalid,
+        timeMs % 120000 < 110000,
+        false,
+        0.25f - minutes * 0.003f);
+
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        deviceMockAdd(
+            table,
+            vr::TrackedDeviceClass_TrackingReference,
+            vr::TrackedControllerRole_Invalid,
+            true,
+            false,
+            0.0f);
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stdint.h>
+#include <mutex>
+#include <openvr/openvr.h>
+
+typedef struct _VR_DEVICE_DATA
+{
+    vr::ETrackedDeviceClass deviceClass;
+    bool isConnected;
+    bool isCharging;
+    float batteryPercentage;
+    vr::ETrackedControllerRole controllerRole;
+    uint64_t buttonPressedMask;
+    uint64_t buttonTouchedMask;
+} VR_DEVICE_DATA;
+
+typedef struct _VR_DEVICE_TABLE
+{
+    std::mutex lock;
+    uint32_t count;
+    VR_DEVICE_DATA data[vr::k_unMaxTrackedDeviceCount];
+} VR_DEVICE_TABLE;
+
+uint32_t deviceTableSnapshot(VR_DEVICE_TABLE *table, VR_DEVICE_DATA *data);
+// a scripted hmd, two controllers, three trackers and two base stations
+// whose batteries drain and charge over time, for running the hud and the
+// device paths without SteamVR. the caller holds the table lock
+void deviceTableFillMock(VR_DEVICE_TABLE *table, uint64_t timeMs);
@@ -0,0 +1,279 @@
+#include <math.h>
+#include <string.h>
+#include "follow.h"
+
+#define FOLLOW_PI 3.14159265f
+#define FOLLOW_SETTLE_METERS 0.001f // caught up, stop moving
+#define FOLLOW_SETTLE_RAD 0.002f
+#define FOLLOW_MAX_STEP_NS 100000000ull // a stalled tick doesn't jump
+
+static void followQuatFromMatrix(float *q, const float *m)
+{
+    auto trace = m[0] + m[5] + m[10];
+
+    if (trace > 0.0f)
+    {
+        auto s = sqrtf(trace + 1.0f) * 2.0f;
+        q[0] = (m[9] - m[6]) / s;
+        q[1] = (m[2] - m[8]) / s;
+        q[2] = (m[4] - m[1]) / s;
+        q[3] = 0.25f * s;
+    }
+    else if (m[0] > m[5] && m[0] > m[10])
+    {
+        auto s = sqrtf(1.0f + m[0] - m[5] - m[10]) * 2.0f;
+        q[0] = 0.25f * s;
+        q[1] = (m[1] + m[4]) / s;
+        q[2] = (m[2] + m[8]) / s;
+        q[3] = (m[9] - m[6]) / s;
+    }
+    else if (m[5] > m[10])
+    {
+        auto s = sqrtf(1.0f + m[5] - m[0] - m[10]) * 2.0f;
+        q[0] = (m[1] + m[4]) / s;
+        q[1] = 0.25f * s;
+        q[2] = (m[6] + m[9]) / s;
+        q[3] = (m[2] - m[8]) / s;
+    }
+    else
+    {
+        auto s = sqrtf(1.0f + m[10] - m[0] - m[5]) * 2.0f;
+        q[0] = (m[2] + m[8]) / s;
+        q[1] = (m[6] + m[9]) / s;
+        q[2] = 0.25f * s;
+        q[3] = (m[4] - m[1]) / s;
+    }
+}
+
+static void followMatrixFromPose(float *m, const float *q, const float *p)
+{
+    auto x = q[0], y = q[1], z = q[2], w = q[3];
+
+    m[0] = 1.0f - 2.0f * (y * y + z * z);
+    m[1] = 2.0f * (x * y - z * w);
+    m[2] = 2.0f * (x * z + y * w);
+    m[3] = p[0];
+    m[4] = 2.0f * (x * y + z * w);
+    m[5] = 1.0f - 2.0f * (x * x + z * z);
+    m[6] = 2.0f * (y * z - x * w);
+    m[7] = p[1];
+    m[8] = 2.0f * (x * z - y * w);
+    m[9] = 2.0f * (y * z + x * w);
+    m[10] = 1.0f - 2.0f * (x * x + y * y);
+    m[11] = p[2];
+}
+
+static float followQuatDot(const float *a, const float *b)
+{
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+}
+
+static float followQuatAngle(const float *a, const float *b)
+{
+    auto dot = fabsf(followQuatDot(a, b));
+    return dot >= 1.0f ? 0.0f : 2.0f * acosf(dot);
+}
+
+// normalized lerp along the short way, close enough to slerp for the small
+// steps of one tick
+static void followQuatBlend(float *q, const float *target, float t)
+{
+    auto sign = followQuatDot(q, target) < 0.0f ? -1.0f : 1.0f;
+    auto length = 0.0f;
+
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        q[i] += (target[i] * sign - q[i]) * t;
+        length += q[i] * q[i];
+    }
+
+    length = sqrtf(length);
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        q[i] /= length;
+    }
+}
+
+// the head turned about the vertical only, false when looking straight up
+// or down and the heading is undefined
+static bool followUpright(float *out, const float *hmd)
+{
+    // forward is -z
+    auto fx = -hmd[2];
+    auto fz = -hmd[10];
+    auto length = sqrtf(fx * fx + fz * fz);
+    if (length < 0.0001f)
+    {
+        return false;
+    }
+
+    auto s = -fx / length;
+    auto c = -fz / length;
+
+    const float yaw[12] = {
+        c, 0.0f, s, hmd[3],
+        0.0f, 1.0f, 0.0f, hmd[7],
+        -s, 0.0f, c, hmd[11]};
+    memcpy(out, yaw, sizeof(yaw));
+    return true;
+}
+
+void followDefaultConfig(FOLLOW_CONFIG *config)
+{
+    config->dampingMs = 250.0f;
+    config->deadzoneDeg = 15.0f;
+    config->deadzoneMeters = 0.1f;
+    config->epsilon = 0.0005f;
+    config->isUpright = true;
+}
+
+bool followConfigIsValid(const FOLLOW_CONFIG *config)
+{
+    // written so that nan fails too
+    return config->dampingMs >= 0.0f && config->dampingMs <= 10000.0f &&
+           config->deadzoneDeg >= 0.0f && config->deadzoneDeg <= 180.0f &&
+           config->deadzoneMeters >= 0.0f && config->deadzoneMeters <= 10.0f &&
+           config->epsilon >= 0.0f && config->epsilon <= 1.0f;
+}
+
+void followInit(FOLLOW *follow, const FOLLOW_CONFIG *config)
+{
+    auto submitCount = follow->submitCount;
+
+    memset(follow, 0, sizeof(FOLLOW));
+    follow->config = *config;
+    follow->rotation[3] = 1.0f;
+    follow->submitCount = submitCount;
+}
+
+void followRetarget(FOLLOW *follow)
+{
+    follow->isMoving = true;
+    follow->hasSubmitted = false;
+}
+
+bool followUpdate(
+    FOLLOW *follow,
+    const float *hmd,
+    const float *offset,
+    uint64_t nowNs,
+    float *transform)
+{
+    auto config = &follow->config;
+
+    float head[12];
+    if (config->isUpright == false)
+    {
+        memcpy(head, hmd, sizeof(head));
+    }
+    else if (followUpright(head, hmd) == false)
+    {
+        return false;
+    }
+
+    float target[12];
+    followMultiply(target, head, offset);
+
+    float targetRotation[4];
+    followQuatFromMatrix(targetRotation, target);
+    const float targetPosition[3] = {target[3], target[7], target[11]};
+
+    if (follow->hasPose == false)
+    {
+        memcpy(follow->rotation, targetRotation, sizeof(targetRotation));
+        memcpy(follow->position, targetPosition, sizeof(targetPosition));
+        follow->anchor[0] = hmd[3];
+        follow->anchor[1] = hmd[7];
+        follow->anchor[2] = hmd[11];
+        follow->hasPose = true;
+        follow->lastNs = nowNs;
+    }
+
+    auto stepNs = nowNs - follow->lastNs;
+    follow->lastNs = nowNs;
+    if (stepNs > FOLLOW_MAX_STEP_NS)
+    {
+        stepNs = FOLLOW_MAX_STEP_NS;
+    }
+
+    auto dx = targetPosition[0] - follow->position[0];
+    auto dy = targetPosition[1] - follow->position[1];
+    auto dz = targetPosition[2] - follow->position[2];
+    auto distance = sqrtf(dx * dx + dy * dy + dz * dz);
+    auto angle = followQuatAngle(follow->rotation, targetRotation);
+
+    // travel is the head's, turning the head swings the overlay a lot further
+    auto ax = hmd[3] - follow->anchor[0];
+    auto ay = hmd[7] - follow->anchor[1];
+    auto az = hmd[11] - follow->anchor[2];
+    auto travel = sqrtf(ax * ax + ay * ay + az * az);
+
+    if (follow->isMoving == false &&
+        (travel > config->deadzoneMeters ||
+         angle > config->deadzoneDeg * (FOLLOW_PI / 180.0f)))
+    {
+        follow->isMoving = true;
+    }
+
+    if (follow->isMoving != false)
+    {
+        auto t = config->dampingMs <= 0.0f
+                     ? 1.0f
+                     : 1.0f - expf(-(float)stepNs / (config->dampingMs * 1000000.0f));
+
+        follow->position[0] += dx * t;
+        follow->position[1] += dy * t;
+        follow->position[2] += dz * t;
+        followQuatBlend(follow->rotation, targetRotation, t);
+
+        // all the way back in front, rest until the deadzone is left again
+        if (distance * (1.0f - t) < FOLLOW_SETTLE_METERS &&
+            angle * (1.0f - t) < FOLLOW_SETTLE_RAD)
+        {
+            memcpy(follow->rotation, targetRotation, sizeof(targetRotation));
+            memcpy(follow->position, targetPosition, sizeof(targetPosition));
+            follow->anchor[0] = hmd[3];
+            follow->anchor[1] = hmd[7];
+            follow->anchor[2] = hmd[11];
+            follow->isMoving = false;
+        }
+    }
+
+    followMatrixFromPose(transform, follow->rotation, follow->position);
+
+    if (follow->hasSubmitted != false)
+    {
+        auto change = 0.0f;
+        for (uint32_t i = 0; i < 12; ++i)
+        {
+            auto delta = fabsf(transform[i] - follow->submitted[i]);
+            change = delta > change ? delta : change;
+        }
+
+        if (change <= config->epsilon)
+        {
+            return false;
+        }
+    }
+
+    memcpy(follow->submitted, transform, sizeof(follow->submitted));
+    follow->hasSubmitted = true;
+    ++follow->submitCount;
+    return true;
+}
+
+void followMultiply(float *out, const float *a, const float *b)
+{
+    for (uint32_t row = 0; row < 3; ++row)
+    {
+        auto r = a + row * 4;
+        for (uint32_t column = 0; column < 4; ++column)
+        {
+            out[row * 4 + column] =
+                r[0] * b[column] +
+                r[1] * b[4 + column] +
+                r[2] * b[8 + column] +
+                (column == 3 ? r[3] : 0.0f);
+        }
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stdint.h>
+
+// places a head-relative overlay in the room so that it trails the head
+// instead of being bolted to it: small head movements inside the deadzone
+// leave it where it is, anything beyond makes it glide back in front with
+// an exponential ease of dampingMs. plain float math on row-major 3x4
+// matrices (HmdMatrix34_t layout), no platform dependencies. overlay
+// thread only.
+
+typedef struct _FOLLOW_CONFIG
+{
+    float dampingMs;      // time constant of the ease, 0 snaps
+    float deadzoneDeg;    // head turn tolerated before following
+    float deadzoneMeters; // head travel tolerated before following
+    float epsilon;        // smallest matrix change worth submitting
+    bool isUpright;       // follow yaw only, the overlay never rolls or pitches
+} FOLLOW_CONFIG;
+
+typedef struct _FOLLOW
+{
+    FOLLOW_CONFIG config;
+    float position[3]; // where the overlay is, absolute
+    float rotation[4]; // quaternion x, y, z, w
+    float anchor[3];   // head position when the overlay last came to rest
+    bool hasPose;
+    bool isMoving;
+    uint64_t lastNs;
+    float submitted[12];
+    bool hasSubmitted;
+    uint64_t submitCount;
+} FOLLOW;
+
+void followDefaultConfig(FOLLOW_CONFIG *config);
+bool followConfigIsValid(const FOLLOW_CONFIG *config);
+// forgets the pose, the next update snaps to the target and submits
+void followInit(FOLLOW *follow, const FOLLOW_CONFIG *config);
+// the offset changed or the overlay was recreated: glide to the target and
+// submit even if it is already there
+void followRetarget(FOLLOW *follow);
+// hmd is the head's absolute pose, offset the overlay relative to the head.
+// returns true with the absolute transform to submit when it moved by more
+// than epsilon since the last submit
+bool followUpdate(
+    FOLLOW *follow,
+    const float *hmd,
+    const float *offset,
+    uint64_t nowNs,
+    float *transform);
+// a * b for affine 3x4 matrices
+void followMultiply(float *out, const float *a, const float *b);
@@ -0,0 +1,250 @@
+#include <string.h>
+#include "platform.h"
+#include "frame.h"
+#include "compositor.h"
+
+static_assert(
+    FRAME_WIDTH % FRAME_TILE_SIZE == 0 && FRAME_HEIGHT % FRAME_TILE_SIZE == 0,
+    "frame must be a whole number of tiles");
+static_assert(FRAME_TILES_Y <= 32, "dirtyRows has a bit per row of tiles");
+
+// data must be zeroed, which matches an empty tile grid
+void overlayDataInit(OVERLAY_DATA *overlayData, void *data)
+{
+    overlayData->dirty = false;
+    overlayData->damageCount = 0;
+    overlayData->dirtyRows = 0;
+    overlayData->data = data;
+    overlayData->convert = {};
+    memset(overlayData->tileFilled, 0, sizeof(overlayData->tileFilled));
+    overlayData->filledTiles = 0;
+    overlayData->isShared = false;
+    memset(overlayData->damage, 0, sizeof(overlayData->damage));
+    overlayData->compositor = NULL;
+}
+
+void frameMarkDirty(OVERLAY_DATA *overlayData)
+{
+    overlayData->damageCount.fetch_add(1, std::memory_order_relaxed);
+    overlayData->dirty.store(true, std::memory_order_release);
+}
+
+bool frameTakeDirty(OVERLAY_DATA *overlayData, uint32_t *dirtyRows)
+{
+    if (overlayData->dirty.exchange(false, std::memory_order_acquire) == false)
+    {
+        *dirtyRows = 0;
+        return false;
+    }
+
+    // rows marked after the flag was taken come again with the next one
+    *dirtyRows = overlayData->dirtyRows.exchange(0, std::memory_order_relaxed);
+    return true;
+}
+
+bool frameTakeDamage(
+    OVERLAY_DATA *overlayData,
+    uint32_t *x,
+    uint32_t *y,
+    uint32_t *width,
+    uint32_t *height)
+{
+    auto damage = overlayData->damage;
+    if (damage[2] == 0)
+    {
+        return false;
+    }
+
+    *x = damage[0];
+    *y = damage[1];
+    *width = damage[2] - damage[0];
+    *height = damage[3] - damage[1];
+    memset(damage, 0, sizeof(overlayData->damage));
+    return true;
+}
+
+bool frameIsEmpty(const OVERLAY_DATA *overlayData)
+{
+    return overlayData->filledTiles.load(std::memory_order_relaxed) == 0 &&
+           overlayData->isShared.load(std::memory_order_relaxed) == false;
+}
+
+bool frameIsValidRect(
+    uint32_t x,
+    uint32_t y,
+    uint32_t width,
+    uint32_t height)
+{
+    return x < FRAME_WIDTH && y < FRAME_HEIGHT &&
+           width != 0 && width <= FRAME_WIDTH &&
+           height != 0 && height <= FRAME_HEIGHT &&
+           x + width <= FRAME_WIDTH && y + height <= FRAME_HEIGHT;
+}
+
+NOINLINE void copyFrameBuffer(
+    uint8_t *target,
+    const uint8_t *source,
+    uint32_t x,
+    uint32_t y,
+    uint32_t width,
+    uint32_t height)
+{
+    // printf("copyFrameBuffer: origin=(%u,%u) size=(%u,%u)\n", x, y, width, height);
+    // copyFrameBuffer: origin=(0,0) size=(512,512)
+    // copyFrameBuffer: origin=(0,106) size=(512,406)
+
+    source += (y * FRAME_WIDTH + x) * 4;
+    target += (y * FRAME_WIDTH + x) * 4;
+
+    if (x == 0 && width == FRAME_WIDTH)
+    {
+        memcpy(target, source, height * FRAME_STRIDE);
+    }
+    else
+    {
+        uint32_t xs = width * 4;
+        for (uint32_t ys = height; ys != 0; --ys)
+        {
+            memcpy(target, source, xs);
+            source += FRAME_STRIDE;
+            target += FRAME_STRIDE;
+        }
+    }
+}
+
+NOINLINE void convertFrameBuffer(
+    uint8_t *target,
+    const uint8_t *source,
+    uint32_t x,
+    uint32_t y,
+    uint32_t width,
+    uint32_t height,
+    const PIXEL_CONVERT *convert)
+{
+    if (convert->ops == 0)
+    {
+        copyFrameBuffer(target, source, x, y, width, height);
+        return;
+    }
+
+    source += (y * FRAME_WIDTH + x) * 4;
+    target += (y * FRAME_WIDTH + x) * 4;
+
+    if (x == 0 && width == FRAME_WIDTH)
+    {
+        pixelConvertRow(target, source, height * FRAME_WIDTH, convert);
+    }
+    else
+    {
+        for (uint32_t ys = height; ys != 0; --ys)
+        {
+            pixelConvertRow(target, source, width, convert);
+            source += FRAME_STRIDE;
+            target += FRAME_STRIDE;
+        }
+    }
+}
+
+// rescans every tile the rect touches. a tile is only partly covered by the
+// rect at the edges, so the whole tile is scanned, never the rect alone.
+NOINLINE void frameUpdateTiles(
+    OVERLAY_DATA *overlayData,
+    uint32_t x,
+    uint32_t y,
+    uint32_t width,
+    uint32_t height)
+{
+    auto data = (const uint8_t *)overlayData->data;
+    auto filledTiles = overlayData->filledTiles.load(std::memory_order_relaxed);
+
+    auto tx0 = x / FRAME_TILE_SIZE;
+    auto tx1 = (x + width - 1) / FRAME_TILE_SIZE;
+    auto ty0 = y / FRAME_TILE_SIZE;
+    auto ty1 = (y + height - 1) / FRAME_TILE_SIZE;
+
+    for (auto ty = ty0; ty <= ty1; ++ty)
+    {
+        for (auto tx = tx0; tx <= tx1; ++tx)
+        {
+            auto tile = &overlayData->tileFilled[ty * FRAME_TILES_X + tx];
+            auto isFilled = pixelHasAlpha(
+                data + (ty * FRAME_TILE_SIZE * FRAME_WIDTH + tx * FRAME_TILE_SIZE) * 4,
+                FRAME_STRIDE,
+                FRAME_TILE_SIZE,
+                FRAME_TILE_SIZE);
+
+            if (isFilled != (*tile != 0))
+            {
+                *tile = isFilled != false ? 1 : 0;
+                filledTiles += isFilled != false ? 1 : -1;
+            }
+        }
+    }
+
+    overlayData->filledTiles.store(filledTiles, std::memory_order_relaxed);
+
+    // every write to data ends up here, so this is where its damage grows
+    auto damage = overlayData->damage;
+    if (damage[2] == 0)
+    {
+        damage[0] = x;
+        damage[1] = y;
+        damage[2] = x + width;
+        damage[3] = y + height;
+    }
+    else
+    {
+        damage[0] = x < damage[0] ? x : damage[0];
+        damage[1] = y < damage[1] ? y : damage[1];
+        damage[2] = x + width > damage[2] ? x + width : damage[2];
+        damage[3] = y + height > damage[3] ? y + height : damage[3];
+    }
+
+    overlayData->dirtyRows.fetch_or(
+        (uint32_t)(((1ull << (ty1 + 1)) - 1) & ~((1ull << ty0) - 1)),
+        std::memory_order_relaxed);
+}
+
+void overlayDataWrite(
+    OVERLAY_DATA *overlayData,
+    const uint8_t *source,
+    uint32_t x,
+    uint32_t y,
+    uint32_t width,
+    uint32_t height)
+{
+    // the cpu frame missed every shared frame, so the first paint after
+    // them goes in whole whatever its dirty rect
+    if (overlayData->isShared.exchange(false, std::memory_order_relaxed) != false)
+    {
+        x = 0;
+        y = 0;
+        width = FRAME_WIDTH;
+        height = FRAME_HEIGHT;
+    }
+
+    if (overlayData->compositor != NULL)
+    {
+        convertFrameBuffer(
+            compositorPage(overlayData),
+            source,
+            x,
+            y,
+            width,
+            height,
+            &overlayData->convert);
+        compositorDamage(overlayData, x, y, width, height);
+        return;
+    }
+
+    convertFrameBuffer(
+        (uint8_t *)overlayData->data,
+        source,
+        x,
+        y,
+        width,
+        height,
+        &overlayData->convert);
+    frameUpdateTiles(overlayData, x, y, width, height);
+    frameMarkDirty(overlayData);
+}
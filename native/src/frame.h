@@ -0,0 +1,86 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include "pixel.h"
+
+#define FRAME_WIDTH 512
+#define FRAME_HEIGHT 512
+#define FRAME_STRIDE (FRAME_WIDTH * 4)
+#define FRAME_SIZE (FRAME_STRIDE * FRAME_HEIGHT)
+
+// coverage is tracked on a coarse grid so a paint only rescans the tiles
+// it touched
+#define FRAME_TILE_SIZE 32
+#define FRAME_TILES_X (FRAME_WIDTH / FRAME_TILE_SIZE)
+#define FRAME_TILES_Y (FRAME_HEIGHT / FRAME_TILE_SIZE)
+#define FRAME_TILE_COUNT (FRAME_TILES_X * FRAME_TILES_Y)
+
+struct _COMPOSITOR;
+
+typedef struct _OVERLAY_DATA
+{
+    std::atomic<bool> dirty;
+    std::atomic<uint32_t> damageCount; // bumped with dirty, read by the governor
+    std::atomic<uint32_t> dirtyRows;   // bit per row of tiles written since the upload
+    void *data;
+    PIXEL_CONVERT convert; // applied on the way in, written from the js thread
+    uint8_t tileFilled[FRAME_TILE_COUNT]; // any non-zero alpha in the tile
+    std::atomic<uint32_t> filledTiles;    // 0 = frame is fully transparent
+    std::atomic<bool> isShared;           // last frame came as a gpu texture, tiles unknown
+    uint32_t damage[4];                   // x0, y0, x1, y1 written since frameTakeDamage, js thread only
+    struct _COMPOSITOR *compositor;       // NULL until a sprite is added
+} OVERLAY_DATA;
+
+void overlayDataInit(OVERLAY_DATA *overlayData, void *data);
+// new content for the next upload
+void frameMarkDirty(OVERLAY_DATA *overlayData);
+// takes the dirty flag and the rows to upload with it. a frame marked dirty
+// without any rows (shown again, say) returns true and 0
+bool frameTakeDirty(OVERLAY_DATA *overlayData, uint32_t *dirtyRows);
+// the rect of data written since the last call, for whatever is drawn from
+// this frame. false when nothing was
+bool frameTakeDamage(
+    OVERLAY_DATA *overlayData,
+    uint32_t *x,
+    uint32_t *y,
+    uint32_t *width,
+    uint32_t *height);
+// fully transparent as far as the cpu can tell, a shared frame never is
+bool frameIsEmpty(const OVERLAY_DATA *overlayData);
+bool frameIsValidRect(
+    uint32_t x,
+    uint32_t y,
+    uint32_t width,
+    uint32_t height);
+void copyFrameBuffer(
+    uint8_t *target,
+    const uint8_t *source,
+    uint32_t x,
+    uint32_t y,
+    uint32_t width,
+    uint32_t height);
+// copyFrameBuffer with a pixel conversion fused into the same pass
+void convertFrameBuffer(
+    uint8_t *target,
+    const uint8_t *source,
+    uint32_t x,
+    uint32_t y,
+    uint32_t width,
+    uint32_t height,
+    const PIXEL_CONVERT *convert);
+void frameUpdateTiles(
+    OVERLAY_DATA *overlayData,
+    uint32_t x,
+    uint32_t y,
+    uint32_t width,
+    uint32_t height);
+// source is a whole frame of which the rect changed. ends a run of shared
+// frames, and then takes all of source
+void overlayDataWrite(
+    OVERLAY_DATA *overlayData,
+    const uint8_t *source,
+    uint32_t x,
+    uint32_t y,
+    uint32_t width,
+    uint32_t height);
@@ -0,0 +1,173 @@
+#include <string.h>
+#include "governor.h"
+
+static void governorApplyMode(GOVERNOR *governor, GOVERNOR_MODE mode)
+{
+    auto config = &governor->config;
+
+    governor->mode = mode;
+
+    switch (mode)
+    {
+    case GOVERNOR_MODE_ACTIVE:
+        governor->ingestFps = config->maxFps;
+        break;
+    case GOVERNOR_MODE_LOW:
+        governor->ingestFps = config->lowFps;
+        break;
+    default:
+        governor->ingestFps = config->idleFps;
+        break;
+    }
+
+    governor->uploadFps = governor->ingestFps < config->maxUploadFps
+                              ? governor->ingestFps
+                              : config->maxUploadFps;
+}
+
+void governorDefaultConfig(GOVERNOR_CONFIG *config)
+{
+    config->maxFps = 30;
+    config->lowFps = 10;
+    config->idleFps = 1;
+    config->maxUploadFps = 20;
+    config->activeRate = 4;
+    config->holdMs = 2000;
+}
+
+bool governorConfigIsValid(const GOVERNOR_CONFIG *config)
+{
+    return config->idleFps >= 1 &&
+           config->idleFps <= config->lowFps &&
+           config->lowFps <= config->maxFps &&
+           config->maxFps <= 240 &&
+           config->maxUploadFps >= 1 && config->maxUploadFps <= 240 &&
+           config->activeRate >= 1 &&
+           config->holdMs >= 100 && config->holdMs <= 60000;
+}
+
+void governorInit(
+    GOVERNOR *governor,
+    const GOVERNOR_CONFIG *config,
+    uint64_t nowNs,
+    uint32_t damageCount)
+{
+    memset(governor, 0, sizeof(GOVERNOR));
+    governor->config = *config;
+    governor->damageCount = damageCount;
+    governor->bucketNs = nowNs;
+    governor->lastDamageNs = nowNs;
+    governor->lastActiveNs = nowNs;
+    governor->isWorn = true;
+    governorApplyMode(governor, GOVERNOR_MODE_ACTIVE);
+}
+
+bool governorUpdate(
+    GOVERNOR *governor,
+    uint64_t nowNs,
+    uint32_t damageCount,
+    bool isTransparent,
+    bool isWorn)
+{
+    if (nowNs - governor->bucketNs >= GOVERNOR_BUCKETS * GOVERNOR_BUCKET_NS)
+    {
+        memset(governor->buckets, 0, sizeof(governor->buckets));
+        governor->bucketNs = nowNs;
+    }
+
+    while (nowNs - governor->bucketNs >= GOVERNOR_BUCKET_NS)
+    {
+        governor->bucket = (governor->bucket + 1) % GOVERNOR_BUCKETS;
+        governor->buckets[governor->bucket] = 0;
+        governor->bucketNs += GOVERNOR_BUCKET_NS;
+    }
+
+    // wraps along with the counter
+    auto damages = damageCount - governor->damageCount;
+    governor->damageCount = damageCount;
+    governor->buckets[governor->bucket] += damages;
+
+    if (damages != 0)
+    {
+        governor->lastDamageNs = nowNs;
+    }
+
+    if (governorDamageRate(governor) >= governor->config.activeRate)
+    {
+        governor->lastActiveNs = nowNs;
+    }
+
+    // put back on: assume the user wants to see it move right away
+    if (isWorn != false && governor->isWorn == false)
+    {
+        governor->lastActiveNs = nowNs;
+    }
+    governor->isWorn = isWorn;
+
+    auto holdNs = governor->config.holdMs * 1000000ull;
+    GOVERNOR_MODE mode;
+
+    if (isWorn == false)
+    {
+        mode = GOVERNOR_MODE_ASLEEP;
+    }
+    else if (nowNs - governor->lastActiveNs < holdNs)
+    {
+        mode = GOVERNOR_MODE_ACTIVE;
+    }
+    else if (nowNs - governor->lastDamageNs < holdNs)
+    {
+        mode = GOVERNOR_MODE_LOW;
+    }
+    else if (isTransparent != false)
+    {
+        mode = GOVERNOR_MODE_HIDDEN;
+    }
+    else
+    {
+        mode = GOVERNOR_MODE_IDLE;
+    }
+
+    if (mode == governor->mode)
+    {
+        return false;
+    }
+
+    governorApplyMode(governor, mode);
+    ++governor->modeChanges;
+    return true;
+}
+
+uint32_t governorDamageRate(const GOVERNOR *governor)
+{
+    uint32_t rate = 0;
+    for (auto count : governor->buckets)
+    {
+        rate += count;
+    }
+    return rate;
+}
+
+uint64_t governorUploadIntervalNs(const GOVERNOR *governor)
+{
+    return 1000000000ull / governor->uploadFps;
+}
+
+const char *governorModeName(GOVERNOR_MODE mode)
+{
+    switch (mode)
+    {
+    case GOVERNOR_MODE_ACTIVE:
+        return "active";
+    case GOVERNOR_MODE_LOW:
+        return "low";
+    case GOVERNOR_MODE_IDLE:
+        return "idle";
+    case GOVERNOR_MODE_HIDDEN:
+        return "hidden";
+    case GOVERNOR_MODE_ASLEEP:
+        return "asleep";
+    default:
+        return "unknown";
+    }
+}
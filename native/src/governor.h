@@ -0,0 +1,71 @@
+#pragma once
+
+#include <stdint.h>
+
+// picks how often an overlay's page should be rendered (ingest, applied by
+// js to the offscreen renderer) and uploaded (applied by the overlay
+// thread) from how often its content actually changes, whether there is
+// anything to see and whether the hmd is on someone's head. rates go up as
+// soon as activity shows and come down only after it has been gone for
+// holdMs. overlay thread only.
+
+#define GOVERNOR_BUCKETS 10 // damage history, one bucket per 100ms
+#define GOVERNOR_BUCKET_NS 100000000ull
+
+typedef enum _GOVERNOR_MODE
+{
+    GOVERNOR_MODE_ACTIVE = 0, // animating, full rate
+    GOVERNOR_MODE_LOW,        // occasional changes, e.g. a ticking clock
+    GOVERNOR_MODE_IDLE,       // nothing changed for holdMs
+    GOVERNOR_MODE_HIDDEN,     // idle and fully transparent
+    GOVERNOR_MODE_ASLEEP,     // the hmd isn't worn
+    GOVERNOR_MODE_COUNT
+} GOVERNOR_MODE;
+
+typedef struct _GOVERNOR_CONFIG
+{
+    uint32_t maxFps;       // ingest when active
+    uint32_t lowFps;       // ingest when low
+    uint32_t idleFps;      // ingest when idle, hidden or asleep
+    uint32_t maxUploadFps; // what the overlay thread can upload at most
+    uint32_t activeRate;   // damages per second that count as animating
+    uint32_t holdMs;
+} GOVERNOR_CONFIG;
+
+typedef struct _GOVERNOR
+{
+    GOVERNOR_CONFIG config;
+    uint32_t damageCount; // last seen OVERLAY_DATA::damageCount
+    uint32_t buckets[GOVERNOR_BUCKETS];
+    uint64_t bucketNs; // start of the current bucket
+    uint32_t bucket;
+    uint64_t lastDamageNs;
+    uint64_t lastActiveNs;
+    bool isWorn;
+    GOVERNOR_MODE mode;
+    uint32_t ingestFps;
+    uint32_t uploadFps;
+    uint64_t modeChanges;
+} GOVERNOR;
+
+void governorDefaultConfig(GOVERNOR_CONFIG *config);
+bool governorConfigIsValid(const GOVERNOR_CONFIG *config);
+// starts active, so a fresh overlay renders at full rate until it settles
+void governorInit(
+    GOVERNOR *governor,
+    const GOVERNOR_CONFIG *config,
+    uint64_t nowNs,
+    uint32_t damageCount);
+// call every poll; returns true when the mode, and with it the rates,
+// changed
+bool governorUpdate(
+    GOVERNOR *governor,
+    uint64_t nowNs,
+    uint32_t damageCount,
+    bool isTransparent,
+    bool isWorn);
+// damages over the last second
+uint32_t governorDamageRate(const GOVERNOR *governor);
+// ns between uploads at the current rate
+uint64_t governorUploadIntervalNs(const GOVERNOR *governor);
+const char *governorModeName(GOVERNOR_MODE mode);
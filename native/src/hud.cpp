@@ -0,0 +1,300 @@
+#include <string.h>
+#include "hud.h"
+
+// 16x16 masks drawn at twice the size
+static const char *hudIconHmd_[16] = {
+    "................",
+    "................",
+    "................",
+    "...##########...",
+    ".##############.",
+    "################",
+    "###...####...###",
+    "##.....##.....##",
+    "##.....##.....##",
+    "###...####...###",
+    "################",
+    ".######..######.",
+    "..####....####..",
+    "................",
+    "................",
+    "................",
+};
+
+static const char *hudIconController_[16] = {
+    ".....######.....",
+    "....##....##....",
+    "...##......##...",
+    "...##......##...",
+    "...##......##...",
+    "....##....##....",
+    ".....######.....",
+    "......####......",
+    "......####......",
+    "......####......",
+    "......####......",
+    "......####......",
+    "......####......",
+    "......####......",
+    ".......##.......",
+    "................",
+};
+
+static const char *hudIconTracker_[16] = {
+    "................",
+    "................",
+    ".....######.....",
+    "...##########...",
+    "..############..",
+    ".######..######.",
+    ".#####....#####.",
+    ".#####....#####.",
+    ".######..######.",
+    "..############..",
+    "...##########...",
+    ".....######.....",
+    "....##....##....",
+    "...##......##...",
+    "................",
+    "................",
+};
+
+// 6x10, drawn at twice the size
+static const char *hudIconBolt_[10] = {
+    "...###",
+    "..###.",
+    ".###..",
+    "###...",
+    "######",
+    "...###",
+    "..###.",
+    ".###..",
+    ".##...",
+    "##....",
+};
+
+// straight rgba
+static const uint8_t hudColorIcon_[4] = {255, 255, 255, 230};
+static const uint8_t hudColorIconOff_[4] = {255, 255, 255, 80};
+static const uint8_t hudColorFrame_[4] = {255, 255, 255, 200};
+static const uint8_t hudColorLow_[4] = {244, 67, 54, 255};
+static const uint8_t hudColorMid_[4] = {255, 193, 7, 255};
+static const uint8_t hudColorHigh_[4] = {76, 175, 80, 255};
+static const uint8_t hudColorBolt_[4] = {255, 214, 0, 255};
+
+static void hudPremultiply(uint8_t *bgra, const uint8_t *rgba)
+{
+    bgra[0] = (uint8_t)((rgba[2] * rgba[3] + 127) / 255);
+    bgra[1] = (uint8_t)((rgba[1] * rgba[3] + 127) / 255);
+    bgra[2] = (uint8_t)((rgba[0] * rgba[3] + 127) / 255);
+    bgra[3] = rgba[3];
+}
+
+static void hudFill(
+    uint8_t *pixels,
+    uint32_t x,
+    uint32_t y,
+    uint32_t width,
+    uint32_t height,
+    const uint8_t *rgba)
+{
+    uint8_t bgra[4];
+    hudPremultiply(bgra, rgba);
+
+    for (auto row = y; row < y + height; ++row)
+    {
+        auto p = pixels + (row * HUD_WIDTH + x) * 4;
+        for (uint32_t i = 0; i < width; ++i)
+        {
+            memcpy(p + i * 4, bgra, 4);
+        }
+    }
+}
+
+static void hudMask(
+    uint8_t *pixels,
+    uint32_t x,
+    uint32_t y,
+    const char *const *mask,
+    uint32_t rows,
+    uint32_t scale,
+    const uint8_t *rgba)
+{
+    for (uint32_t row = 0; row < rows; ++row)
+    {
+        auto line = mask[row];
+        for (uint32_t column = 0; line[column] != '\0'; ++column)
+        {
+            if (line[column] == '#')
+            {
+                hudFill(pixels, x + column * scale, y + row * scale, scale, scale, rgba);
+            }
+        }
+    }
+}
+
+static void hudDrawCell(uint8_t *pixels, uint32_t index, const HUD_CELL *cell)
+{
+    auto x = index * HUD_CELL_WIDTH;
+
+    for (uint32_t row = 0; row < HUD_CELL_HEIGHT; ++row)
+    {
+        memset(pixels + (row * HUD_WIDTH + x) * 4, 0, HUD_CELL_WIDTH * 4);
+    }
+
+    const char *const *icon;
+    switch (cell->kind)
+    {
+    case HUD_KIND_HMD:
+        icon = hudIconHmd_;
+        break;
+    case HUD_KIND_CONTROLLER:
+        icon = hudIconController_;
+        break;
+    case HUD_KIND_TRACKER:
+        icon = hudIconTracker_;
+        break;
+    default:
+        return;
+    }
+
+    if (cell->isConnected == false)
+    {
+        hudMask(pixels, x + 4, 4, icon, 16, 2, hudColorIconOff_);
+        return;
+    }
+
+    hudMask(pixels, x + 4, 4, icon, 16, 2, hudColorIcon_);
+
+    if (cell->isCharging != false)
+    {
+        hudMask(pixels, x + 40, 10, hudIconBolt_, 10, 2, hudColorBolt_);
+    }
+
+    // 44x12 battery outline with its terminal, the fill inside
+    hudFill(pixels, x + 4, 42, 44, 2, hudColorFrame_);
+    hudFill(pixels, x + 4, 52, 44, 2, hudColorFrame_);
+    hudFill(pixels, x + 4, 44, 2, 8, hudColorFrame_);
+    hudFill(pixels, x + 46, 44, 2, 8, hudColorFrame_);
+    hudFill(pixels, x + 48, 45, 3, 6, hudColorFrame_);
+
+    auto fill = cell->level <= 2   ? hudColorLow_
+                : cell->level <= 4 ? hudColorMid_
+                                   : hudColorHigh_;
+    auto width = 38 * cell->level / HUD_BATTERY_LEVELS;
+    if (width > 0)
+    {
+        hudFill(pixels, x + 7, 45, width, 6, fill);
+    }
+}
+
+static void hudAddCells(
+    HUD_STATE *state,
+    const VR_DEVICE_DATA *data,
+    uint32_t count,
+    vr::ETrackedDeviceClass deviceClass,
+    HUD_KIND kind)
+{
+    for (uint32_t i = 0; i < count && state->count < HUD_MAX_CELLS; ++i)
+    {
+        auto deviceData = &data[i];
+        if (deviceData->deviceClass != deviceClass)
+        {
+            continue;
+        }
+
+        // a wired hmd reports neither
+        if (kind == HUD_KIND_HMD &&
+            deviceData->batteryPercentage <= 0.0f &&
+            deviceData->isCharging == false)
+        {
+            continue;
+        }
+
+        auto percent = deviceData->batteryPercentage * 100.0f + 0.5f;
+        auto level = percent <= 0.0f    ? 0u
+                     : percent >= 100.0f ? (uint32_t)HUD_BATTERY_LEVELS
+                                         : ((uint32_t)percent + 9) / 10;
+
+        auto cell = &state->cells[state->count++];
+        cell->kind = (uint8_t)kind;
+        cell->level = (uint8_t)level;
+        cell->isConnected = deviceData->isConnected;
+        cell->isCharging = deviceData->isCharging;
+    }
+}
+
+void hudStateFromDevices(HUD_STATE *state, const VR_DEVICE_DATA *data, uint32_t count)
+{
+    memset(state, 0, sizeof(HUD_STATE));
+
+    hudAddCells(state, data, count, vr::TrackedDeviceClass_HMD, HUD_KIND_HMD);
+    hudAddCells(state, data, count, vr::TrackedDeviceClass_Controller, HUD_KIND_CONTROLLER);
+    hudAddCells(state, data, count, vr::TrackedDeviceClass_GenericTracker, HUD_KIND_TRACKER);
+}
+
+bool hudStateEquals(const HUD_STATE *a, const HUD_STATE *b)
+{
+    return memcmp(a, b, sizeof(HUD_STATE)) == 0;
+}
+
+bool hudCreate(
+    OVERLAY_DATA *overlayData,
+    HUD *hud,
+    const HUD_STATE *state,
+    const SPRITE_PROPS *props)
+{
+    auto spriteId = compositorCreateSprite(overlayData, NULL, HUD_WIDTH, HUD_HEIGHT, props);
+    if (spriteId == 0)
+    {
+        return false;
+    }
+
+    memset(hud, 0, sizeof(HUD));
+    hud->spriteId = spriteId;
+    hudUpdate(overlayData, hud, state);
+    return true;
+}
+
+uint32_t hudUpdate(OVERLAY_DATA *overlayData, HUD *hud, const HUD_STATE *state)
+{
+    auto pixels = compositorSpritePixels(overlayData, hud->spriteId);
+    if (pixels == NULL)
+    {
+        return 0;
+    }
+
+    ++hud->updateCount;
+
+    uint32_t redrawn = 0;
+
+    for (uint32_t i = 0; i < HUD_MAX_CELLS; ++i)
+    {
+        if (memcmp(&hud->drawn.cells[i], &state->cells[i], sizeof(HUD_CELL)) == 0)
+        {
+            continue;
+        }
+
+        hudDrawCell(pixels, i, &state->cells[i]);
+        compositorDamageSprite(
+            overlayData,
+            hud->spriteId,
+            i * HUD_CELL_WIDTH,
+            0,
+            HUD_CELL_WIDTH,
+            HUD_CELL_HEIGHT);
+        ++redrawn;
+    }
+
+    hud->drawn = *state;
+    hud->redrawCount += redrawn;
+
+    return redrawn;
+}
+
+bool hudDestroy(OVERLAY_DATA *overlayData, HUD *hud)
+{
+    auto isDestroyed = compositorDestroySprite(overlayData, hud->spriteId);
+    memset(hud, 0, sizeof(HUD));
+    return isDestroyed;
+}
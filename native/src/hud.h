@@ -0,0 +1,62 @@
+#pragma once
+
+#include <stdint.h>
+#include "compositor.h"
+#include "device.h"
+#include "frame.h"
+
+// battery hud drawn natively into a compositor sprite: one cell per
+// controller/tracker with its icon, a battery bar and a charging bolt.
+// the device table is first reduced to a HUD_STATE holding only what the
+// cells show, so a redraw happens only when a value crosses a step of the
+// bar, and then only for the cells that changed.
+
+#define HUD_MAX_CELLS 8
+#define HUD_BATTERY_LEVELS 10 // bar steps, 10% each
+#define HUD_CELL_WIDTH 56
+#define HUD_CELL_HEIGHT 56
+#define HUD_WIDTH (HUD_CELL_WIDTH * HUD_MAX_CELLS)
+#define HUD_HEIGHT HUD_CELL_HEIGHT
+
+typedef enum _HUD_KIND
+{
+    HUD_KIND_NONE = 0, // empty cell
+    HUD_KIND_HMD,      // only when it reports a battery
+    HUD_KIND_CONTROLLER,
+    HUD_KIND_TRACKER
+} HUD_KIND;
+
+typedef struct _HUD_CELL
+{
+    uint8_t kind;
+    uint8_t level; // 0..HUD_BATTERY_LEVELS, rounded up
+    bool isConnected;
+    bool isCharging;
+} HUD_CELL;
+
+typedef struct _HUD_STATE
+{
+    uint32_t count;
+    HUD_CELL cells[HUD_MAX_CELLS];
+} HUD_STATE;
+
+typedef struct _HUD
+{
+    uint32_t spriteId; // 0 = off
+    HUD_STATE drawn;
+    uint64_t updateCount; // hudUpdate calls
+    uint64_t redrawCount; // cells drawn by them
+} HUD;
+
+// cheap enough for the overlay thread, fully zeroed so states compare with
+// memcmp. hmd first, then controllers, then trackers, each in table order
+void hudStateFromDevices(HUD_STATE *state, const VR_DEVICE_DATA *data, uint32_t count);
+bool hudStateEquals(const HUD_STATE *a, const HUD_STATE *b);
+bool hudCreate(
+    OVERLAY_DATA *overlayData,
+    HUD *hud,
+    const HUD_STATE *state,
+    const SPRITE_PROPS *props);
+// redraws the cells that differ from what's on screen, returns their count
+uint32_t hudUpdate(OVERLAY_DATA *overlayData, HUD *hud, const HUD_STATE *state);
+bool hudDestroy(OVERLAY_DATA *overlayData, HUD *hud);
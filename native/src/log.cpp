@@ -0,0 +1,261 @@
+#include <string.h>
+#include <atomic>
+#include "platform.h"
+#include "log.h"
+
+// bounded MPMC ring (Vyukov) used as MPSC: producers only touch an atomic
+// index and the cell they claimed, so writing from the overlay thread never
+// takes a lock or enters the kernel. the single consumer is the JS thread.
+
+#define LOG_QUEUE_SIZE 1024 // power of two
+#define LOG_REPEAT_SLOTS 64 // power of two
+#define LOG_REPEAT_WINDOW_NS 1000000000ull // 1s
+
+typedef struct _LOG_CELL
+{
+    std::atomic<uint32_t> sequence;
+    LOG_RECORD record;
+} LOG_CELL;
+
+typedef struct _LOG_REPEAT
+{
+    bool isUsed;
+    uint32_t suppressed;
+    uint64_t firstNs;
+    LOG_RECORD record;
+} LOG_REPEAT;
+
+static LOG_CELL cells_[LOG_QUEUE_SIZE];
+static std::atomic<uint32_t> enqueuePos_;
+static uint32_t dequeuePos_;
+static std::atomic<uint64_t> written_;
+static std::atomic<uint64_t> dropped_;
+static uint64_t suppressed_;
+static LOG_REPEAT repeats_[LOG_REPEAT_SLOTS];
+
+static const char *levelNames_[LOG_LEVEL_COUNT] = {
+    "debug",
+    "info",
+    "warn",
+    "error"};
+
+static const char *codeNames_[LOG_CODE_COUNT] = {
+    "OverlayInit",
+    "OverlayShutdown",
+    "D3D11CreateDevice",
+    "CreateTexture2D",
+    "VR_Init",
+    "VREvent",
+    "VREvent_Quit",
+    "FindOverlay",
+    "CreateOverlay",
+    "SetOverlayWidthInMeters",
+    "SetOverlayInputMethod",
+    "SetOverlayTransform",
+    "SetOverlayTexture",
+    "ShowOverlay",
+    "HideOverlay",
+    "SetOverlayAlpha",
+    "SetOverlayColor",
+    "SetOverlaySortOrder",
+    "OpenVRLoad",
+    "GLInit",
+    "CreateQuery",
+    "ImportShared",
+    "ProcmonWait"};
+
+void logInit(void)
+{
+    for (uint32_t i = 0; i < LOG_QUEUE_SIZE; ++i)
+    {
+        cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    enqueuePos_.store(0, std::memory_order_relaxed);
+    dequeuePos_ = 0;
+    memset(repeats_, 0, sizeof(repeats_));
+}
+
+bool logWrite(
+    LOG_LEVEL level,
+    LOG_CODE code,
+    int64_t arg0,
+    int64_t arg1,
+    int64_t arg2)
+{
+    LOG_CELL *cell;
+    auto pos = enqueuePos_.load(std::memory_order_relaxed);
+
+    for (;;)
+    {
+        cell = &cells_[pos & (LOG_QUEUE_SIZE - 1)];
+        auto sequence = cell->sequence.load(std::memory_order_acquire);
+        auto diff = (int32_t)(sequence - pos);
+
+        if (diff == 0)
+        {
+            if (enqueuePos_.compare_exchange_weak(
+                    pos,
+                    pos + 1,
+                    std::memory_order_relaxed) != false)
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            // full, the consumer is behind. never block the writer
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        else
+        {
+            pos = enqueuePos_.load(std::memory_order_relaxed);
+        }
+    }
+
+    auto record = &cell->record;
+    record->timeNs = platformNowNs();
+    record->level = (uint16_t)level;
+    record->code = (uint16_t)code;
+    record->count = 1;
+    record->args[0] = arg0;
+    record->args[1] = arg1;
+    record->args[2] = arg2;
+
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    written_.fetch_add(1, std::memory_order_relaxed);
+
+    return true;
+}
+
+static bool logPop(LOG_RECORD *record)
+{
+    auto cell = &cells_[dequeuePos_ & (LOG_QUEUE_SIZE - 1)];
+    auto sequence = cell->sequence.load(std::memory_order_acquire);
+
+    if ((int32_t)(sequence - (dequeuePos_ + 1)) < 0)
+    {
+        return false; // empty
+    }
+
+    *record = cell->record;
+    cell->sequence.store(dequeuePos_ + LOG_QUEUE_SIZE, std::memory_order_release);
+    ++dequeuePos_;
+
+    return true;
+}
+
+static uint32_t logRepeatSlot(const LOG_RECORD *record)
+{
+    // FNV-1a over the identifying fields
+    auto hash = 2166136261u;
+    auto mix = [&hash](uint64_t value)
+    {
+        for (int i = 0; i < 8; ++i)
+        {
+            hash = (hash ^ (uint8_t)(value >> (i * 8))) * 16777619u;
+        }
+    };
+
+    mix(((uint64_t)record->level << 16) | record->code);
+    for (int i = 0; i < LOG_MAX_ARGS; ++i)
+    {
+        mix((uint64_t)record->args[i]);
+    }
+
+    return hash & (LOG_REPEAT_SLOTS - 1);
+}
+
+static bool logIsRepeat(const LOG_RECORD *a, const LOG_RECORD *b)
+{
+    return a->level == b->level &&
+           a->code == b->code &&
+           memcmp(a->args, b->args, sizeof(a->args)) == 0;
+}
+
+static void logFlushRepeat(LOG_REPEAT *repeat, LOG_RECORD *record)
+{
+    *record = repeat->record;
+    record->count = repeat->suppressed;
+    repeat->suppressed = 0;
+}
+
+uint32_t logDrain(LOG_RECORD *records, uint32_t maxCount, uint64_t nowNs)
+{
+    uint32_t count = 0;
+    LOG_RECORD record;
+
+    // each popped record may also flush a pending summary, keep room for both
+    while (count + 2 <= maxCount && logPop(&record) != false)
+    {
+        auto repeat = &repeats_[logRepeatSlot(&record)];
+
+        if (repeat->isUsed != false &&
+            logIsRepeat(&repeat->record, &record) != false &&
+            record.timeNs - repeat->firstNs < LOG_REPEAT_WINDOW_NS)
+        {
+            repeat->record.timeNs = record.timeNs;
+            ++repeat->suppressed;
+            ++suppressed_;
+            continue;
+        }
+
+        if (repeat->isUsed != false && repeat->suppressed != 0)
+        {
+            logFlushRepeat(repeat, &records[count++]);
+        }
+
+        repeat->isUsed = true;
+        repeat->suppressed = 0;
+        repeat->firstNs = record.timeNs;
+        repeat->record = record;
+
+        records[count++] = record;
+    }
+
+    for (uint32_t i = 0; i < LOG_REPEAT_SLOTS && count < maxCount; ++i)
+    {
+        auto repeat = &repeats_[i];
+
+        if (repeat->isUsed != false &&
+            nowNs - repeat->firstNs >= LOG_REPEAT_WINDOW_NS)
+        {
+            if (repeat->suppressed != 0)
+            {
+                logFlushRepeat(repeat, &records[count++]);
+            }
+
+            repeat->isUsed = false;
+        }
+    }
+
+    return count;
+}
+
+void logGetStats(LOG_STATS *stats)
+{
+    stats->written = written_.load(std::memory_order_relaxed);
+    stats->dropped = dropped_.load(std::memory_order_relaxed);
+    stats->suppressed = suppressed_;
+}
+
+const char *logLevelName(uint32_t level)
+{
+    if (level >= LOG_LEVEL_COUNT)
+    {
+        return "unknown";
+    }
+
+    return levelNames_[level];
+}
+
+const char *logCodeName(uint32_t code)
+{
+    if (code >= LOG_CODE_COUNT)
+    {
+        return "unknown";
+    }
+
+    return codeNames_[code];
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <stdint.h>
+
+#define LOG_MAX_ARGS 3
+
+typedef enum _LOG_LEVEL
+{
+    LOG_LEVEL_DEBUG = 0,
+    LOG_LEVEL_INFO,
+    LOG_LEVEL_WARN,
+    LOG_LEVEL_ERROR,
+    LOG_LEVEL_COUNT
+} LOG_LEVEL;
+
+typedef enum _LOG_CODE
+{
+    LOG_CODE_OVERLAY_INIT = 0,
+    LOG_CODE_OVERLAY_SHUTDOWN,
+    LOG_CODE_D3D11_CREATE_DEVICE,
+    LOG_CODE_CREATE_TEXTURE_2D,
+    LOG_CODE_VR_INIT,
+    LOG_CODE_VR_EVENT,
+    LOG_CODE_VR_QUIT,
+    LOG_CODE_FIND_OVERLAY,
+    LOG_CODE_CREATE_OVERLAY,
+    LOG_CODE_SET_OVERLAY_WIDTH_IN_METERS,
+    LOG_CODE_SET_OVERLAY_INPUT_METHOD,
+    LOG_CODE_SET_OVERLAY_TRANSFORM,
+    LOG_CODE_SET_OVERLAY_TEXTURE,
+    LOG_CODE_SHOW_OVERLAY,
+    LOG_CODE_HIDE_OVERLAY,
+    LOG_CODE_SET_OVERLAY_ALPHA,
+    LOG_CODE_SET_OVERLAY_COLOR,
+    LOG_CODE_SET_OVERLAY_SORT_ORDER,
+    LOG_CODE_OPENVR_LOAD,
+    LOG_CODE_GL_INIT,
+    LOG_CODE_CREATE_QUERY,
+    LOG_CODE_IMPORT_SHARED,
+    LOG_CODE_PROCMON_WAIT,
+    LOG_CODE_COUNT
+} LOG_CODE;
+
+typedef struct _LOG_RECORD
+{
+    uint64_t timeNs;
+    uint16_t level;
+    uint16_t code;
+    uint32_t count; // > 1 for a summary of suppressed repeats
+    int64_t args[LOG_MAX_ARGS];
+} LOG_RECORD;
+
+typedef struct _LOG_STATS
+{
+    uint64_t written;
+    uint64_t dropped;
+    uint64_t suppressed;
+} LOG_STATS;
+
+void logInit(void);
+bool logWrite(
+    LOG_LEVEL level,
+    LOG_CODE code,
+    int64_t arg0 = 0,
+    int64_t arg1 = 0,
+    int64_t arg2 = 0);
+uint32_t logDrain(LOG_RECORD *records, uint32_t maxCount, uint64_t nowNs);
+void logGetStats(LOG_STATS *stats);
+const char *logLevelName(uint32_t level);
+const char *logCodeName(uint32_t code);
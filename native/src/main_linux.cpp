@@ -1,90 +1,222 @@
-#include <stdio.h>
-#include "napi.h"
-
-Napi::Value getRunningApp(const Napi::CallbackInfo &info)
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <spawn.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <openvr/openvr.h>
+#include "backend.h"
+#include "log.h"
+#include "procscan.h"
+#include "texture.h"
+
+std::mutex runningAppLock_;
+PROCSCAN runningAppScan_;
+bool hasRunningAppScan_;
+std::once_flag openvrOnce_;
+void *openvrLib_; // never unloaded, vrclient keeps pointers into it
+
+// patterns of runningAppScan_, vrchat runs under proton
+#define RUNNING_APP_VRCHAT 0
+#define RUNNING_APP_VRSERVER 1
+#define RUNNING_APP_VRCOMPOSITOR 2
+
+// the openvr entry points VR_Init and friends call, forwarded to a
+// libopenvr_api.so loaded on first use. there is no linux import library to
+// link against, and a missing runtime shouldn't keep the addon from loading
+struct
+{
+    uint32_t (*initInternal2)(vr::EVRInitError *, vr::EVRApplicationType, const char *);
+    void (*shutdownInternal)(void);
+    bool (*isInterfaceVersionValid)(const char *);
+    void *(*getGenericInterface)(const char *, vr::EVRInitError *);
+    uint32_t (*getInitToken)(void);
+} openvr_;
+
+void *openvrOpen(void)
 {
-    auto env = info.Env();
-    auto obj = Napi::Object::New(env);
-
-    obj.Set(
-        "vrchat",
-        Napi::Boolean::New(
-            env,
-            false));
-
-    obj.Set(
-        "steamvr",
-        Napi::Boolean::New(
-            env,
-            false));
-
-    return obj;
+    // VRCX_OPENVR_LIB, then the loader's search path, then next to the addon
+    auto path = getenv("VRCX_OPENVR_LIB");
+    if (path != NULL && *path != 0)
+    {
+        return dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    }
+
+    auto lib = dlopen("libopenvr_api.so", RTLD_NOW | RTLD_LOCAL);
+    if (lib != NULL)
+    {
+        return lib;
+    }
+
+    Dl_info addonInfo;
+    if (dladdr((void *)openvrOpen, &addonInfo) == 0 || addonInfo.dli_fname == NULL)
+    {
+        return NULL;
+    }
+
+    std::string addonPath(addonInfo.dli_fname);
+    auto slash = addonPath.rfind('/');
+    addonPath.resize(slash != std::string::npos ? slash + 1 : 0);
+    addonPath += "libopenvr_api.so";
+
+    return dlopen(addonPath.c_str(), RTLD_NOW | RTLD_LOCAL);
 }
 
-Napi::Value playGame(const Napi::CallbackInfo &info)
+void openvrLoad(void)
 {
-    auto env = info.Env();
-
-    return Napi::Boolean::New(env, false);
+    auto lib = openvrOpen();
+    if (lib == NULL)
+    {
+        logWrite(LOG_LEVEL_ERROR, LOG_CODE_OPENVR_LOAD);
+        return;
+    }
+
+    *(void **)&openvr_.initInternal2 = dlsym(lib, "VR_InitInternal2");
+    *(void **)&openvr_.shutdownInternal = dlsym(lib, "VR_ShutdownInternal");
+    *(void **)&openvr_.isInterfaceVersionValid = dlsym(lib, "VR_IsInterfaceVersionValid");
+    *(void **)&openvr_.getGenericInterface = dlsym(lib, "VR_GetGenericInterface");
+    *(void **)&openvr_.getInitToken = dlsym(lib, "VR_GetInitToken");
+
+    if (openvr_.initInternal2 == NULL ||
+        openvr_.shutdownInternal == NULL ||
+        openvr_.isInterfaceVersionValid == NULL ||
+        openvr_.getGenericInterface == NULL ||
+        openvr_.getInitToken == NULL)
+    {
+        logWrite(LOG_LEVEL_ERROR, LOG_CODE_OPENVR_LOAD, 1);
+        memset(&openvr_, 0, sizeof(openvr_));
+        dlclose(lib);
+        return;
+    }
+
+    openvrLib_ = lib;
 }
 
-Napi::Value startOverlay(const Napi::CallbackInfo &info)
+namespace vr
 {
-    auto env = info.Env();
-
-    return Napi::Boolean::New(env, false);
+    uint32_t VR_InitInternal2(EVRInitError *peError, EVRApplicationType eApplicationType, const char *pStartupInfo)
+    {
+        std::call_once(openvrOnce_, openvrLoad);
+        if (openvrLib_ == NULL)
+        {
+            *peError = VRInitError_Init_InstallationNotFound;
+            return 0;
+        }
+
+        return openvr_.initInternal2(peError, eApplicationType, pStartupInfo);
+    }
+
+    void VR_ShutdownInternal()
+    {
+        if (openvrLib_ != NULL)
+        {
+            openvr_.shutdownInternal();
+        }
+    }
+
+    bool VR_IsInterfaceVersionValid(const char *pchInterfaceVersion)
+    {
+        return openvrLib_ != NULL && openvr_.isInterfaceVersionValid(pchInterfaceVersion);
+    }
+
+    void *VR_GetGenericInterface(const char *pchInterfaceVersion, EVRInitError *peError)
+    {
+        if (openvrLib_ == NULL)
+        {
+            *peError = VRInitError_Init_InstallationNotFound;
+            return NULL;
+        }
+
+        return openvr_.getGenericInterface(pchInterfaceVersion, peError);
+    }
+
+    uint32_t VR_GetInitToken()
+    {
+        return openvrLib_ != NULL ? openvr_.getInitToken() : 0;
+    }
 }
 
-Napi::Value stopOverlay(const Napi::CallbackInfo &info)
+const TEXTURE_BACKEND *backendTexture(void)
 {
-    auto env = info.Env();
-
-    return env.Undefined();
+    return &textureBackendGl;
 }
 
-Napi::Value setOverlayFrameBuffer(const Napi::CallbackInfo &info)
+void backendGetRunningApp(bool *isVrchat, bool *isSteamvr)
 {
-    auto env = info.Env();
-
-    return env.Undefined();
+    std::lock_guard<std::mutex> guard(runningAppLock_);
+
+    *isVrchat = false;
+    *isSteamvr = false;
+
+    // the scan is kept, later calls only read pids they haven't seen
+    if (hasRunningAppScan_ == false)
+    {
+        static const char *const names[] = {"VRChat.exe", "vrserver", "vrcompositor"};
+        hasRunningAppScan_ = procscanInit(&runningAppScan_, names, 3);
+    }
+
+    if (hasRunningAppScan_ != false &&
+        procscanUpdate(&runningAppScan_, NULL, NULL) != false)
+    {
+        *isVrchat = runningAppScan_.matchCounts[RUNNING_APP_VRCHAT] != 0;
+        *isSteamvr =
+            runningAppScan_.matchCounts[RUNNING_APP_VRSERVER] != 0 ||
+            runningAppScan_.matchCounts[RUNNING_APP_VRCOMPOSITOR] != 0;
+    }
 }
 
-Napi::Value getVRDeviceList(const Napi::CallbackInfo &info)
+void backendReapRoutine(pid_t pid)
 {
-    auto env = info.Env();
-
-    auto arr = Napi::Array::New(env, 0);
-
-    return arr;
+    waitpid(pid, NULL, 0);
 }
 
-Napi::Object init(Napi::Env env, Napi::Object exports)
+bool backendSpawnGame(const char *launchOption, uint32_t *pid)
 {
-    exports.Set(
-        "getRunningApp",
-        Napi::Function::New(env, getRunningApp));
-
-    exports.Set(
-        "playGame",
-        Napi::Function::New(env, playGame));
-
-    exports.Set(
-        "startOverlay",
-        Napi::Function::New(env, startOverlay));
-
-    exports.Set(
-        "stopOverlay",
-        Napi::Function::New(env, stopOverlay));
-
-    exports.Set(
-        "setOverlayFrameBuffer",
-        Napi::Function::New(env, setOverlayFrameBuffer));
-
-    exports.Set(
-        "getVRDeviceList",
-        Napi::Function::New(env, getVRDeviceList));
+    const char *argv[] = {
+        "steam",
+        "-applaunch",
+        "438100",
+        "--",
+        launchOption,
+        NULL};
+
+    pid_t steamPid;
+    if (posix_spawnp(&steamPid, "steam", NULL, NULL, (char *const *)argv, environ) != 0)
+    {
+        return false;
+    }
+
+    *pid = (uint32_t)steamPid;
+
+    // steam hands the launch to a running client and exits, or becomes the
+    // client. either way it's ours to reap
+    std::thread(backendReapRoutine, steamPid).detach();
+
+    return true;
+}
 
-    return exports;
+bool backendSharedDup(uint64_t handle, uint64_t *dup)
+{
+    if (handle > INT32_MAX)
+    {
+        return false;
+    }
+
+    auto fd = fcntl((int)handle, F_DUPFD_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    *dup = (uint64_t)fd;
+    return true;
 }
 
-NODE_API_MODULE(NODE_GYP_MODULE_NAME, init);
+void backendSharedClose(uint64_t handle)
+{
+    close((int)handle);
+}
@@ -1,46 +1,29 @@
-#define _XM_NO_INTRINSICS_
 #include <windows.h>
-#include <DirectXMath.h>
-#include <d3d11.h>
+#include <d3d11_1.h>
 #include <openvr/openvr.h>
-#include <stdio.h>
-#include "napi.h"
+#include <string.h>
+#include <string>
+#include "backend.h"
+#include "frame.h"
+#include "log.h"
+#include "staging.h"
+#include "texture.h"
 
-// https://docs.microsoft.com/en-us/windows/win32/dxmath/pg-xnamath-migration-d3dx
+#define STAGING_SLOTS 3 // one being written, up to two still being copied out of
 
-typedef struct _OVERLAY_DATA
-{
-    BOOL dirty;
-    VOID *data;
-} OVERLAY_DATA;
-
-typedef struct _VR_DEVICE_DATA
-{
-    vr::ETrackedDeviceClass deviceClass;
-    bool isConnected;
-    bool isCharging;
-    float batteryPercentage;
-    vr::ETrackedControllerRole controllerRole;
-    uint64_t buttonPressedMask;
-    uint64_t buttonTouchedMask;
-} VR_DEVICE_DATA;
-
-BOOL isOverlayRunning_;
-HANDLE overlayThreadHandle_;
 ID3D11Device *device_;
+ID3D11Device1 *device1_; // opens shared nt handles, NULL before windows 8
 ID3D11DeviceContext *immediateContext_;
-ID3D11Texture2D *textureHmd_;
-ID3D11Texture2D *textureWrist_;
-OVERLAY_DATA overlayDataHmd_;
-OVERLAY_DATA overlayDataWrist_;
-CRITICAL_SECTION vrDeviceLock_;
-uint32_t vrDeviceCount_;
-VR_DEVICE_DATA vrDeviceData_[vr::k_unMaxTrackedDeviceCount];
-VR_DEVICE_DATA vrDeviceDataLocal_[vr::k_unMaxTrackedDeviceCount];
-vr::VROverlayHandle_t overlayHandleHmd_ = vr::k_ulOverlayHandleInvalid;
-vr::VROverlayHandle_t overlayHandleWrist_ = vr::k_ulOverlayHandleInvalid;
-
-__declspec(noinline) BOOL overlayInit(void)
+ID3D11Texture2D *textures_[TEXTURE_TARGET_COUNT];
+bool isTextureFilled_[TEXTURE_TARGET_COUNT];
+bool isFlushPending_; // overlay thread only
+// uploads go through mapped staging textures shared by both targets, an
+// event query per slot stands in for a fence
+ID3D11Texture2D *stagingTextures_[STAGING_SLOTS];
+ID3D11Query *stagingQueries_[STAGING_SLOTS];
+STAGING_RING stagingRing_;
+
+bool textureD3d11Init(void)
 {
     HRESULT hr;
 
@@ -57,13 +40,13 @@ __declspec(noinline) BOOL overlayInit(void)
         &immediateContext_);
     if (hr != S_OK)
     {
-        printf("D3D11CreateDevice(): %08x\n", hr);
-        return FALSE;
+        logWrite(LOG_LEVEL_ERROR, LOG_CODE_D3D11_CREATE_DEVICE, (uint32_t)hr);
+        return false;
     }
 
     D3D11_TEXTURE2D_DESC texDesc;
-    texDesc.Width = 512;
-    texDesc.Height = 512;
+    texDesc.Width = FRAME_WIDTH;
+    texDesc.Height = FRAME_HEIGHT;
     texDesc.MipLevels = 1;
     texDesc.ArraySize = 1;
     texDesc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
@@ -74,35 +57,85 @@ __declspec(noinline) BOOL overlayInit(void)
     texDesc.CPUAccessFlags = 0;
     texDesc.MiscFlags = 0;
 
-    hr = device_->CreateTexture2D(&texDesc, NULL, &textureHmd_);
-    if (hr != S_OK)
+    for (uint32_t target = 0; target < TEXTURE_TARGET_COUNT; ++target)
     {
-        printf("CreateTexture2D(): %08x\n", hr);
-        return FALSE;
+        hr = device_->CreateTexture2D(&texDesc, NULL, &textures_[target]);
+        if (hr != S_OK)
+        {
+            logWrite(LOG_LEVEL_ERROR, LOG_CODE_CREATE_TEXTURE_2D, (uint32_t)hr);
+            return false;
+        }
+        isTextureFilled_[target] = false;
     }
 
-    hr = device_->CreateTexture2D(&texDesc, NULL, &textureWrist_);
-    if (hr != S_OK)
+    texDesc.Usage = D3D11_USAGE_STAGING;
+    texDesc.BindFlags = 0;
+    texDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+
+    D3D11_QUERY_DESC queryDesc;
+    queryDesc.Query = D3D11_QUERY_EVENT;
+    queryDesc.MiscFlags = 0;
+
+    for (uint32_t slot = 0; slot < STAGING_SLOTS; ++slot)
     {
-        printf("CreateTexture2D(): %08x\n", hr);
-        return FALSE;
+        hr = device_->CreateTexture2D(&texDesc, NULL, &stagingTextures_[slot]);
+        if (hr != S_OK)
+        {
+            logWrite(LOG_LEVEL_ERROR, LOG_CODE_CREATE_TEXTURE_2D, (uint32_t)hr);
+            return false;
+        }
+
+        hr = device_->CreateQuery(&queryDesc, &stagingQueries_[slot]);
+        if (hr != S_OK)
+        {
+            logWrite(LOG_LEVEL_ERROR, LOG_CODE_CREATE_QUERY, (uint32_t)hr);
+            return false;
+        }
     }
 
-    return TRUE;
+    stagingRingInit(&stagingRing_, STAGING_SLOTS);
+
+    if (device_->QueryInterface(__uuidof(ID3D11Device1), (void **)&device1_) != S_OK)
+    {
+        device1_ = NULL;
+    }
+
+    return true;
 }
 
-__declspec(noinline) void overlayExit(void)
+void textureD3d11Exit(void)
 {
-    if (textureWrist_ != NULL)
+    for (auto &query : stagingQueries_)
+    {
+        if (query != NULL)
+        {
+            query->Release();
+            query = NULL;
+        }
+    }
+
+    for (auto &texture : stagingTextures_)
+    {
+        if (texture != NULL)
+        {
+            texture->Release();
+            texture = NULL;
+        }
+    }
+
+    for (auto &texture : textures_)
     {
-        textureWrist_->Release();
-        textureWrist_ = NULL;
+        if (texture != NULL)
+        {
+            texture->Release();
+            texture = NULL;
+        }
     }
 
-    if (textureHmd_ != NULL)
+    if (device1_ != NULL)
     {
-        textureHmd_->Release();
-        textureHmd_ = NULL;
+        device1_->Release();
+        device1_ = NULL;
     }
 
     if (immediateContext_ != NULL)
@@ -118,360 +151,217 @@ __declspec(noinline) void overlayExit(void)
     }
 }
 
-__declspec(noinline) BOOL overlaySetTexture(
-    vr::IVROverlay *pVROverlay,
-    vr::VROverlayHandle_t overlayHandle,
-    OVERLAY_DATA *overlayData)
+void textureD3d11Poll(void)
 {
-    BOOL dirty = overlayData->dirty;
-    overlayData->dirty = FALSE;
-
-    if (dirty != FALSE)
-    {
-        immediateContext_->UpdateSubresource(
-            textureHmd_,
-            0,
-            NULL,
-            overlayData->data,
-            512 * 4,
-            0);
+    // DONOTFLUSH: the submit flushes, a query stuck before it just keeps
+    // its slot busy a little longer
+    uint32_t slot;
+    uint64_t fence;
+    while (stagingRingPending(&stagingRing_, &slot, &fence) != false &&
+           immediateContext_->GetData(
+               stagingQueries_[slot],
+               NULL,
+               0,
+               D3D11_ASYNC_GETDATA_DONOTFLUSH) == S_OK)
+    {
+        stagingRingComplete(&stagingRing_, fence);
     }
+}
 
-    vr::Texture_t texture;
-    texture.handle = (void *)textureHmd_;
-    texture.eType = vr::ETextureType::TextureType_DirectX;
-    texture.eColorSpace = vr::EColorSpace::ColorSpace_Auto;
+bool textureD3d11UploadStaging(uint32_t target, const uint8_t *data, uint32_t dirtyRows)
+{
+    textureD3d11Poll();
 
-    auto overlayError = pVROverlay->SetOverlayTexture(
-        overlayHandleHmd_,
-        &texture);
-    if (overlayError != vr::EVROverlayError::VROverlayError_None)
+    auto slot = stagingRingAcquire(&stagingRing_);
+    if (slot < 0)
     {
-        printf("SetOverlayTexture(): %d\n", overlayError);
-
-        if (dirty != FALSE)
-        {
-            immediateContext_->Flush();
-        }
-
-        return FALSE;
+        return false;
     }
 
-    if (dirty != FALSE)
+    // the fence passed, so this can't block. if the driver disagrees the
+    // slot is simply skipped, its fence still counts as passed
+    D3D11_MAPPED_SUBRESOURCE mapped;
+    if (immediateContext_->Map(
+            stagingTextures_[slot],
+            0,
+            D3D11_MAP_WRITE,
+            D3D11_MAP_FLAG_DO_NOT_WAIT,
+            &mapped) != S_OK)
     {
-        immediateContext_->Flush();
+        return false;
     }
 
-    return TRUE;
-}
-
-__declspec(noinline) void overlayRenderHmdCleanup(vr::IVROverlay *pVROverlay)
-{
-    pVROverlay->DestroyOverlay(overlayHandleHmd_);
-    overlayHandleHmd_ = vr::k_ulOverlayHandleInvalid;
-}
-
-__declspec(noinline) BOOL overlayRenderHmdInit(vr::IVROverlay *pVROverlay)
-{
-    auto overlayError = pVROverlay->FindOverlay(
-        "VRCX_HMD",
-        &overlayHandleHmd_);
-
-    if (overlayError != vr::EVROverlayError::VROverlayError_None)
+    auto runs = dirtyRows;
+    uint32_t y, height;
+    while (textureTakeRun(&runs, &y, &height) != false)
     {
-        if (overlayError != vr::EVROverlayError::VROverlayError_UnknownOverlay)
+        auto dst = (uint8_t *)mapped.pData + y * mapped.RowPitch;
+        auto src = data + y * FRAME_STRIDE;
+        if (mapped.RowPitch == FRAME_STRIDE)
         {
-            printf("FindOverlay(): %d\n", overlayError);
-            return FALSE;
+            memcpy(dst, src, height * FRAME_STRIDE);
+            continue;
         }
-
-        overlayError = pVROverlay->CreateOverlay(
-            "VRCX_HMD",
-            "VRCX_HMD",
-            &overlayHandleHmd_);
-        if (overlayError != vr::EVROverlayError::VROverlayError_None)
+        for (uint32_t i = 0; i < height; ++i)
         {
-            printf("CreateOverlay(): %d\n", overlayError);
-            return FALSE;
+            memcpy(dst + i * mapped.RowPitch, src + i * FRAME_STRIDE, FRAME_STRIDE);
         }
     }
 
-    pVROverlay->SetOverlayAlpha(overlayHandleHmd_, 0.9f);
-
-    overlayError = pVROverlay->SetOverlayWidthInMeters(
-        overlayHandleHmd_,
-        1.0f);
-    if (overlayError != vr::EVROverlayError::VROverlayError_None)
-    {
-        printf("SetOverlayWidthInMeters(): %d\n", overlayError);
-        overlayRenderHmdCleanup(pVROverlay);
-        return FALSE;
-    }
-
-    overlayError = pVROverlay->SetOverlayInputMethod(
-        overlayHandleHmd_,
-        vr::VROverlayInputMethod::VROverlayInputMethod_None);
-    if (overlayError != vr::EVROverlayError::VROverlayError_None)
-    {
-        printf("SetOverlayInputMethod(): %d\n", overlayError);
-        overlayRenderHmdCleanup(pVROverlay);
-        return FALSE;
-    }
+    immediateContext_->Unmap(stagingTextures_[slot], 0);
 
-    auto m = DirectX::XMMatrixScaling(1.0f, 1.0f, 1.0f);
-    m *= DirectX::XMMatrixTranslation(0.0f, -0.1f, -1.0f);
-    vr::HmdMatrix34_t hmdMatrix34 = {
-        m._11, m._21, m._31, m._41,
-        m._12, m._22, m._32, m._42,
-        m._13, m._23, m._33, m._43};
-
-    overlayError = pVROverlay->SetOverlayTransformTrackedDeviceRelative(
-        overlayHandleHmd_,
-        vr::k_unTrackedDeviceIndex_Hmd,
-        &hmdMatrix34);
-    if (overlayError != vr::EVROverlayError::VROverlayError_None)
+    while (textureTakeRun(&dirtyRows, &y, &height) != false)
     {
-        printf("SetOverlayTransformTrackedDeviceRelative(): %d\n", overlayError);
-        overlayRenderHmdCleanup(pVROverlay);
-        return FALSE;
-    }
+        D3D11_BOX box = {0, y, 0, FRAME_WIDTH, y + height, 1};
+        immediateContext_->CopySubresourceRegion(
+            textures_[target],
+            0,
+            0,
+            y,
+            0,
+            stagingTextures_[slot],
+            0,
+            &box);
 
-    if (overlaySetTexture(
-            pVROverlay,
-            overlayHandleHmd_,
-            &overlayDataHmd_) == FALSE)
-    {
-        overlayRenderHmdCleanup(pVROverlay);
-        return FALSE;
+        textureCountUpload(height * FRAME_STRIDE);
     }
 
-    overlayError = pVROverlay->ShowOverlay(overlayHandleHmd_);
-    if (overlayError != vr::EVROverlayError::VROverlayError_None)
-    {
-        printf("ShowOverlay(): %d\n", overlayError);
-        overlayRenderHmdCleanup(pVROverlay);
-        return FALSE;
-    }
+    stagingRingRelease(&stagingRing_, (uint32_t)slot);
+    immediateContext_->End(stagingQueries_[slot]);
+    isFlushPending_ = true;
 
-    return TRUE;
+    return true;
 }
 
-__declspec(noinline) void overlayRenderHmd(vr::IVROverlay *pVROverlay)
+bool textureD3d11Upload(uint32_t target, const uint8_t *data, uint32_t dirtyRows)
 {
-    if (overlayHandleHmd_ == vr::k_ulOverlayHandleInvalid)
+    if (isTextureFilled_[target] == false)
     {
-        overlayRenderHmdInit(pVROverlay);
-        return;
+        dirtyRows = TEXTURE_ALL_ROWS;
+        isTextureFilled_[target] = true;
     }
 
-    if (overlayDataHmd_.dirty == FALSE)
+    if (textureD3d11UploadStaging(target, data, dirtyRows) != false)
     {
-        return;
+        return true;
     }
 
-    if (overlaySetTexture(
-            pVROverlay,
-            overlayHandleHmd_,
-            &overlayDataHmd_) == FALSE)
+    // every slot still in flight: the driver's own staging rather than a
+    // wait on ours
+    uint32_t y, height;
+    while (textureTakeRun(&dirtyRows, &y, &height) != false)
     {
-        overlayRenderHmdCleanup(pVROverlay);
-    }
-}
-
-__declspec(noinline) BOOL overlayPollEvent(vr::IVRSystem *pVRSystem)
-{
-    vr::VREvent_t event;
+        D3D11_BOX box = {0, y, 0, FRAME_WIDTH, y + height, 1};
+        immediateContext_->UpdateSubresource(
+            textures_[target],
+            0,
+            &box,
+            data + y * FRAME_STRIDE,
+            FRAME_STRIDE,
+            0);
 
-    while (pVRSystem->PollNextEvent(&event, sizeof(event)) != false)
-    {
-        printf("VREventType: %d\n", event.eventType);
-        if (event.eventType == vr::EVREventType::VREvent_Quit)
-        {
-            return FALSE;
-        }
+        isFlushPending_ = true;
+        textureCountUpload(height * FRAME_STRIDE);
     }
 
-    return TRUE;
+    return true;
 }
 
-__declspec(noinline) void overlayUpdateTrackedDevices(vr::IVRSystem *pVRSystem)
+vr::EVROverlayError textureD3d11Submit(
+    vr::IVROverlay *pVROverlay,
+    vr::VROverlayHandle_t overlayHandle,
+    uint32_t target)
 {
-    vr::VRControllerState_t state;
-
-    vrDeviceCount_ = 0;
-
-    for (uint32_t devIndex = 0u; devIndex < vr::k_unMaxTrackedDeviceCount; ++devIndex)
+    // the runtime copies from the texture, the upload has to be out first
+    if (isFlushPending_ != false)
     {
-        auto devClass = pVRSystem->GetTrackedDeviceClass(devIndex);
-        if (devClass == vr::ETrackedDeviceClass::TrackedDeviceClass_Invalid)
-        {
-            continue;
-        }
-
-        auto deviceData = &vrDeviceData_[vrDeviceCount_++];
-        deviceData->deviceClass = devClass;
-
-        deviceData->isConnected =
-            pVRSystem->IsTrackedDeviceConnected(devIndex);
-
-        deviceData->isCharging =
-            pVRSystem->GetBoolTrackedDeviceProperty(
-                devIndex,
-                vr::ETrackedDeviceProperty::Prop_DeviceIsCharging_Bool);
+        immediateContext_->Flush();
+        isFlushPending_ = false;
+    }
 
-        deviceData->batteryPercentage =
-            pVRSystem->GetFloatTrackedDeviceProperty(
-                devIndex,
-                vr::ETrackedDeviceProperty::Prop_DeviceBatteryPercentage_Float);
+    vr::Texture_t texture;
+    texture.handle = (void *)textures_[target];
+    texture.eType = vr::ETextureType::TextureType_DirectX;
+    texture.eColorSpace = vr::EColorSpace::ColorSpace_Auto;
 
-        if (devClass == vr::ETrackedDeviceClass::TrackedDeviceClass_Controller)
-        {
-            deviceData->controllerRole =
-                pVRSystem->GetControllerRoleForTrackedDeviceIndex(devIndex);
-
-            if (pVRSystem->GetControllerState(
-                    devIndex,
-                    &state,
-                    sizeof(state)) == false)
-            {
-                deviceData->buttonPressedMask = 0;
-                deviceData->buttonTouchedMask = 0;
-            }
-            else
-            {
-                deviceData->buttonPressedMask = state.ulButtonPressed;
-                deviceData->buttonTouchedMask = state.ulButtonTouched;
-            }
-        }
-        else
-        {
-            deviceData->controllerRole =
-                vr::ETrackedControllerRole::TrackedControllerRole_Invalid;
-            deviceData->buttonPressedMask = 0;
-            deviceData->buttonTouchedMask = 0;
-        }
-    }
-}
+    auto overlayError = pVROverlay->SetOverlayTexture(
+        overlayHandle,
+        &texture);
 
-__declspec(noinline) void overlayShutdown(void)
-{
-    auto pVROverlay = vr::VROverlay();
-    if (pVROverlay != NULL)
+    if (overlayError == vr::EVROverlayError::VROverlayError_None)
     {
-        overlayRenderHmdCleanup(pVROverlay);
+        textureCountSubmit();
     }
 
-    overlayHandleHmd_ = vr::k_ulOverlayHandleInvalid;
-    overlayHandleWrist_ = vr::k_ulOverlayHandleInvalid;
-    vrDeviceCount_ = 0;
-
-    vr::VR_Shutdown();
+    return overlayError;
 }
 
-__declspec(noinline) void overlayLoop(void)
+bool textureD3d11ImportShared(uint32_t target, const TEXTURE_SHARED *shared)
 {
-    uint32_t renderTick = 0;
-
-    while (isOverlayRunning_ != FALSE)
+    if (device1_ == NULL)
     {
-        auto pVRSystem = vr::VRSystem();
-        if (pVRSystem == NULL)
-        {
-            auto initError = vr::EVRInitError::VRInitError_None;
-
-            pVRSystem = vr::VR_Init(
-                &initError,
-                vr::EVRApplicationType::VRApplication_Overlay);
-
-            if (initError != vr::EVRInitError::VRInitError_None)
-            {
-                printf("VR_Init(): %d\n", initError);
-                Sleep(5000); // 5s
-                continue;
-            }
-        }
-
-        if (overlayPollEvent(pVRSystem) == FALSE)
-        {
-            printf("overlayPollEvent FALSE\n");
-            overlayShutdown();
-            Sleep(10000); // 10s
-            continue;
-        }
-
-        if (TryEnterCriticalSection(&vrDeviceLock_) != FALSE)
-        {
-            overlayUpdateTrackedDevices(pVRSystem);
-            LeaveCriticalSection(&vrDeviceLock_);
-        }
-
-        if (renderTick == 0)
-        {
-            renderTick = 5; // 20fps
-
-            auto pVROverlay = vr::VROverlay();
-            if (pVROverlay != NULL)
-            {
-                overlayRenderHmd(pVROverlay);
-            }
-        }
-        else
-        {
-            --renderTick;
-        }
-
-        Sleep(10); // 0.01s
+        return false;
     }
 
-    overlayShutdown();
-}
+    ID3D11Texture2D *sharedTexture;
+    auto hr = device1_->OpenSharedResource1(
+        (HANDLE)(uintptr_t)shared->handle,
+        __uuidof(ID3D11Texture2D),
+        (void **)&sharedTexture);
+    if (hr != S_OK)
+    {
+        return false;
+    }
 
-DWORD __stdcall overlayThreadRoutine(void *args)
-{
-    printf("overlay init\n");
+    D3D11_TEXTURE2D_DESC desc;
+    sharedTexture->GetDesc(&desc);
 
-    if (overlayInit() != FALSE)
+    // CopyResource wants the same size and format, anything else is a
+    // renderer that doesn't match the frame
+    auto isMatching =
+        desc.Width == FRAME_WIDTH &&
+        desc.Height == FRAME_HEIGHT &&
+        desc.Format == DXGI_FORMAT_B8G8R8A8_UNORM &&
+        desc.SampleDesc.Count == 1;
+    if (isMatching != false)
     {
-        overlayLoop();
-        overlayExit();
+        immediateContext_->CopyResource(textures_[target], sharedTexture);
+        isTextureFilled_[target] = false; // the cpu frame is behind now
+        isFlushPending_ = true;
+        textureCountShared();
     }
 
-    printf("overlay shutdown\n");
+    sharedTexture->Release();
+    return isMatching;
+}
 
-    CloseHandle(overlayThreadHandle_);
-    overlayThreadHandle_ = NULL;
+const TEXTURE_BACKEND textureBackendD3d11 = {
+    "d3d11",
+    NULL,
+    textureD3d11Init,
+    textureD3d11Exit,
+    textureD3d11Upload,
+    textureD3d11Submit,
+    textureD3d11ImportShared};
 
-    return 0;
+const TEXTURE_BACKEND *backendTexture(void)
+{
+    return &textureBackendD3d11;
 }
 
-Napi::Value getRunningApp(const Napi::CallbackInfo &info)
+void backendGetRunningApp(bool *isVrchat, bool *isSteamvr)
 {
-    auto env = info.Env();
-    auto obj = Napi::Object::New(env);
-
-    obj.Set(
-        "vrchat",
-        Napi::Boolean::New(
-            env,
-            FindWindowW(
-                L"UnityWndClass",
-                L"VRChat") != NULL));
-
-    obj.Set(
-        "steamvr",
-        Napi::Boolean::New(
-            env,
-            FindWindowW(
-                L"Qt5QWindowIcon",
-                L"SteamVR Status") != NULL));
-
-    return obj;
+    *isVrchat = FindWindowW(
+                    L"UnityWndClass",
+                    L"VRChat") != NULL;
+
+    *isSteamvr = FindWindowW(
+                     L"Qt5QWindowIcon",
+                     L"SteamVR Status") != NULL;
 }
 
-Napi::Value playGame(const Napi::CallbackInfo &info)
+bool backendSpawnGame(const char *launchOption, uint32_t *pid)
 {
-    auto env = info.Env();
-
     wchar_t steamExe[256];
     *steamExe = 0;
 
@@ -483,33 +373,38 @@ Napi::Value playGame(const Napi::CallbackInfo &info)
             KEY_READ,
             &hkey) == ERROR_SUCCESS)
     {
-        DWORD cb = sizeof(steamExe);
+        DWORD cb = sizeof(steamExe) - sizeof(wchar_t);
         RegQueryValueExW(hkey, NULL, NULL, NULL, (BYTE *)steamExe, &cb);
         RegCloseKey(hkey);
+        steamExe[cb / sizeof(wchar_t)] = 0;
     }
 
     // "C:\Program Files (x86)\Steam\steam.exe" -- "%1"
     auto ptr = wcsstr(steamExe, L".exe\"");
     if (ptr == NULL)
     {
-        return Napi::Boolean::New(env, false);
+        return false;
     }
 
     ptr[5] = 0; // cut the rest
 
-    auto arg0 = info[0];
-    if (arg0.IsString() == false)
+    auto length = MultiByteToWideChar(CP_UTF8, 0, launchOption, -1, NULL, 0);
+    if (length == 0)
+    {
+        return false;
+    }
+
+    std::wstring wideLaunchOption(length, L'\0');
+    if (MultiByteToWideChar(CP_UTF8, 0, launchOption, -1, &wideLaunchOption[0], length) == 0)
     {
-        return Napi::Boolean::New(env, false);
+        return false;
     }
-    auto launchOption = arg0.ToString().Utf16Value(); // pin to stack
+    wideLaunchOption.resize(length - 1); // the terminator
 
-    wchar_t command[1024]; // wsprint() has limit to 1024 bytes
-    wsprintfW(
-        command,
-        L"%s -applaunch 438100 -- %s",
-        steamExe,
-        launchOption.data());
+    // as long as the launch option is, CreateProcessW writes into it
+    std::wstring command(steamExe);
+    command += L" -applaunch 438100 -- ";
+    command += wideLaunchOption;
 
     PROCESS_INFORMATION processInfo;
     STARTUPINFOW startupInfo;
@@ -518,7 +413,7 @@ Napi::Value playGame(const Napi::CallbackInfo &info)
 
     if (CreateProcessW(
             NULL,
-            command,
+            &command[0],
             NULL,
             NULL,
             FALSE,
@@ -528,256 +423,38 @@ Napi::Value playGame(const Napi::CallbackInfo &info)
             &startupInfo,
             &processInfo) == FALSE)
     {
-        return Napi::Boolean::New(env, false);
+        return false;
     }
 
+    *pid = processInfo.dwProcessId;
+
     CloseHandle(processInfo.hProcess);
     CloseHandle(processInfo.hThread);
 
-    return Napi::Boolean::New(env, true);
+    return true;
 }
 
-Napi::Value startOverlay(const Napi::CallbackInfo &info)
+bool backendSharedDup(uint64_t handle, uint64_t *dup)
 {
-    auto env = info.Env();
-
-    if (overlayThreadHandle_ == NULL)
-    {
-        isOverlayRunning_ = TRUE;
-        overlayThreadHandle_ = CreateThread(
-            NULL,
-            0,
-            overlayThreadRoutine,
-            NULL,
+    HANDLE process = GetCurrentProcess();
+    HANDLE target;
+    if (DuplicateHandle(
+            process,
+            (HANDLE)(uintptr_t)handle,
+            process,
+            &target,
             0,
-            NULL);
-    }
-
-    return Napi::Boolean::New(env, overlayThreadHandle_ != NULL);
-}
-
-Napi::Value stopOverlay(const Napi::CallbackInfo &info)
-{
-    auto env = info.Env();
-
-    isOverlayRunning_ = FALSE;
-
-    return env.Undefined();
-}
-
-__declspec(noinline) void copyFrameBuffer(
-    uint8_t *target,
-    uint8_t *source,
-    int32_t x,
-    uint32_t y,
-    uint32_t width,
-    uint32_t height)
-{
-    // printf("copyFrameBuffer: origin=(%u,%u) size=(%u,%u)\n", x, y, width, height);
-    // copyFrameBuffer: origin=(0,0) size=(512,512)
-    // copyFrameBuffer: origin=(0,106) size=(512,406)
-
-    source += (y * 512 + x) * 4;
-    target += (y * 512 + x) * 4;
-
-    if (x == 0 && width == 512)
-    {
-        memcpy(target, source, height * 512 * 4);
-    }
-    else
-    {
-        uint32_t xs = width * 4;
-        for (uint32_t ys = height; ys != 0; --ys)
-        {
-            memcpy(target, source, xs);
-            source += 512 * 4;
-            target += 512 * 4;
-        }
-    }
-}
-
-Napi::Value setOverlayFrameBuffer(const Napi::CallbackInfo &info)
-{
-    auto env = info.Env();
-
-    if (info.Length() != 6)
-    {
-        return env.Undefined();
-    }
-
-    auto x = info[1].ToNumber().Uint32Value();
-    auto y = info[2].ToNumber().Uint32Value();
-    auto width = info[3].ToNumber().Uint32Value();
-    auto height = info[4].ToNumber().Uint32Value();
-
-    // sanity check
-    if (x >= 512 || y >= 512 ||
-        width == 0 || width > 512 ||
-        height == 0 || height > 512 ||
-        x + width > 512 || y + height > 512)
-    {
-        return env.Undefined();
-    }
-
-    auto arg5 = info[5];
-    if (arg5.IsTypedArray() == false)
-    {
-        return env.Undefined();
-    }
-
-    auto data = arg5.As<Napi::Uint8Array>();
-    if (data.ByteLength() != 512 * 512 * 4)
-    {
-        return env.Undefined();
-    }
-
-    auto id = info[0].ToNumber().Uint32Value();
-    if (id == 0)
-    {
-        copyFrameBuffer(
-            (uint8_t *)overlayDataHmd_.data,
-            data.Data(),
-            x,
-            y,
-            width,
-            height);
-        overlayDataHmd_.dirty = TRUE;
-    }
-    else if (id == 1)
-    {
-        copyFrameBuffer(
-            (uint8_t *)overlayDataWrist_.data,
-            data.Data(),
-            x,
-            y,
-            width,
-            height);
-        overlayDataWrist_.dirty = TRUE;
-    }
-
-    return env.Undefined();
-}
-
-Napi::Value getVRDeviceList(const Napi::CallbackInfo &info)
-{
-    auto env = info.Env();
-
-    EnterCriticalSection(&vrDeviceLock_);
-
-    auto count = vrDeviceCount_;
-    memcpy(vrDeviceDataLocal_, vrDeviceData_, sizeof(VR_DEVICE_DATA) * count);
-
-    LeaveCriticalSection(&vrDeviceLock_);
-
-    auto arr = Napi::Array::New(env, count);
-
-    for (uint32_t i = 0; i < count; ++i)
+            FALSE,
+            DUPLICATE_SAME_ACCESS) == FALSE)
     {
-        auto deviceData = &vrDeviceDataLocal_[i];
-        auto obj = Napi::Object::New(env);
-
-        obj.Set(
-            "deviceClass",
-            Napi::Number::New(
-                env,
-                deviceData->deviceClass));
-
-        obj.Set(
-            "isConnected",
-            Napi::Boolean::New(
-                env,
-                deviceData->isConnected));
-
-        obj.Set(
-            "isCharging",
-            Napi::Boolean::New(
-                env,
-                deviceData->isCharging));
-
-        obj.Set(
-            "batteryPercentage",
-            Napi::Number::New(
-                env,
-                deviceData->batteryPercentage));
-
-        obj.Set(
-            "controllerRole",
-            Napi::Number::New(
-                env,
-                deviceData->controllerRole));
-
-        obj.Set(
-            "buttonPressedMask",
-            Napi::Number::New(
-                env,
-                deviceData->buttonPressedMask));
-
-        obj.Set(
-            "buttonTouchedMask",
-            Napi::Number::New(
-                env,
-                deviceData->buttonTouchedMask));
-
-        arr.Set(i, obj);
+        return false;
     }
 
-    return arr;
+    *dup = (uint64_t)(uintptr_t)target;
+    return true;
 }
 
-Napi::Object init(Napi::Env env, Napi::Object exports)
+void backendSharedClose(uint64_t handle)
 {
-    if (InitializeCriticalSectionAndSpinCount(&vrDeviceLock_, 4000) == FALSE)
-    {
-        throw Napi::Error::New(env, "out of memory");
-    }
-
-    overlayDataHmd_.data = VirtualAlloc(
-        NULL,
-        512 * 512 * 4,
-        MEM_COMMIT,
-        PAGE_READWRITE);
-
-    if (overlayDataHmd_.data == NULL)
-    {
-        throw Napi::Error::New(env, "out of memory");
-    }
-
-    overlayDataWrist_.data = VirtualAlloc(
-        NULL,
-        512 * 512 * 4,
-        MEM_COMMIT,
-        PAGE_READWRITE);
-
-    if (overlayDataWrist_.data == NULL)
-    {
-        throw Napi::Error::New(env, "out of memory");
-    }
-
-    exports.Set(
-        "getRunningApp",
-        Napi::Function::New(env, getRunningApp));
-
-    exports.Set(
-        "playGame",
-        Napi::Function::New(env, playGame));
-
-    exports.Set(
-        "startOverlay",
-        Napi::Function::New(env, startOverlay));
-
-    exports.Set(
-        "stopOverlay",
-        Napi::Function::New(env, stopOverlay));
-
-    exports.Set(
-        "setOverlayFrameBuffer",
-        Napi::Function::New(env, setOverlayFrameBuffer));
-
-    exports.Set(
-        "getVRDeviceList",
-        Napi::Function::New(env, getVRDeviceList));
-
-    return exports;
+    CloseHandle((HANDLE)(uintptr_t)handle);
 }
-
-NODE_API_MODULE(NODE_GYP_MODULE_NAME, init);
@@ -0,0 +1,615 @@
+#include <string.h>
+#if defined(_M_X64) || defined(__x86_64__)
+#include <immintrin.h>
+#define PIXEL_X64
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#include "pixel.h"
+
+#ifdef _MSC_VER
+#define PIXEL_TARGET_AVX2
+#else
+#define PIXEL_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+static const char *isaNames_[PIXEL_ISA_COUNT] = {"scalar", "sse2", "avx2"};
+
+// round(t / 255) for t <= 255 * 255
+static inline uint32_t pixelDiv255(uint32_t t)
+{
+    t += 128;
+    return (t + (t >> 8)) >> 8;
+}
+
+// float on purpose: the simd kernels do the same ops in the same order, so
+// every variant produces identical bytes
+static inline uint32_t pixelUnpremultiply(uint32_t c, uint32_t a)
+{
+    auto v = (uint32_t)((float)c * 255.0f / (float)a + 0.5f);
+    return v > 255 ? 255 : v;
+}
+
+static inline void pixelConvertOne(
+    uint8_t *target,
+    const uint8_t *source,
+    const PIXEL_CONVERT *convert)
+{
+    auto ops = convert->ops;
+    uint32_t c0 = source[0];
+    uint32_t c1 = source[1];
+    uint32_t c2 = source[2];
+    uint32_t a = source[3];
+
+    if ((ops & PIXEL_OP_PREMULTIPLY) != 0)
+    {
+        c0 = pixelDiv255(c0 * a);
+        c1 = pixelDiv255(c1 * a);
+        c2 = pixelDiv255(c2 * a);
+    }
+
+    if ((ops & PIXEL_OP_ALPHA_THRESHOLD) != 0 && a < convert->alphaThreshold)
+    {
+        c0 = c1 = c2 = a = 0;
+    }
+
+    if ((ops & PIXEL_OP_OPACITY) != 0)
+    {
+        uint32_t opacity = convert->opacity;
+        c0 = pixelDiv255(c0 * opacity);
+        c1 = pixelDiv255(c1 * opacity);
+        c2 = pixelDiv255(c2 * opacity);
+        a = pixelDiv255(a * opacity);
+    }
+
+    if ((ops & PIXEL_OP_UNPREMULTIPLY) != 0)
+    {
+        if (a == 0)
+        {
+            c0 = c1 = c2 = 0;
+        }
+        else
+        {
+            c0 = pixelUnpremultiply(c0, a);
+            c1 = pixelUnpremultiply(c1, a);
+            c2 = pixelUnpremultiply(c2, a);
+        }
+    }
+
+    if ((ops & PIXEL_OP_SWIZZLE) != 0)
+    {
+        auto t = c0;
+        c0 = c2;
+        c2 = t;
+    }
+
+    target[0] = (uint8_t)c0;
+    target[1] = (uint8_t)c1;
+    target[2] = (uint8_t)c2;
+    target[3] = (uint8_t)a;
+}
+
+static void pixelConvertRowScalar(
+    uint8_t *target,
+    const uint8_t *source,
+    uint32_t count,
+    const PIXEL_CONVERT *convert)
+{
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        pixelConvertOne(target, source, convert);
+        target += 4;
+        source += 4;
+    }
+}
+
+static bool pixelHasAlphaScalar(
+    const uint8_t *source,
+    uint32_t stride,
+    uint32_t width,
+    uint32_t height)
+{
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        auto row = source + y * stride;
+        uint8_t alpha = 0;
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            alpha |= row[x * 4 + 3];
+        }
+        if (alpha != 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void pixelBlendRowScalar(
+    uint8_t *target,
+    const uint8_t *source,
+    uint32_t count,
+    uint8_t opacity)
+{
+    for (uint32_t i = 0; i < count * 4; i += 4)
+    {
+        auto alpha = pixelDiv255(source[i + 3] * opacity);
+        for (uint32_t c = 0; c < 4; ++c)
+        {
+            auto v = pixelDiv255(source[i + c] * opacity) +
+                     pixelDiv255(target[i + c] * (255 - alpha));
+            target[i + c] = (uint8_t)(v > 255 ? 255 : v);
+        }
+    }
+}
+
+#ifdef PIXEL_X64
+
+// 16-bit lanes: x * m / 255, rounded
+static inline __m128i pixelMulDiv255Sse2(__m128i x, __m128i m)
+{
+    auto t = _mm_add_epi16(_mm_mullo_epi16(x, m), _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+// one pixel per 128-bit register, 32-bit lanes
+static inline __m128i pixelUnpremultiplySse2(__m128i x)
+{
+    auto f = _mm_cvtepi32_ps(x);
+    auto a = _mm_max_ps(_mm_shuffle_ps(f, f, 0xff), _mm_set1_ps(1.0f));
+    f = _mm_add_ps(_mm_div_ps(_mm_mul_ps(f, _mm_set1_ps(255.0f)), a), _mm_set1_ps(0.5f));
+    return _mm_cvttps_epi32(f);
+}
+
+static void pixelConvertRowSse2(
+    uint8_t *target,
+    const uint8_t *source,
+    uint32_t count,
+    const PIXEL_CONVERT *convert)
+{
+    auto ops = convert->ops;
+    auto zero = _mm_setzero_si128();
+    auto alphaMask = _mm_set1_epi32((int)0xff000000u);
+    // multiplier lanes are b g r a; premultiply scales colour by a, alpha by 255
+    auto colourMask16 = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+    auto alphaOne16 = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+    auto threshold = _mm_set1_epi32(convert->alphaThreshold);
+    auto opacity = _mm_set1_epi16(convert->opacity);
+
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        auto p = _mm_loadu_si128((const __m128i *)(source + i * 4));
+
+        if ((ops & PIXEL_OP_PREMULTIPLY) != 0)
+        {
+            auto lo = _mm_unpacklo_epi8(p, zero);
+            auto hi = _mm_unpackhi_epi8(p, zero);
+            auto alo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(lo, 0xff), 0xff);
+            auto ahi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, 0xff), 0xff);
+            alo = _mm_or_si128(_mm_and_si128(alo, colourMask16), alphaOne16);
+            ahi = _mm_or_si128(_mm_and_si128(ahi, colourMask16), alphaOne16);
+            p = _mm_packus_epi16(
+                pixelMulDiv255Sse2(lo, alo),
+                pixelMulDiv255Sse2(hi, ahi));
+        }
+
+        if ((ops & PIXEL_OP_ALPHA_THRESHOLD) != 0)
+        {
+            auto below = _mm_cmplt_epi32(_mm_srli_epi32(p, 24), threshold);
+            p = _mm_andnot_si128(below, p);
+        }
+
+        if ((ops & PIXEL_OP_OPACITY) != 0)
+        {
+            p = _mm_packus_epi16(
+                pixelMulDiv255Sse2(_mm_unpacklo_epi8(p, zero), opacity),
+                pixelMulDiv255Sse2(_mm_unpackhi_epi8(p, zero), opacity));
+        }
+
+        if ((ops & PIXEL_OP_UNPREMULTIPLY) != 0)
+        {
+            auto lo = _mm_unpacklo_epi8(p, zero);
+            auto hi = _mm_unpackhi_epi8(p, zero);
+            auto x = _mm_packus_epi16(
+                _mm_packs_epi32(
+                    pixelUnpremultiplySse2(_mm_unpacklo_epi16(lo, zero)),
+                    pixelUnpremultiplySse2(_mm_unpackhi_epi16(lo, zero))),
+                _mm_packs_epi32(
+                    pixelUnpremultiplySse2(_mm_unpacklo_epi16(hi, zero)),
+                    pixelUnpremultiplySse2(_mm_unpackhi_epi16(hi, zero))));
+            auto alpha = _mm_and_si128(p, alphaMask);
+            auto transparent = _mm_cmpeq_epi32(alpha, zero);
+            p = _mm_andnot_si128(
+                transparent,
+                _mm_or_si128(_mm_andnot_si128(alphaMask, x), alpha));
+        }
+
+        if ((ops & PIXEL_OP_SWIZZLE) != 0)
+        {
+            // swap the 16-bit halves of the b_r_ bytes
+            auto ga = _mm_and_si128(p, _mm_set1_epi32((int)0xff00ff00u));
+            auto br = _mm_and_si128(p, _mm_set1_epi32(0x00ff00ff));
+            br = _mm_shufflehi_epi16(_mm_shufflelo_epi16(br, 0xb1), 0xb1);
+            p = _mm_or_si128(ga, br);
+        }
+
+        _mm_storeu_si128((__m128i *)(target + i * 4), p);
+    }
+
+    pixelConvertRowScalar(target + i * 4, source + i * 4, count - i, convert);
+}
+
+static inline __m128i pixelBlendSse2(__m128i s, __m128i d, __m128i opacity, __m128i full)
+{
+    s = pixelMulDiv255Sse2(s, opacity);
+    auto inverse = _mm_sub_epi16(
+        full,
+        _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, 0xff), 0xff));
+    return _mm_add_epi16(s, pixelMulDiv255Sse2(d, inverse));
+}
+
+static void pixelBlendRowSse2(
+    uint8_t *target,
+    const uint8_t *source,
+    uint32_t count,
+    uint8_t opacity)
+{
+    auto zero = _mm_setzero_si128();
+    auto full = _mm_set1_epi16(255);
+    auto scale = _mm_set1_epi16(opacity);
+
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        auto s = _mm_loadu_si128((const __m128i *)(source + i * 4));
+        auto d = _mm_loadu_si128((const __m128i *)(target + i * 4));
+        auto lo = pixelBlendSse2(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero), scale, full);
+        auto hi = pixelBlendSse2(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero), scale, full);
+        _mm_storeu_si128((__m128i *)(target + i * 4), _mm_packus_epi16(lo, hi));
+    }
+
+    pixelBlendRowScalar(target + i * 4, source + i * 4, count - i, opacity);
+}
+
+static bool pixelHasAlphaSse2(
+    const uint8_t *source,
+    uint32_t stride,
+    uint32_t width,
+    uint32_t height)
+{
+    auto alphaMask = _mm_set1_epi32((int)0xff000000u);
+
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        auto row = source + y * stride;
+        auto acc = _mm_setzero_si128();
+
+        uint32_t x = 0;
+        for (; x + 4 <= width; x += 4)
+        {
+            acc = _mm_or_si128(acc, _mm_loadu_si128((const __m128i *)(row + x * 4)));
+        }
+
+        acc = _mm_and_si128(acc, alphaMask);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(acc, _mm_setzero_si128())) != 0xffff ||
+            pixelHasAlphaScalar(row + x * 4, 0, width - x, 1) != false)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+PIXEL_TARGET_AVX2 static inline __m256i pixelMulDiv255Avx2(__m256i x, __m256i m)
+{
+    auto t = _mm256_add_epi16(_mm256_mullo_epi16(x, m), _mm256_set1_epi16(128));
+    return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+}
+
+// two pixels per 256-bit register, 32-bit lanes
+PIXEL_TARGET_AVX2 static inline __m256i pixelUnpremultiplyAvx2(__m128i x)
+{
+    auto f = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(x));
+    auto a = _mm256_max_ps(_mm256_shuffle_ps(f, f, 0xff), _mm256_set1_ps(1.0f));
+    f = _mm256_add_ps(_mm256_div_ps(_mm256_mul_ps(f, _mm256_set1_ps(255.0f)), a), _mm256_set1_ps(0.5f));
+    return _mm256_cvttps_epi32(f);
+}
+
+PIXEL_TARGET_AVX2 static void pixelConvertRowAvx2(
+    uint8_t *target,
+    const uint8_t *source,
+    uint32_t count,
+    const PIXEL_CONVERT *convert)
+{
+    auto ops = convert->ops;
+    auto zero = _mm256_setzero_si256();
+    auto alphaMask = _mm256_set1_epi32((int)0xff000000u);
+    auto colourMask16 = _mm256_set_epi16(0, -1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1);
+    auto alphaOne16 = _mm256_set_epi16(255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0);
+    auto threshold = _mm256_set1_epi32(convert->alphaThreshold);
+    auto opacity = _mm256_set1_epi16(convert->opacity);
+    auto swizzle = _mm256_setr_epi8(
+        2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+        2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+    // packs leave the pixels of the two lanes interleaved
+    auto order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        auto p = _mm256_loadu_si256((const __m256i *)(source + i * 4));
+
+        if ((ops & PIXEL_OP_PREMULTIPLY) != 0)
+        {
+            auto lo = _mm256_unpacklo_epi8(p, zero);
+            auto hi = _mm256_unpackhi_epi8(p, zero);
+            auto alo = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(lo, 0xff), 0xff);
+            auto ahi = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(hi, 0xff), 0xff);
+            alo = _mm256_or_si256(_mm256_and_si256(alo, colourMask16), alphaOne16);
+            ahi = _mm256_or_si256(_mm256_and_si256(ahi, colourMask16), alphaOne16);
+            p = _mm256_packus_epi16(
+                pixelMulDiv255Avx2(lo, alo),
+                pixelMulDiv255Avx2(hi, ahi));
+        }
+
+        if ((ops & PIXEL_OP_ALPHA_THRESHOLD) != 0)
+        {
+            auto below = _mm256_cmpgt_epi32(threshold, _mm256_srli_epi32(p, 24));
+            p = _mm256_andnot_si256(below, p);
+        }
+
+        if ((ops & PIXEL_OP_OPACITY) != 0)
+        {
+            p = _mm256_packus_epi16(
+                pixelMulDiv255Avx2(_mm256_unpacklo_epi8(p, zero), opacity),
+                pixelMulDiv255Avx2(_mm256_unpackhi_epi8(p, zero), opacity));
+        }
+
+        if ((ops & PIXEL_OP_UNPREMULTIPLY) != 0)
+        {
+            auto lo = _mm256_castsi256_si128(p);
+            auto hi = _mm256_extracti128_si256(p, 1);
+            auto x = _mm256_packus_epi16(
+                _mm256_packs_epi32(
+                    pixelUnpremultiplyAvx2(lo),
+                    pixelUnpremultiplyAvx2(_mm_srli_si128(lo, 8))),
+                _mm256_packs_epi32(
+                    pixelUnpremultiplyAvx2(hi),
+                    pixelUnpremultiplyAvx2(_mm_srli_si128(hi, 8))));
+            x = _mm256_permutevar8x32_epi32(x, order);
+            auto alpha = _mm256_and_si256(p, alphaMask);
+            auto transparent = _mm256_cmpeq_epi32(alpha, zero);
+            p = _mm256_andnot_si256(
+                transparent,
+                _mm256_or_si256(_mm256_andnot_si256(alphaMask, x), alpha));
+        }
+
+        if ((ops & PIXEL_OP_SWIZZLE) != 0)
+        {
+            p = _mm256_shuffle_epi8(p, swizzle);
+        }
+
+        _mm256_storeu_si256((__m256i *)(target + i * 4), p);
+    }
+
+    pixelConvertRowScalar(target + i * 4, source + i * 4, count - i, convert);
+}
+
+PIXEL_TARGET_AVX2 static inline __m256i pixelBlendAvx2(__m256i s, __m256i d, __m256i opacity, __m256i full)
+{
+    s = pixelMulDiv255Avx2(s, opacity);
+    auto inverse = _mm256_sub_epi16(
+        full,
+        _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(s, 0xff), 0xff));
+    return _mm256_add_epi16(s, pixelMulDiv255Avx2(d, inverse));
+}
+
+PIXEL_TARGET_AVX2 static void pixelBlendRowAvx2(
+    uint8_t *target,
+    const uint8_t *source,
+    uint32_t count,
+    uint8_t opacity)
+{
+    auto zero = _mm256_setzero_si256();
+    auto full = _mm256_set1_epi16(255);
+    auto scale = _mm256_set1_epi16(opacity);
+
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        auto s = _mm256_loadu_si256((const __m256i *)(source + i * 4));
+        auto d = _mm256_loadu_si256((const __m256i *)(target + i * 4));
+        auto lo = pixelBlendAvx2(_mm256_unpacklo_epi8(s, zero), _mm256_unpacklo_epi8(d, zero), scale, full);
+        auto hi = pixelBlendAvx2(_mm256_unpackhi_epi8(s, zero), _mm256_unpackhi_epi8(d, zero), scale, full);
+        _mm256_storeu_si256((__m256i *)(target + i * 4), _mm256_packus_epi16(lo, hi));
+    }
+
+    pixelBlendRowSse2(target + i * 4, source + i * 4, count - i, opacity);
+}
+
+PIXEL_TARGET_AVX2 static bool pixelHasAlphaAvx2(
+    const uint8_t *source,
+    uint32_t stride,
+    uint32_t width,
+    uint32_t height)
+{
+    auto alphaMask = _mm256_set1_epi32((int)0xff000000u);
+
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        auto row = source + y * stride;
+        auto acc = _mm256_setzero_si256();
+
+        uint32_t x = 0;
+        for (; x + 8 <= width; x += 8)
+        {
+            acc = _mm256_or_si256(acc, _mm256_loadu_si256((const __m256i *)(row + x * 4)));
+        }
+
+        if (_mm256_testz_si256(acc, alphaMask) == 0 ||
+            pixelHasAlphaScalar(row + x * 4, 0, width - x, 1) != false)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+#endif
+
+bool pixelConvertIsValid(const PIXEL_CONVERT *convert)
+{
+    auto ops = convert->ops;
+    return (ops & ~PIXEL_OP_MASK) == 0 &&
+           ((ops & PIXEL_OP_PREMULTIPLY) == 0 || (ops & PIXEL_OP_UNPREMULTIPLY) == 0);
+}
+
+PIXEL_ISA pixelDetectIsa(void)
+{
+#ifdef PIXEL_X64
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] >= 7)
+    {
+        __cpuid(info, 1);
+        auto osxsave = (info[2] & (1 << 27)) != 0;
+        auto avx = (info[2] & (1 << 28)) != 0;
+        if (osxsave != false && avx != false && (_xgetbv(0) & 6) == 6)
+        {
+            __cpuidex(info, 7, 0);
+            if ((info[1] & (1 << 5)) != 0)
+            {
+                return PIXEL_ISA_AVX2;
+            }
+        }
+    }
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") != 0)
+    {
+        return PIXEL_ISA_AVX2;
+    }
+#endif
+    return PIXEL_ISA_SSE2;
+#else
+    return PIXEL_ISA_SCALAR;
+#endif
+}
+
+const char *pixelIsaName(PIXEL_ISA isa)
+{
+    if (isa >= PIXEL_ISA_COUNT)
+    {
+        return "unknown";
+    }
+    return isaNames_[isa];
+}
+
+PIXEL_CONVERT_ROW pixelGetKernel(PIXEL_ISA isa)
+{
+    if (isa > pixelDetectIsa())
+    {
+        return NULL;
+    }
+
+    switch (isa)
+    {
+    case PIXEL_ISA_SCALAR:
+        return pixelConvertRowScalar;
+#ifdef PIXEL_X64
+    case PIXEL_ISA_SSE2:
+        return pixelConvertRowSse2;
+    case PIXEL_ISA_AVX2:
+        return pixelConvertRowAvx2;
+#endif
+    default:
+        return NULL;
+    }
+}
+
+PIXEL_ALPHA_SCAN pixelGetAlphaScan(PIXEL_ISA isa)
+{
+    if (isa > pixelDetectIsa())
+    {
+        return NULL;
+    }
+
+    switch (isa)
+    {
+    case PIXEL_ISA_SCALAR:
+        return pixelHasAlphaScalar;
+#ifdef PIXEL_X64
+    case PIXEL_ISA_SSE2:
+        return pixelHasAlphaSse2;
+    case PIXEL_ISA_AVX2:
+        return pixelHasAlphaAvx2;
+#endif
+    default:
+        return NULL;
+    }
+}
+
+PIXEL_BLEND_ROW pixelGetBlend(PIXEL_ISA isa)
+{
+    if (isa > pixelDetectIsa())
+    {
+        return NULL;
+    }
+
+    switch (isa)
+    {
+    case PIXEL_ISA_SCALAR:
+        return pixelBlendRowScalar;
+#ifdef PIXEL_X64
+    case PIXEL_ISA_SSE2:
+        return pixelBlendRowSse2;
+    case PIXEL_ISA_AVX2:
+        return pixelBlendRowAvx2;
+#endif
+    default:
+        return NULL;
+    }
+}
+
+static const PIXEL_CONVERT_ROW kernel_ = pixelGetKernel(pixelDetectIsa());
+static const PIXEL_ALPHA_SCAN alphaScan_ = pixelGetAlphaScan(pixelDetectIsa());
+static const PIXEL_BLEND_ROW blend_ = pixelGetBlend(pixelDetectIsa());
+
+void pixelConvertRow(
+    uint8_t *target,
+    const uint8_t *source,
+    uint32_t count,
+    const PIXEL_CONVERT *convert)
+{
+    if (convert->ops == 0)
+    {
+        memcpy(target, source, count * 4);
+        return;
+    }
+
+    kernel_(target, source, count, convert);
+}
+
+bool pixelHasAlpha(
+    const uint8_t *source,
+    uint32_t stride,
+    uint32_t width,
+    uint32_t height)
+{
+    return alphaScan_(source, stride, width, height);
+}
+
+void pixelBlendRow(
+    uint8_t *target,
+    const uint8_t *source,
+    uint32_t count,
+    uint8_t opacity)
+{
+    blend_(target, source, count, opacity);
+}
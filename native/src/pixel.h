@@ -0,0 +1,81 @@
+#pragma once
+
+#include <stdint.h>
+
+// per-pixel conversion applied while a dirty rect is copied in. stages run
+// in this order, each one only if its flag is set:
+//
+//   premultiply     straight -> premultiplied alpha
+//   alpha threshold pixels with alpha below the threshold become transparent
+//   opacity         all four channels scaled, data is premultiplied here
+//   unpremultiply   premultiplied -> straight alpha
+//   swizzle         BGRA <-> RGBA
+//
+// Chromium paints premultiplied BGRA, so with no flags set the data is
+// assumed premultiplied. premultiply and unpremultiply are exclusive.
+
+#define PIXEL_OP_PREMULTIPLY 0x01
+#define PIXEL_OP_ALPHA_THRESHOLD 0x02
+#define PIXEL_OP_OPACITY 0x04
+#define PIXEL_OP_UNPREMULTIPLY 0x08
+#define PIXEL_OP_SWIZZLE 0x10
+#define PIXEL_OP_MASK 0x1f
+
+typedef enum _PIXEL_ISA
+{
+    PIXEL_ISA_SCALAR = 0,
+    PIXEL_ISA_SSE2,
+    PIXEL_ISA_AVX2,
+    PIXEL_ISA_COUNT
+} PIXEL_ISA;
+
+typedef struct _PIXEL_CONVERT
+{
+    uint32_t ops;
+    uint8_t alphaThreshold;
+    uint8_t opacity; // 255 = unchanged
+} PIXEL_CONVERT;
+
+typedef void (*PIXEL_CONVERT_ROW)(
+    uint8_t *target,
+    const uint8_t *source,
+    uint32_t count,
+    const PIXEL_CONVERT *convert);
+
+// true if any pixel of the block has non-zero alpha
+typedef bool (*PIXEL_ALPHA_SCAN)(
+    const uint8_t *source,
+    uint32_t stride,
+    uint32_t width,
+    uint32_t height);
+
+// premultiplied "over": target = source * opacity + target * (1 - source alpha)
+typedef void (*PIXEL_BLEND_ROW)(
+    uint8_t *target,
+    const uint8_t *source,
+    uint32_t count,
+    uint8_t opacity);
+
+bool pixelConvertIsValid(const PIXEL_CONVERT *convert);
+PIXEL_ISA pixelDetectIsa(void);
+const char *pixelIsaName(PIXEL_ISA isa);
+// kernel for the given isa, or NULL when this build/cpu can't run it
+PIXEL_CONVERT_ROW pixelGetKernel(PIXEL_ISA isa);
+PIXEL_ALPHA_SCAN pixelGetAlphaScan(PIXEL_ISA isa);
+PIXEL_BLEND_ROW pixelGetBlend(PIXEL_ISA isa);
+// converts count pixels with the best kernel picked at load time
+void pixelConvertRow(
+    uint8_t *target,
+    const uint8_t *source,
+    uint32_t count,
+    const PIXEL_CONVERT *convert);
+bool pixelHasAlpha(
+    const uint8_t *source,
+    uint32_t stride,
+    uint32_t width,
+    uint32_t height);
+void pixelBlendRow(
+    uint8_t *target,
+    const uint8_t *source,
+    uint32_t count,
+    uint8_t opacity);
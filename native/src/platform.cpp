@@ -0,0 +1,77 @@
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+#include <chrono>
+#include <string>
+#include "platform.h"
+
+uint64_t platformNowNs(void)
+{
+#ifdef _WIN32
+    static LARGE_INTEGER frequency_;
+
+    if (frequency_.QuadPart == 0)
+    {
+        QueryPerformanceFrequency(&frequency_);
+    }
+
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+
+    // split to avoid overflow of counter * 1e9
+    uint64_t q = counter.QuadPart / frequency_.QuadPart;
+    uint64_t r = counter.QuadPart % frequency_.QuadPart;
+    return q * 1000000000ull + r * 1000000000ull / frequency_.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+void platformSleepMs(uint32_t ms)
+{
+#ifdef _WIN32
+    Sleep(ms);
+#else
+    struct timespec ts;
+    ts.tv_sec = ms / 1000;
+    ts.tv_nsec = (long)(ms % 1000) * 1000000l;
+    while (nanosleep(&ts, &ts) != 0)
+    {
+        // interrupted by a signal, sleep the rest
+    }
+#endif
+}
+
+double platformWallMs(void)
+{
+    return std::chrono::duration<double, std::milli>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+FILE *platformOpenFile(const char *path, const char *mode)
+{
+#ifdef _WIN32
+    auto length = MultiByteToWideChar(CP_UTF8, 0, path, -1, NULL, 0);
+    if (length == 0)
+    {
+        return NULL;
+    }
+
+    std::wstring widePath(length, L'\0');
+    wchar_t wideMode[8];
+    if (MultiByteToWideChar(CP_UTF8, 0, path, -1, &widePath[0], length) == 0 ||
+        MultiByteToWideChar(CP_UTF8, 0, mode, -1, wideMode, 8) == 0)
+    {
+        return NULL;
+    }
+
+    return _wfopen(widePath.c_str(), wideMode);
+#else
+    return fopen(path, mode);
+#endif
+}
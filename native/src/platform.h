@@ -0,0 +1,16 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef _WIN32
+#define NOINLINE __declspec(noinline)
+#else
+#define NOINLINE __attribute__((noinline))
+#endif
+
+uint64_t platformNowNs(void);
+void platformSleepMs(uint32_t ms);
+double platformWallMs(void);
+// path is utf-8 on every platform
+FILE *platformOpenFile(const char *path, const char *mode);
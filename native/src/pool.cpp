@@ -0,0 +1,161 @@
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+#include <string.h>
+#include <mutex>
+#include "frame.h"
+#include "pool.h"
+
+#define POOL_CHUNK_SIZE ((size_t)FRAME_SIZE * POOL_CHUNK_SLOTS)
+
+static_assert(FRAME_SIZE % 4096 == 0, "slots must stay page aligned");
+
+static std::mutex lock_;
+static uint32_t flags_;
+static void *freeList_;   // freed slots, linked through their first bytes
+static uint8_t *fresh_;   // never used slots of the newest chunk, zeroed
+static uint32_t freshCount_;
+static POOL_STATS stats_;
+
+static uint8_t *poolMapChunk(void)
+{
+#ifdef _WIN32
+    auto chunk = (uint8_t *)VirtualAlloc(
+        NULL,
+        POOL_CHUNK_SIZE,
+        MEM_RESERVE | MEM_COMMIT,
+        PAGE_READWRITE);
+    if (chunk != NULL)
+    {
+        stats_.reservedBytes += POOL_CHUNK_SIZE;
+    }
+    return chunk;
+#else
+    void *chunk = MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+    if ((flags_ & POOL_FLAG_HUGE_PAGES) != 0)
+    {
+        // needs pages reserved in /proc/sys/vm/nr_hugepages
+        chunk = mmap(
+            NULL,
+            POOL_CHUNK_SIZE,
+            PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+            -1,
+            0);
+        if (chunk != MAP_FAILED)
+        {
+            stats_.reservedBytes += POOL_CHUNK_SIZE;
+            stats_.hugePageBytes += POOL_CHUNK_SIZE;
+            return (uint8_t *)chunk;
+        }
+    }
+#endif
+
+    chunk = mmap(
+        NULL,
+        POOL_CHUNK_SIZE,
+        PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS,
+        -1,
+        0);
+    if (chunk == MAP_FAILED)
+    {
+        return NULL;
+    }
+
+    stats_.reservedBytes += POOL_CHUNK_SIZE;
+
+#ifdef MADV_HUGEPAGE
+    if ((flags_ & POOL_FLAG_HUGE_PAGES) != 0 &&
+        madvise(chunk, POOL_CHUNK_SIZE, MADV_HUGEPAGE) == 0)
+    {
+        stats_.thpBytes += POOL_CHUNK_SIZE;
+    }
+#endif
+
+    return (uint8_t *)chunk;
+#endif
+}
+
+void poolInit(uint32_t flags)
+{
+    std::lock_guard<std::mutex> guard(lock_);
+    flags_ = flags;
+}
+
+void *poolAlloc(bool isZeroed)
+{
+    void *slot = NULL;
+    auto isRecycled = false;
+
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+
+        if (freeList_ != NULL)
+        {
+            slot = freeList_;
+            freeList_ = *(void **)slot;
+            ++stats_.reuseCount;
+            isRecycled = true;
+        }
+        else
+        {
+            if (freshCount_ == 0)
+            {
+                fresh_ = poolMapChunk();
+                if (fresh_ == NULL)
+                {
+                    ++stats_.failCount;
+                    return NULL;
+                }
+                freshCount_ = POOL_CHUNK_SLOTS;
+            }
+
+            // straight from the os, already zero
+            slot = fresh_;
+            fresh_ += FRAME_SIZE;
+            --freshCount_;
+            ++stats_.slotCount;
+        }
+
+        ++stats_.allocCount;
+        ++stats_.inUse;
+        if (stats_.inUse > stats_.peakInUse)
+        {
+            stats_.peakInUse = stats_.inUse;
+        }
+    }
+
+    // the slot is ours once off the list, no need to hold up other
+    // threads for a frame's worth of stores
+    if (isRecycled != false && isZeroed != false)
+    {
+        memset(slot, 0, FRAME_SIZE);
+    }
+
+    return slot;
+}
+
+void poolFree(void *slot)
+{
+    if (slot == NULL)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> guard(lock_);
+
+    *(void **)slot = freeList_;
+    freeList_ = slot;
+    --stats_.inUse;
+}
+
+void poolGetStats(POOL_STATS *stats)
+{
+    std::lock_guard<std::mutex> guard(lock_);
+    *stats = stats_;
+}
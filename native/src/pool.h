@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stdint.h>
+
+// whole-frame (FRAME_SIZE) buffers for overlays, compositor pages and codec
+// reference frames. slots come from chunks mapped straight from the os,
+// page aligned, and a freed slot is kept for the next allocation instead of
+// going back, so toggling overlays doesn't grow or fragment the heap.
+// chunks are never unmapped. thread safe.
+
+#define POOL_CHUNK_SLOTS 2 // 2MiB, one huge page on x64
+
+#define POOL_FLAG_HUGE_PAGES 0x01 // linux: MAP_HUGETLB, else THP advice
+
+typedef struct _POOL_STATS
+{
+    uint64_t reservedBytes;  // mapped for slots
+    uint64_t hugePageBytes;  // of those, backed by MAP_HUGETLB
+    uint64_t thpBytes;       // of those, advised MADV_HUGEPAGE
+    uint32_t slotCount;      // carved out of the chunks so far
+    uint32_t inUse;
+    uint32_t peakInUse;
+    uint64_t allocCount;
+    uint64_t reuseCount;     // allocations served by a freed slot
+    uint64_t failCount;
+} POOL_STATS;
+
+// optional, applies to chunks mapped afterwards
+void poolInit(uint32_t flags);
+// FRAME_SIZE bytes, page aligned, NULL when out of memory
+void *poolAlloc(bool isZeroed);
+void poolFree(void *slot);
+void poolGetStats(POOL_STATS *stats);
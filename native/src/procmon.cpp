@@ -0,0 +1,723 @@
+#ifdef _WIN32
+#include <windows.h>
+#include <tlhelp32.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <linux/cn_proc.h>
+#include <linux/connector.h>
+#include <linux/netlink.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#endif
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include "log.h"
+#include "procmon.h"
+#ifndef _WIN32
+#include "procscan.h"
+#endif
+
+#ifdef _WIN32
+typedef HANDLE PROCMON_HANDLE; // SYNCHRONIZE, NULL when it couldn't be opened
+#else
+typedef int PROCMON_HANDLE; // pidfd, -1 when the kernel has none
+#endif
+
+typedef struct _PROCMON_PROCESS
+{
+    uint32_t pid;
+    uint32_t nameIndex;
+    PROCMON_HANDLE handle;
+    bool isSeen; // by the current scan
+} PROCMON_PROCESS;
+
+static std::mutex lock_; // guards processes_ and stats_
+static std::thread *thread_; // created by procmonStart, joined and deleted by procmonStop
+static std::atomic<bool> isStopping_;
+static char names_[PROCMON_MAX_NAMES][PROCMON_MAX_NAME];
+static uint32_t nameCount_;
+static PROCMON_CALLBACK callback_;
+static void *context_;
+static PROCMON_PROCESS processes_[PROCMON_MAX_PROCESSES];
+static uint32_t processCount_;
+static PROCMON_STATS stats_;
+#ifdef _WIN32
+static HANDLE stopEvent_;
+static wchar_t wideNames_[PROCMON_MAX_NAMES][PROCMON_MAX_NAME];
+#else
+static int stopFd_ = -1;
+static PROCSCAN scan_; // monitor thread only
+#endif
+
+static const char *backendNames_[PROCMON_BACKEND_COUNT] = {
+    "none",
+    "netlink",
+    "scan"};
+
+static void procmonCloseHandle(PROCMON_HANDLE handle)
+{
+#ifdef _WIN32
+    if (handle != NULL)
+    {
+        CloseHandle(handle);
+    }
+#else
+    if (handle >= 0)
+    {
+        close(handle);
+    }
+#endif
+}
+
+static PROCMON_HANDLE procmonOpenHandle(uint32_t pid)
+{
+#ifdef _WIN32
+    return OpenProcess(SYNCHRONIZE, FALSE, pid);
+#elif defined(SYS_pidfd_open)
+    return (int)syscall(SYS_pidfd_open, (pid_t)pid, 0);
+#else
+    return -1;
+#endif
+}
+
+static void procmonEmit(uint32_t pid, uint32_t nameIndex, bool isRunning)
+{
+    PROCMON_EVENT event;
+    event.pid = pid;
+    event.nameIndex = nameIndex;
+    event.isRunning = isRunning;
+    memcpy(event.name, names_[nameIndex], PROCMON_MAX_NAME);
+
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        ++stats_.eventCount;
+        stats_.processCount = processCount_;
+    }
+
+    callback_(&event, context_);
+}
+
+static int32_t procmonFind(uint32_t pid)
+{
+    for (uint32_t i = 0; i < processCount_; ++i)
+    {
+        if (processes_[i].pid == pid)
+        {
+            return (int32_t)i;
+        }
+    }
+
+    return -1;
+}
+
+static void procmonAdd(uint32_t pid, uint32_t nameIndex)
+{
+    auto index = procmonFind(pid);
+    if (index >= 0)
+    {
+        processes_[index].isSeen = true;
+        return;
+    }
+
+    if (processCount_ == PROCMON_MAX_PROCESSES)
+    {
+        return;
+    }
+
+    auto handle = procmonOpenHandle(pid);
+
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        auto process = &processes_[processCount_++];
+        process->pid = pid;
+        process->nameIndex = nameIndex;
+        process->handle = handle;
+        process->isSeen = true;
+    }
+
+    procmonEmit(pid, nameIndex, true);
+}
+
+static void procmonRemove(uint32_t index)
+{
+    auto process = processes_[index];
+    procmonCloseHandle(process.handle);
+
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        processes_[index] = processes_[--processCount_];
+    }
+
+    procmonEmit(process.pid, process.nameIndex, false);
+}
+
+static void procmonRemovePid(uint32_t pid)
+{
+    auto index = procmonFind(pid);
+    if (index >= 0)
+    {
+        procmonRemove((uint32_t)index);
+    }
+}
+
+#ifdef _WIN32
+static int32_t procmonMatch(const wchar_t *exeName)
+{
+    for (uint32_t i = 0; i < nameCount_; ++i)
+    {
+        if (_wcsicmp(exeName, wideNames_[i]) == 0)
+        {
+            return (int32_t)i;
+        }
+    }
+
+    return -1;
+}
+
+// starts by snapshot, exits of anything that couldn't be waited on too
+static void procmonScan(void)
+{
+    auto snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
+    if (snapshot == INVALID_HANDLE_VALUE)
+    {
+        return;
+    }
+
+    for (uint32_t i = 0; i < processCount_; ++i)
+    {
+        processes_[i].isSeen = false;
+    }
+
+    PROCESSENTRY32W entry;
+    entry.dwSize = sizeof(entry);
+
+    if (Process32FirstW(snapshot, &entry) != FALSE)
+    {
+        do
+        {
+            auto nameIndex = procmonMatch(entry.szExeFile);
+            if (nameIndex >= 0)
+            {
+                procmonAdd(entry.th32ProcessID, (uint32_t)nameIndex);
+            }
+        } while (Process32NextW(snapshot, &entry) != FALSE);
+    }
+
+    CloseHandle(snapshot);
+
+    for (uint32_t i = processCount_; i-- > 0;)
+    {
+        if (processes_[i].isSeen == false)
+        {
+            procmonRemove(i);
+        }
+    }
+
+    std::lock_guard<std::mutex> guard(lock_);
+    ++stats_.scanCount;
+}
+
+static void procmonThreadRoutine(void)
+{
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        stats_.backend = PROCMON_BACKEND_SCAN;
+    }
+
+    procmonScan();
+
+    HANDLE handles[PROCMON_MAX_PROCESSES + 1];
+    uint32_t indices[PROCMON_MAX_PROCESSES + 1];
+
+    while (isStopping_ == false)
+    {
+        handles[0] = stopEvent_;
+        DWORD count = 1;
+        for (uint32_t i = 0; i < processCount_; ++i)
+        {
+            if (processes_[i].handle != NULL)
+            {
+                handles[count] = processes_[i].handle;
+                indices[count] = i;
+                ++count;
+            }
+        }
+
+        auto result = WaitForMultipleObjects(count, handles, FALSE, PROCMON_SCAN_MS);
+
+        {
+            std::lock_guard<std::mutex> guard(lock_);
+            ++stats_.wakeCount;
+        }
+
+        if (result == WAIT_OBJECT_0)
+        {
+            break;
+        }
+
+        if (result > WAIT_OBJECT_0 && result < WAIT_OBJECT_0 + count)
+        {
+            procmonRemove(indices[result - WAIT_OBJECT_0]);
+            continue;
+        }
+
+        // a handle that went bad fails every wait, so don't spin on it
+        if (result == WAIT_FAILED)
+        {
+            logWrite(LOG_LEVEL_WARN, LOG_CODE_PROCMON_WAIT, GetLastError());
+            {
+                std::lock_guard<std::mutex> guard(lock_);
+                ++stats_.errorCount;
+            }
+            if (WaitForSingleObject(stopEvent_, PROCMON_SCAN_MS) == WAIT_OBJECT_0)
+            {
+                break;
+            }
+        }
+
+        procmonScan();
+    }
+}
+#else
+// false when the process is gone or unreadable
+static bool procmonReadComm(uint32_t pid, char *comm)
+{
+    char path[32];
+    snprintf(path, sizeof(path), "/proc/%u/comm", pid);
+
+    auto fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    auto size = read(fd, comm, 15 + 1);
+    close(fd);
+    if (size <= 0)
+    {
+        return false;
+    }
+
+    // ends with a newline
+    comm[size - 1] = '\0';
+    return true;
+}
+
+static void procmonCheck(uint32_t pid)
+{
+    char comm[16 + 1];
+    if (procmonReadComm(pid, comm) == false)
+    {
+        return;
+    }
+
+    auto nameIndex = procscanMatch(&scan_, comm);
+    if (nameIndex >= 0)
+    {
+        procmonAdd(pid, (uint32_t)nameIndex);
+    }
+}
+
+static void procmonOnScan(uint32_t pid, uint32_t pattern, bool isRunning, void *context)
+{
+    (void)context;
+
+    if (isRunning != false)
+    {
+        procmonAdd(pid, pattern);
+    }
+    else
+    {
+        procmonRemovePid(pid);
+    }
+}
+
+static void procmonScan(void)
+{
+    // only reads /proc/<pid> for pids it hasn't listed before
+    procscanUpdate(&scan_, procmonOnScan, NULL);
+
+    // whatever the connector added and the scan doesn't list anymore
+    for (uint32_t i = processCount_; i-- > 0;)
+    {
+        if (procscanGetPattern(&scan_, processes_[i].pid) < 0)
+        {
+            procmonRemove(i);
+        }
+    }
+
+    std::lock_guard<std::mutex> guard(lock_);
+    ++stats_.scanCount;
+}
+
+// newer headers moved these out of struct proc_event, the values stay
+#define PROCMON_PROC_EVENT_NONE 0x00000000u
+#define PROCMON_PROC_EVENT_EXEC 0x00000002u
+#define PROCMON_PROC_EVENT_COMM 0x00000200u
+#define PROCMON_PROC_EVENT_EXIT 0x80000000u
+
+// -1 when the connector can't be listened to
+static int procmonOpenNetlink(void)
+{
+    auto fd = socket(PF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_CONNECTOR);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    struct sockaddr_nl address = {};
+    address.nl_family = AF_NETLINK;
+    address.nl_groups = CN_IDX_PROC;
+
+    auto op = PROC_CN_MCAST_LISTEN;
+    alignas(struct nlmsghdr) char request[NLMSG_SPACE(sizeof(struct cn_msg) + sizeof(op))] = {};
+
+    auto header = (struct nlmsghdr *)request;
+    header->nlmsg_len = NLMSG_LENGTH(sizeof(struct cn_msg) + sizeof(op));
+    header->nlmsg_type = NLMSG_DONE;
+
+    auto message = (struct cn_msg *)NLMSG_DATA(header);
+    message->id.idx = CN_IDX_PROC;
+    message->id.val = CN_VAL_PROC;
+    message->len = sizeof(op);
+    memcpy(message->data, &op, sizeof(op));
+
+    if (bind(fd, (struct sockaddr *)&address, sizeof(address)) != 0 ||
+        send(fd, request, header->nlmsg_len, 0) != (ssize_t)header->nlmsg_len)
+    {
+        close(fd);
+        return -1;
+    }
+
+    // the kernel acks the listen, with EPERM when unprivileged
+    struct pollfd pollFd = {fd, POLLIN, 0};
+    alignas(struct nlmsghdr) char buffer[1024];
+
+    if (poll(&pollFd, 1, 100) == 1)
+    {
+        auto size = recv(fd, buffer, sizeof(buffer), 0);
+        header = (struct nlmsghdr *)buffer;
+
+        if (size > 0 && NLMSG_OK(header, (uint32_t)size) != false)
+        {
+            message = (struct cn_msg *)NLMSG_DATA(header);
+            auto event = (struct proc_event *)message->data;
+
+            // or an event already, which means listening works too
+            if ((uint32_t)event->what != PROCMON_PROC_EVENT_NONE ||
+                event->event_data.ack.err == 0)
+            {
+                return fd;
+            }
+        }
+    }
+
+    close(fd);
+    return -1;
+}
+
+// false when events were lost and a rescan is due
+static bool procmonReadNetlink(int fd)
+{
+    alignas(struct nlmsghdr) char buffer[8192];
+
+    for (;;)
+    {
+        auto size = recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+        if (size < 0)
+        {
+            return errno != ENOBUFS;
+        }
+
+        for (auto header = (struct nlmsghdr *)buffer;
+             NLMSG_OK(header, (uint32_t)size);
+             header = NLMSG_NEXT(header, size))
+        {
+            auto message = (struct cn_msg *)NLMSG_DATA(header);
+            auto event = (struct proc_event *)message->data;
+
+            switch ((uint32_t)event->what)
+            {
+            case PROCMON_PROC_EVENT_EXEC:
+                procmonCheck(event->event_data.exec.process_tgid);
+                break;
+
+            // wine names the process after the .exe only once it runs
+            case PROCMON_PROC_EVENT_COMM:
+                if (event->event_data.comm.process_pid == event->event_data.comm.process_tgid)
+                {
+                    auto nameIndex = procscanMatch(&scan_, event->event_data.comm.comm);
+                    if (nameIndex >= 0)
+                    {
+                        procmonAdd(event->event_data.comm.process_tgid, (uint32_t)nameIndex);
+                    }
+                }
+                break;
+
+            case PROCMON_PROC_EVENT_EXIT:
+                if (event->event_data.exit.process_pid == event->event_data.exit.process_tgid)
+                {
+                    procmonRemovePid(event->event_data.exit.process_tgid);
+                }
+                break;
+
+            default:
+                break;
+            }
+        }
+    }
+}
+
+static void procmonThreadRoutine(void)
+{
+    const char *names[PROCMON_MAX_NAMES];
+    for (uint32_t i = 0; i < nameCount_; ++i)
+    {
+        names[i] = names_[i];
+    }
+    procscanInit(&scan_, names, nameCount_);
+
+    // listen before the first scan so nothing starts in between unseen
+    auto netlinkFd = procmonOpenNetlink();
+
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        stats_.backend = netlinkFd >= 0 ? PROCMON_BACKEND_NETLINK : PROCMON_BACKEND_SCAN;
+    }
+
+    procmonScan();
+
+    struct pollfd pollFds[PROCMON_MAX_PROCESSES + 2];
+    uint32_t indices[PROCMON_MAX_PROCESSES + 2];
+
+    while (isStopping_ == false)
+    {
+        pollFds[0] = {stopFd_, POLLIN, 0};
+        nfds_t count = 1;
+
+        if (netlinkFd >= 0)
+        {
+            pollFds[count++] = {netlinkFd, POLLIN, 0};
+        }
+
+        auto firstProcess = count;
+        for (uint32_t i = 0; i < processCount_; ++i)
+        {
+            if (processes_[i].handle >= 0)
+            {
+                pollFds[count] = {processes_[i].handle, POLLIN, 0};
+                indices[count] = i;
+                ++count;
+            }
+        }
+
+        auto result = poll(pollFds, count, netlinkFd >= 0 ? -1 : PROCMON_SCAN_MS);
+
+        {
+            std::lock_guard<std::mutex> guard(lock_);
+            ++stats_.wakeCount;
+        }
+
+        if (result < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            // drop the connector and carry on scanning rather than lose
+            // every event from here on. already scanning, a poll that keeps
+            // failing waits out the interval instead of spinning
+            logWrite(LOG_LEVEL_WARN, LOG_CODE_PROCMON_WAIT, errno, netlinkFd >= 0);
+            {
+                std::lock_guard<std::mutex> guard(lock_);
+                ++stats_.errorCount;
+                stats_.backend = PROCMON_BACKEND_SCAN;
+            }
+            if (netlinkFd >= 0)
+            {
+                close(netlinkFd);
+                netlinkFd = -1;
+            }
+            else
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(PROCMON_SCAN_MS));
+            }
+            procmonScan();
+            continue;
+        }
+
+        if (pollFds[0].revents != 0)
+        {
+            break;
+        }
+
+        if (result == 0)
+        {
+            procmonScan();
+            continue;
+        }
+
+        // exits first, the indices are stale after any removal
+        for (auto i = count; i-- > firstProcess;)
+        {
+            if (pollFds[i].revents != 0)
+            {
+                procmonRemove(indices[i]);
+            }
+        }
+
+        if (netlinkFd >= 0 &&
+            pollFds[1].revents != 0 &&
+            procmonReadNetlink(netlinkFd) == false)
+        {
+            procmonScan();
+        }
+    }
+
+    if (netlinkFd >= 0)
+    {
+        close(netlinkFd);
+    }
+
+    procscanDestroy(&scan_);
+}
+#endif
+
+bool procmonStart(
+    const char *const *names,
+    uint32_t count,
+    PROCMON_CALLBACK callback,
+    void *context)
+{
+    procmonStop();
+
+    if (count == 0 || count > PROCMON_MAX_NAMES)
+    {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        auto length = strlen(names[i]);
+        if (length == 0 || length >= PROCMON_MAX_NAME)
+        {
+            return false;
+        }
+        memcpy(names_[i], names[i], length + 1);
+
+#ifdef _WIN32
+        if (MultiByteToWideChar(CP_UTF8, 0, names[i], -1, wideNames_[i], PROCMON_MAX_NAME) == 0)
+        {
+            return false;
+        }
+#endif
+    }
+
+    nameCount_ = count;
+    callback_ = callback;
+    context_ = context;
+
+#ifdef _WIN32
+    stopEvent_ = CreateEventW(NULL, TRUE, FALSE, NULL);
+    if (stopEvent_ == NULL)
+    {
+        return false;
+    }
+#else
+    stopFd_ = eventfd(0, EFD_CLOEXEC);
+    if (stopFd_ < 0)
+    {
+        return false;
+    }
+#endif
+
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        memset(&stats_, 0, sizeof(stats_));
+        processCount_ = 0;
+    }
+
+    isStopping_ = false;
+    thread_ = new std::thread(procmonThreadRoutine);
+    return true;
+}
+
+void procmonStop(void)
+{
+    if (thread_ == NULL)
+    {
+        return;
+    }
+
+    isStopping_ = true;
+#ifdef _WIN32
+    SetEvent(stopEvent_);
+#else
+    uint64_t one = 1;
+    if (write(stopFd_, &one, sizeof(one)) != sizeof(one))
+    {
+        // the flag alone is seen within PROCMON_SCAN_MS or the next event
+    }
+#endif
+
+    thread_->join();
+    delete thread_;
+    thread_ = NULL;
+
+#ifdef _WIN32
+    CloseHandle(stopEvent_);
+    stopEvent_ = NULL;
+#else
+    close(stopFd_);
+    stopFd_ = -1;
+#endif
+
+    std::lock_guard<std::mutex> guard(lock_);
+    for (uint32_t i = 0; i < processCount_; ++i)
+    {
+        procmonCloseHandle(processes_[i].handle);
+    }
+    processCount_ = 0;
+    memset(&stats_, 0, sizeof(stats_));
+}
+
+bool procmonIsRunning(uint32_t nameIndex)
+{
+    std::lock_guard<std::mutex> guard(lock_);
+
+    for (uint32_t i = 0; i < processCount_; ++i)
+    {
+        if (processes_[i].nameIndex == nameIndex)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void procmonGetStats(PROCMON_STATS *stats)
+{
+    std::lock_guard<std::mutex> guard(lock_);
+    *stats = stats_;
+    stats->processCount = processCount_;
+}
+
+const char *procmonBackendName(PROCMON_BACKEND backend)
+{
+    if (backend >= PROCMON_BACKEND_COUNT)
+    {
+        return "unknown";
+    }
+
+    return backendNames_[backend];
+}
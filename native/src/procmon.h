@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stdint.h>
+
+// watches for executables by name and reports every instance that starts
+// or exits, from a thread of its own that sleeps in the kernel between
+// events. linux: the proc connector (netlink) for starts and pidfds for
+// exits, a /proc rescan every PROCMON_SCAN_MS where the connector isn't
+// available (it needs CAP_NET_ADMIN) or after a poll that failed. windows:
+// process handles for exits and a toolhelp snapshot every PROCMON_SCAN_MS
+// for starts, which win32 has no wait for short of wmi or etw.
+
+#define PROCMON_MAX_NAMES 16
+#define PROCMON_MAX_NAME 64
+#define PROCMON_MAX_PROCESSES 32
+#define PROCMON_SCAN_MS 50
+
+typedef enum _PROCMON_BACKEND
+{
+    PROCMON_BACKEND_NONE = 0, // not started
+    PROCMON_BACKEND_NETLINK,
+    PROCMON_BACKEND_SCAN,
+    PROCMON_BACKEND_COUNT
+} PROCMON_BACKEND;
+
+typedef struct _PROCMON_EVENT
+{
+    uint32_t pid;
+    uint32_t nameIndex;
+    bool isRunning;
+    char name[PROCMON_MAX_NAME]; // the watched name that matched
+} PROCMON_EVENT;
+
+// runs on the monitor thread
+typedef void (*PROCMON_CALLBACK)(const PROCMON_EVENT *event, void *context);
+
+typedef struct _PROCMON_STATS
+{
+    PROCMON_BACKEND backend;
+    uint32_t processCount; // watched instances running now
+    uint64_t wakeCount;
+    uint64_t scanCount;
+    uint64_t eventCount;
+    uint64_t errorCount; // waits that failed, each logged
+} PROCMON_STATS;
+
+// names match the executable case-insensitively, e.g. "VRChat.exe" or
+// "vrserver". stops a running monitor first; instances already running are
+// reported right after the start
+bool procmonStart(
+    const char *const *names,
+    uint32_t count,
+    PROCMON_CALLBACK callback,
+    void *context);
+void procmonStop(void);
+bool procmonIsRunning(uint32_t nameIndex);
+void procmonGetStats(PROCMON_STATS *stats);
+const char *procmonBackendName(PROCMON_BACKEND backend);
@@ -0,0 +1,411 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include "procscan.h"
+
+#define PROCSCAN_BUFFER_SIZE 32768
+#define PROCSCAN_INITIAL_CAPACITY 1024
+
+// struct linux_dirent64: u64 ino, s64 off, u16 reclen, u8 type, name
+#define PROCSCAN_DIRENT_INO 0
+#define PROCSCAN_DIRENT_RECLEN 16
+#define PROCSCAN_DIRENT_NAME 19
+
+static uint32_t procscanHash(uint32_t pid, uint32_t capacity)
+{
+    auto hash = pid * 0x9e3779b1u;
+    return (hash ^ (hash >> 16)) & (capacity - 1);
+}
+
+static PROCSCAN_ENTRY *procscanSlot(PROCSCAN_ENTRY *table, uint32_t capacity, uint32_t pid)
+{
+    auto index = procscanHash(pid, capacity);
+
+    while (table[index].pid != 0 && table[index].pid != pid)
+    {
+        index = (index + 1) & (capacity - 1);
+    }
+
+    return &table[index];
+}
+
+// moves the entries of the current generation into spare, then swaps
+static void procscanRebuild(PROCSCAN *scan)
+{
+    memset(scan->spare, 0, scan->capacity * sizeof(PROCSCAN_ENTRY));
+    scan->count = 0;
+
+    for (uint32_t i = 0; i < scan->capacity; ++i)
+    {
+        auto entry = &scan->table[i];
+        if (entry->pid != 0 && entry->generation == scan->generation)
+        {
+            *procscanSlot(scan->spare, scan->capacity, entry->pid) = *entry;
+            ++scan->count;
+        }
+    }
+
+    auto table = scan->table;
+    scan->table = scan->spare;
+    scan->spare = table;
+}
+
+static bool procscanGrow(PROCSCAN *scan, uint32_t capacity)
+{
+    auto table = (PROCSCAN_ENTRY *)calloc(capacity, sizeof(PROCSCAN_ENTRY));
+    auto spare = (PROCSCAN_ENTRY *)calloc(capacity, sizeof(PROCSCAN_ENTRY));
+    if (table == NULL || spare == NULL)
+    {
+        free(table);
+        free(spare);
+        return false;
+    }
+
+    for (uint32_t i = 0; i < scan->capacity; ++i)
+    {
+        auto entry = &scan->table[i];
+        if (entry->pid != 0)
+        {
+            *procscanSlot(table, capacity, entry->pid) = *entry;
+        }
+    }
+
+    free(scan->table);
+    free(scan->spare);
+    scan->table = table;
+    scan->spare = spare;
+    scan->capacity = capacity;
+    return true;
+}
+
+// comm and start time from /proc/<pid>/stat, false when it's gone
+static bool procscanReadStat(
+    PROCSCAN *scan,
+    uint32_t pid,
+    char *comm,
+    uint64_t *startTime)
+{
+    char path[16];
+    snprintf(path, sizeof(path), "%u/stat", pid);
+
+    ++scan->stats.openCount;
+
+    auto fd = openat(scan->procFd, path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    char text[512];
+    auto size = read(fd, text, sizeof(text) - 1);
+    close(fd);
+    if (size <= 0)
+    {
+        return false;
+    }
+    text[size] = '\0';
+
+    // "pid (comm) state ...", comm may itself hold spaces and parentheses
+    auto left = strchr(text, '(');
+    auto right = strrchr(text, ')');
+    if (left == NULL || right == NULL || right < left ||
+        right - left - 1 >= PROCSCAN_COMM_SIZE)
+    {
+        return false;
+    }
+
+    memcpy(comm, left + 1, right - left - 1);
+    comm[right - left - 1] = '\0';
+
+    // starttime is field 22, state the 3rd right after the parenthesis
+    auto p = right + 2;
+    for (uint32_t field = 3; field < 22; ++field)
+    {
+        p = strchr(p, ' ');
+        if (p == NULL)
+        {
+            return false;
+        }
+        ++p;
+    }
+
+    *startTime = strtoull(p, NULL, 10);
+    return true;
+}
+
+static void procscanSetPattern(
+    PROCSCAN *scan,
+    PROCSCAN_ENTRY *entry,
+    int32_t pattern,
+    PROCSCAN_CALLBACK callback,
+    void *context)
+{
+    if (entry->pattern == pattern)
+    {
+        return;
+    }
+
+    if (entry->pattern >= 0)
+    {
+        --scan->matchCounts[entry->pattern];
+        if (callback != NULL)
+        {
+            callback(entry->pid, (uint32_t)entry->pattern, false, context);
+        }
+    }
+
+    entry->pattern = pattern;
+
+    if (pattern >= 0)
+    {
+        ++scan->matchCounts[pattern];
+        if (callback != NULL)
+        {
+            callback(entry->pid, (uint32_t)pattern, true, context);
+        }
+    }
+}
+
+static void procscanIdentify(
+    PROCSCAN *scan,
+    PROCSCAN_ENTRY *entry,
+    uint64_t nowTicks,
+    PROCSCAN_CALLBACK callback,
+    void *context)
+{
+    char comm[PROCSCAN_COMM_SIZE];
+    uint64_t startTime;
+
+    // gone already, dropped by the next scan
+    if (procscanReadStat(scan, entry->pid, comm, &startTime) == false)
+    {
+        entry->isSettled = true;
+        procscanSetPattern(scan, entry, -1, callback, context);
+        return;
+    }
+
+    entry->startTime = startTime;
+    entry->isSettled =
+        nowTicks >= startTime &&
+        nowTicks - startTime >= scan->ticksPerSecond * PROCSCAN_SETTLE_MS / 1000;
+    procscanSetPattern(scan, entry, procscanMatch(scan, comm), callback, context);
+}
+
+bool procscanInit(PROCSCAN *scan, const char *const *names, uint32_t count)
+{
+    memset(scan, 0, sizeof(PROCSCAN));
+    scan->procFd = -1;
+
+    if (count > PROCSCAN_MAX_PATTERNS)
+    {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        auto length = strlen(names[i]);
+        if (length == 0)
+        {
+            return false;
+        }
+
+        // the kernel keeps 15 bytes of the name
+        if (length > PROCSCAN_COMM_SIZE - 1)
+        {
+            length = PROCSCAN_COMM_SIZE - 1;
+        }
+
+        for (size_t j = 0; j < length; ++j)
+        {
+            auto c = names[i][j];
+            scan->patterns[i][j] = c >= 'A' && c <= 'Z' ? (char)(c + 32) : c;
+        }
+        scan->patterns[i][length] = '\0';
+        scan->patternsByLength[length] |= 1u << i;
+    }
+    scan->patternCount = count;
+
+    auto ticks = sysconf(_SC_CLK_TCK);
+    scan->ticksPerSecond = ticks > 0 ? (uint64_t)ticks : 100;
+
+    scan->procFd = open("/proc", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    scan->buffer = (char *)malloc(PROCSCAN_BUFFER_SIZE);
+    if (scan->procFd < 0 ||
+        scan->buffer == NULL ||
+        procscanGrow(scan, PROCSCAN_INITIAL_CAPACITY) == false)
+    {
+        procscanDestroy(scan);
+        return false;
+    }
+
+    return true;
+}
+
+void procscanDestroy(PROCSCAN *scan)
+{
+    if (scan->procFd >= 0)
+    {
+        close(scan->procFd);
+    }
+
+    free(scan->buffer);
+    free(scan->table);
+    free(scan->spare);
+    memset(scan, 0, sizeof(PROCSCAN));
+    scan->procFd = -1;
+}
+
+bool procscanUpdate(PROCSCAN *scan, PROCSCAN_CALLBACK callback, void *context)
+{
+    if (lseek(scan->procFd, 0, SEEK_SET) != 0)
+    {
+        return false;
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_BOOTTIME, &now);
+    auto nowTicks =
+        (uint64_t)now.tv_sec * scan->ticksPerSecond +
+        (uint64_t)now.tv_nsec * scan->ticksPerSecond / 1000000000ull;
+
+    ++scan->generation;
+    scan->stats.entryCount = 0;
+
+    for (;;)
+    {
+        auto size = syscall(SYS_getdents64, scan->procFd, scan->buffer, PROCSCAN_BUFFER_SIZE);
+        if (size < 0)
+        {
+            return false;
+        }
+        if (size == 0)
+        {
+            break;
+        }
+
+        for (long offset = 0; offset < size;)
+        {
+            auto record = scan->buffer + offset;
+            uint16_t recordLength;
+            memcpy(&recordLength, record + PROCSCAN_DIRENT_RECLEN, sizeof(recordLength));
+            offset += recordLength;
+
+            // only the pid directories
+            auto name = record + PROCSCAN_DIRENT_NAME;
+            if (name[0] < '1' || name[0] > '9')
+            {
+                continue;
+            }
+
+            uint32_t pid = 0;
+            for (auto c = name; *c != '\0'; ++c)
+            {
+                pid = pid * 10 + (uint32_t)(*c - '0');
+            }
+
+            uint64_t inode;
+            memcpy(&inode, record + PROCSCAN_DIRENT_INO, sizeof(inode));
+
+            ++scan->stats.entryCount;
+
+            // stay at most half full
+            if ((scan->count + 1) * 2 > scan->capacity &&
+                procscanGrow(scan, scan->capacity * 2) == false)
+            {
+                return false;
+            }
+
+            auto entry = procscanSlot(scan->table, scan->capacity, pid);
+            if (entry->pid == 0)
+            {
+                entry->pid = pid;
+                entry->inode = inode;
+                entry->pattern = -1;
+                ++scan->count;
+                procscanIdentify(scan, entry, nowTicks, callback, context);
+            }
+            else if (entry->inode != inode)
+            {
+                // the pid went to another process since the last scan
+                procscanSetPattern(scan, entry, -1, callback, context);
+                entry->inode = inode;
+                procscanIdentify(scan, entry, nowTicks, callback, context);
+            }
+            else if (entry->isSettled == false)
+            {
+                procscanIdentify(scan, entry, nowTicks, callback, context);
+            }
+
+            entry->generation = scan->generation;
+        }
+    }
+
+    // whatever wasn't listed has exited
+    auto isExited = false;
+    for (uint32_t i = 0; i < scan->capacity; ++i)
+    {
+        auto entry = &scan->table[i];
+        if (entry->pid != 0 && entry->generation != scan->generation)
+        {
+            procscanSetPattern(scan, entry, -1, callback, context);
+            isExited = true;
+        }
+    }
+
+    if (isExited != false)
+    {
+        procscanRebuild(scan);
+    }
+
+    ++scan->stats.scanCount;
+    return true;
+}
+
+int32_t procscanMatch(const PROCSCAN *scan, const char *comm)
+{
+    char lower[PROCSCAN_COMM_SIZE];
+    size_t length = 0;
+
+    for (; comm[length] != '\0'; ++length)
+    {
+        if (length == PROCSCAN_COMM_SIZE - 1)
+        {
+            return -1;
+        }
+
+        auto c = comm[length];
+        lower[length] = c >= 'A' && c <= 'Z' ? (char)(c + 32) : c;
+    }
+    lower[length] = '\0';
+
+    for (auto mask = scan->patternsByLength[length]; mask != 0; mask &= mask - 1)
+    {
+        auto i = __builtin_ctz(mask);
+        if (memcmp(lower, scan->patterns[i], length) == 0)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+int32_t procscanGetPattern(const PROCSCAN *scan, uint32_t pid)
+{
+    if (scan->capacity == 0 || pid == 0)
+    {
+        return -1;
+    }
+
+    auto entry = procscanSlot(scan->table, scan->capacity, pid);
+    if (entry->pid != pid || entry->generation != scan->generation)
+    {
+        return -1;
+    }
+
+    return entry->pattern;
+}
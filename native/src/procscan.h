@@ -0,0 +1,65 @@
+#pragma once
+
+#include <stdint.h>
+
+// linux: finds processes by name without re-reading /proc/<pid> for ones
+// already known. a scan lists /proc with getdents64 into a buffer that is
+// kept, and only opens /proc/<pid>/stat for a pid it hasn't seen, or whose
+// directory inode changed because the pid was reused. processes younger
+// than PROCSCAN_SETTLE_MS are read again on the next scans since wine
+// renames them to the .exe only after starting. not thread safe.
+
+#define PROCSCAN_MAX_PATTERNS 16
+#define PROCSCAN_COMM_SIZE 16 // TASK_COMM_LEN, names are cut to 15 bytes
+#define PROCSCAN_SETTLE_MS 2000
+
+typedef struct _PROCSCAN_ENTRY
+{
+    uint32_t pid; // 0 = free slot
+    uint32_t generation; // of the scan that last listed it
+    uint64_t inode;      // of /proc/<pid>, new for every process
+    uint64_t startTime;  // clock ticks after boot
+    int32_t pattern;     // -1 when it matches none
+    bool isSettled;      // old enough that its name won't change
+} PROCSCAN_ENTRY;
+
+typedef struct _PROCSCAN_STATS
+{
+    uint64_t scanCount;
+    uint64_t openCount; // stat files read, what a naive scan does per pid
+    uint32_t entryCount; // processes listed by the last scan
+} PROCSCAN_STATS;
+
+typedef struct _PROCSCAN
+{
+    int procFd;
+    char *buffer; // getdents64
+    PROCSCAN_ENTRY *table; // open addressing by pid
+    PROCSCAN_ENTRY *spare; // rebuild target after exits
+    uint32_t capacity;     // power of two
+    uint32_t count;
+    uint32_t generation;
+    uint64_t ticksPerSecond;
+    // lower-cased, cut to 15 bytes, bucketed by length
+    char patterns[PROCSCAN_MAX_PATTERNS][PROCSCAN_COMM_SIZE];
+    uint32_t patternCount;
+    uint32_t patternsByLength[PROCSCAN_COMM_SIZE]; // bit per pattern
+    uint32_t matchCounts[PROCSCAN_MAX_PATTERNS];
+    PROCSCAN_STATS stats;
+} PROCSCAN;
+
+// a matching process appeared or went away
+typedef void (*PROCSCAN_CALLBACK)(
+    uint32_t pid,
+    uint32_t pattern,
+    bool isRunning,
+    void *context);
+
+bool procscanInit(PROCSCAN *scan, const char *const *names, uint32_t count);
+void procscanDestroy(PROCSCAN *scan);
+// callback may be NULL
+bool procscanUpdate(PROCSCAN *scan, PROCSCAN_CALLBACK callback, void *context);
+// the pattern a process name (comm) matches, -1 for none
+int32_t procscanMatch(const PROCSCAN *scan, const char *comm);
+// the pattern of a pid the last scan listed, -1 for none or not listed
+int32_t procscanGetPattern(const PROCSCAN *scan, uint32_t pid);
@@ -0,0 +1,118 @@
+#include <string.h>
+#include "props.h"
+
+void propsDefault(OVERLAY_PROPS *props)
+{
+    // a metre wide, a metre ahead and slightly below the eyes
+    static const float transform[12] = {
+        1.0f, 0.0f, 0.0f, 0.0f,
+        0.0f, 1.0f, 0.0f, -0.1f,
+        0.0f, 0.0f, 1.0f, -1.0f};
+
+    props->alpha = 0.9f;
+    props->widthInMeters = 1.0f;
+    memcpy(props->transform, transform, sizeof(transform));
+    props->color[0] = 1.0f;
+    props->color[1] = 1.0f;
+    props->color[2] = 1.0f;
+    props->sortOrder = 0;
+    props->isVisible = true;
+}
+
+bool propsIsValid(const OVERLAY_PROPS *props)
+{
+    // written so that nan fails too
+    if (!(props->alpha >= 0.0f && props->alpha <= 1.0f) ||
+        !(props->widthInMeters > 0.0f && props->widthInMeters <= 100.0f))
+    {
+        return false;
+    }
+
+    for (auto value : props->color)
+    {
+        if (!(value >= 0.0f && value <= 1.0f))
+        {
+            return false;
+        }
+    }
+
+    for (auto value : props->transform)
+    {
+        if (!(value >= -1000.0f && value <= 1000.0f))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+uint32_t propsDiff(const OVERLAY_PROPS *a, const OVERLAY_PROPS *b)
+{
+    uint32_t mask = 0;
+
+    if (a->alpha != b->alpha)
+    {
+        mask |= PROPS_ALPHA;
+    }
+
+    if (a->widthInMeters != b->widthInMeters)
+    {
+        mask |= PROPS_WIDTH;
+    }
+
+    if (memcmp(a->transform, b->transform, sizeof(a->transform)) != 0)
+    {
+        mask |= PROPS_TRANSFORM;
+    }
+
+    if (memcmp(a->color, b->color, sizeof(a->color)) != 0)
+    {
+        mask |= PROPS_COLOR;
+    }
+
+    if (a->sortOrder != b->sortOrder)
+    {
+        mask |= PROPS_SORT_ORDER;
+    }
+
+    if (a->isVisible != b->isVisible)
+    {
+        mask |= PROPS_VISIBLE;
+    }
+
+    return mask;
+}
+
+void propsBlockInit(PROPS_BLOCK *block)
+{
+    std::lock_guard<std::mutex> guard(block->lock);
+    propsDefault(&block->props);
+    block->version.store(0, std::memory_order_release);
+}
+
+void propsBlockGet(PROPS_BLOCK *block, OVERLAY_PROPS *props)
+{
+    std::lock_guard<std::mutex> guard(block->lock);
+    *props = block->props;
+}
+
+void propsBlockSet(PROPS_BLOCK *block, const OVERLAY_PROPS *props)
+{
+    std::lock_guard<std::mutex> guard(block->lock);
+    block->props = *props;
+    block->version.fetch_add(1, std::memory_order_release);
+}
+
+bool propsBlockTake(PROPS_BLOCK *block, OVERLAY_PROPS *props, uint32_t *version)
+{
+    if (block->version.load(std::memory_order_acquire) == *version)
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> guard(block->lock);
+    *props = block->props;
+    *version = block->version.load(std::memory_order_relaxed);
+    return true;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+
+// the runtime side of an overlay: what vrserver is told rather than what is
+// drawn. js writes the whole block, the overlay thread picks it up once per
+// tick and pushes only the properties that differ from what it applied
+// last, so an animation costs one IVROverlay call per changed property per
+// tick instead of one per js update.
+
+#define PROPS_ALPHA 0x01
+#define PROPS_WIDTH 0x02
+#define PROPS_TRANSFORM 0x04
+#define PROPS_COLOR 0x08
+#define PROPS_SORT_ORDER 0x10
+#define PROPS_VISIBLE 0x20
+#define PROPS_ALL 0x3f
+
+typedef struct _OVERLAY_PROPS
+{
+    float alpha;
+    float widthInMeters;
+    float transform[12]; // row-major 3x4 like HmdMatrix34_t, hmd relative
+    float color[3];      // rgb tint
+    uint32_t sortOrder;
+    bool isVisible; // an empty frame still hides the overlay
+} OVERLAY_PROPS;
+
+typedef struct _PROPS_BLOCK
+{
+    std::mutex lock;
+    OVERLAY_PROPS props;
+    std::atomic<uint32_t> version; // bumped by every propsBlockSet
+} PROPS_BLOCK;
+
+void propsDefault(OVERLAY_PROPS *props);
+bool propsIsValid(const OVERLAY_PROPS *props);
+// PROPS_* bits of what differs
+uint32_t propsDiff(const OVERLAY_PROPS *a, const OVERLAY_PROPS *b);
+void propsBlockInit(PROPS_BLOCK *block);
+void propsBlockGet(PROPS_BLOCK *block, OVERLAY_PROPS *props);
+void propsBlockSet(PROPS_BLOCK *block, const OVERLAY_PROPS *props);
+// copies the block out when it changed since *version; lock-free otherwise
+bool propsBlockTake(PROPS_BLOCK *block, OVERLAY_PROPS *props, uint32_t *version);
@@ -0,0 +1,215 @@
+#include <stdlib.h>
+#include <string.h>
+#include "frame.h"
+#include "platform.h"
+#include "record.h"
+
+#define PAINT_PAYLOAD_MAX (FRAME_SIZE / 4 * 5)
+
+static void paintCodecsExit(FRAME_CODEC *codecs)
+{
+    for (uint32_t i = 0; i < PAINT_TARGET_COUNT; ++i)
+    {
+        frameCodecExit(&codecs[i]);
+    }
+}
+
+static bool paintCodecsInit(FRAME_CODEC *codecs)
+{
+    for (uint32_t i = 0; i < PAINT_TARGET_COUNT; ++i)
+    {
+        if (frameCodecInit(&codecs[i]) == false)
+        {
+            paintCodecsExit(codecs);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool paintRecorderOpen(PAINT_RECORDER *recorder, FILE *file)
+{
+    memset(recorder, 0, sizeof(PAINT_RECORDER));
+
+    recorder->buffer = (uint8_t *)malloc(PAINT_PAYLOAD_MAX);
+    if (recorder->buffer == NULL)
+    {
+        return false;
+    }
+
+    if (paintCodecsInit(recorder->codecs) == false)
+    {
+        free(recorder->buffer);
+        recorder->buffer = NULL;
+        return false;
+    }
+
+    PAINT_FILE_HEADER header;
+    memset(&header, 0, sizeof(header));
+    header.magic = PAINT_FILE_MAGIC;
+    header.version = PAINT_FILE_VERSION;
+    header.frameWidth = FRAME_WIDTH;
+    header.frameHeight = FRAME_HEIGHT;
+
+    if (fwrite(&header, sizeof(header), 1, file) != 1)
+    {
+        paintCodecsExit(recorder->codecs);
+        free(recorder->buffer);
+        recorder->buffer = NULL;
+        return false;
+    }
+
+    recorder->file = file;
+    recorder->startNs = platformNowNs();
+
+    return true;
+}
+
+bool paintRecorderWrite(
+    PAINT_RECORDER *recorder,
+    uint32_t target,
+    const uint8_t *frame,
+    uint32_t x,
+    uint32_t y,
+    uint32_t width,
+    uint32_t height)
+{
+    if (recorder->file == NULL || target >= PAINT_TARGET_COUNT)
+    {
+        return false;
+    }
+
+    PAINT_RECORD_HEADER header;
+    memset(&header, 0, sizeof(header));
+    header.timeNs = platformNowNs() - recorder->startNs;
+    header.target = (uint8_t)target;
+    header.codec = PAINT_CODEC_FRAME;
+    header.x = (uint16_t)x;
+    header.y = (uint16_t)y;
+    header.width = (uint16_t)width;
+    header.height = (uint16_t)height;
+    header.payloadSize = frameEncode(
+        &recorder->codecs[target],
+        recorder->buffer,
+        frame,
+        x,
+        y,
+        width,
+        height);
+
+    if (fwrite(&header, sizeof(header), 1, recorder->file) != 1 ||
+        (header.payloadSize != 0 &&
+         fwrite(recorder->buffer, header.payloadSize, 1, recorder->file) != 1))
+    {
+        return false;
+    }
+
+    ++recorder->frameCount;
+    recorder->rawBytes += width * height * 4;
+    recorder->storedBytes += sizeof(header) + header.payloadSize;
+
+    return true;
+}
+
+void paintRecorderClose(PAINT_RECORDER *recorder)
+{
+    if (recorder->file != NULL)
+    {
+        fclose(recorder->file);
+        recorder->file = NULL;
+    }
+
+    if (recorder->buffer != NULL)
+    {
+        paintCodecsExit(recorder->codecs);
+        free(recorder->buffer);
+        recorder->buffer = NULL;
+    }
+}
+
+bool paintReaderOpen(PAINT_READER *reader, FILE *file)
+{
+    memset(reader, 0, sizeof(PAINT_READER));
+
+    PAINT_FILE_HEADER header;
+    if (fread(&header, sizeof(header), 1, file) != 1 ||
+        header.magic != PAINT_FILE_MAGIC ||
+        header.version != PAINT_FILE_VERSION ||
+        header.frameWidth != FRAME_WIDTH ||
+        header.frameHeight != FRAME_HEIGHT)
+    {
+        return false;
+    }
+
+    reader->payload = (uint8_t *)malloc(PAINT_PAYLOAD_MAX);
+    if (reader->payload == NULL)
+    {
+        return false;
+    }
+
+    if (paintCodecsInit(reader->codecs) == false)
+    {
+        free(reader->payload);
+        reader->payload = NULL;
+        return false;
+    }
+
+    reader->file = file;
+
+    return true;
+}
+
+int paintReaderNext(PAINT_READER *reader, PAINT_EVENT *event)
+{
+    PAINT_RECORD_HEADER header;
+
+    if (fread(&header, sizeof(header), 1, reader->file) != 1)
+    {
+        return feof(reader->file) != 0 ? 0 : -1;
+    }
+
+    if (header.codec != PAINT_CODEC_FRAME ||
+        header.target >= PAINT_TARGET_COUNT ||
+        header.payloadSize > PAINT_PAYLOAD_MAX ||
+        frameIsValidRect(header.x, header.y, header.width, header.height) == false ||
+        (header.payloadSize != 0 &&
+         fread(reader->payload, header.payloadSize, 1, reader->file) != 1) ||
+        frameDecode(
+            &reader->codecs[header.target],
+            reader->payload,
+            header.payloadSize,
+            header.x,
+            header.y,
+            header.width,
+            header.height) == false)
+    {
+        return -1;
+    }
+
+    event->timeNs = header.timeNs;
+    event->target = header.target;
+    event->x = header.x;
+    event->y = header.y;
+    event->width = header.width;
+    event->height = header.height;
+    event->frame = reader->codecs[header.target].reference;
+
+    return 1;
+}
+
+void paintReaderClose(PAINT_READER *reader)
+{
+    if (reader->file != NULL)
+    {
+        fclose(reader->file);
+        reader->file = NULL;
+    }
+
+    if (reader->payload != NULL)
+    {
+        paintCodecsExit(reader->codecs);
+        free(reader->payload);
+        reader->payload = NULL;
+    }
+}
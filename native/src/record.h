@@ -0,0 +1,82 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include "codec.h"
+
+// paint stream file: PAINT_FILE_HEADER followed by PAINT_RECORD_HEADER +
+// payload for every setOverlayFrameBuffer() call. the payload holds only
+// the dirty rect, encoded against the previous frame of the same target
+// (see codec.h). all fields are little endian.
+
+#define PAINT_FILE_MAGIC 0x544e5053u // "SPNT"
+#define PAINT_FILE_VERSION 2
+#define PAINT_TARGET_COUNT 2
+
+#define PAINT_CODEC_FRAME 1
+
+typedef struct _PAINT_FILE_HEADER
+{
+    uint32_t magic;
+    uint32_t version;
+    uint16_t frameWidth;
+    uint16_t frameHeight;
+    uint32_t reserved;
+} PAINT_FILE_HEADER;
+
+typedef struct _PAINT_RECORD_HEADER
+{
+    uint64_t timeNs; // since the start of the recording
+    uint8_t target;
+    uint8_t codec;
+    uint16_t reserved;
+    uint16_t x;
+    uint16_t y;
+    uint16_t width;
+    uint16_t height;
+    uint32_t payloadSize;
+} PAINT_RECORD_HEADER;
+
+typedef struct _PAINT_RECORDER
+{
+    FILE *file;
+    uint64_t startNs;
+    uint8_t *buffer;
+    FRAME_CODEC codecs[PAINT_TARGET_COUNT];
+    uint64_t frameCount;
+    uint64_t rawBytes;
+    uint64_t storedBytes;
+} PAINT_RECORDER;
+
+typedef struct _PAINT_READER
+{
+    FILE *file;
+    uint8_t *payload;
+    FRAME_CODEC codecs[PAINT_TARGET_COUNT];
+} PAINT_READER;
+
+typedef struct _PAINT_EVENT
+{
+    uint64_t timeNs;
+    uint32_t target;
+    uint32_t x;
+    uint32_t y;
+    uint32_t width;
+    uint32_t height;
+    const uint8_t *frame; // whole frame of the target with the rect applied
+} PAINT_EVENT;
+
+bool paintRecorderOpen(PAINT_RECORDER *recorder, FILE *file);
+bool paintRecorderWrite(
+    PAINT_RECORDER *recorder,
+    uint32_t target,
+    const uint8_t *frame,
+    uint32_t x,
+    uint32_t y,
+    uint32_t width,
+    uint32_t height);
+void paintRecorderClose(PAINT_RECORDER *recorder);
+
+bool paintReaderOpen(PAINT_READER *reader, FILE *file);
+int paintReaderNext(PAINT_READER *reader, PAINT_EVENT *event);
+void paintReaderClose(PAINT_READER *reader);
@@ -0,0 +1,391 @@
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "platform.h"
+#include "sampler.h"
+
+typedef struct _SAMPLER_PROCESS
+{
+    SAMPLER_PROCESS_INFO info;
+    bool isUsed;
+    uint64_t exitNs; // which exited slot to reuse first
+#ifdef _WIN32
+    HANDLE handle;
+#else
+    int statFd;
+    int statmFd;
+    int ioFd;
+#endif
+    uint64_t writeCount;
+    double samples[SAMPLER_RING_SIZE * SAMPLER_FIELD_COUNT];
+} SAMPLER_PROCESS;
+
+static std::mutex lock_; // guards everything below
+static std::condition_variable wake_;
+static std::thread *thread_; // created by samplerStart, joined and deleted by samplerStop
+static bool isStopping_;
+static SAMPLER_PROCESS processes_[SAMPLER_MAX_PROCESSES];
+static SAMPLER_STATS stats_;
+#ifndef _WIN32
+static double msPerTick_;
+static double pageSize_;
+#endif
+
+static void samplerClose(SAMPLER_PROCESS *process)
+{
+#ifdef _WIN32
+    if (process->handle != NULL)
+    {
+        CloseHandle(process->handle);
+        process->handle = NULL;
+    }
+#else
+    int *fds[] = {&process->statFd, &process->statmFd, &process->ioFd};
+    for (auto fd : fds)
+    {
+        if (*fd >= 0)
+        {
+            close(*fd);
+            *fd = -1;
+        }
+    }
+#endif
+}
+
+static bool samplerOpen(SAMPLER_PROCESS *process)
+{
+#ifdef _WIN32
+    process->handle = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, process->info.pid);
+    process->info.hasIo = process->handle != NULL;
+    return process->handle != NULL;
+#else
+    if (msPerTick_ == 0)
+    {
+        auto ticks = sysconf(_SC_CLK_TCK);
+        msPerTick_ = 1000.0 / (double)(ticks > 0 ? ticks : 100);
+        pageSize_ = (double)sysconf(_SC_PAGESIZE);
+    }
+
+    char path[32];
+    int *fds[] = {&process->statFd, &process->statmFd, &process->ioFd};
+    const char *files[] = {"stat", "statm", "io"};
+
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        snprintf(path, sizeof(path), "/proc/%u/%s", process->info.pid, files[i]);
+        *fds[i] = open(path, O_RDONLY | O_CLOEXEC);
+    }
+
+    process->info.hasIo = process->ioFd >= 0;
+    return process->statFd >= 0 && process->statmFd >= 0;
+#endif
+}
+
+#ifndef _WIN32
+// the file from the start, the fd stays open for the next sample
+static bool samplerReadFd(int fd, char *text, size_t size)
+{
+    auto length = pread(fd, text, size - 1, 0);
+    if (length <= 0)
+    {
+        return false;
+    }
+
+    text[length] = '\0';
+    return true;
+}
+
+static uint64_t samplerParseAfter(const char *text, const char *key)
+{
+    auto p = strstr(text, key);
+    return p != NULL ? strtoull(p + strlen(key), NULL, 10) : 0;
+}
+#endif
+
+static bool samplerTake(SAMPLER_PROCESS *process, double *row)
+{
+#ifdef _WIN32
+    FILETIME createdAt, exitedAt, kernel, user;
+    PROCESS_MEMORY_COUNTERS memory;
+    IO_COUNTERS io;
+
+    if (GetProcessTimes(process->handle, &createdAt, &exitedAt, &kernel, &user) == FALSE ||
+        K32GetProcessMemoryInfo(process->handle, &memory, sizeof(memory)) == FALSE ||
+        GetProcessIoCounters(process->handle, &io) == FALSE)
+    {
+        return false;
+    }
+
+    // 100ns units
+    auto cpu =
+        (((uint64_t)kernel.dwHighDateTime << 32) | kernel.dwLowDateTime) +
+        (((uint64_t)user.dwHighDateTime << 32) | user.dwLowDateTime);
+
+    row[SAMPLER_FIELD_CPU_MS] = (double)cpu / 10000.0;
+    row[SAMPLER_FIELD_RSS_BYTES] = (double)memory.WorkingSetSize;
+    row[SAMPLER_FIELD_THREADS] = 0;
+    row[SAMPLER_FIELD_READ_BYTES] = (double)io.ReadTransferCount;
+    row[SAMPLER_FIELD_WRITE_BYTES] = (double)io.WriteTransferCount;
+    return true;
+#else
+    char text[1024];
+
+    // "pid (comm) state ...", utime and stime are fields 14 and 15, threads 20
+    if (samplerReadFd(process->statFd, text, sizeof(text)) == false)
+    {
+        return false;
+    }
+
+    auto p = strrchr(text, ')');
+    if (p == NULL)
+    {
+        return false;
+    }
+
+    uint64_t fields[21] = {};
+    for (uint32_t field = 3; field <= 20; ++field)
+    {
+        p = strchr(p, ' ');
+        if (p == NULL)
+        {
+            return false;
+        }
+        fields[field] = strtoull(++p, NULL, 10);
+    }
+
+    row[SAMPLER_FIELD_CPU_MS] = (double)(fields[14] + fields[15]) * msPerTick_;
+    row[SAMPLER_FIELD_THREADS] = (double)fields[20];
+
+    // "size resident shared ..." in pages
+    if (samplerReadFd(process->statmFd, text, sizeof(text)) == false)
+    {
+        return false;
+    }
+
+    p = strchr(text, ' ');
+    row[SAMPLER_FIELD_RSS_BYTES] = p != NULL ? (double)strtoull(p + 1, NULL, 10) * pageSize_ : 0;
+
+    row[SAMPLER_FIELD_READ_BYTES] = 0;
+    row[SAMPLER_FIELD_WRITE_BYTES] = 0;
+    if (process->ioFd >= 0 && samplerReadFd(process->ioFd, text, sizeof(text)) != false)
+    {
+        // "\n" keeps cancelled_write_bytes from matching
+        row[SAMPLER_FIELD_READ_BYTES] = (double)samplerParseAfter(text, "\nread_bytes: ");
+        row[SAMPLER_FIELD_WRITE_BYTES] = (double)samplerParseAfter(text, "\nwrite_bytes: ");
+    }
+
+    return true;
+#endif
+}
+
+static void samplerSampleLocked(void)
+{
+    auto startNs = platformNowNs();
+
+    for (auto &process : processes_)
+    {
+        if (process.isUsed == false || process.info.isRunning == false)
+        {
+            continue;
+        }
+
+        auto row = &process.samples[(process.writeCount & (SAMPLER_RING_SIZE - 1)) * SAMPLER_FIELD_COUNT];
+        if (samplerTake(&process, row) == false)
+        {
+            ++stats_.failCount;
+            continue;
+        }
+
+        row[SAMPLER_FIELD_TIME_MS] = (double)platformNowNs() / 1e6;
+        ++process.writeCount;
+        ++stats_.sampleCount;
+    }
+
+    stats_.sampleNs += platformNowNs() - startNs;
+}
+
+static void samplerThreadRoutine(void)
+{
+    std::unique_lock<std::mutex> guard(lock_);
+
+    while (isStopping_ == false)
+    {
+        samplerSampleLocked();
+        wake_.wait_for(guard, std::chrono::milliseconds(stats_.intervalMs));
+    }
+}
+
+bool samplerStart(uint32_t intervalMs)
+{
+    samplerStop();
+
+    if (intervalMs < SAMPLER_MIN_INTERVAL_MS)
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> guard(lock_);
+    stats_.intervalMs = intervalMs;
+    isStopping_ = false;
+    thread_ = new std::thread(samplerThreadRoutine);
+    return true;
+}
+
+void samplerStop(void)
+{
+    if (thread_ == NULL)
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        isStopping_ = true;
+    }
+    wake_.notify_one();
+
+    thread_->join();
+    delete thread_;
+    thread_ = NULL;
+
+    std::lock_guard<std::mutex> guard(lock_);
+    stats_.intervalMs = 0;
+}
+
+void samplerTrack(uint32_t pid, const char *name, bool isRunning)
+{
+    std::lock_guard<std::mutex> guard(lock_);
+
+    SAMPLER_PROCESS *slot = NULL;
+    for (auto &process : processes_)
+    {
+        if (process.isUsed != false && process.info.isRunning != false && process.info.pid == pid)
+        {
+            slot = &process;
+            break;
+        }
+    }
+
+    if (isRunning == false)
+    {
+        if (slot != NULL)
+        {
+            samplerClose(slot);
+            slot->info.isRunning = false;
+            slot->exitNs = platformNowNs();
+        }
+        return;
+    }
+
+    if (slot != NULL)
+    {
+        return;
+    }
+
+    // a free slot, else the one that exited first
+    for (auto &process : processes_)
+    {
+        if (process.isUsed == false)
+        {
+            slot = &process;
+            break;
+        }
+
+        if (process.info.isRunning == false && (slot == NULL || process.exitNs < slot->exitNs))
+        {
+            slot = &process;
+        }
+    }
+
+    if (slot == NULL)
+    {
+        ++stats_.failCount;
+        return;
+    }
+
+    memset(&slot->info, 0, sizeof(slot->info));
+    slot->info.pid = pid;
+    snprintf(slot->info.name, sizeof(slot->info.name), "%s", name);
+#ifdef _WIN32
+    slot->handle = NULL;
+#else
+    slot->statFd = -1;
+    slot->statmFd = -1;
+    slot->ioFd = -1;
+#endif
+    slot->writeCount = 0;
+    slot->isUsed = true;
+
+    if (samplerOpen(slot) == false)
+    {
+        // gone already
+        samplerClose(slot);
+        slot->isUsed = false;
+        ++stats_.failCount;
+        return;
+    }
+
+    slot->info.isRunning = true;
+}
+
+void samplerSample(void)
+{
+    std::lock_guard<std::mutex> guard(lock_);
+    samplerSampleLocked();
+}
+
+bool samplerRead(uint32_t index, SAMPLER_PROCESS_INFO *info, double *samples, uint32_t *count)
+{
+    std::lock_guard<std::mutex> guard(lock_);
+
+    if (index >= SAMPLER_MAX_PROCESSES || processes_[index].isUsed == false)
+    {
+        return false;
+    }
+
+    auto process = &processes_[index];
+    *info = process->info;
+
+    auto rows = process->writeCount < SAMPLER_RING_SIZE ? (uint32_t)process->writeCount : SAMPLER_RING_SIZE;
+    auto first = (uint32_t)(process->writeCount - rows) & (SAMPLER_RING_SIZE - 1);
+
+    // oldest first, in at most two runs
+    auto head = SAMPLER_RING_SIZE - first < rows ? SAMPLER_RING_SIZE - first : rows;
+    memcpy(
+        samples,
+        &process->samples[first * SAMPLER_FIELD_COUNT],
+        head * SAMPLER_FIELD_COUNT * sizeof(double));
+    memcpy(
+        samples + head * SAMPLER_FIELD_COUNT,
+        process->samples,
+        (rows - head) * SAMPLER_FIELD_COUNT * sizeof(double));
+
+    *count = rows;
+    return true;
+}
+
+void samplerGetStats(SAMPLER_STATS *stats)
+{
+    std::lock_guard<std::mutex> guard(lock_);
+    *stats = stats_;
+
+    stats->processCount = 0;
+    for (auto &process : processes_)
+    {
+        if (process.isUsed != false && process.info.isRunning != false)
+        {
+            ++stats->processCount;
+        }
+    }
+}
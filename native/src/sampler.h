@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stdint.h>
+
+// samples cpu time, memory, threads and i/o of the processes the process
+// monitor reports (the game and the vr runtime) every intervalMs, from a
+// thread of its own, into a ring per process. linux keeps
+// /proc/<pid>/stat, statm and io open and preads them, windows keeps a
+// process handle. exited processes keep their ring until the slot is needed
+
+#define SAMPLER_MAX_PROCESSES 8
+#define SAMPLER_RING_SIZE 512 // samples per process, power of two
+#define SAMPLER_MAX_NAME 64
+#define SAMPLER_MIN_INTERVAL_MS 10
+
+// columns of a sample, a row is SAMPLER_FIELD_COUNT doubles
+typedef enum _SAMPLER_FIELD
+{
+    SAMPLER_FIELD_TIME_MS = 0, // platformNowNs
+    SAMPLER_FIELD_CPU_MS,      // user + kernel since the process started
+    SAMPLER_FIELD_RSS_BYTES,
+    SAMPLER_FIELD_THREADS,     // 0 on windows, not sampled
+    SAMPLER_FIELD_READ_BYTES,  // from storage on linux, all i/o on windows
+    SAMPLER_FIELD_WRITE_BYTES,
+    SAMPLER_FIELD_COUNT
+} SAMPLER_FIELD;
+
+typedef struct _SAMPLER_PROCESS_INFO
+{
+    uint32_t pid;
+    bool isRunning;
+    bool hasIo; // linux: io is only readable for processes of the same user
+    char name[SAMPLER_MAX_NAME];
+} SAMPLER_PROCESS_INFO;
+
+typedef struct _SAMPLER_STATS
+{
+    uint32_t intervalMs; // 0 when not sampling on a timer
+    uint32_t processCount; // running ones
+    uint64_t sampleCount;
+    uint64_t failCount;
+    uint64_t sampleNs; // spent taking samples, all processes
+} SAMPLER_STATS;
+
+// stops a running sampler first
+bool samplerStart(uint32_t intervalMs);
+void samplerStop(void);
+// from the process monitor's callback, any thread
+void samplerTrack(uint32_t pid, const char *name, bool isRunning);
+// one sample of every running process now, what the thread does per tick
+void samplerSample(void);
+// copies slot index oldest first into samples (room for SAMPLER_RING_SIZE
+// rows), false for an empty slot
+bool samplerRead(uint32_t index, SAMPLER_PROCESS_INFO *info, double *samples, uint32_t *count);
+void samplerGetStats(SAMPLER_STATS *stats);
@@ -0,0 +1,512 @@
+#include <string.h>
+#if defined(_M_X64) || defined(__x86_64__)
+#include <immintrin.h>
+#define SCALE_X64
+#endif
+#include "compositor.h"
+#include "platform.h"
+#include "scale.h"
+
+#ifdef _MSC_VER
+#define SCALE_TARGET_AVX2
+#else
+#define SCALE_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+static const char *filterNames_[SCALE_FILTER_COUNT] = {"box", "bilinear"};
+
+static void scaleBox2xScalar(
+    uint8_t *target,
+    const uint8_t *source,
+    uint32_t width,
+    uint32_t height)
+{
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        auto row0 = source + y * 2 * FRAME_STRIDE;
+        auto row1 = row0 + FRAME_STRIDE;
+        auto out = target + y * FRAME_STRIDE;
+
+        for (uint32_t i = 0; i < width * 4; ++i)
+        {
+            auto c = i & 3;
+            auto s = (i - c) * 2 + c;
+            out[i] = (uint8_t)((row0[s] + row0[s + 4] + row1[s] + row1[s + 4] + 2) >> 2);
+        }
+    }
+}
+
+static void scaleBox4xScalar(
+    uint8_t *target,
+    const uint8_t *source,
+    uint32_t width,
+    uint32_t height)
+{
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        auto rows = source + y * 4 * FRAME_STRIDE;
+        auto out = target + y * FRAME_STRIDE;
+
+        for (uint32_t i = 0; i < width * 4; ++i)
+        {
+            auto c = i & 3;
+            auto s = (i - c) * 4 + c;
+            uint32_t sum = 8;
+            for (uint32_t r = 0; r < 4; ++r)
+            {
+                auto row = rows + r * FRAME_STRIDE + s;
+                sum += row[0] + row[4] + row[8] + row[12];
+            }
+            out[i] = (uint8_t)(sum >> 4);
+        }
+    }
+}
+
+static void scaleBilinearRowScalar(
+    uint8_t *target,
+    const uint8_t *row0,
+    const uint8_t *row1,
+    const uint16_t *sx,
+    const uint16_t *fx,
+    uint32_t fy,
+    uint32_t count)
+{
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        auto p0 = row0 + sx[i] * 4;
+        auto p1 = row1 + sx[i] * 4;
+        uint32_t wx = fx[i];
+
+        for (uint32_t c = 0; c < 4; ++c)
+        {
+            auto top = (p0[c] * (256 - wx) + p0[c + 4] * wx + 128) >> 8;
+            auto bottom = (p1[c] * (256 - wx) + p1[c + 4] * wx + 128) >> 8;
+            target[i * 4 + c] = (uint8_t)((top * (256 - fy) + bottom * fy + 128) >> 8);
+        }
+    }
+}
+
+#ifdef SCALE_X64
+
+// 8 u16 lanes holding pixels [a, b] -> [a + b] in the low half
+static inline __m128i scaleFoldSse2(__m128i x)
+{
+    return _mm_add_epi16(x, _mm_srli_si128(x, 8));
+}
+
+static void scaleBox2xSse2(
+    uint8_t *target,
+    const uint8_t *source,
+    uint32_t width,
+    uint32_t height)
+{
+    auto zero = _mm_setzero_si128();
+    auto round = _mm_set1_epi16(2);
+
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        auto row0 = source + y * 2 * FRAME_STRIDE;
+        auto row1 = row0 + FRAME_STRIDE;
+        auto out = target + y * FRAME_STRIDE;
+
+        uint32_t x = 0;
+        for (; x + 4 <= width; x += 4)
+        {
+            __m128i sums[2];
+            for (uint32_t half = 0; half < 2; ++half)
+            {
+                auto a = _mm_loadu_si128((const __m128i *)(row0 + (x + half * 2) * 8));
+                auto b = _mm_loadu_si128((const __m128i *)(row1 + (x + half * 2) * 8));
+                auto lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+                auto hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+                // even and odd source pixels side by side
+                sums[half] = _mm_add_epi16(
+                    _mm_unpacklo_epi64(lo, hi),
+                    _mm_unpackhi_epi64(lo, hi));
+            }
+
+            auto d0 = _mm_srli_epi16(_mm_add_epi16(sums[0], round), 2);
+            auto d1 = _mm_srli_epi16(_mm_add_epi16(sums[1], round), 2);
+            _mm_storeu_si128((__m128i *)(out + x * 4), _mm_packus_epi16(d0, d1));
+        }
+
+        if (x < width)
+        {
+            scaleBox2xScalar(out + x * 4, row0 + x * 8, width - x, 1);
+        }
+    }
+}
+
+static void scaleBox4xSse2(
+    uint8_t *target,
+    const uint8_t *source,
+    uint32_t width,
+    uint32_t height)
+{
+    auto zero = _mm_setzero_si128();
+    auto round = _mm_set1_epi16(8);
+
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        auto rows = source + y * 4 * FRAME_STRIDE;
+        auto out = target + y * FRAME_STRIDE;
+
+        uint32_t x = 0;
+        for (; x + 2 <= width; x += 2)
+        {
+            __m128i sums[2];
+            for (uint32_t half = 0; half < 2; ++half)
+            {
+                auto lo = zero;
+                auto hi = zero;
+                for (uint32_t r = 0; r < 4; ++r)
+                {
+                    auto p = _mm_loadu_si128((const __m128i *)(rows + r * FRAME_STRIDE + (x + half) * 16));
+                    lo = _mm_add_epi16(lo, _mm_unpacklo_epi8(p, zero));
+                    hi = _mm_add_epi16(hi, _mm_unpackhi_epi8(p, zero));
+                }
+                sums[half] = scaleFoldSse2(_mm_add_epi16(lo, hi));
+            }
+
+            auto d = _mm_srli_epi16(
+                _mm_add_epi16(_mm_unpacklo_epi64(sums[0], sums[1]), round),
+                4);
+            _mm_storel_epi64((__m128i *)(out + x * 4), _mm_packus_epi16(d, zero));
+        }
+
+        if (x < width)
+        {
+            scaleBox4xScalar(out + x * 4, rows + x * 16, width - x, 1);
+        }
+    }
+}
+
+static void scaleBilinearRowSse2(
+    uint8_t *target,
+    const uint8_t *row0,
+    const uint8_t *row1,
+    const uint16_t *sx,
+    const uint16_t *fx,
+    uint32_t fy,
+    uint32_t count)
+{
+    auto zero = _mm_setzero_si128();
+    auto round = _mm_set1_epi16(128);
+    auto wy = _mm_set_epi16(
+        (short)fy, (short)fy, (short)fy, (short)fy,
+        (short)(256 - fy), (short)(256 - fy), (short)(256 - fy), (short)(256 - fy));
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        auto wx0 = (short)(256 - fx[i]);
+        auto wx1 = (short)fx[i];
+        auto wx = _mm_set_epi16(wx1, wx1, wx1, wx1, wx0, wx0, wx0, wx0);
+
+        // the pixel and its right neighbour are adjacent, one 8 byte load
+        auto p0 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(row0 + sx[i] * 4)), zero);
+        auto p1 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(row1 + sx[i] * 4)), zero);
+        auto top = _mm_srli_epi16(_mm_add_epi16(scaleFoldSse2(_mm_mullo_epi16(p0, wx)), round), 8);
+        auto bottom = _mm_srli_epi16(_mm_add_epi16(scaleFoldSse2(_mm_mullo_epi16(p1, wx)), round), 8);
+
+        auto v = _mm_mullo_epi16(_mm_unpacklo_epi64(top, bottom), wy);
+        v = _mm_srli_epi16(_mm_add_epi16(scaleFoldSse2(v), round), 8);
+        auto pixel = _mm_cvtsi128_si32(_mm_packus_epi16(v, zero));
+        memcpy(target + i * 4, &pixel, 4);
+    }
+}
+
+SCALE_TARGET_AVX2 static void scaleBox2xAvx2(
+    uint8_t *target,
+    const uint8_t *source,
+    uint32_t width,
+    uint32_t height)
+{
+    auto zero = _mm256_setzero_si256();
+    auto round = _mm256_set1_epi16(2);
+
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        auto row0 = source + y * 2 * FRAME_STRIDE;
+        auto row1 = row0 + FRAME_STRIDE;
+        auto out = target + y * FRAME_STRIDE;
+
+        uint32_t x = 0;
+        for (; x + 8 <= width; x += 8)
+        {
+            __m256i sums[2];
+            for (uint32_t half = 0; half < 2; ++half)
+            {
+                auto a = _mm256_loadu_si256((const __m256i *)(row0 + (x + half * 4) * 8));
+                auto b = _mm256_loadu_si256((const __m256i *)(row1 + (x + half * 4) * 8));
+                auto lo = _mm256_add_epi16(_mm256_unpacklo_epi8(a, zero), _mm256_unpacklo_epi8(b, zero));
+                auto hi = _mm256_add_epi16(_mm256_unpackhi_epi8(a, zero), _mm256_unpackhi_epi8(b, zero));
+                sums[half] = _mm256_add_epi16(
+                    _mm256_unpacklo_epi64(lo, hi),
+                    _mm256_unpackhi_epi64(lo, hi));
+            }
+
+            auto d0 = _mm256_srli_epi16(_mm256_add_epi16(sums[0], round), 2);
+            auto d1 = _mm256_srli_epi16(_mm256_add_epi16(sums[1], round), 2);
+            // packs interleave the lanes, put the pixels back in order
+            auto d = _mm256_permute4x64_epi64(_mm256_packus_epi16(d0, d1), 0xd8);
+            _mm256_storeu_si256((__m256i *)(out + x * 4), d);
+        }
+
+        if (x < width)
+        {
+            scaleBox2xSse2(out + x * 4, row0 + x * 8, width - x, 1);
+        }
+    }
+}
+
+#endif
+
+static const SCALE_KERNELS scalarKernels_ = {
+    scaleBox2xScalar,
+    scaleBox4xScalar,
+    scaleBilinearRowScalar};
+
+#ifdef SCALE_X64
+static const SCALE_KERNELS sse2Kernels_ = {
+    scaleBox2xSse2,
+    scaleBox4xSse2,
+    scaleBilinearRowSse2};
+
+// box4x and bilinear are bound by loads and gathers, the wider registers
+// don't pay for themselves there
+static const SCALE_KERNELS avx2Kernels_ = {
+    scaleBox2xAvx2,
+    scaleBox4xSse2,
+    scaleBilinearRowSse2};
+#endif
+
+const SCALE_KERNELS *scaleGetKernels(PIXEL_ISA isa)
+{
+    if (isa > pixelDetectIsa())
+    {
+        return NULL;
+    }
+
+    switch (isa)
+    {
+    case PIXEL_ISA_SCALAR:
+        return &scalarKernels_;
+#ifdef SCALE_X64
+    case PIXEL_ISA_SSE2:
+        return &sse2Kernels_;
+    case PIXEL_ISA_AVX2:
+        return &avx2Kernels_;
+#endif
+    default:
+        return NULL;
+    }
+}
+
+static const SCALE_KERNELS *kernels_ = scaleGetKernels(pixelDetectIsa());
+
+const char *scaleFilterName(SCALE_FILTER filter)
+{
+    if (filter >= SCALE_FILTER_COUNT)
+    {
+        return "unknown";
+    }
+    return filterNames_[filter];
+}
+
+static bool scaleRectIsValid(const SCALE_RECT *rect)
+{
+    return frameIsValidRect(rect->x, rect->y, rect->width, rect->height);
+}
+
+bool overlayDeriveIsValid(const OVERLAY_DERIVE *derive)
+{
+    auto crop = &derive->crop;
+    auto place = &derive->place;
+
+    if (scaleRectIsValid(crop) == false || scaleRectIsValid(place) == false)
+    {
+        return false;
+    }
+
+    if (derive->filter == SCALE_FILTER_BOX)
+    {
+        auto factor = crop->width / place->width;
+        return (factor == 2 || factor == 4) &&
+               crop->width == place->width * factor &&
+               crop->height == place->height * factor;
+    }
+
+    // bilinear reads a 2x2 neighbourhood
+    return derive->filter == SCALE_FILTER_BILINEAR &&
+           crop->width >= 2 && crop->height >= 2;
+}
+
+// 16.16 sample position of target pixel i, centres aligned
+static inline void scaleBilinearTap(
+    uint32_t i,
+    uint32_t step,
+    uint32_t sourceSize,
+    uint16_t *s,
+    uint16_t *f)
+{
+    auto pos = (int64_t)i * step + step / 2 - 0x8000;
+    if (pos < 0)
+    {
+        pos = 0;
+    }
+
+    auto index = (uint32_t)(pos >> 16);
+    auto weight = (uint32_t)(pos >> 8) & 0xff;
+
+    // keep the right/bottom neighbour inside the crop
+    if (index >= sourceSize - 1)
+    {
+        index = sourceSize - 2;
+        weight = 256;
+    }
+
+    *s = (uint16_t)index;
+    *f = (uint16_t)weight;
+}
+
+// target region in place coordinates: [x, x + width) x [y, y + height)
+static void scaleResample(
+    const OVERLAY_DERIVE *derive,
+    const uint8_t *source,
+    uint8_t *target,
+    uint32_t x,
+    uint32_t y,
+    uint32_t width,
+    uint32_t height)
+{
+    auto crop = &derive->crop;
+    auto place = &derive->place;
+
+    target += ((place->y + y) * FRAME_WIDTH + place->x + x) * 4;
+
+    if (derive->filter == SCALE_FILTER_BOX)
+    {
+        auto factor = crop->width / place->width;
+        source += ((crop->y + y * factor) * FRAME_WIDTH + crop->x + x * factor) * 4;
+
+        if (factor == 2)
+        {
+            kernels_->box2x(target, source, width, height);
+        }
+        else
+        {
+            kernels_->box4x(target, source, width, height);
+        }
+        return;
+    }
+
+    uint16_t sx[FRAME_WIDTH];
+    uint16_t fx[FRAME_WIDTH];
+    auto stepX = (uint32_t)(((uint64_t)crop->width << 16) / place->width);
+    auto stepY = (uint32_t)(((uint64_t)crop->height << 16) / place->height);
+
+    for (uint32_t i = 0; i < width; ++i)
+    {
+        scaleBilinearTap(x + i, stepX, crop->width, &sx[i], &fx[i]);
+    }
+
+    source += (crop->y * FRAME_WIDTH + crop->x) * 4;
+
+    for (uint32_t j = 0; j < height; ++j)
+    {
+        uint16_t sy;
+        uint16_t fy;
+        scaleBilinearTap(y + j, stepY, crop->height, &sy, &fy);
+
+        auto row0 = source + sy * FRAME_STRIDE;
+        kernels_->bilinear(
+            target + j * FRAME_STRIDE,
+            row0,
+            row0 + FRAME_STRIDE,
+            sx,
+            fx,
+            fy,
+            width);
+    }
+}
+
+// [start, end) of source pixels to the target pixels they can touch, one
+// pixel of slack on each side covers the bilinear footprint
+static inline void scaleMapSpan(
+    uint32_t start,
+    uint32_t end,
+    uint32_t sourceSize,
+    uint32_t targetSize,
+    uint32_t *targetStart,
+    uint32_t *targetEnd)
+{
+    auto first = start > 0 ? start - 1 : 0;
+    auto last = end + 1;
+
+    *targetStart = (uint32_t)((uint64_t)first * targetSize / sourceSize);
+    auto stop = (uint32_t)(((uint64_t)last * targetSize + sourceSize - 1) / sourceSize) + 1;
+    *targetEnd = stop < targetSize ? stop : targetSize;
+}
+
+void overlayDeriveRefresh(
+    const OVERLAY_DERIVE *derive,
+    const OVERLAY_DATA *source,
+    OVERLAY_DATA *target)
+{
+    auto place = &derive->place;
+
+    auto page = compositorPage(target);
+
+    // nothing outside the placement belongs to the derived overlay
+    memset(page, 0, FRAME_SIZE);
+
+    scaleResample(
+        derive,
+        (const uint8_t *)source->data,
+        page,
+        0,
+        0,
+        place->width,
+        place->height);
+
+    compositorDamage(target, 0, 0, FRAME_WIDTH, FRAME_HEIGHT);
+}
+
+NOINLINE void overlayDeriveUpdate(
+    const OVERLAY_DERIVE *derive,
+    const OVERLAY_DATA *source,
+    OVERLAY_DATA *target,
+    uint32_t x,
+    uint32_t y,
+    uint32_t width,
+    uint32_t height)
+{
+    auto crop = &derive->crop;
+    auto place = &derive->place;
+
+    // dirty rect clipped to the crop, relative to it
+    auto x0 = x > crop->x ? x - crop->x : 0;
+    auto y0 = y > crop->y ? y - crop->y : 0;
+    auto x1 = x + width < crop->x + crop->width ? x + width - crop->x : crop->width;
+    auto y1 = y + height < crop->y + crop->height ? y + height - crop->y : crop->height;
+
+    if (x + width <= crop->x || y + height <= crop->y || x0 >= x1 || y0 >= y1)
+    {
+        return;
+    }
+
+    uint32_t tx0, tx1, ty0, ty1;
+    scaleMapSpan(x0, x1, crop->width, place->width, &tx0, &tx1);
+    scaleMapSpan(y0, y1, crop->height, place->height, &ty0, &ty1);
+
+    scaleResample(
+        derive,
+        (const uint8_t *)source->data,
+        compositorPage(target),
+        tx0,
+        ty0,
+        tx1 - tx0,
+        ty1 - ty0);
+
+    compositorDamage(target, place->x + tx0, place->y + ty0, tx1 - tx0, ty1 - ty0);
+}
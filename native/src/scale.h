@@ -0,0 +1,76 @@
+#pragma once
+
+#include <stdint.h>
+#include "frame.h"
+#include "pixel.h"
+
+// derives one overlay from a region of another, so a single rendered page
+// can feed several overlays. only the part of the target that a dirty rect
+// of the source can affect is resampled.
+
+typedef enum _SCALE_FILTER
+{
+    SCALE_FILTER_BOX = 0, // exact 2x or 4x reduction, averages each block
+    SCALE_FILTER_BILINEAR,  // any ratio
+    SCALE_FILTER_COUNT
+} SCALE_FILTER;
+
+typedef struct _SCALE_RECT
+{
+    uint32_t x;
+    uint32_t y;
+    uint32_t width;
+    uint32_t height;
+} SCALE_RECT;
+
+typedef struct _OVERLAY_DERIVE
+{
+    bool isEnabled;
+    uint32_t source; // overlay target the frame is taken from
+    SCALE_RECT crop;  // in the source frame
+    SCALE_RECT place; // in the derived frame
+    SCALE_FILTER filter;
+} OVERLAY_DERIVE;
+
+// width and height are in target pixels, source covers factor times that
+typedef void (*SCALE_BOX)(
+    uint8_t *target,
+    const uint8_t *source,
+    uint32_t width,
+    uint32_t height);
+
+// one target row; sx/fx are per-pixel source column and 8-bit weight
+// (0..256) of the column to its right, fy the weight of row1
+typedef void (*SCALE_BILINEAR_ROW)(
+    uint8_t *target,
+    const uint8_t *row0,
+    const uint8_t *row1,
+    const uint16_t *sx,
+    const uint16_t *fx,
+    uint32_t fy,
+    uint32_t count);
+
+typedef struct _SCALE_KERNELS
+{
+    SCALE_BOX box2x;
+    SCALE_BOX box4x;
+    SCALE_BILINEAR_ROW bilinear;
+} SCALE_KERNELS;
+
+// kernels for the given isa, or NULL when this build/cpu can't run them
+const SCALE_KERNELS *scaleGetKernels(PIXEL_ISA isa);
+const char *scaleFilterName(SCALE_FILTER filter);
+bool overlayDeriveIsValid(const OVERLAY_DERIVE *derive);
+// resamples the whole placement, for when the derive is (re)configured
+void overlayDeriveRefresh(
+    const OVERLAY_DERIVE *derive,
+    const OVERLAY_DATA *source,
+    OVERLAY_DATA *target);
+void overlayDeriveUpdate(
+    const OVERLAY_DERIVE *derive,
+    const OVERLAY_DATA *source,
+    OVERLAY_DATA *target,
+    uint32_t x,
+    uint32_t y,
+    uint32_t width,
+    uint32_t height);
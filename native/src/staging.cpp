@@ -0,0 +1,63 @@
+#include <string.h>
+#include "staging.h"
+
+void stagingRingInit(STAGING_RING *ring, uint32_t slotCount)
+{
+    memset(ring, 0, sizeof(STAGING_RING));
+    ring->slotCount = slotCount;
+    if (ring->slotCount < 1)
+    {
+        ring->slotCount = 1;
+    }
+    else if (ring->slotCount > STAGING_MAX_SLOTS)
+    {
+        ring->slotCount = STAGING_MAX_SLOTS;
+    }
+}
+
+bool stagingRingPending(const STAGING_RING *ring, uint32_t *slot, uint64_t *fence)
+{
+    // from the oldest slot on, past the ones never used or already passed
+    for (uint32_t i = 0; i < ring->slotCount; ++i)
+    {
+        auto index = (ring->next + i) % ring->slotCount;
+        if (ring->fences[index] > ring->completed)
+        {
+            *slot = index;
+            *fence = ring->fences[index];
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void stagingRingComplete(STAGING_RING *ring, uint64_t fence)
+{
+    // fences arrive in order, a stale one changes nothing
+    if (fence > ring->completed && fence <= ring->issued)
+    {
+        ring->completed = fence;
+    }
+}
+
+int32_t stagingRingAcquire(STAGING_RING *ring)
+{
+    ++ring->acquireCount;
+
+    if (ring->fences[ring->next] > ring->completed)
+    {
+        ++ring->busyCount;
+        return -1;
+    }
+
+    auto slot = ring->next;
+    ring->next = (ring->next + 1) % ring->slotCount;
+    return (int32_t)slot;
+}
+
+uint64_t stagingRingRelease(STAGING_RING *ring, uint32_t slot)
+{
+    ring->fences[slot] = ++ring->issued;
+    return ring->issued;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <stdint.h>
+
+// which cpu-writable staging buffer an upload goes through, without ever
+// waiting on the gpu. uploads write a slot, queue the copies out of it and
+// signal a fence; a slot is written again only once its fence has passed.
+// slots are taken round robin, so the next one is always the oldest and
+// fences are polled in the order the gpu signals them. no gpu api here, the
+// backend owns the buffers and fences. overlay thread only
+
+#define STAGING_MAX_SLOTS 4
+
+typedef struct _STAGING_RING
+{
+    uint32_t slotCount;
+    uint32_t next;                       // slot the next upload gets
+    uint64_t fences[STAGING_MAX_SLOTS];  // serial signalled after the copies out of a slot, 0 if never used
+    uint64_t issued;                     // last serial handed out
+    uint64_t completed;                  // last serial the gpu passed
+    uint64_t acquireCount;
+    uint64_t busyCount; // acquires that found the next slot still in flight
+} STAGING_RING;
+
+void stagingRingInit(STAGING_RING *ring, uint32_t slotCount);
+// the slot and serial to poll next, false when nothing is in flight
+bool stagingRingPending(const STAGING_RING *ring, uint32_t *slot, uint64_t *fence);
+// the gpu passed fence, and with it every serial before
+void stagingRingComplete(STAGING_RING *ring, uint64_t fence);
+// a slot free to write, or -1 when the oldest is still being copied out of.
+// the caller takes another path then instead of waiting
+int32_t stagingRingAcquire(STAGING_RING *ring);
+// the copies out of slot are queued; returns the serial to signal after them
+uint64_t stagingRingRelease(STAGING_RING *ring, uint32_t slot);
@@ -0,0 +1,400 @@
+#include <string.h>
+#include "pixel.h"
+#include "text.h"
+#include "glyph_atlas.h" // generated, see tools/glyph_atlas.py
+
+static_assert(
+    sizeof(glyphAtlasFonts_) / sizeof(glyphAtlasFonts_[0]) == TEXT_FONT_COUNT,
+    "glyph_atlas.py and TEXT_FONT disagree");
+
+typedef struct _TEXT_RECT
+{
+    int32_t x0;
+    int32_t y0;
+    int32_t x1;
+    int32_t y1;
+} TEXT_RECT;
+
+// next codepoint, U+FFFD for anything malformed
+static uint32_t textDecodeUtf8(const uint8_t **cursor, const uint8_t *end)
+{
+    auto p = *cursor;
+    uint32_t c = *p++;
+    uint32_t extra = 0;
+    uint32_t min = 0;
+
+    if (c >= 0xf0 && c < 0xf8)
+    {
+        c &= 0x07;
+        extra = 3;
+        min = 0x10000;
+    }
+    else if (c >= 0xe0)
+    {
+        c &= 0x0f;
+        extra = 2;
+        min = 0x800;
+    }
+    else if (c >= 0xc0)
+    {
+        c &= 0x1f;
+        extra = 1;
+        min = 0x80;
+    }
+    else if (c >= 0x80)
+    {
+        *cursor = p;
+        return 0xfffd;
+    }
+
+    for (; extra > 0; --extra)
+    {
+        if (p == end || (*p & 0xc0) != 0x80)
+        {
+            *cursor = p;
+            return 0xfffd;
+        }
+        c = (c << 6) | (*p++ & 0x3f);
+    }
+
+    *cursor = p;
+    return c < min || c > 0x10ffff ? 0xfffd : c;
+}
+
+static const GLYPH *textFindGlyph(const GLYPH_FONT *font, uint32_t codepoint)
+{
+    uint32_t low = 0;
+    uint32_t high = font->glyphCount;
+
+    while (low < high)
+    {
+        auto middle = (low + high) / 2;
+        auto glyph = &font->glyphs[middle];
+        if (glyph->codepoint == codepoint)
+        {
+            return glyph;
+        }
+        if (glyph->codepoint < codepoint)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return NULL;
+}
+
+// glyphs for the string, codepoints the font lacks fall back to '?' or
+// are dropped. returns the count, *width gets the total advance
+static uint32_t textShape(
+    const GLYPH_FONT *font,
+    const char *utf8,
+    size_t length,
+    const GLYPH **glyphs,
+    uint32_t *width)
+{
+    auto cursor = (const uint8_t *)utf8;
+    auto end = cursor + length;
+    auto fallback = textFindGlyph(font, '?');
+    uint32_t count = 0;
+
+    *width = 0;
+
+    while (cursor < end && count < TEXT_MAX_GLYPHS)
+    {
+        auto glyph = textFindGlyph(font, textDecodeUtf8(&cursor, end));
+        if (glyph == NULL)
+        {
+            glyph = fallback;
+        }
+        if (glyph == NULL)
+        {
+            continue;
+        }
+
+        glyphs[count++] = glyph;
+        *width += glyph->advance;
+    }
+
+    return count;
+}
+
+static int32_t textBaseline(const TEXT_LABEL *label)
+{
+    auto font = &glyphAtlasFonts_[label->style.font];
+    return ((int32_t)label->height - (int32_t)(font->ascent + font->descent)) / 2 +
+           (int32_t)font->ascent;
+}
+
+static TEXT_RECT textInkRect(const GLYPH *glyph, int32_t pen, int32_t baseline)
+{
+    TEXT_RECT rect;
+    rect.x0 = pen + glyph->left;
+    rect.y0 = baseline - glyph->top;
+    rect.x1 = rect.x0 + glyph->width;
+    rect.y1 = rect.y0 + glyph->height;
+    return rect;
+}
+
+static void textUnion(TEXT_RECT *rect, const TEXT_RECT *other)
+{
+    if (other->x0 >= other->x1 || other->y0 >= other->y1)
+    {
+        return;
+    }
+
+    if (rect->x0 >= rect->x1 || rect->y0 >= rect->y1)
+    {
+        *rect = *other;
+        return;
+    }
+
+    rect->x0 = other->x0 < rect->x0 ? other->x0 : rect->x0;
+    rect->y0 = other->y0 < rect->y0 ? other->y0 : rect->y0;
+    rect->x1 = other->x1 > rect->x1 ? other->x1 : rect->x1;
+    rect->y1 = other->y1 > rect->y1 ? other->y1 : rect->y1;
+}
+
+// blends the part of the glyph inside clip, color is premultiplied BGRA
+static void textDrawGlyph(
+    uint8_t *pixels,
+    uint32_t stride,
+    const GLYPH *glyph,
+    const TEXT_RECT *ink,
+    const TEXT_RECT *clip,
+    const uint8_t *color)
+{
+    auto x0 = ink->x0 > clip->x0 ? ink->x0 : clip->x0;
+    auto y0 = ink->y0 > clip->y0 ? ink->y0 : clip->y0;
+    auto x1 = ink->x1 < clip->x1 ? ink->x1 : clip->x1;
+    auto y1 = ink->y1 < clip->y1 ? ink->y1 : clip->y1;
+
+    if (x0 >= x1 || y0 >= y1)
+    {
+        return;
+    }
+
+    uint8_t row[GLYPH_ATLAS_WIDTH * 4];
+    auto count = (uint32_t)(x1 - x0);
+
+    for (auto y = y0; y < y1; ++y)
+    {
+        auto coverage = glyphAtlasPixels_ +
+                        (glyph->y + (y - ink->y0)) * GLYPH_ATLAS_WIDTH +
+                        glyph->x + (x0 - ink->x0);
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            uint32_t c = coverage[i];
+            row[i * 4 + 0] = (uint8_t)((color[0] * c + 127) / 255);
+            row[i * 4 + 1] = (uint8_t)((color[1] * c + 127) / 255);
+            row[i * 4 + 2] = (uint8_t)((color[2] * c + 127) / 255);
+            row[i * 4 + 3] = (uint8_t)((color[3] * c + 127) / 255);
+        }
+
+        pixelBlendRow(pixels + (y * stride + x0) * 4, row, count, 255);
+    }
+}
+
+const GLYPH_FONT *textGetFont(TEXT_FONT font)
+{
+    if ((uint32_t)font >= TEXT_FONT_COUNT)
+    {
+        return NULL;
+    }
+
+    return &glyphAtlasFonts_[font];
+}
+
+const char *textFontName(TEXT_FONT font)
+{
+    switch (font)
+    {
+    case TEXT_FONT_TEXT:
+        return "text";
+    case TEXT_FONT_CLOCK:
+        return "clock";
+    default:
+        return "unknown";
+    }
+}
+
+const char *textAlignName(TEXT_ALIGN align)
+{
+    switch (align)
+    {
+    case TEXT_ALIGN_LEFT:
+        return "left";
+    case TEXT_ALIGN_CENTER:
+        return "center";
+    case TEXT_ALIGN_RIGHT:
+        return "right";
+    default:
+        return "unknown";
+    }
+}
+
+uint32_t textMeasure(TEXT_FONT font, const char *utf8, size_t length)
+{
+    if ((uint32_t)font >= TEXT_FONT_COUNT)
+    {
+        return 0;
+    }
+
+    const GLYPH *glyphs[TEXT_MAX_GLYPHS];
+    uint32_t width;
+    textShape(&glyphAtlasFonts_[font], utf8, length, glyphs, &width);
+    return width;
+}
+
+bool textLabelCreate(
+    OVERLAY_DATA *overlayData,
+    TEXT_LABEL *label,
+    uint32_t width,
+    uint32_t height,
+    const TEXT_STYLE *style,
+    const SPRITE_PROPS *props)
+{
+    if ((uint32_t)style->font >= TEXT_FONT_COUNT ||
+        (uint32_t)style->align >= TEXT_ALIGN_COUNT)
+    {
+        return false;
+    }
+
+    auto spriteId = compositorCreateSprite(overlayData, NULL, width, height, props);
+    if (spriteId == 0)
+    {
+        return false;
+    }
+
+    memset(label, 0, sizeof(TEXT_LABEL));
+    label->spriteId = spriteId;
+    label->width = width;
+    label->height = height;
+    label->style = *style;
+    return true;
+}
+
+uint32_t textLabelSet(
+    OVERLAY_DATA *overlayData,
+    TEXT_LABEL *label,
+    const char *utf8,
+    size_t length)
+{
+    auto pixels = compositorSpritePixels(overlayData, label->spriteId);
+    if (pixels == NULL)
+    {
+        return 0;
+    }
+
+    auto font = &glyphAtlasFonts_[label->style.font];
+    auto baseline = textBaseline(label);
+
+    const GLYPH *glyphs[TEXT_MAX_GLYPHS];
+    int32_t pens[TEXT_MAX_GLYPHS];
+    uint32_t width;
+    auto count = textShape(font, utf8, length, glyphs, &width);
+
+    int32_t pen = 0;
+    if (label->style.align == TEXT_ALIGN_CENTER)
+    {
+        pen = ((int32_t)label->width - (int32_t)width) / 2;
+    }
+    else if (label->style.align == TEXT_ALIGN_RIGHT)
+    {
+        pen = (int32_t)label->width - (int32_t)width;
+    }
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        pens[i] = pen;
+        pen += glyphs[i]->advance;
+    }
+
+    // ink of every glyph that isn't the same glyph at the same place as before
+    TEXT_RECT dirty = {0, 0, 0, 0};
+    auto maxCount = count > label->glyphCount ? count : label->glyphCount;
+
+    for (uint32_t i = 0; i < maxCount; ++i)
+    {
+        auto isOld = i < label->glyphCount;
+        auto isNew = i < count;
+
+        if (isOld != false && isNew != false &&
+            label->glyphs[i] == glyphs[i] && label->pens[i] == pens[i])
+        {
+            continue;
+        }
+
+        if (isOld != false)
+        {
+            auto ink = textInkRect(label->glyphs[i], label->pens[i], baseline);
+            textUnion(&dirty, &ink);
+        }
+
+        if (isNew != false)
+        {
+            auto ink = textInkRect(glyphs[i], pens[i], baseline);
+            textUnion(&dirty, &ink);
+        }
+    }
+
+    label->glyphCount = count;
+    memcpy(label->glyphs, glyphs, count * sizeof(glyphs[0]));
+    memcpy(label->pens, pens, count * sizeof(pens[0]));
+
+    dirty.x0 = dirty.x0 > 0 ? dirty.x0 : 0;
+    dirty.y0 = dirty.y0 > 0 ? dirty.y0 : 0;
+    dirty.x1 = dirty.x1 < (int32_t)label->width ? dirty.x1 : (int32_t)label->width;
+    dirty.y1 = dirty.y1 < (int32_t)label->height ? dirty.y1 : (int32_t)label->height;
+
+    if (dirty.x0 >= dirty.x1 || dirty.y0 >= dirty.y1)
+    {
+        return 0;
+    }
+
+    for (auto y = dirty.y0; y < dirty.y1; ++y)
+    {
+        memset(
+            pixels + (y * label->width + dirty.x0) * 4,
+            0,
+            (dirty.x1 - dirty.x0) * 4);
+    }
+
+    auto color = label->style.color;
+    uint8_t premultiplied[4] = {
+        (uint8_t)((color[2] * color[3] + 127) / 255),
+        (uint8_t)((color[1] * color[3] + 127) / 255),
+        (uint8_t)((color[0] * color[3] + 127) / 255),
+        color[3]};
+
+    // neighbours reaching into the cleared rect are drawn again, clipped
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        auto ink = textInkRect(glyphs[i], pens[i], baseline);
+        textDrawGlyph(pixels, label->width, glyphs[i], &ink, &dirty, premultiplied);
+    }
+
+    auto dirtyWidth = (uint32_t)(dirty.x1 - dirty.x0);
+    auto dirtyHeight = (uint32_t)(dirty.y1 - dirty.y0);
+
+    compositorDamageSprite(
+        overlayData,
+        label->spriteId,
+        (uint32_t)dirty.x0,
+        (uint32_t)dirty.y0,
+        dirtyWidth,
+        dirtyHeight);
+
+    return dirtyWidth * dirtyHeight;
+}
+
+bool textLabelDestroy(OVERLAY_DATA *overlayData, TEXT_LABEL *label)
+{
+    auto isDestroyed = compositorDestroySprite(overlayData, label->spriteId);
+    memset(label, 0, sizeof(TEXT_LABEL));
+    return isDestroyed;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "compositor.h"
+#include "frame.h"
+
+// draws strings into compositor sprites from the glyph atlas that
+// tools/glyph_atlas.py builds out of fonts/DejaVuSans.ttf. a label keeps the
+// layout it drew last, so setting new text only redraws and damages the
+// part of the box whose glyphs changed. js thread only, like the compositor.
+
+#define TEXT_MAX_GLYPHS 128
+
+typedef enum _TEXT_FONT
+{
+    TEXT_FONT_TEXT = 0, // 24px, printable ascii and a few symbols
+    TEXT_FONT_CLOCK,    // 64px, digits and what a time or date needs
+    TEXT_FONT_COUNT
+} TEXT_FONT;
+
+typedef enum _TEXT_ALIGN
+{
+    TEXT_ALIGN_LEFT = 0,
+    TEXT_ALIGN_CENTER,
+    TEXT_ALIGN_RIGHT,
+    TEXT_ALIGN_COUNT
+} TEXT_ALIGN;
+
+typedef struct _GLYPH
+{
+    uint32_t codepoint;
+    uint16_t x; // in the atlas
+    uint16_t y;
+    uint16_t width;
+    uint16_t height;
+    int16_t left; // pen to the ink's left edge
+    int16_t top;  // baseline to the ink's top edge, up is positive
+    uint16_t advance;
+} GLYPH;
+
+typedef struct _GLYPH_FONT
+{
+    uint32_t size;
+    uint32_t ascent;
+    uint32_t descent;
+    uint32_t lineHeight;
+    uint32_t glyphCount;
+    const GLYPH *glyphs; // sorted by codepoint
+} GLYPH_FONT;
+
+typedef struct _TEXT_STYLE
+{
+    TEXT_FONT font;
+    TEXT_ALIGN align;
+    uint8_t color[4]; // straight rgba
+} TEXT_STYLE;
+
+typedef struct _TEXT_LABEL
+{
+    uint32_t spriteId; // 0 = free
+    uint32_t width;
+    uint32_t height;
+    TEXT_STYLE style;
+    uint32_t glyphCount;
+    const GLYPH *glyphs[TEXT_MAX_GLYPHS];
+    int32_t pens[TEXT_MAX_GLYPHS]; // x of each glyph's origin in the box
+} TEXT_LABEL;
+
+const GLYPH_FONT *textGetFont(TEXT_FONT font);
+const char *textFontName(TEXT_FONT font);
+const char *textAlignName(TEXT_ALIGN align);
+// width of the string laid out in the font, in pixels
+uint32_t textMeasure(TEXT_FONT font, const char *utf8, size_t length);
+// creates the label's sprite, empty until the first textLabelSet
+bool textLabelCreate(
+    OVERLAY_DATA *overlayData,
+    TEXT_LABEL *label,
+    uint32_t width,
+    uint32_t height,
+    const TEXT_STYLE *style,
+    const SPRITE_PROPS *props);
+// lays the string out and redraws what differs from the last one. text
+// past the box or TEXT_MAX_GLYPHS is cut off. returns the number of pixels
+// redrawn, 0 when nothing changed
+uint32_t textLabelSet(
+    OVERLAY_DATA *overlayData,
+    TEXT_LABEL *label,
+    const char *utf8,
+    size_t length);
+bool textLabelDestroy(OVERLAY_DATA *overlayData, TEXT_LABEL *label);
@@ -0,0 +1,150 @@
+#include <atomic>
+#include "frame.h"
+#include "pixel.h"
+#include "pool.h"
+#include "texture.h"
+
+static std::atomic<uint64_t> uploadCount_;
+static std::atomic<uint64_t> uploadBytes_;
+static std::atomic<uint64_t> submitCount_;
+static std::atomic<uint64_t> sharedCount_;
+static std::atomic<const char *> backendName_;
+
+static uint8_t *rawFrames_[TEXTURE_TARGET_COUNT]; // rgba
+static bool isRawFilled_[TEXTURE_TARGET_COUNT];
+
+static bool textureRawInit(void)
+{
+    for (uint32_t target = 0; target < TEXTURE_TARGET_COUNT; ++target)
+    {
+        rawFrames_[target] = (uint8_t *)poolAlloc(true);
+        if (rawFrames_[target] == NULL)
+        {
+            return false;
+        }
+        isRawFilled_[target] = false;
+    }
+
+    return true;
+}
+
+static void textureRawExit(void)
+{
+    for (auto &frame : rawFrames_)
+    {
+        if (frame != NULL)
+        {
+            poolFree(frame);
+            frame = NULL;
+        }
+    }
+}
+
+static bool textureRawUpload(uint32_t target, const uint8_t *data, uint32_t dirtyRows)
+{
+    if (isRawFilled_[target] == false)
+    {
+        dirtyRows = TEXTURE_ALL_ROWS;
+        isRawFilled_[target] = true;
+    }
+
+    // SetOverlayRaw takes rgba, premultiplied like the d3d11 texture. it
+    // still copies the whole frame on submit, only the swizzle is saved
+    PIXEL_CONVERT convert = {PIXEL_OP_SWIZZLE, 0, 255};
+    uint32_t y, height;
+    while (textureTakeRun(&dirtyRows, &y, &height) != false)
+    {
+        pixelConvertRow(
+            rawFrames_[target] + y * FRAME_STRIDE,
+            data + y * FRAME_STRIDE,
+            FRAME_WIDTH * height,
+            &convert);
+        textureCountUpload(height * FRAME_STRIDE);
+    }
+
+    return true;
+}
+
+static vr::EVROverlayError textureRawSubmit(
+    vr::IVROverlay *pVROverlay,
+    vr::VROverlayHandle_t overlayHandle,
+    uint32_t target)
+{
+    auto overlayError = pVROverlay->SetOverlayRaw(
+        overlayHandle,
+        rawFrames_[target],
+        FRAME_WIDTH,
+        FRAME_HEIGHT,
+        4);
+    if (overlayError == vr::EVROverlayError::VROverlayError_None)
+    {
+        textureCountSubmit();
+    }
+
+    return overlayError;
+}
+
+const TEXTURE_BACKEND textureBackendRaw = {
+    "raw",
+    NULL,
+    textureRawInit,
+    textureRawExit,
+    textureRawUpload,
+    textureRawSubmit,
+    NULL};
+
+void textureGetStats(TEXTURE_STATS *stats)
+{
+    stats->uploadCount = uploadCount_.load(std::memory_order_relaxed);
+    stats->uploadBytes = uploadBytes_.load(std::memory_order_relaxed);
+    stats->submitCount = submitCount_.load(std::memory_order_relaxed);
+    stats->sharedCount = sharedCount_.load(std::memory_order_relaxed);
+    stats->backend = backendName_.load(std::memory_order_relaxed);
+}
+
+void textureSetBackend(const TEXTURE_BACKEND *backend)
+{
+    backendName_.store(backend->name, std::memory_order_relaxed);
+}
+
+bool textureTakeRun(uint32_t *dirtyRows, uint32_t *y, uint32_t *height)
+{
+    auto rows = *dirtyRows & TEXTURE_ALL_ROWS;
+    if (rows == 0)
+    {
+        return false;
+    }
+
+    uint32_t first = 0;
+    while ((rows & (1u << first)) == 0)
+    {
+        ++first;
+    }
+
+    auto last = first;
+    while (last + 1 < FRAME_TILES_Y && (rows & (1u << (last + 1))) != 0)
+    {
+        ++last;
+    }
+
+    *dirtyRows = rows & ~(((2u << last) - 1) & ~((1u << first) - 1));
+    *y = first * FRAME_TILE_SIZE;
+    *height = (last - first + 1) * FRAME_TILE_SIZE;
+    return true;
+}
+
+void textureCountUpload(uint64_t bytes)
+{
+    uploadCount_.fetch_add(1, std::memory_order_relaxed);
+    uploadBytes_.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void textureCountSubmit(void)
+{
+    submitCount_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void textureCountShared(void)
+{
+    sharedCount_.fetch_add(1, std::memory_order_relaxed);
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <stdint.h>
+#include <openvr/openvr.h>
+#include "frame.h"
+
+// how overlay frames get from the frame buffer into the vr runtime. the
+// platform picks the backend (main_win.cpp: d3d11 textures, main_linux.cpp:
+// gl textures). all calls come from the overlay thread
+
+#define TEXTURE_TARGET_COUNT 2 // hmd, wrist
+#define TEXTURE_ALL_ROWS ((1u << FRAME_TILES_Y) - 1)
+#define TEXTURE_MODIFIER_INVALID 0x00ffffffffffffffull // DRM_FORMAT_MOD_INVALID, the driver picks
+#define TEXTURE_SHARED_MAX_FAILS 3 // imports failed in a row before shared textures are refused
+#ifdef _WIN32
+#define TEXTURE_SHARED_IS_DMABUF false
+#else
+#define TEXTURE_SHARED_IS_DMABUF true // stride has to come with the handle
+#endif
+
+typedef struct _TEXTURE_STATS
+{
+    uint64_t uploadCount;
+    uint64_t uploadBytes; // dirty rows only
+    uint64_t submitCount;
+    uint64_t sharedCount; // frames copied from a shared texture on the gpu
+    const char *backend;  // NULL until the overlay started once
+} TEXTURE_STATS;
+
+// a frame the renderer left in gpu memory, bgra premultiplied and
+// FRAME_WIDTH x FRAME_HEIGHT
+typedef struct _TEXTURE_SHARED
+{
+    uint64_t handle; // an nt handle on windows, a dmabuf fd on linux
+    uint32_t width;
+    uint32_t height;
+    uint32_t stride;   // dmabuf only
+    uint32_t offset;   // dmabuf only
+    uint64_t modifier; // dmabuf only
+} TEXTURE_SHARED;
+
+typedef struct _TEXTURE_BACKEND
+{
+    const char *name;
+    // tried when init fails, NULL for none
+    const struct _TEXTURE_BACKEND *fallback;
+    bool (*init)(void);
+    void (*exit)(void);
+    // copies the rows of tiles in dirtyRows (frameTakeDirty) of a frame
+    // (FRAME_SIZE, bgra premultiplied) into the texture of target, no
+    // runtime needed. the first upload after init copies everything
+    bool (*upload)(uint32_t target, const uint8_t *data, uint32_t dirtyRows);
+    // hands the texture of target to the overlay
+    vr::EVROverlayError (*submit)(
+        vr::IVROverlay *pVROverlay,
+        vr::VROverlayHandle_t overlayHandle,
+        uint32_t target);
+    // copies a shared texture into the texture of target on the gpu, the
+    // next upload is a full one again. the handle stays the caller's. NULL
+    // when the backend can't
+    bool (*importShared)(uint32_t target, const TEXTURE_SHARED *shared);
+} TEXTURE_BACKEND;
+
+// rgba copies handed to SetOverlayRaw, which works with any runtime but
+// goes through the runtime's own upload every time
+extern const TEXTURE_BACKEND textureBackendRaw;
+// headless: a cpu mirror of each texture that uploads land in exactly as
+// they would on the gpu, hashed on submit. no runtime or gpu needed, the
+// backend of VRCX_MOCK_VR and of replay --verify
+extern const TEXTURE_BACKEND textureBackendSoft;
+#ifndef _WIN32
+// a persistent opengl texture per target on a surfaceless egl context,
+// libEGL loaded at runtime. falls back to raw without a usable gpu
+extern const TEXTURE_BACKEND textureBackendGl;
+#endif
+
+void textureGetStats(TEXTURE_STATS *stats);
+// textureBackendSoft only, false unless it's initialized. the hash is of the
+// last submit (0 before one), the mirror is read as it is now
+bool textureSoftHash(uint32_t target, uint64_t *hash, uint64_t *submitCount);
+bool textureSoftRead(uint32_t target, uint8_t *frame);
+uint64_t textureHashFrame(const uint8_t *frame);
+// the backend the overlay thread ended up with
+void textureSetBackend(const TEXTURE_BACKEND *backend);
+// takes the lowest run of consecutive rows of tiles off dirtyRows, as
+// pixel rows. false when none are left
+bool textureTakeRun(uint32_t *dirtyRows, uint32_t *y, uint32_t *height);
+// for the backends
+void textureCountUpload(uint64_t bytes);
+void textureCountSubmit(void);
+void textureCountShared(void);
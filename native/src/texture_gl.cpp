@@ -0,0 +1,481 @@
+#include <dlfcn.h>
+#include <stddef.h>
+#include <string.h>
+#include "frame.h"
+#include "log.h"
+#include "texture.h"
+
+// the few egl and gl declarations used here, so building needs neither
+// header. libEGL is loaded when the overlay starts, a box without one gets
+// the raw backend
+typedef void *EGLDisplay;
+typedef void *EGLConfig;
+typedef void *EGLContext;
+typedef void *EGLSurface;
+typedef void *EGLImage;
+typedef int32_t EGLint;
+typedef unsigned int EGLBoolean;
+typedef unsigned int EGLenum;
+typedef intptr_t EGLAttrib;
+typedef unsigned int GLenum;
+typedef unsigned int GLuint;
+typedef int GLint;
+typedef int GLsizei;
+
+#define EGL_NONE 0x3038
+#define EGL_SURFACE_TYPE 0x3033
+#define EGL_PBUFFER_BIT 0x0001
+#define EGL_RENDERABLE_TYPE 0x3040
+#define EGL_OPENGL_BIT 0x0008
+#define EGL_OPENGL_API 0x30A2
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#define EGL_WIDTH 0x3057
+#define EGL_HEIGHT 0x3056
+#define EGL_LINUX_DMA_BUF_EXT 0x3270
+#define EGL_LINUX_DRM_FOURCC_EXT 0x3271
+#define EGL_DMA_BUF_PLANE0_FD_EXT 0x3272
+#define EGL_DMA_BUF_PLANE0_OFFSET_EXT 0x3273
+#define EGL_DMA_BUF_PLANE0_PITCH_EXT 0x3274
+#define EGL_DMA_BUF_PLANE0_MODIFIER_LO_EXT 0x3443
+#define EGL_DMA_BUF_PLANE0_MODIFIER_HI_EXT 0x3444
+#define DRM_FORMAT_ARGB8888 0x34325241 // bgra in memory
+
+#define GL_NO_ERROR 0
+#define GL_TEXTURE_2D 0x0DE1
+#define GL_TEXTURE_MAG_FILTER 0x2800
+#define GL_TEXTURE_MIN_FILTER 0x2801
+#define GL_LINEAR 0x2601
+#define GL_RGBA8 0x8058
+#define GL_BGRA 0x80E1
+#define GL_UNSIGNED_INT_8_8_8_8_REV 0x8367
+#define GL_UNPACK_ROW_LENGTH 0x0CF2
+#define GL_UNPACK_ALIGNMENT 0x0CF5
+#define GL_NEAREST 0x2600
+#define GL_COLOR_BUFFER_BIT 0x4000
+#define GL_READ_FRAMEBUFFER 0x8CA8
+#define GL_DRAW_FRAMEBUFFER 0x8CA9
+#define GL_COLOR_ATTACHMENT0 0x8CE0
+
+// arg0 of LOG_CODE_GL_INIT, the step that failed
+typedef enum _GL_INIT_STEP
+{
+    GL_INIT_STEP_LOAD = 0,
+    GL_INIT_STEP_DISPLAY,
+    GL_INIT_STEP_CONTEXT,
+    GL_INIT_STEP_TEXTURE
+} GL_INIT_STEP;
+
+static struct
+{
+    void *(*getProcAddress)(const char *);
+    EGLDisplay (*getPlatformDisplay)(EGLenum, void *, const EGLAttrib *);
+    EGLDisplay (*getDisplay)(void *);
+    EGLBoolean (*initialize)(EGLDisplay, EGLint *, EGLint *);
+    EGLBoolean (*terminate)(EGLDisplay);
+    EGLBoolean (*bindApi)(EGLenum);
+    EGLBoolean (*chooseConfig)(EGLDisplay, const EGLint *, EGLConfig *, EGLint, EGLint *);
+    EGLContext (*createContext)(EGLDisplay, EGLConfig, EGLContext, const EGLint *);
+    EGLBoolean (*destroyContext)(EGLDisplay, EGLContext);
+    EGLBoolean (*makeCurrent)(EGLDisplay, EGLSurface, EGLSurface, EGLContext);
+    EGLint (*getError)(void);
+} egl_;
+
+static struct
+{
+    void (*genTextures)(GLsizei, GLuint *);
+    void (*deleteTextures)(GLsizei, const GLuint *);
+    void (*bindTexture)(GLenum, GLuint);
+    void (*texParameteri)(GLenum, GLenum, GLint);
+    void (*texImage2D)(GLenum, GLint, GLint, GLsizei, GLsizei, GLint, GLenum, GLenum, const void *);
+    void (*texSubImage2D)(GLenum, GLint, GLint, GLint, GLsizei, GLsizei, GLenum, GLenum, const void *);
+    void (*pixelStorei)(GLenum, GLint);
+    GLenum (*getError)(void);
+    void (*flush)(void);
+} gl_;
+
+// dmabuf import, optional: without it shared textures are refused
+static struct
+{
+    EGLImage (*createImage)(EGLDisplay, EGLContext, EGLenum, void *, const EGLint *);
+    EGLBoolean (*destroyImage)(EGLDisplay, EGLImage);
+    void (*imageTargetTexture2D)(GLenum, void *);
+    void (*genFramebuffers)(GLsizei, GLuint *);
+    void (*deleteFramebuffers)(GLsizei, const GLuint *);
+    void (*bindFramebuffer)(GLenum, GLuint);
+    void (*framebufferTexture2D)(GLenum, GLenum, GLenum, GLuint, GLint);
+    void (*blitFramebuffer)(GLint, GLint, GLint, GLint, GLint, GLint, GLint, GLint, GLenum, GLenum);
+} glShared_;
+
+static void *eglLib_; // kept loaded once opened, mesa doesn't like unloading
+static EGLDisplay display_;
+static EGLContext context_;
+static GLuint textures_[TEXTURE_TARGET_COUNT];
+static bool isFilled_[TEXTURE_TARGET_COUNT];
+static bool isFlushPending_;
+// overlay the texture bounds were flipped for, per target
+static vr::VROverlayHandle_t flippedHandles_[TEXTURE_TARGET_COUNT];
+static bool hasShared_;
+static GLuint sharedTexture_; // the imported dmabuf, respecified per import
+static GLuint sharedFramebuffers_[2]; // read, draw
+
+static bool textureGlLoad(void)
+{
+    if (eglLib_ == NULL)
+    {
+        eglLib_ = dlopen("libEGL.so.1", RTLD_NOW | RTLD_LOCAL);
+        if (eglLib_ == NULL)
+        {
+            return false;
+        }
+    }
+
+    *(void **)&egl_.getProcAddress = dlsym(eglLib_, "eglGetProcAddress");
+    *(void **)&egl_.getPlatformDisplay = dlsym(eglLib_, "eglGetPlatformDisplay");
+    *(void **)&egl_.getDisplay = dlsym(eglLib_, "eglGetDisplay");
+    *(void **)&egl_.initialize = dlsym(eglLib_, "eglInitialize");
+    *(void **)&egl_.terminate = dlsym(eglLib_, "eglTerminate");
+    *(void **)&egl_.bindApi = dlsym(eglLib_, "eglBindAPI");
+    *(void **)&egl_.chooseConfig = dlsym(eglLib_, "eglChooseConfig");
+    *(void **)&egl_.createContext = dlsym(eglLib_, "eglCreateContext");
+    *(void **)&egl_.destroyContext = dlsym(eglLib_, "eglDestroyContext");
+    *(void **)&egl_.makeCurrent = dlsym(eglLib_, "eglMakeCurrent");
+    *(void **)&egl_.getError = dlsym(eglLib_, "eglGetError");
+    if (egl_.getProcAddress == NULL ||
+        egl_.getDisplay == NULL ||
+        egl_.initialize == NULL ||
+        egl_.terminate == NULL ||
+        egl_.bindApi == NULL ||
+        egl_.chooseConfig == NULL ||
+        egl_.createContext == NULL ||
+        egl_.destroyContext == NULL ||
+        egl_.makeCurrent == NULL ||
+        egl_.getError == NULL)
+    {
+        return false;
+    }
+
+    // core gl through egl, with glvnd these are dispatch stubs
+    *(void **)&gl_.genTextures = egl_.getProcAddress("glGenTextures");
+    *(void **)&gl_.deleteTextures = egl_.getProcAddress("glDeleteTextures");
+    *(void **)&gl_.bindTexture = egl_.getProcAddress("glBindTexture");
+    *(void **)&gl_.texParameteri = egl_.getProcAddress("glTexParameteri");
+    *(void **)&gl_.texImage2D = egl_.getProcAddress("glTexImage2D");
+    *(void **)&gl_.texSubImage2D = egl_.getProcAddress("glTexSubImage2D");
+    *(void **)&gl_.pixelStorei = egl_.getProcAddress("glPixelStorei");
+    *(void **)&gl_.getError = egl_.getProcAddress("glGetError");
+    *(void **)&gl_.flush = egl_.getProcAddress("glFlush");
+
+    void **functions = (void **)&gl_;
+    for (size_t i = 0; i < sizeof(gl_) / sizeof(void *); ++i)
+    {
+        if (functions[i] == NULL)
+        {
+            return false;
+        }
+    }
+
+    *(void **)&glShared_.createImage = egl_.getProcAddress("eglCreateImageKHR");
+    *(void **)&glShared_.destroyImage = egl_.getProcAddress("eglDestroyImageKHR");
+    *(void **)&glShared_.imageTargetTexture2D = egl_.getProcAddress("glEGLImageTargetTexture2DOES");
+    *(void **)&glShared_.genFramebuffers = egl_.getProcAddress("glGenFramebuffers");
+    *(void **)&glShared_.deleteFramebuffers = egl_.getProcAddress("glDeleteFramebuffers");
+    *(void **)&glShared_.bindFramebuffer = egl_.getProcAddress("glBindFramebuffer");
+    *(void **)&glShared_.framebufferTexture2D = egl_.getProcAddress("glFramebufferTexture2D");
+    *(void **)&glShared_.blitFramebuffer = egl_.getProcAddress("glBlitFramebuffer");
+
+    hasShared_ = true;
+    functions = (void **)&glShared_;
+    for (size_t i = 0; i < sizeof(glShared_) / sizeof(void *); ++i)
+    {
+        if (functions[i] == NULL)
+        {
+            hasShared_ = false;
+        }
+    }
+
+    return true;
+}
+
+static bool textureGlInit(void)
+{
+    if (textureGlLoad() == false)
+    {
+        logWrite(LOG_LEVEL_WARN, LOG_CODE_GL_INIT, GL_INIT_STEP_LOAD);
+        return false;
+    }
+
+    // no window system needed, mesa's surfaceless platform first
+    display_ = NULL;
+    if (egl_.getPlatformDisplay != NULL)
+    {
+        display_ = egl_.getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, NULL, NULL);
+    }
+    if (display_ == NULL)
+    {
+        display_ = egl_.getDisplay(NULL);
+    }
+    if (display_ == NULL || egl_.initialize(display_, NULL, NULL) == 0)
+    {
+        logWrite(LOG_LEVEL_WARN, LOG_CODE_GL_INIT, GL_INIT_STEP_DISPLAY, egl_.getError());
+        display_ = NULL;
+        return false;
+    }
+
+    // the default surface type is window, which surfaceless doesn't have
+    static const EGLint configAttribs[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE};
+    EGLConfig config;
+    EGLint configCount;
+    if (egl_.bindApi(EGL_OPENGL_API) == 0 ||
+        egl_.chooseConfig(display_, configAttribs, &config, 1, &configCount) == 0 ||
+        configCount == 0)
+    {
+        logWrite(LOG_LEVEL_WARN, LOG_CODE_GL_INIT, GL_INIT_STEP_CONTEXT, egl_.getError());
+        return false;
+    }
+
+    // current on the overlay thread from here on, without a surface
+    static const EGLint contextAttribs[] = {EGL_NONE};
+    context_ = egl_.createContext(display_, config, NULL, contextAttribs);
+    if (context_ == NULL || egl_.makeCurrent(display_, NULL, NULL, context_) == 0)
+    {
+        logWrite(LOG_LEVEL_WARN, LOG_CODE_GL_INIT, GL_INIT_STEP_CONTEXT, egl_.getError());
+        return false;
+    }
+
+    gl_.genTextures(TEXTURE_TARGET_COUNT, textures_);
+
+    // uploads read frame rows straight from client memory, rows are
+    // FRAME_STRIDE apart and 4 byte aligned
+    gl_.pixelStorei(GL_UNPACK_ROW_LENGTH, FRAME_WIDTH);
+    gl_.pixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    for (uint32_t target = 0; target < TEXTURE_TARGET_COUNT; ++target)
+    {
+        gl_.bindTexture(GL_TEXTURE_2D, textures_[target]);
+        gl_.texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        gl_.texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        gl_.texImage2D(
+            GL_TEXTURE_2D,
+            0,
+            GL_RGBA8,
+            FRAME_WIDTH,
+            FRAME_HEIGHT,
+            0,
+            GL_BGRA,
+            GL_UNSIGNED_INT_8_8_8_8_REV,
+            NULL);
+
+        isFilled_[target] = false;
+        flippedHandles_[target] = vr::k_ulOverlayHandleInvalid;
+    }
+
+    gl_.bindTexture(GL_TEXTURE_2D, 0);
+
+    if (hasShared_ != false)
+    {
+        gl_.genTextures(1, &sharedTexture_);
+        glShared_.genFramebuffers(2, sharedFramebuffers_);
+    }
+
+    auto error = gl_.getError();
+    if (error != GL_NO_ERROR)
+    {
+        logWrite(LOG_LEVEL_WARN, LOG_CODE_GL_INIT, GL_INIT_STEP_TEXTURE, error);
+        return false;
+    }
+
+    return true;
+}
+
+static void textureGlExit(void)
+{
+    if (context_ != NULL)
+    {
+        if (hasShared_ != false)
+        {
+            glShared_.deleteFramebuffers(2, sharedFramebuffers_);
+            gl_.deleteTextures(1, &sharedTexture_);
+            memset(sharedFramebuffers_, 0, sizeof(sharedFramebuffers_));
+            sharedTexture_ = 0;
+        }
+        gl_.deleteTextures(TEXTURE_TARGET_COUNT, textures_);
+        memset(textures_, 0, sizeof(textures_));
+
+        egl_.makeCurrent(display_, NULL, NULL, NULL);
+        egl_.destroyContext(display_, context_);
+        context_ = NULL;
+    }
+
+    if (display_ != NULL)
+    {
+        egl_.terminate(display_);
+        display_ = NULL;
+    }
+
+    isFlushPending_ = false;
+}
+
+static bool textureGlUpload(uint32_t target, const uint8_t *data, uint32_t dirtyRows)
+{
+    if (isFilled_[target] == false)
+    {
+        dirtyRows = TEXTURE_ALL_ROWS;
+        isFilled_[target] = true;
+    }
+
+    if (dirtyRows == 0)
+    {
+        return true;
+    }
+
+    gl_.bindTexture(GL_TEXTURE_2D, textures_[target]);
+
+    // each run goes from the frame buffer to the texture in one copy. no
+    // unpack buffer in between, staging the rows there first was a second
+    // cpu copy of every dirty byte
+    uint32_t y, height;
+    while (textureTakeRun(&dirtyRows, &y, &height) != false)
+    {
+        auto offset = (size_t)y * FRAME_STRIDE;
+        auto size = (size_t)height * FRAME_STRIDE;
+
+        gl_.texSubImage2D(
+            GL_TEXTURE_2D,
+            0,
+            0,
+            y,
+            FRAME_WIDTH,
+            height,
+            GL_BGRA,
+            GL_UNSIGNED_INT_8_8_8_8_REV,
+            data + offset);
+
+        textureCountUpload(size);
+    }
+
+    gl_.bindTexture(GL_TEXTURE_2D, 0);
+
+    isFlushPending_ = true;
+    return true;
+}
+
+static vr::EVROverlayError textureGlSubmit(
+    vr::IVROverlay *pVROverlay,
+    vr::VROverlayHandle_t overlayHandle,
+    uint32_t target)
+{
+    // row 0 of the frame went in as row 0 of the texture, which gl samples
+    // as the bottom. flipped once per overlay
+    if (flippedHandles_[target] != overlayHandle)
+    {
+        vr::VRTextureBounds_t bounds = {0.0f, 1.0f, 1.0f, 0.0f};
+        auto overlayError = pVROverlay->SetOverlayTextureBounds(overlayHandle, &bounds);
+        if (overlayError != vr::EVROverlayError::VROverlayError_None)
+        {
+            return overlayError;
+        }
+        flippedHandles_[target] = overlayHandle;
+    }
+
+    // the runtime reads the texture from its own context
+    if (isFlushPending_ != false)
+    {
+        gl_.flush();
+        isFlushPending_ = false;
+    }
+
+    vr::Texture_t texture;
+    texture.handle = (void *)(uintptr_t)textures_[target];
+    texture.eType = vr::ETextureType::TextureType_OpenGL;
+    texture.eColorSpace = vr::EColorSpace::ColorSpace_Auto;
+
+    auto overlayError = pVROverlay->SetOverlayTexture(
+        overlayHandle,
+        &texture);
+    if (overlayError == vr::EVROverlayError::VROverlayError_None)
+    {
+        textureCountSubmit();
+    }
+
+    return overlayError;
+}
+
+static bool textureGlImportShared(uint32_t target, const TEXTURE_SHARED *shared)
+{
+    if (hasShared_ == false ||
+        shared->width != FRAME_WIDTH ||
+        shared->height != FRAME_HEIGHT ||
+        shared->handle > INT32_MAX)
+    {
+        return false;
+    }
+
+    EGLint attribs[19] = {
+        EGL_WIDTH, FRAME_WIDTH,
+        EGL_HEIGHT, FRAME_HEIGHT,
+        EGL_LINUX_DRM_FOURCC_EXT, DRM_FORMAT_ARGB8888,
+        EGL_DMA_BUF_PLANE0_FD_EXT, (EGLint)shared->handle,
+        EGL_DMA_BUF_PLANE0_OFFSET_EXT, (EGLint)shared->offset,
+        EGL_DMA_BUF_PLANE0_PITCH_EXT, (EGLint)shared->stride,
+        EGL_NONE};
+    if (shared->modifier != TEXTURE_MODIFIER_INVALID)
+    {
+        attribs[12] = EGL_DMA_BUF_PLANE0_MODIFIER_LO_EXT;
+        attribs[13] = (EGLint)(uint32_t)shared->modifier;
+        attribs[14] = EGL_DMA_BUF_PLANE0_MODIFIER_HI_EXT;
+        attribs[15] = (EGLint)(uint32_t)(shared->modifier >> 32);
+        attribs[16] = EGL_NONE;
+    }
+
+    // egl takes its own reference on the dmabuf, the fd stays the caller's
+    auto image = glShared_.createImage(display_, NULL, EGL_LINUX_DMA_BUF_EXT, NULL, attribs);
+    if (image == NULL)
+    {
+        return false;
+    }
+
+    gl_.getError();
+    gl_.bindTexture(GL_TEXTURE_2D, sharedTexture_);
+    glShared_.imageTargetTexture2D(GL_TEXTURE_2D, image);
+    gl_.bindTexture(GL_TEXTURE_2D, 0);
+
+    // a blit rather than a raw copy: the driver may keep the dmabuf bgra
+    // and our texture rgba. row 0 lands on row 0 either way, so the flipped
+    // bounds still hold
+    glShared_.bindFramebuffer(GL_READ_FRAMEBUFFER, sharedFramebuffers_[0]);
+    glShared_.framebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, sharedTexture_, 0);
+    glShared_.bindFramebuffer(GL_DRAW_FRAMEBUFFER, sharedFramebuffers_[1]);
+    glShared_.framebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, textures_[target], 0);
+    glShared_.blitFramebuffer(
+        0, 0, FRAME_WIDTH, FRAME_HEIGHT,
+        0, 0, FRAME_WIDTH, FRAME_HEIGHT,
+        GL_COLOR_BUFFER_BIT,
+        GL_NEAREST);
+    glShared_.bindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    glShared_.bindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+
+    // the texture holds on to the storage until the next import
+    glShared_.destroyImage(display_, image);
+
+    if (gl_.getError() != GL_NO_ERROR)
+    {
+        return false;
+    }
+
+    isFilled_[target] = false; // the cpu frame is behind now
+    isFlushPending_ = true;
+    textureCountShared();
+    return true;
+}
+
+const TEXTURE_BACKEND textureBackendGl = {
+    "gl",
+    &textureBackendRaw,
+    textureGlInit,
+    textureGlExit,
+    textureGlUpload,
+    textureGlSubmit,
+    textureGlImportShared};
@@ -0,0 +1,134 @@
+#include <string.h>
+#include <mutex>
+#include "frame.h"
+#include "pool.h"
+#include "texture.h"
+
+static std::mutex softLock_; // guards the mirrors against readers off the overlay thread
+static uint8_t *softMirrors_[TEXTURE_TARGET_COUNT]; // bgra premultiplied, like the gpu texture
+static bool isSoftFilled_[TEXTURE_TARGET_COUNT];
+static uint64_t softHashes_[TEXTURE_TARGET_COUNT];
+static uint64_t softSubmitCounts_[TEXTURE_TARGET_COUNT];
+
+static bool textureSoftInit(void)
+{
+    std::lock_guard<std::mutex> guard(softLock_);
+
+    for (uint32_t target = 0; target < TEXTURE_TARGET_COUNT; ++target)
+    {
+        softMirrors_[target] = (uint8_t *)poolAlloc(true);
+        if (softMirrors_[target] == NULL)
+        {
+            return false;
+        }
+        isSoftFilled_[target] = false;
+        softHashes_[target] = 0;
+        softSubmitCounts_[target] = 0;
+    }
+
+    return true;
+}
+
+static void textureSoftExit(void)
+{
+    std::lock_guard<std::mutex> guard(softLock_);
+
+    for (auto &mirror : softMirrors_)
+    {
+        if (mirror != NULL)
+        {
+            poolFree(mirror);
+            mirror = NULL;
+        }
+    }
+}
+
+static bool textureSoftUpload(uint32_t target, const uint8_t *data, uint32_t dirtyRows)
+{
+    std::lock_guard<std::mutex> guard(softLock_);
+
+    if (isSoftFilled_[target] == false)
+    {
+        dirtyRows = TEXTURE_ALL_ROWS;
+        isSoftFilled_[target] = true;
+    }
+
+    // the same runs the gpu backends copy, nothing else may reach the mirror
+    uint32_t y, height;
+    while (textureTakeRun(&dirtyRows, &y, &height) != false)
+    {
+        memcpy(
+            softMirrors_[target] + y * FRAME_STRIDE,
+            data + y * FRAME_STRIDE,
+            height * FRAME_STRIDE);
+        textureCountUpload(height * FRAME_STRIDE);
+    }
+
+    return true;
+}
+
+// never reaches a runtime, the overlay may be NULL
+static vr::EVROverlayError textureSoftSubmit(
+    vr::IVROverlay *,
+    vr::VROverlayHandle_t,
+    uint32_t target)
+{
+    std::lock_guard<std::mutex> guard(softLock_);
+
+    softHashes_[target] = textureHashFrame(softMirrors_[target]);
+    ++softSubmitCounts_[target];
+    textureCountSubmit();
+
+    return vr::EVROverlayError::VROverlayError_None;
+}
+
+const TEXTURE_BACKEND textureBackendSoft = {
+    "soft",
+    NULL,
+    textureSoftInit,
+    textureSoftExit,
+    textureSoftUpload,
+    textureSoftSubmit,
+    NULL};
+
+bool textureSoftHash(uint32_t target, uint64_t *hash, uint64_t *submitCount)
+{
+    std::lock_guard<std::mutex> guard(softLock_);
+
+    if (target >= TEXTURE_TARGET_COUNT || softMirrors_[target] == NULL)
+    {
+        return false;
+    }
+
+    *hash = softHashes_[target];
+    *submitCount = softSubmitCounts_[target];
+    return true;
+}
+
+bool textureSoftRead(uint32_t target, uint8_t *frame)
+{
+    std::lock_guard<std::mutex> guard(softLock_);
+
+    if (target >= TEXTURE_TARGET_COUNT || softMirrors_[target] == NULL)
+    {
+        return false;
+    }
+
+    memcpy(frame, softMirrors_[target], FRAME_SIZE);
+    return true;
+}
+
+uint64_t textureHashFrame(const uint8_t *frame)
+{
+    // 64-bit words mixed in order, enough to tell frames apart, not crypto
+    uint64_t hash = 0x9e3779b97f4a7c15ull;
+    for (uint32_t i = 0; i < FRAME_SIZE; i += 8)
+    {
+        uint64_t word;
+        memcpy(&word, frame + i, 8);
+        hash ^= word * 0xff51afd7ed558ccdull;
+        hash = (hash << 31 | hash >> 33) * 0xc4ceb9fe1a85ec53ull;
+    }
+
+    return hash ^ hash >> 29;
+}
@@ -0,0 +1,88 @@
+#include "platform.h"
+#include "watchdog.h"
+
+static const char *phaseNames_[OVERLAY_PHASE_COUNT] = {
+    "idle",
+    "init",
+    "pollEvent",
+    "updateDevices",
+    "updateProps",
+    "render",
+    "sleep",
+    "shutdown"};
+
+void watchdogReset(WATCHDOG *watchdog)
+{
+    watchdog->graceNs.store(0, std::memory_order_relaxed);
+    watchdog->phase.store(OVERLAY_PHASE_IDLE, std::memory_order_relaxed);
+    watchdog->beatNs.store(0, std::memory_order_release);
+}
+
+void watchdogBeat(WATCHDOG *watchdog, OVERLAY_PHASE phase, uint64_t graceNs)
+{
+    // beatNs is published last so a checker never pairs a fresh beat with
+    // the grace period of the previous phase
+    watchdog->graceNs.store(graceNs, std::memory_order_relaxed);
+    watchdog->phase.store(phase, std::memory_order_relaxed);
+    watchdog->beatNs.store(platformNowNs(), std::memory_order_release);
+}
+
+bool watchdogCheck(
+    WATCHDOG *watchdog,
+    uint64_t nowNs,
+    uint64_t thresholdNs,
+    WATCHDOG_STALL *stall)
+{
+    auto beatNs = watchdog->beatNs.load(std::memory_order_acquire);
+    auto graceNs = watchdog->graceNs.load(std::memory_order_relaxed);
+    auto phase = watchdog->phase.load(std::memory_order_relaxed);
+
+    if (watchdog->isStalled != false)
+    {
+        if (beatNs == watchdog->stallBeatNs)
+        {
+            return false; // still stuck, already reported
+        }
+
+        watchdog->isStalled = false;
+
+        // the thread moved on (or went idle), report how long it was stuck
+        auto endNs = beatNs != 0 ? beatNs : nowNs;
+        stall->phase = watchdog->stallPhase;
+        stall->durationNs = endNs - watchdog->stallBeatNs - watchdog->stallGraceNs;
+        stall->isResolved = true;
+        return true;
+    }
+
+    if (beatNs == 0 || nowNs <= beatNs)
+    {
+        return false;
+    }
+
+    auto ageNs = nowNs - beatNs;
+    if (ageNs <= graceNs + thresholdNs)
+    {
+        return false;
+    }
+
+    watchdog->isStalled = true;
+    watchdog->stallPhase = phase;
+    watchdog->stallBeatNs = beatNs;
+    watchdog->stallGraceNs = graceNs;
+    watchdog->stallCount.fetch_add(1, std::memory_order_relaxed);
+
+    stall->phase = phase;
+    stall->durationNs = ageNs - graceNs;
+    stall->isResolved = false;
+    return true;
+}
+
+const char *watchdogPhaseName(uint32_t phase)
+{
+    if (phase >= OVERLAY_PHASE_COUNT)
+    {
+        return "unknown";
+    }
+
+    return phaseNames_[phase];
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+
+typedef enum _OVERLAY_PHASE
+{
+    OVERLAY_PHASE_IDLE = 0,
+    OVERLAY_PHASE_INIT,
+    OVERLAY_PHASE_POLL_EVENT,
+    OVERLAY_PHASE_UPDATE_DEVICES,
+    OVERLAY_PHASE_UPDATE_PROPS,
+    OVERLAY_PHASE_RENDER,
+    OVERLAY_PHASE_SLEEP,
+    OVERLAY_PHASE_SHUTDOWN,
+    OVERLAY_PHASE_COUNT
+} OVERLAY_PHASE;
+
+typedef struct _WATCHDOG_STALL
+{
+    uint32_t phase;
+    uint64_t durationNs;
+    bool isResolved;
+} WATCHDOG_STALL;
+
+typedef struct _WATCHDOG
+{
+    // written by the watched thread
+    std::atomic<uint64_t> beatNs;
+    std::atomic<uint64_t> graceNs;
+    std::atomic<uint32_t> phase;
+    // written by the checking thread
+    std::atomic<uint32_t> stallCount;
+    bool isStalled;
+    uint32_t stallPhase;
+    uint64_t stallBeatNs;
+    uint64_t stallGraceNs;
+} WATCHDOG;
+
+void watchdogReset(WATCHDOG *watchdog);
+void watchdogBeat(WATCHDOG *watchdog, OVERLAY_PHASE phase, uint64_t graceNs = 0);
+bool watchdogCheck(
+    WATCHDOG *watchdog,
+    uint64_t nowNs,
+    uint64_t thresholdNs,
+    WATCHDOG_STALL *stall);
+const char *watchdogPhaseName(uint32_t phase);
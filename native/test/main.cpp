@@ -0,0 +1,69 @@
+#include <stdio.h>
+#include <string.h>
+#include "test.h"
+
+// usage: test [--filter <substring>]
+// prints every failed check, exits 1 when there was one
+
+bool testBegin(TEST_CONTEXT *ctx, const char *name)
+{
+    if (ctx->filter != NULL && strstr(name, ctx->filter) == NULL)
+    {
+        return false;
+    }
+
+    ctx->name = name;
+    ++ctx->caseCount;
+    return true;
+}
+
+bool testCheck(TEST_CONTEXT *ctx, bool isOk, const char *expr, const char *file, int line)
+{
+    ++ctx->checkCount;
+
+    if (isOk == false)
+    {
+        fprintf(stderr, "%s:%d: %s: failed: %s\n", file, line, ctx->name, expr);
+        ++ctx->failCount;
+    }
+
+    return isOk;
+}
+
+int main(int argc, char **argv)
+{
+    TEST_CONTEXT ctx;
+    memset(&ctx, 0, sizeof(ctx));
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+        {
+            ctx.filter = argv[++i];
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--filter <substring>]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    testCodec(&ctx);
+    testCompositor(&ctx);
+    testFollow(&ctx);
+    testFrame(&ctx);
+    testGovernor(&ctx);
+    testPool(&ctx);
+    testProps(&ctx);
+    testScale(&ctx);
+    testStaging(&ctx);
+    testText(&ctx);
+
+    printf(
+        "%u cases, %u checks, %u failed\n",
+        ctx.caseCount,
+        ctx.checkCount,
+        ctx.failCount);
+
+    return ctx.failCount != 0 ? 1 : 0;
+}
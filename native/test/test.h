@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stdint.h>
+
+typedef struct _TEST_CONTEXT
+{
+    const char *filter;
+    const char *name; // of the case running
+    uint32_t caseCount;
+    uint32_t checkCount;
+    uint32_t failCount;
+} TEST_CONTEXT;
+
+// false when the case is filtered out
+bool testBegin(TEST_CONTEXT *ctx, const char *name);
+bool testCheck(TEST_CONTEXT *ctx, bool isOk, const char *expr, const char *file, int line);
+
+#define TEST_CHECK(ctx, expr) testCheck((ctx), (expr), #expr, __FILE__, __LINE__)
+#define TEST_NEAR(ctx, a, b, tolerance) \
+    testCheck((ctx), ((a) - (b)) <= (tolerance) && ((b) - (a)) <= (tolerance), #a " ~ " #b, __FILE__, __LINE__)
+
+void testCodec(TEST_CONTEXT *ctx);
+void testCompositor(TEST_CONTEXT *ctx);
+void testFollow(TEST_CONTEXT *ctx);
+void testFrame(TEST_CONTEXT *ctx);
+void testGovernor(TEST_CONTEXT *ctx);
+void testPool(TEST_CONTEXT *ctx);
+void testProps(TEST_CONTEXT *ctx);
+void testScale(TEST_CONTEXT *ctx);
+void testStaging(TEST_CONTEXT *ctx);
+void testText(TEST_CONTEXT *ctx);
@@ -0,0 +1,115 @@
+#include <stdlib.h>
+#include <string.h>
+#include "../src/codec.h"
+#include "../src/frame.h"
+#include "test.h"
+
+// flat panels with noisy blocks, so every op of the codec shows up
+static void testCodecFill(uint8_t *frame, uint32_t x, uint32_t y, uint32_t width, uint32_t height, uint32_t seed)
+{
+    auto state = seed * 2654435761u + 1;
+
+    for (uint32_t row = y; row < y + height; ++row)
+    {
+        auto pixels = (uint32_t *)(frame + row * FRAME_STRIDE);
+        for (uint32_t column = x; column < x + width; ++column)
+        {
+            state = state * 1664525u + 1013904223u;
+            if ((column / 32 + row / 32 + seed) % 3 == 0)
+            {
+                pixels[column] = state;
+            }
+            else if ((column / 32 + row / 32) % 3 == 1)
+            {
+                pixels[column] = 0xe0202020u + (state >> 30); // small deltas
+            }
+            else
+            {
+                pixels[column] = 0xff000000u | seed * 0x010203u;
+            }
+        }
+    }
+}
+
+void testCodec(TEST_CONTEXT *ctx)
+{
+    auto frame = (uint8_t *)calloc(1, FRAME_SIZE);
+    auto decoded = (uint8_t *)calloc(1, FRAME_SIZE);
+    auto out = (uint8_t *)malloc(frameImageBound() > framePngBound() ? frameImageBound() : framePngBound());
+    if (frame == NULL || decoded == NULL || out == NULL)
+    {
+        TEST_CHECK(ctx, false);
+        return;
+    }
+
+    // a stream of dirty rects decodes into the same frame the encoder saw
+    if (testBegin(ctx, "codec/stream") != false)
+    {
+        FRAME_CODEC encoder;
+        FRAME_CODEC decoder;
+        TEST_CHECK(ctx, frameCodecInit(&encoder));
+        TEST_CHECK(ctx, frameCodecInit(&decoder));
+
+        static const uint32_t rects[][4] = {
+            {0, 0, FRAME_WIDTH, FRAME_HEIGHT},
+            {10, 20, 100, 50},
+            {FRAME_WIDTH - 64, FRAME_HEIGHT - 1, 64, 1},
+            {0, 100, FRAME_WIDTH, 200},
+            {300, 0, 1, FRAME_HEIGHT}};
+
+        auto seed = 1u;
+        for (auto &rect : rects)
+        {
+            testCodecFill(frame, rect[0], rect[1], rect[2], rect[3], seed++);
+
+            auto size = frameEncode(&encoder, out, frame, rect[0], rect[1], rect[2], rect[3]);
+            TEST_CHECK(ctx, size != 0 && size <= frameCodecBound(rect[2], rect[3]));
+            TEST_CHECK(ctx, frameDecode(&decoder, out, size, rect[0], rect[1], rect[2], rect[3]));
+            TEST_CHECK(ctx, memcmp(decoder.reference, frame, FRAME_SIZE) == 0);
+        }
+
+        // an unchanged rect costs next to nothing
+        auto size = frameEncode(&encoder, out, frame, 0, 0, FRAME_WIDTH, FRAME_HEIGHT);
+        TEST_CHECK(ctx, size < 256);
+        TEST_CHECK(ctx, frameDecode(&decoder, out, size, 0, 0, FRAME_WIDTH, FRAME_HEIGHT));
+        TEST_CHECK(ctx, memcmp(decoder.reference, frame, FRAME_SIZE) == 0);
+
+        // cut short, the decoder notices
+        testCodecFill(frame, 0, 0, 64, 64, 99);
+        size = frameEncode(&encoder, out, frame, 0, 0, 64, 64);
+        TEST_CHECK(ctx, frameDecode(&decoder, out, size - 1, 0, 0, 64, 64) == false);
+
+        frameCodecExit(&encoder);
+        frameCodecExit(&decoder);
+    }
+
+    if (testBegin(ctx, "codec/image") != false)
+    {
+        testCodecFill(frame, 0, 0, FRAME_WIDTH, FRAME_HEIGHT, 7);
+
+        auto size = frameImageEncode(out, frame);
+        TEST_CHECK(ctx, size > sizeof(FRAME_IMAGE_HEADER) && size <= frameImageBound());
+        TEST_CHECK(ctx, frameImageDecode(decoded, out, size));
+        TEST_CHECK(ctx, memcmp(decoded, frame, FRAME_SIZE) == 0);
+
+        TEST_CHECK(ctx, frameImageDecode(decoded, out, size - 1) == false);
+        out[0] ^= 1; // magic
+        TEST_CHECK(ctx, frameImageDecode(decoded, out, size) == false);
+    }
+
+    if (testBegin(ctx, "codec/png") != false)
+    {
+        static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+        static const uint8_t end[8] = {'I', 'E', 'N', 'D', 0xae, 0x42, 0x60, 0x82};
+
+        auto size = framePngEncode(out, frame);
+        TEST_CHECK(ctx, size == framePngBound());
+        TEST_CHECK(ctx, memcmp(out, signature, sizeof(signature)) == 0);
+        TEST_CHECK(ctx, memcmp(out + 12, "IHDR", 4) == 0);
+        TEST_CHECK(ctx, size >= 8 && memcmp(out + size - 8, end, sizeof(end)) == 0);
+    }
+
+    free(out);
+    free(decoded);
+    free(frame);
+}
@@ -0,0 +1,198 @@
+#include <string.h>
+#include "../src/compositor.h"
+#include "../src/frame.h"
+#include "../src/pool.h"
+#include "test.h"
+
+// an opaque sprite of one colour, as canvas hands it out (rgba)
+static void testSolid(uint8_t *rgba, uint32_t count, uint8_t r, uint8_t g, uint8_t b)
+{
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        rgba[i * 4 + 0] = r;
+        rgba[i * 4 + 1] = g;
+        rgba[i * 4 + 2] = b;
+        rgba[i * 4 + 3] = 255;
+    }
+}
+
+// the composite at (x, y), as bgra
+static uint32_t testPixel(const OVERLAY_DATA *overlayData, uint32_t x, uint32_t y)
+{
+    uint32_t pixel;
+    memcpy(&pixel, (const uint8_t *)overlayData->data + (y * FRAME_WIDTH + x) * 4, 4);
+    return pixel;
+}
+
+static bool testNoDamage(const COMPOSITOR *compositor)
+{
+    for (auto damage : compositor->damage)
+    {
+        if (damage != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+#define TEST_RED 0xffff0000u // bgra in memory, read little endian
+#define TEST_GREEN 0xff00ff00u
+#define TEST_BLUE 0xff0000ffu
+
+void testCompositor(TEST_CONTEXT *ctx)
+{
+    auto data = (uint8_t *)poolAlloc(true);
+    auto page = (uint8_t *)poolAlloc(true);
+    TEST_CHECK(ctx, data != NULL && page != NULL);
+    if (data == NULL || page == NULL)
+    {
+        poolFree(data);
+        poolFree(page);
+        return;
+    }
+
+    uint8_t red[32 * 32 * 4];
+    uint8_t green[32 * 32 * 4];
+    uint8_t blue[32 * 32 * 4];
+    testSolid(red, 32 * 32, 255, 0, 0);
+    testSolid(green, 32 * 32, 0, 255, 0);
+    testSolid(blue, 32 * 32, 0, 0, 255);
+
+    // higher z on top, equal z in creation order, re-sorted on a change
+    if (testBegin(ctx, "compositor/order") != false)
+    {
+        memset(data, 0, FRAME_SIZE);
+        OVERLAY_DATA overlayData;
+        overlayDataInit(&overlayData, data);
+
+        SPRITE_PROPS top = {0, 0, 5, 255, true};
+        SPRITE_PROPS low = {0, 0, 1, 255, true};
+        auto a = compositorCreateSprite(&overlayData, red, 32, 32, &top);
+        auto b = compositorCreateSprite(&overlayData, green, 32, 32, &low);
+        TEST_CHECK(ctx, a != 0 && b != 0 && a != b);
+        TEST_CHECK(ctx, testPixel(&overlayData, 0, 0) == TEST_RED);
+
+        auto c = compositorCreateSprite(&overlayData, blue, 32, 32, &top);
+        TEST_CHECK(ctx, testPixel(&overlayData, 0, 0) == TEST_BLUE);
+
+        SPRITE_PROPS props;
+        TEST_CHECK(ctx, compositorGetSprite(&overlayData, b, &props) && props.z == 1);
+        props.z = 9;
+        TEST_CHECK(ctx, compositorUpdateSprite(&overlayData, b, &props));
+        TEST_CHECK(ctx, testPixel(&overlayData, 0, 0) == TEST_GREEN);
+
+        props.isVisible = false;
+        compositorUpdateSprite(&overlayData, b, &props);
+        TEST_CHECK(ctx, testPixel(&overlayData, 0, 0) == TEST_BLUE);
+
+        auto compositor = overlayData.compositor;
+        TEST_CHECK(ctx, compositor->count == 3);
+        TEST_CHECK(ctx, compositor->sprites[compositor->order[0]].id == a);
+        TEST_CHECK(ctx, compositor->sprites[compositor->order[1]].id == c);
+        TEST_CHECK(ctx, compositor->sprites[compositor->order[2]].id == b);
+
+        TEST_CHECK(ctx, compositorGetSprite(&overlayData, 0, &props) == false);
+        TEST_CHECK(ctx, compositorUpdateSprite(&overlayData, 999, &props) == false);
+
+        compositorDestroySprite(&overlayData, a);
+        compositorDestroySprite(&overlayData, b);
+        compositorDestroySprite(&overlayData, c);
+    }
+
+    // only the tiles under a change are composited, and their rows uploaded
+    if (testBegin(ctx, "compositor/damage") != false)
+    {
+        memset(data, 0, FRAME_SIZE);
+        OVERLAY_DATA overlayData;
+        overlayDataInit(&overlayData, data);
+
+        // straddles the tiles at (1, 2)..(2, 3)
+        SPRITE_PROPS props = {40, 80, 0, 255, true};
+        auto id = compositorCreateSprite(&overlayData, red, 32, 32, &props);
+        TEST_CHECK(ctx, id != 0);
+        TEST_CHECK(ctx, testNoDamage(overlayData.compositor));
+
+        uint32_t dirtyRows;
+        TEST_CHECK(ctx, frameTakeDirty(&overlayData, &dirtyRows));
+        TEST_CHECK(ctx, dirtyRows == 0xcu);
+        TEST_CHECK(ctx, overlayData.filledTiles == 4);
+        TEST_CHECK(ctx, testPixel(&overlayData, 40, 80) == TEST_RED);
+        TEST_CHECK(ctx, testPixel(&overlayData, 39, 80) == 0);
+        TEST_CHECK(ctx, testPixel(&overlayData, 71, 111) == TEST_RED);
+        TEST_CHECK(ctx, testPixel(&overlayData, 72, 111) == 0);
+
+        // moved down: rows it left and rows it entered
+        props.y = 200;
+        compositorUpdateSprite(&overlayData, id, &props);
+        TEST_CHECK(ctx, frameTakeDirty(&overlayData, &dirtyRows));
+        TEST_CHECK(ctx, dirtyRows == (0xcu | 0x40u | 0x80u));
+        TEST_CHECK(ctx, testPixel(&overlayData, 40, 80) == 0);
+        TEST_CHECK(ctx, testPixel(&overlayData, 40, 200) == TEST_RED);
+        TEST_CHECK(ctx, overlayData.filledTiles == 4);
+
+        // a page paint under the sprite stays under it
+        memset(page, 0x11, FRAME_SIZE);
+        overlayDataWrite(&overlayData, page, 0, 192, FRAME_WIDTH, 32);
+        TEST_CHECK(ctx, frameTakeDirty(&overlayData, &dirtyRows) && dirtyRows == 0x40u);
+        TEST_CHECK(ctx, testPixel(&overlayData, 40, 200) == TEST_RED);
+        TEST_CHECK(ctx, testPixel(&overlayData, 0, 200) == 0x11111111u);
+        TEST_CHECK(ctx, testNoDamage(overlayData.compositor));
+
+        // outside the frame nothing is damaged, nothing is dirty
+        props.x = -100;
+        props.y = -100;
+        compositorUpdateSprite(&overlayData, id, &props);
+        frameTakeDirty(&overlayData, &dirtyRows);
+        compositorUpdateSprite(&overlayData, id, &props);
+        TEST_CHECK(ctx, frameTakeDirty(&overlayData, &dirtyRows) == false);
+
+        compositorDestroySprite(&overlayData, id);
+    }
+
+    // the page buffer only lives while sprites do
+    if (testBegin(ctx, "compositor/page") != false)
+    {
+        memset(data, 0, FRAME_SIZE);
+        OVERLAY_DATA overlayData;
+        overlayDataInit(&overlayData, data);
+        TEST_CHECK(ctx, compositorIsActive(&overlayData) == false);
+        TEST_CHECK(ctx, compositorPage(&overlayData) == data);
+
+        POOL_STATS before;
+        poolGetStats(&before);
+
+        SPRITE_PROPS props = {0, 0, 0, 255, true};
+        auto a = compositorCreateSprite(&overlayData, red, 32, 32, &props);
+        auto b = compositorCreateSprite(&overlayData, NULL, 16, 16, &props);
+        TEST_CHECK(ctx, compositorIsActive(&overlayData));
+        TEST_CHECK(ctx, compositorPage(&overlayData) != data);
+
+        POOL_STATS stats;
+        poolGetStats(&stats);
+        TEST_CHECK(ctx, stats.inUse == before.inUse + 1);
+
+        // painted while composited, and kept when the compositor goes
+        memset(page, 0x22, FRAME_SIZE);
+        overlayDataWrite(&overlayData, page, 0, 0, FRAME_WIDTH, FRAME_HEIGHT);
+        TEST_CHECK(ctx, testPixel(&overlayData, 0, 0) == TEST_RED);
+
+        TEST_CHECK(ctx, compositorDestroySprite(&overlayData, a));
+        TEST_CHECK(ctx, compositorIsActive(&overlayData));
+        TEST_CHECK(ctx, compositorDestroySprite(&overlayData, b));
+        TEST_CHECK(ctx, compositorIsActive(&overlayData) == false);
+        TEST_CHECK(ctx, compositorDestroySprite(&overlayData, b) == false);
+        TEST_CHECK(ctx, memcmp(data, page, FRAME_SIZE) == 0);
+
+        poolGetStats(&stats);
+        TEST_CHECK(ctx, stats.inUse == before.inUse);
+
+        // and a failed create doesn't leave one behind
+        TEST_CHECK(ctx, compositorCreateSprite(&overlayData, NULL, 0, 16, &props) == 0);
+        TEST_CHECK(ctx, compositorCreateSprite(&overlayData, NULL, FRAME_WIDTH + 1, 16, &props) == 0);
+        TEST_CHECK(ctx, compositorIsActive(&overlayData) == false);
+    }
+
+    poolFree(page);
+    poolFree(data);
+}
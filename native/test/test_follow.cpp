@@ -0,0 +1,219 @@
+#include <math.h>
+#include <string.h>
+#include "../src/follow.h"
+#include "test.h"
+
+#define TEST_MS 1000000ull
+#define TEST_RAD(deg) ((deg) * 3.14159265f / 180.0f)
+
+static const float offset_[12] = {
+    1.0f, 0.0f, 0.0f, 0.0f,
+    0.0f, 1.0f, 0.0f, 0.0f,
+    0.0f, 0.0f, 1.0f, -1.0f}; // a metre ahead
+
+// rotations of the head, as row-major 3x4 at the origin
+static void testYaw(float *m, float deg)
+{
+    auto c = cosf(TEST_RAD(deg)), s = sinf(TEST_RAD(deg));
+    const float r[12] = {c, 0.0f, s, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, -s, 0.0f, c, 0.0f};
+    memcpy(m, r, sizeof(r));
+}
+
+static void testPitch(float *m, float deg)
+{
+    auto c = cosf(TEST_RAD(deg)), s = sinf(TEST_RAD(deg));
+    const float r[12] = {1.0f, 0.0f, 0.0f, 0.0f, 0.0f, c, -s, 0.0f, 0.0f, s, c, 0.0f};
+    memcpy(m, r, sizeof(r));
+}
+
+static void testRoll(float *m, float deg)
+{
+    auto c = cosf(TEST_RAD(deg)), s = sinf(TEST_RAD(deg));
+    const float r[12] = {c, -s, 0.0f, 0.0f, s, c, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f};
+    memcpy(m, r, sizeof(r));
+}
+
+static bool testMatrixNear(const float *a, const float *b, float tolerance)
+{
+    for (uint32_t i = 0; i < 12; ++i)
+    {
+        if (fabsf(a[i] - b[i]) > tolerance)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void testFollow(TEST_CONTEXT *ctx)
+{
+    FOLLOW_CONFIG config;
+    followDefaultConfig(&config);
+
+    float hmd[12];
+    float transform[12];
+    float expected[12];
+
+    if (testBegin(ctx, "follow/snap") != false)
+    {
+        FOLLOW follow;
+        memset(&follow, 0, sizeof(follow));
+        followInit(&follow, &config);
+
+        testYaw(hmd, 40.0f);
+        hmd[3] = 0.5f;
+        hmd[7] = 1.6f;
+        TEST_CHECK(ctx, followUpdate(&follow, hmd, offset_, 0, transform));
+        followMultiply(expected, hmd, offset_);
+        TEST_CHECK(ctx, testMatrixNear(transform, expected, 1e-5f));
+        TEST_CHECK(ctx, follow.isMoving == false);
+        TEST_CHECK(ctx, follow.submitCount == 1);
+
+        // nothing moved, nothing to submit
+        TEST_CHECK(ctx, followUpdate(&follow, hmd, offset_, 10 * TEST_MS, transform) == false);
+        TEST_CHECK(ctx, follow.submitCount == 1);
+    }
+
+    if (testBegin(ctx, "follow/deadzone") != false)
+    {
+        FOLLOW follow;
+        memset(&follow, 0, sizeof(follow));
+        followInit(&follow, &config);
+
+        testYaw(hmd, 0.0f);
+        followUpdate(&follow, hmd, offset_, 0, expected);
+
+        // inside the deadzone the overlay stays where it is
+        testYaw(hmd, config.deadzoneDeg - 5.0f);
+        TEST_CHECK(ctx, followUpdate(&follow, hmd, offset_, 10 * TEST_MS, transform) == false);
+        TEST_CHECK(ctx, follow.isMoving == false);
+        TEST_CHECK(ctx, testMatrixNear(follow.submitted, expected, 0.0f));
+        TEST_NEAR(ctx, follow.position[2], -1.0f, 1e-5f);
+
+        hmd[3] = config.deadzoneMeters * 0.5f;
+        TEST_CHECK(ctx, followUpdate(&follow, hmd, offset_, 20 * TEST_MS, transform) == false);
+        TEST_CHECK(ctx, follow.isMoving == false);
+    }
+
+    // past the deadzone it eases in with dampingMs, then comes to rest
+    if (testBegin(ctx, "follow/ease") != false)
+    {
+        FOLLOW follow;
+        memset(&follow, 0, sizeof(follow));
+        followInit(&follow, &config);
+
+        testYaw(hmd, 0.0f);
+        followUpdate(&follow, hmd, offset_, 0, transform);
+
+        auto deg = config.deadzoneDeg + 15.0f;
+        testYaw(hmd, deg);
+        float target[12];
+        followMultiply(target, hmd, offset_);
+
+        TEST_CHECK(ctx, followUpdate(&follow, hmd, offset_, 10 * TEST_MS, transform));
+        TEST_CHECK(ctx, follow.isMoving != false);
+
+        // one 10ms step of an exponential ease
+        auto t = 1.0f - expf(-10.0f / config.dampingMs);
+        TEST_NEAR(ctx, transform[3], target[3] * t, 1e-4f);
+        TEST_NEAR(ctx, transform[11], -1.0f + (target[11] + 1.0f) * t, 1e-4f);
+
+        // after one time constant about 63% of the way
+        for (uint64_t nowMs = 20; nowMs <= (uint64_t)config.dampingMs; nowMs += 10)
+        {
+            followUpdate(&follow, hmd, offset_, nowMs * TEST_MS, transform);
+        }
+        TEST_NEAR(ctx, follow.position[0] / target[3], 1.0f - expf(-1.0f), 0.01f);
+
+        uint64_t nowMs = (uint64_t)config.dampingMs;
+        for (uint32_t i = 0; i < 500 && follow.isMoving != false; ++i)
+        {
+            nowMs += 10;
+            followUpdate(&follow, hmd, offset_, nowMs * TEST_MS, transform);
+        }
+        TEST_CHECK(ctx, follow.isMoving == false);
+        TEST_CHECK(ctx, testMatrixNear(follow.submitted, target, 0.005f));
+
+        // a stalled tick is clamped rather than jumped
+        FOLLOW stalled;
+        memset(&stalled, 0, sizeof(stalled));
+        followInit(&stalled, &config);
+        testYaw(hmd, 0.0f);
+        followUpdate(&stalled, hmd, offset_, 0, transform);
+        testYaw(hmd, deg);
+        followUpdate(&stalled, hmd, offset_, 5000 * TEST_MS, transform);
+        TEST_CHECK(ctx, stalled.isMoving != false);
+        TEST_NEAR(ctx, stalled.position[0] / target[3], 1.0f - expf(-100.0f / config.dampingMs), 0.001f);
+    }
+
+    if (testBegin(ctx, "follow/epsilon") != false)
+    {
+        auto snap = config;
+        snap.dampingMs = 0.0f;
+        snap.deadzoneDeg = 0.0f;
+        snap.deadzoneMeters = 0.0f;
+
+        FOLLOW follow;
+        memset(&follow, 0, sizeof(follow));
+        followInit(&follow, &snap);
+
+        testYaw(hmd, 0.0f);
+        followUpdate(&follow, hmd, offset_, 0, transform);
+
+        // moved by exactly epsilon: not worth a submit
+        hmd[3] = snap.epsilon;
+        TEST_CHECK(ctx, followUpdate(&follow, hmd, offset_, 10 * TEST_MS, transform) == false);
+        TEST_NEAR(ctx, transform[3], snap.epsilon, 0.0f);
+        TEST_CHECK(ctx, follow.submitCount == 1);
+
+        hmd[3] = snap.epsilon * 2.5f;
+        TEST_CHECK(ctx, followUpdate(&follow, hmd, offset_, 20 * TEST_MS, transform));
+        TEST_CHECK(ctx, follow.submitCount == 2);
+
+        // a retarget submits even in place
+        followRetarget(&follow);
+        TEST_CHECK(ctx, followUpdate(&follow, hmd, offset_, 30 * TEST_MS, transform));
+    }
+
+    if (testBegin(ctx, "follow/upright") != false)
+    {
+        FOLLOW follow;
+        memset(&follow, 0, sizeof(follow));
+        followInit(&follow, &config);
+
+        // heading 20 degrees, looking down and tilted: only the heading counts
+        float yaw[12], pitch[12], roll[12], yawPitch[12];
+        testYaw(yaw, 20.0f);
+        testPitch(pitch, -30.0f);
+        testRoll(roll, 10.0f);
+        followMultiply(yawPitch, yaw, pitch);
+        followMultiply(hmd, yawPitch, roll);
+        hmd[7] = 1.6f;
+        yaw[7] = 1.6f;
+
+        TEST_CHECK(ctx, followUpdate(&follow, hmd, offset_, 0, transform));
+        followMultiply(expected, yaw, offset_);
+        TEST_CHECK(ctx, testMatrixNear(transform, expected, 1e-4f));
+        TEST_NEAR(ctx, transform[5], 1.0f, 1e-5f);
+
+        // without upright the overlay pitches and rolls with the head
+        auto tiltConfig = config;
+        tiltConfig.isUpright = false;
+        FOLLOW tilted;
+        memset(&tilted, 0, sizeof(tilted));
+        followInit(&tilted, &tiltConfig);
+        TEST_CHECK(ctx, followUpdate(&tilted, hmd, offset_, 0, transform));
+        followMultiply(expected, hmd, offset_);
+        TEST_CHECK(ctx, testMatrixNear(transform, expected, 1e-4f));
+
+        // straight up there is no heading to follow
+        FOLLOW up;
+        memset(&up, 0, sizeof(up));
+        followInit(&up, &config);
+        testPitch(hmd, 90.0f);
+        hmd[2] = 0.0f;
+        hmd[10] = 0.0f;
+        TEST_CHECK(ctx, followUpdate(&up, hmd, offset_, 0, transform) == false);
+        TEST_CHECK(ctx, up.hasPose == false && up.submitCount == 0);
+    }
+}
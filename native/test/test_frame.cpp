@@ -0,0 +1,51 @@
+#include <string.h>
+#include "../src/frame.h"
+#include "../src/pool.h"
+#include "test.h"
+
+void testFrame(TEST_CONTEXT *ctx)
+{
+    // a paint after shared frames can't trust the cpu frame outside its rect
+    if (testBegin(ctx, "frame/shared") != false)
+    {
+        auto data = (uint8_t *)poolAlloc(true);
+        auto bitmap = (uint8_t *)poolAlloc(false);
+        TEST_CHECK(ctx, data != NULL && bitmap != NULL);
+        if (data == NULL || bitmap == NULL)
+        {
+            poolFree(data);
+            poolFree(bitmap);
+            return;
+        }
+
+        OVERLAY_DATA overlayData;
+        overlayDataInit(&overlayData, data);
+        memset(bitmap, 0x40, FRAME_SIZE);
+
+        uint32_t dirtyRows;
+        overlayDataWrite(&overlayData, bitmap, 0, 0, 32, 32);
+        TEST_CHECK(ctx, frameTakeDirty(&overlayData, &dirtyRows) && dirtyRows == 1);
+        TEST_CHECK(ctx, data[FRAME_SIZE - 1] == 0);
+
+        overlayData.isShared = true;
+        TEST_CHECK(ctx, frameIsEmpty(&overlayData) == false);
+
+        overlayDataWrite(&overlayData, bitmap, 0, 0, 32, 32);
+        TEST_CHECK(ctx, overlayData.isShared == false);
+        TEST_CHECK(ctx, memcmp(data, bitmap, FRAME_SIZE) == 0);
+        TEST_CHECK(ctx, frameTakeDirty(&overlayData, &dirtyRows));
+        TEST_CHECK(ctx, dirtyRows == (1u << FRAME_TILES_Y) - 1);
+        TEST_CHECK(ctx, overlayData.filledTiles == FRAME_TILE_COUNT);
+
+        // and from then on only the rect again
+        memset(bitmap, 0, FRAME_SIZE);
+        overlayDataWrite(&overlayData, bitmap, 0, FRAME_HEIGHT - 32, 32, 32);
+        TEST_CHECK(ctx, frameTakeDirty(&overlayData, &dirtyRows));
+        TEST_CHECK(ctx, dirtyRows == 1u << (FRAME_TILES_Y - 1));
+        TEST_CHECK(ctx, data[0] == 0x40);
+        TEST_CHECK(ctx, overlayData.filledTiles == FRAME_TILE_COUNT - 1);
+
+        poolFree(bitmap);
+        poolFree(data);
+    }
+}
@@ -0,0 +1,102 @@
+#include "../src/governor.h"
+#include "test.h"
+
+#define TEST_MS 1000000ull
+
+void testGovernor(TEST_CONTEXT *ctx)
+{
+    GOVERNOR_CONFIG config;
+    governorDefaultConfig(&config);
+
+    if (testBegin(ctx, "governor/config") != false)
+    {
+        TEST_CHECK(ctx, governorConfigIsValid(&config));
+
+        auto bad = config;
+        bad.idleFps = bad.lowFps + 1;
+        TEST_CHECK(ctx, governorConfigIsValid(&bad) == false);
+
+        bad = config;
+        bad.holdMs = 50;
+        TEST_CHECK(ctx, governorConfigIsValid(&bad) == false);
+    }
+
+    // a fresh overlay runs at full rate until it settles
+    if (testBegin(ctx, "governor/settle") != false)
+    {
+        GOVERNOR governor;
+        governorInit(&governor, &config, 0, 0);
+        TEST_CHECK(ctx, governor.mode == GOVERNOR_MODE_ACTIVE);
+        TEST_CHECK(ctx, governor.ingestFps == config.maxFps);
+        TEST_CHECK(ctx, governor.uploadFps == config.maxUploadFps);
+        TEST_CHECK(ctx, governorUploadIntervalNs(&governor) == 1000000000ull / config.maxUploadFps);
+
+        auto changes = 0;
+        for (uint64_t nowMs = 100; nowMs < config.holdMs; nowMs += 100)
+        {
+            changes += governorUpdate(&governor, nowMs * TEST_MS, 0, false, true);
+        }
+        TEST_CHECK(ctx, changes == 0);
+        TEST_CHECK(ctx, governor.mode == GOVERNOR_MODE_ACTIVE);
+
+        TEST_CHECK(ctx, governorUpdate(&governor, config.holdMs * TEST_MS, 0, false, true));
+        TEST_CHECK(ctx, governor.mode == GOVERNOR_MODE_IDLE);
+        TEST_CHECK(ctx, governor.ingestFps == config.idleFps);
+        TEST_CHECK(ctx, governor.uploadFps == config.idleFps);
+        TEST_CHECK(ctx, governor.modeChanges == 1);
+    }
+
+    // occasional damage is low, a burst is active again
+    if (testBegin(ctx, "governor/activity") != false)
+    {
+        GOVERNOR governor;
+        governorInit(&governor, &config, 0, 0);
+        governorUpdate(&governor, config.holdMs * TEST_MS, 0, false, true);
+
+        auto nowNs = (config.holdMs + 100) * TEST_MS;
+        TEST_CHECK(ctx, governorUpdate(&governor, nowNs, 1, false, true));
+        TEST_CHECK(ctx, governor.mode == GOVERNOR_MODE_LOW);
+        TEST_CHECK(ctx, governor.ingestFps == config.lowFps);
+        TEST_CHECK(ctx, governorDamageRate(&governor) == 1);
+
+        nowNs += 100 * TEST_MS;
+        TEST_CHECK(ctx, governorUpdate(&governor, nowNs, 1 + config.activeRate, false, true));
+        TEST_CHECK(ctx, governor.mode == GOVERNOR_MODE_ACTIVE);
+        TEST_CHECK(ctx, governorDamageRate(&governor) == 1 + config.activeRate);
+
+        // the damage history is a second long
+        nowNs += 1100 * TEST_MS;
+        governorUpdate(&governor, nowNs, 1 + config.activeRate, false, true);
+        TEST_CHECK(ctx, governorDamageRate(&governor) == 0);
+        TEST_CHECK(ctx, governor.mode == GOVERNOR_MODE_ACTIVE);
+    }
+
+    // the counter wraps, the damages in between still count
+    if (testBegin(ctx, "governor/wrap") != false)
+    {
+        GOVERNOR governor;
+        governorInit(&governor, &config, 0, UINT32_MAX - 1);
+        governorUpdate(&governor, 100 * TEST_MS, 2, false, true);
+        TEST_CHECK(ctx, governorDamageRate(&governor) == 4);
+    }
+
+    if (testBegin(ctx, "governor/hiddenAsleep") != false)
+    {
+        GOVERNOR governor;
+        governorInit(&governor, &config, 0, 0);
+
+        TEST_CHECK(ctx, governorUpdate(&governor, config.holdMs * TEST_MS, 0, true, true));
+        TEST_CHECK(ctx, governor.mode == GOVERNOR_MODE_HIDDEN);
+        TEST_CHECK(ctx, governor.ingestFps == config.idleFps);
+
+        // taken off: asleep whatever the content does
+        auto nowNs = (config.holdMs + 100) * TEST_MS;
+        TEST_CHECK(ctx, governorUpdate(&governor, nowNs, 10, false, false));
+        TEST_CHECK(ctx, governor.mode == GOVERNOR_MODE_ASLEEP);
+
+        // put back on: full rate right away, with or without damage
+        nowNs += 100 * TEST_MS;
+        TEST_CHECK(ctx, governorUpdate(&governor, nowNs, 10, false, true));
+        TEST_CHECK(ctx, governor.mode == GOVERNOR_MODE_ACTIVE);
+    }
+}
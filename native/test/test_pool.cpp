@@ -0,0 +1,73 @@
+#include <string.h>
+#include "../src/frame.h"
+#include "../src/pool.h"
+#include "test.h"
+
+static bool testIsZero(const uint8_t *data, size_t size)
+{
+    for (size_t i = 0; i < size; ++i)
+    {
+        if (data[i] != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void testPool(TEST_CONTEXT *ctx)
+{
+    // the stats are process wide, only their changes are looked at
+    if (testBegin(ctx, "pool/reuse") != false)
+    {
+        auto a = (uint8_t *)poolAlloc(true);
+        TEST_CHECK(ctx, a != NULL);
+        if (a == NULL)
+        {
+            return;
+        }
+
+        // a may have been a freed slot already, counted from here
+        POOL_STATS before;
+        poolGetStats(&before);
+        TEST_CHECK(ctx, ((uintptr_t)a & 4095) == 0);
+        TEST_CHECK(ctx, testIsZero(a, FRAME_SIZE));
+
+        // a dirty slot comes back zeroed when asked to
+        memset(a, 0xab, FRAME_SIZE);
+        poolFree(a);
+        auto b = (uint8_t *)poolAlloc(true);
+        TEST_CHECK(ctx, b == a);
+        TEST_CHECK(ctx, testIsZero(b, FRAME_SIZE));
+
+        // and as it was otherwise, past the free list link
+        memset(b, 0xcd, FRAME_SIZE);
+        poolFree(b);
+        auto c = (uint8_t *)poolAlloc(false);
+        TEST_CHECK(ctx, c == a);
+        TEST_CHECK(ctx, c[FRAME_SIZE - 1] == 0xcd);
+
+        POOL_STATS stats;
+        poolGetStats(&stats);
+        TEST_CHECK(ctx, stats.allocCount - before.allocCount == 2);
+        TEST_CHECK(ctx, stats.reuseCount - before.reuseCount == 2);
+        TEST_CHECK(ctx, stats.inUse == before.inUse);
+
+        // earlier cases may have left slots on the free list, either way
+        // it's another one
+        auto d = (uint8_t *)poolAlloc(true);
+        TEST_CHECK(ctx, d != NULL && d != c);
+        TEST_CHECK(ctx, d != NULL && testIsZero(d, FRAME_SIZE));
+
+        poolGetStats(&stats);
+        TEST_CHECK(ctx, stats.inUse - before.inUse == 1);
+        TEST_CHECK(ctx, stats.peakInUse >= stats.inUse);
+
+        poolFree(c);
+        poolFree(d);
+        poolFree(NULL);
+
+        poolGetStats(&stats);
+        TEST_CHECK(ctx, stats.inUse == before.inUse - 1);
+    }
+}
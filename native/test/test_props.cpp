@@ -0,0 +1,77 @@
+#include <math.h>
+#include "../src/props.h"
+#include "test.h"
+
+void testProps(TEST_CONTEXT *ctx)
+{
+    if (testBegin(ctx, "props/valid") != false)
+    {
+        OVERLAY_PROPS props;
+        propsDefault(&props);
+        TEST_CHECK(ctx, propsIsValid(&props));
+
+        auto bad = props;
+        bad.alpha = 1.5f;
+        TEST_CHECK(ctx, propsIsValid(&bad) == false);
+
+        bad = props;
+        bad.widthInMeters = NAN;
+        TEST_CHECK(ctx, propsIsValid(&bad) == false);
+
+        bad = props;
+        bad.widthInMeters = 0.0f;
+        TEST_CHECK(ctx, propsIsValid(&bad) == false);
+
+        bad = props;
+        bad.color[1] = -0.1f;
+        TEST_CHECK(ctx, propsIsValid(&bad) == false);
+
+        bad = props;
+        bad.transform[7] = INFINITY;
+        TEST_CHECK(ctx, propsIsValid(&bad) == false);
+    }
+
+    if (testBegin(ctx, "props/diff") != false)
+    {
+        OVERLAY_PROPS a;
+        propsDefault(&a);
+        auto b = a;
+        TEST_CHECK(ctx, propsDiff(&a, &b) == 0);
+
+        b.alpha = 0.5f;
+        b.transform[11] = -2.0f;
+        TEST_CHECK(ctx, propsDiff(&a, &b) == (PROPS_ALPHA | PROPS_TRANSFORM));
+
+        b = a;
+        b.widthInMeters = 2.0f;
+        b.color[2] = 0.0f;
+        b.sortOrder = 3;
+        b.isVisible = false;
+        TEST_CHECK(
+            ctx,
+            propsDiff(&a, &b) == (PROPS_WIDTH | PROPS_COLOR | PROPS_SORT_ORDER | PROPS_VISIBLE));
+    }
+
+    // the overlay thread copies out only what js set since it last looked
+    if (testBegin(ctx, "props/block") != false)
+    {
+        PROPS_BLOCK block;
+        propsBlockInit(&block);
+
+        OVERLAY_PROPS props;
+        uint32_t version = 0;
+        TEST_CHECK(ctx, propsBlockTake(&block, &props, &version) == false);
+
+        OVERLAY_PROPS set;
+        propsBlockGet(&block, &set);
+        set.alpha = 0.25f;
+        propsBlockSet(&block, &set);
+        set.sortOrder = 7;
+        propsBlockSet(&block, &set);
+
+        TEST_CHECK(ctx, propsBlockTake(&block, &props, &version));
+        TEST_CHECK(ctx, version == 2);
+        TEST_CHECK(ctx, propsDiff(&props, &set) == 0);
+        TEST_CHECK(ctx, propsBlockTake(&block, &props, &version) == false);
+    }
+}
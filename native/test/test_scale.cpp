@@ -0,0 +1,232 @@
+#include <string.h>
+#include "../src/compositor.h"
+#include "../src/frame.h"
+#include "../src/pool.h"
+#include "../src/scale.h"
+#include "test.h"
+
+typedef struct _TEST_DERIVE_CASE
+{
+    const char *name;
+    OVERLAY_DERIVE derive;
+} TEST_DERIVE_CASE;
+
+static const TEST_DERIVE_CASE deriveCases_[] = {
+    {"box2x", {true, 0, {0, 0, 512, 512}, {128, 128, 256, 256}, SCALE_FILTER_BOX}},
+    {"box4x", {true, 0, {64, 0, 256, 256}, {0, 448, 64, 64}, SCALE_FILTER_BOX}},
+    {"bilinear", {true, 0, {0, 0, 512, 512}, {106, 106, 300, 300}, SCALE_FILTER_BILINEAR}},
+    {"bilinearUp", {true, 0, {0, 256, 512, 256}, {0, 0, 512, 512}, SCALE_FILTER_BILINEAR}}};
+
+static void testFill(uint8_t *data, uint32_t seed)
+{
+    for (uint32_t i = 0; i < FRAME_SIZE; ++i)
+    {
+        data[i] = (uint8_t)((i + seed) * 2654435761u >> 24);
+    }
+}
+
+// kernels of every isa against the scalar ones
+static void testScaleKernels(TEST_CONTEXT *ctx, const uint8_t *source, uint8_t *expected, uint8_t *actual)
+{
+    auto scalar = scaleGetKernels(PIXEL_ISA_SCALAR);
+    TEST_CHECK(ctx, scalar != NULL);
+    if (scalar == NULL)
+    {
+        return;
+    }
+
+    uint16_t sx[300];
+    uint16_t fx[300];
+    for (uint32_t i = 0; i < 300; ++i)
+    {
+        auto pos = i * 510 * 256 / 300;
+        sx[i] = (uint16_t)(pos >> 8);
+        fx[i] = (uint16_t)(pos & 0xff);
+    }
+    sx[299] = 510; // clamped at the edge of the crop, all of the right one
+    fx[299] = 256;
+
+    for (uint32_t isa = 1; isa < PIXEL_ISA_COUNT; ++isa)
+    {
+        auto kernels = scaleGetKernels((PIXEL_ISA)isa);
+        if (kernels == NULL)
+        {
+            continue;
+        }
+
+        // odd widths leave a tail past the vector loop
+        scalar->box2x(expected, source, 251, 255);
+        kernels->box2x(actual, source, 251, 255);
+        TEST_CHECK(ctx, memcmp(expected, actual, 255 * FRAME_STRIDE) == 0);
+
+        scalar->box4x(expected, source, 125, 127);
+        kernels->box4x(actual, source, 125, 127);
+        TEST_CHECK(ctx, memcmp(expected, actual, 127 * FRAME_STRIDE) == 0);
+
+        auto isSame = true;
+        for (uint32_t fy = 0; fy <= 256; fy += 32)
+        {
+            scalar->bilinear(expected, source, source + FRAME_STRIDE, sx, fx, fy, 300);
+            kernels->bilinear(actual, source, source + FRAME_STRIDE, sx, fx, fy, 300);
+            isSame = isSame && memcmp(expected, actual, 300 * 4) == 0;
+        }
+        TEST_CHECK(ctx, isSame);
+    }
+}
+
+void testScale(TEST_CONTEXT *ctx)
+{
+    auto source = (uint8_t *)poolAlloc(true);
+    auto target = (uint8_t *)poolAlloc(true);
+    auto reference = (uint8_t *)poolAlloc(true);
+    auto bitmap = (uint8_t *)poolAlloc(true);
+    TEST_CHECK(ctx, source != NULL && target != NULL && reference != NULL && bitmap != NULL);
+    if (source == NULL || target == NULL || reference == NULL || bitmap == NULL)
+    {
+        poolFree(source);
+        poolFree(target);
+        poolFree(reference);
+        poolFree(bitmap);
+        return;
+    }
+
+    if (testBegin(ctx, "scale/kernels") != false)
+    {
+        testFill(source, 1);
+        testScaleKernels(ctx, source, target, reference);
+    }
+
+    // rounded averages, per channel
+    if (testBegin(ctx, "scale/box") != false)
+    {
+        auto scalar = scaleGetKernels(PIXEL_ISA_SCALAR);
+        const uint8_t quad[4][4] = {{0, 10, 255, 1}, {1, 20, 255, 1}, {2, 30, 255, 2}, {3, 41, 255, 2}};
+        memcpy(source, quad[0], 8);
+        memcpy(source + FRAME_STRIDE, quad[2], 8);
+        scalar->box2x(target, source, 1, 1);
+        TEST_CHECK(ctx, target[0] == 2 && target[1] == 25 && target[2] == 255 && target[3] == 2);
+
+        memset(source, 0, 4 * FRAME_STRIDE);
+        source[0] = 255;
+        scalar->box4x(target, source, 1, 1);
+        TEST_CHECK(ctx, target[0] == 16);
+    }
+
+    if (testBegin(ctx, "scale/valid") != false)
+    {
+        for (auto &item : deriveCases_)
+        {
+            TEST_CHECK(ctx, overlayDeriveIsValid(&item.derive));
+        }
+
+        OVERLAY_DERIVE derive = {true, 0, {0, 0, 512, 512}, {0, 0, 170, 170}, SCALE_FILTER_BOX};
+        TEST_CHECK(ctx, overlayDeriveIsValid(&derive) == false);
+        derive.place = {0, 0, 256, 128};
+        TEST_CHECK(ctx, overlayDeriveIsValid(&derive) == false);
+        derive.filter = SCALE_FILTER_BILINEAR;
+        TEST_CHECK(ctx, overlayDeriveIsValid(&derive));
+        derive.place = {400, 0, 256, 128};
+        TEST_CHECK(ctx, overlayDeriveIsValid(&derive) == false);
+        derive.place = {0, 0, 256, 128};
+        derive.crop = {0, 0, 1, 512};
+        TEST_CHECK(ctx, overlayDeriveIsValid(&derive) == false);
+        derive.crop = {0, 0, 0, 0};
+        TEST_CHECK(ctx, overlayDeriveIsValid(&derive) == false);
+    }
+
+    // resampling only what a paint can reach ends where a full refresh does
+    if (testBegin(ctx, "scale/derive") != false)
+    {
+        for (auto &item : deriveCases_)
+        {
+            auto derive = &item.derive;
+
+            testFill(source, 2);
+            OVERLAY_DATA sourceData;
+            OVERLAY_DATA targetData;
+            OVERLAY_DATA referenceData;
+            overlayDataInit(&sourceData, source);
+            memset(target, 0xff, FRAME_SIZE);
+            overlayDataInit(&targetData, target);
+            memset(reference, 0, FRAME_SIZE);
+            overlayDataInit(&referenceData, reference);
+
+            overlayDeriveRefresh(derive, &sourceData, &targetData);
+
+            // nothing but the placement
+            auto place = &derive->place;
+            auto isOutsideClear = true;
+            for (uint32_t y = 0; y < FRAME_HEIGHT; ++y)
+            {
+                for (uint32_t x = 0; x < FRAME_WIDTH; ++x)
+                {
+                    auto isInside = x >= place->x && x < place->x + place->width &&
+                                    y >= place->y && y < place->y + place->height;
+                    auto pixel = *(const uint32_t *)(target + (y * FRAME_WIDTH + x) * 4);
+                    isOutsideClear = isOutsideClear && (isInside != false || pixel == 0);
+                }
+            }
+            TEST_CHECK(ctx, isOutsideClear);
+
+            testFill(bitmap, 3);
+            overlayDataWrite(&sourceData, bitmap, 301, 117, 9, 16);
+
+            uint32_t x, y, width, height;
+            frameTakeDamage(&targetData, &x, &y, &width, &height);
+            TEST_CHECK(ctx, frameTakeDamage(&sourceData, &x, &y, &width, &height));
+            TEST_CHECK(ctx, x == 301 && y == 117 && width == 9 && height == 16);
+
+            uint32_t dirtyRows;
+            frameTakeDirty(&targetData, &dirtyRows);
+            overlayDeriveUpdate(derive, &sourceData, &targetData, x, y, width, height);
+            overlayDeriveRefresh(derive, &sourceData, &referenceData);
+
+            TEST_CHECK(ctx, memcmp(target, reference, FRAME_SIZE) == 0);
+
+            // a paint outside the crop doesn't touch the derived overlay
+            auto isInCrop = 117 + 16 > derive->crop.y && 117 < derive->crop.y + derive->crop.height;
+            TEST_CHECK(ctx, frameTakeDirty(&targetData, &dirtyRows) == isInCrop);
+        }
+    }
+
+    // compositor changes reach the derived overlay through the same damage
+    if (testBegin(ctx, "scale/compositor") != false)
+    {
+        auto derive = &deriveCases_[0].derive;
+
+        memset(source, 0, FRAME_SIZE);
+        OVERLAY_DATA sourceData;
+        OVERLAY_DATA targetData;
+        OVERLAY_DATA referenceData;
+        overlayDataInit(&sourceData, source);
+        overlayDataInit(&targetData, target);
+        overlayDataInit(&referenceData, reference);
+        overlayDeriveRefresh(derive, &sourceData, &targetData);
+
+        testFill(bitmap, 4);
+        SPRITE_PROPS props = {40, 70, 0, 255, true};
+        auto spriteId = compositorCreateSprite(&sourceData, bitmap, 64, 32, &props);
+        TEST_CHECK(ctx, spriteId != 0);
+
+        uint32_t x, y, width, height;
+        TEST_CHECK(ctx, frameTakeDamage(&sourceData, &x, &y, &width, &height));
+        TEST_CHECK(ctx, x <= 40 && y <= 70 && x + width >= 104 && y + height >= 102);
+        overlayDeriveUpdate(derive, &sourceData, &targetData, x, y, width, height);
+
+        overlayDeriveRefresh(derive, &sourceData, &referenceData);
+        TEST_CHECK(ctx, memcmp(target, reference, FRAME_SIZE) == 0);
+        TEST_CHECK(ctx, frameIsEmpty(&targetData) == false);
+
+        // gone again, composited away
+        compositorDestroySprite(&sourceData, spriteId);
+        TEST_CHECK(ctx, frameTakeDamage(&sourceData, &x, &y, &width, &height));
+        overlayDeriveUpdate(derive, &sourceData, &targetData, x, y, width, height);
+        TEST_CHECK(ctx, frameIsEmpty(&targetData));
+        TEST_CHECK(ctx, frameTakeDamage(&sourceData, &x, &y, &width, &height) == false);
+    }
+
+    poolFree(bitmap);
+    poolFree(reference);
+    poolFree(target);
+    poolFree(source);
+}
@@ -0,0 +1,115 @@
+#include "../src/staging.h"
+#include "test.h"
+
+void testStaging(TEST_CONTEXT *ctx)
+{
+    if (testBegin(ctx, "staging/init") != false)
+    {
+        STAGING_RING ring;
+        stagingRingInit(&ring, 0);
+        TEST_CHECK(ctx, ring.slotCount == 1);
+        stagingRingInit(&ring, STAGING_MAX_SLOTS + 3);
+        TEST_CHECK(ctx, ring.slotCount == STAGING_MAX_SLOTS);
+
+        uint32_t slot;
+        uint64_t fence;
+        TEST_CHECK(ctx, stagingRingPending(&ring, &slot, &fence) == false);
+    }
+
+    // round robin, and once every slot is in flight the next acquire is
+    // refused rather than waited for
+    if (testBegin(ctx, "staging/busy") != false)
+    {
+        STAGING_RING ring;
+        stagingRingInit(&ring, 3);
+
+        for (int32_t i = 0; i < 3; ++i)
+        {
+            auto slot = stagingRingAcquire(&ring);
+            TEST_CHECK(ctx, slot == i);
+            TEST_CHECK(ctx, stagingRingRelease(&ring, (uint32_t)slot) == (uint64_t)i + 1);
+        }
+
+        TEST_CHECK(ctx, stagingRingAcquire(&ring) == -1);
+        TEST_CHECK(ctx, stagingRingAcquire(&ring) == -1);
+        TEST_CHECK(ctx, ring.acquireCount == 5);
+        TEST_CHECK(ctx, ring.busyCount == 2);
+
+        // the oldest is the one to poll
+        uint32_t slot;
+        uint64_t fence;
+        TEST_CHECK(ctx, stagingRingPending(&ring, &slot, &fence));
+        TEST_CHECK(ctx, slot == 0 && fence == 1);
+
+        // a refused acquire didn't move the ring on
+        stagingRingComplete(&ring, 1);
+        TEST_CHECK(ctx, stagingRingAcquire(&ring) == 0);
+        TEST_CHECK(ctx, stagingRingAcquire(&ring) == -1);
+        TEST_CHECK(ctx, ring.busyCount == 3);
+    }
+
+    if (testBegin(ctx, "staging/wrap") != false)
+    {
+        STAGING_RING ring;
+        stagingRingInit(&ring, 3);
+
+        // a gpu one upload behind, for many turns of the ring
+        auto isInOrder = true;
+        for (uint32_t i = 0; i < 100; ++i)
+        {
+            if (ring.issued != 0)
+            {
+                stagingRingComplete(&ring, ring.issued);
+            }
+
+            auto slot = stagingRingAcquire(&ring);
+            isInOrder = isInOrder && slot == (int32_t)(i % 3);
+            if (slot >= 0)
+            {
+                stagingRingRelease(&ring, (uint32_t)slot);
+            }
+        }
+
+        TEST_CHECK(ctx, isInOrder);
+        TEST_CHECK(ctx, ring.busyCount == 0);
+        TEST_CHECK(ctx, ring.issued == 100);
+        TEST_CHECK(ctx, ring.fences[(100 - 1) % 3] == 100);
+
+        uint32_t slot;
+        uint64_t fence;
+        TEST_CHECK(ctx, stagingRingPending(&ring, &slot, &fence));
+        TEST_CHECK(ctx, slot == (100 - 1) % 3 && fence == 100);
+    }
+
+    // completes that arrive late or for serials never issued change nothing
+    if (testBegin(ctx, "staging/complete") != false)
+    {
+        STAGING_RING ring;
+        stagingRingInit(&ring, 3);
+
+        for (uint32_t i = 0; i < 3; ++i)
+        {
+            stagingRingRelease(&ring, (uint32_t)stagingRingAcquire(&ring));
+        }
+
+        stagingRingComplete(&ring, 2);
+        TEST_CHECK(ctx, ring.completed == 2);
+        stagingRingComplete(&ring, 1);
+        TEST_CHECK(ctx, ring.completed == 2);
+        stagingRingComplete(&ring, 9);
+        TEST_CHECK(ctx, ring.completed == 2);
+
+        // passing fence 2 passed fence 1 as well
+        uint32_t slot;
+        uint64_t fence;
+        TEST_CHECK(ctx, stagingRingPending(&ring, &slot, &fence));
+        TEST_CHECK(ctx, slot == 2 && fence == 3);
+        TEST_CHECK(ctx, stagingRingAcquire(&ring) == 0);
+        TEST_CHECK(ctx, stagingRingAcquire(&ring) == 1);
+        TEST_CHECK(ctx, stagingRingAcquire(&ring) == -1);
+
+        stagingRingComplete(&ring, 3);
+        TEST_CHECK(ctx, stagingRingPending(&ring, &slot, &fence) == false);
+        TEST_CHECK(ctx, stagingRingAcquire(&ring) == 2);
+    }
+}
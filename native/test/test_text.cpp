@@ -0,0 +1,209 @@
+#include <string.h>
+#include "../src/compositor.h"
+#include "../src/frame.h"
+#include "../src/pool.h"
+#include "../src/text.h"
+#include "test.h"
+
+typedef struct _TEST_TEXT
+{
+    OVERLAY_DATA overlayData;
+    TEXT_LABEL label;
+} TEST_TEXT;
+
+static bool testTextCreate(
+    TEST_TEXT *text,
+    uint8_t *data,
+    TEXT_FONT font,
+    TEXT_ALIGN align,
+    int32_t x,
+    uint32_t width)
+{
+    memset(data, 0, FRAME_SIZE);
+    overlayDataInit(&text->overlayData, data);
+
+    TEXT_STYLE style = {font, align, {255, 255, 255, 255}};
+    SPRITE_PROPS props = {x, 100, 0, 255, true};
+    return textLabelCreate(&text->overlayData, &text->label, width, 80, &style, &props);
+}
+
+static uint32_t testTextSet(TEST_TEXT *text, const char *utf8)
+{
+    return textLabelSet(&text->overlayData, &text->label, utf8, strlen(utf8));
+}
+
+static bool testTextIs(const TEST_TEXT *text, const char *codepoints)
+{
+    auto count = (uint32_t)strlen(codepoints);
+    if (text->label.glyphCount != count)
+    {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (text->label.glyphs[i]->codepoint != (uint8_t)codepoints[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// drawn incrementally or from scratch, the same pixels
+static bool testTextSameAs(TEST_TEXT *text, uint8_t *data, const char *utf8)
+{
+    TEST_TEXT fresh;
+    auto label = &text->label;
+    if (testTextCreate(&fresh, data, label->style.font, label->style.align, 0, label->width) == false)
+    {
+        return false;
+    }
+    testTextSet(&fresh, utf8);
+
+    auto isSame = memcmp(
+                      compositorSpritePixels(&text->overlayData, label->spriteId),
+                      compositorSpritePixels(&fresh.overlayData, fresh.label.spriteId),
+                      label->width * label->height * 4) == 0;
+    textLabelDestroy(&fresh.overlayData, &fresh.label);
+    return isSame;
+}
+
+void testText(TEST_CONTEXT *ctx)
+{
+    auto data = (uint8_t *)poolAlloc(true);
+    auto scratch = (uint8_t *)poolAlloc(true);
+    TEST_CHECK(ctx, data != NULL && scratch != NULL);
+    if (data == NULL || scratch == NULL)
+    {
+        poolFree(data);
+        poolFree(scratch);
+        return;
+    }
+
+    TEST_TEXT text;
+
+    if (testBegin(ctx, "text/utf8") != false)
+    {
+        TEST_CHECK(ctx, testTextCreate(&text, data, TEXT_FONT_TEXT, TEXT_ALIGN_LEFT, 0, 400));
+
+        testTextSet(&text, "a\xc2\xb0\xe2\x80\xa2\xe2\x80\xa6");
+        TEST_CHECK(ctx, text.label.glyphCount == 4);
+        TEST_CHECK(ctx, text.label.glyphs[0]->codepoint == 'a');
+        TEST_CHECK(ctx, text.label.glyphs[1]->codepoint == 0xb0);
+        TEST_CHECK(ctx, text.label.glyphs[2]->codepoint == 0x2022);
+        TEST_CHECK(ctx, text.label.glyphs[3]->codepoint == 0x2026);
+
+        // each malformed sequence is one U+FFFD, which the font draws as '?'
+        testTextSet(&text, "\xff" "a\x80" "b");
+        TEST_CHECK(ctx, testTextIs(&text, "?a?b"));
+        testTextSet(&text, "\xc0\x80" "c\xe0\x80\xaf"); // overlong
+        TEST_CHECK(ctx, testTextIs(&text, "?c?"));
+        testTextSet(&text, "\xf4\x90\x80\x80" "d"); // past U+10FFFF
+        TEST_CHECK(ctx, testTextIs(&text, "?d"));
+        testTextSet(&text, "\xe2\x80" "A\xe2"); // cut short, the next byte kept
+        TEST_CHECK(ctx, testTextIs(&text, "?A?"));
+        testTextSet(&text, "\xf0\x9f\x98\x80"); // valid, not in the atlas
+        TEST_CHECK(ctx, testTextIs(&text, "?"));
+
+        TEST_CHECK(ctx, textMeasure(TEXT_FONT_TEXT, "\xff", 1) == textMeasure(TEXT_FONT_TEXT, "?", 1));
+        TEST_CHECK(ctx, textMeasure(TEXT_FONT_TEXT, "", 0) == 0);
+
+        textLabelDestroy(&text.overlayData, &text.label);
+    }
+
+    // '?' stands in for what the font lacks, unless it lacks '?' too
+    if (testBegin(ctx, "text/missing") != false)
+    {
+        TEST_CHECK(ctx, testTextCreate(&text, data, TEXT_FONT_CLOCK, TEXT_ALIGN_LEFT, 0, 400));
+
+        testTextSet(&text, "12?x:30");
+        TEST_CHECK(ctx, testTextIs(&text, "12:30"));
+        TEST_CHECK(ctx, textMeasure(TEXT_FONT_CLOCK, "1x2", 3) == textMeasure(TEXT_FONT_CLOCK, "12", 2));
+        TEST_CHECK(ctx, textMeasure(TEXT_FONT_TEXT, "\xc3\xa9", 2) == textMeasure(TEXT_FONT_TEXT, "?", 1));
+        TEST_CHECK(ctx, textMeasure((TEXT_FONT)TEXT_FONT_COUNT, "1", 1) == 0);
+
+        textLabelDestroy(&text.overlayData, &text.label);
+    }
+
+    // a changed glyph redraws its own ink, a shifted line all of it
+    if (testBegin(ctx, "text/dirty") != false)
+    {
+        TEST_CHECK(ctx, testTextCreate(&text, data, TEXT_FONT_CLOCK, TEXT_ALIGN_LEFT, 0, 400));
+        auto label = &text.label;
+        auto full = label->width * label->height;
+
+        uint32_t x, y, width, height;
+        frameTakeDamage(&text.overlayData, &x, &y, &width, &height);
+
+        auto area = testTextSet(&text, "12:30");
+        TEST_CHECK(ctx, area != 0 && area < full);
+        TEST_CHECK(ctx, testTextSet(&text, "12:30") == 0);
+        TEST_CHECK(ctx, frameTakeDamage(&text.overlayData, &x, &y, &width, &height));
+        TEST_CHECK(ctx, frameTakeDamage(&text.overlayData, &x, &y, &width, &height) == false);
+
+        // only the last digit's ink, in whole tiles of the frame
+        auto pen = label->pens[4];
+        auto last = label->glyphs[4];
+        area = testTextSet(&text, "12:31");
+        TEST_CHECK(ctx, area != 0 && area * 4 < full);
+        TEST_CHECK(ctx, frameTakeDamage(&text.overlayData, &x, &y, &width, &height));
+        TEST_CHECK(ctx, x >= (uint32_t)(pen + last->left) / FRAME_TILE_SIZE * FRAME_TILE_SIZE);
+        TEST_CHECK(ctx, testTextSameAs(&text, scratch, "12:31"));
+
+        // shorter: what's left of the old string is cleared
+        testTextSet(&text, "1");
+        TEST_CHECK(ctx, label->glyphCount == 1);
+        TEST_CHECK(ctx, testTextSameAs(&text, scratch, "1"));
+        testTextSet(&text, "");
+        TEST_CHECK(ctx, label->glyphCount == 0);
+        TEST_CHECK(ctx, testTextSameAs(&text, scratch, ""));
+        TEST_CHECK(ctx, frameIsEmpty(&text.overlayData));
+
+        textLabelDestroy(&text.overlayData, &text.label);
+
+        // centred, a longer string moves every glyph
+        TEST_CHECK(ctx, testTextCreate(&text, data, TEXT_FONT_CLOCK, TEXT_ALIGN_CENTER, 0, 400));
+        testTextSet(&text, "1:30");
+        auto before = text.label.pens[0];
+        testTextSet(&text, "11:30");
+        TEST_CHECK(ctx, text.label.pens[0] < before);
+        TEST_CHECK(ctx, testTextSameAs(&text, scratch, "11:30"));
+
+        textLabelDestroy(&text.overlayData, &text.label);
+    }
+
+    // cut at the box, at TEXT_MAX_GLYPHS and at the frame edge
+    if (testBegin(ctx, "text/clip") != false)
+    {
+        char line[TEXT_MAX_GLYPHS + 40];
+        memset(line, 'W', sizeof(line) - 1);
+        line[sizeof(line) - 1] = 0;
+
+        TEST_CHECK(ctx, testTextCreate(&text, data, TEXT_FONT_TEXT, TEXT_ALIGN_LEFT, FRAME_WIDTH - 60, 200));
+        auto area = testTextSet(&text, line);
+        TEST_CHECK(ctx, text.label.glyphCount == TEXT_MAX_GLYPHS);
+        TEST_CHECK(ctx, area <= text.label.width * text.label.height);
+
+        // the sprite hangs off the right edge, the frame only gets its part
+        uint32_t x, y, width, height;
+        TEST_CHECK(ctx, frameTakeDamage(&text.overlayData, &x, &y, &width, &height));
+        TEST_CHECK(ctx, x + width <= FRAME_WIDTH && x >= (FRAME_WIDTH - 60) / FRAME_TILE_SIZE * FRAME_TILE_SIZE);
+        TEST_CHECK(ctx, frameIsEmpty(&text.overlayData) == false);
+        textLabelDestroy(&text.overlayData, &text.label);
+
+        // right aligned past the left of the box, and the box past the
+        // left of the frame
+        TEST_CHECK(ctx, testTextCreate(&text, data, TEXT_FONT_TEXT, TEXT_ALIGN_RIGHT, -100, 150));
+        area = testTextSet(&text, line);
+        TEST_CHECK(ctx, text.label.pens[0] < 0);
+        TEST_CHECK(ctx, area != 0 && area <= text.label.width * text.label.height);
+        TEST_CHECK(ctx, frameTakeDamage(&text.overlayData, &x, &y, &width, &height));
+        TEST_CHECK(ctx, x == 0 && width <= 64);
+        TEST_CHECK(ctx, testTextSameAs(&text, scratch, line));
+        textLabelDestroy(&text.overlayData, &text.label);
+    }
+
+    poolFree(scratch);
+    poolFree(data);
+}
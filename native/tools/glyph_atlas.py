@@ -0,0 +1,397 @@
+#!/usr/bin/env python3
+# rasterizes the glyphs the native text layer needs from a truetype font
+# into one alpha8 atlas and writes it out as a c header.
+#
+#   glyph_atlas.py <font.ttf> <glyph_atlas.h>
+#
+# run by the glyph_atlas target in binding.gyp. standard library only, so
+# the build needs nothing beyond the python node-gyp already uses.
+
+import math
+import struct
+import sys
+
+ATLAS_WIDTH = 512
+GLYPH_PADDING = 1
+CURVE_TOLERANCE = 0.25  # max distance of a flattened curve from the real one, pixels
+
+# (enum name, pixel size, codepoints); order matches TEXT_FONT in text.h
+FONTS = [
+    ('TEXT', 24, [c for c in range(0x20, 0x7f)] + [0xb0, 0x2022, 0x2026]),
+    ('CLOCK', 64, [ord(c) for c in ' %-./0123456789:AMP']),
+]
+
+
+class Font:
+    def __init__(self, data):
+        self.data = data
+        self.tables = {}
+        count = struct.unpack_from('>H', data, 4)[0]
+        for i in range(count):
+            tag, _, offset, length = struct.unpack_from('>4sIII', data, 12 + i * 16)
+            self.tables[tag.decode('latin-1')] = (offset, length)
+
+        head = self.tables['head'][0]
+        self.unitsPerEm = struct.unpack_from('>H', data, head + 18)[0]
+        locFormat = struct.unpack_from('>h', data, head + 50)[0]
+
+        glyphCount = struct.unpack_from('>H', data, self.tables['maxp'][0] + 4)[0]
+
+        hhea = self.tables['hhea'][0]
+        self.ascender, self.descender, self.lineGap = struct.unpack_from('>hhh', data, hhea + 4)
+        metricCount = struct.unpack_from('>H', data, hhea + 34)[0]
+
+        hmtx = self.tables['hmtx'][0]
+        self.advances = [struct.unpack_from('>H', data, hmtx + i * 4)[0] for i in range(metricCount)]
+
+        loca = self.tables['loca'][0]
+        if locFormat == 0:
+            self.loca = [struct.unpack_from('>H', data, loca + i * 2)[0] * 2 for i in range(glyphCount + 1)]
+        else:
+            self.loca = [struct.unpack_from('>I', data, loca + i * 4)[0] for i in range(glyphCount + 1)]
+
+        self.cmap = self.readCmap()
+
+    def readCmap(self):
+        data = self.data
+        cmap = self.tables['cmap'][0]
+        count = struct.unpack_from('>H', data, cmap + 2)[0]
+        subtable = None
+        for i in range(count):
+            platform, encoding, offset = struct.unpack_from('>HHI', data, cmap + 4 + i * 8)
+            if (platform, encoding) in ((3, 1), (0, 3)) and \
+                    struct.unpack_from('>H', data, cmap + offset)[0] == 4:
+                subtable = cmap + offset
+                break
+        if subtable is None:
+            raise ValueError('no format 4 unicode cmap')
+
+        segCount = struct.unpack_from('>H', data, subtable + 6)[0] // 2
+        ends = subtable + 14
+        starts = ends + segCount * 2 + 2
+        deltas = starts + segCount * 2
+        rangeOffsets = deltas + segCount * 2
+
+        result = {}
+        for i in range(segCount):
+            end = struct.unpack_from('>H', data, ends + i * 2)[0]
+            start = struct.unpack_from('>H', data, starts + i * 2)[0]
+            delta = struct.unpack_from('>h', data, deltas + i * 2)[0]
+            rangeOffset = struct.unpack_from('>H', data, rangeOffsets + i * 2)[0]
+            for c in range(start, end + 1):
+                if c == 0xffff:
+                    continue
+                if rangeOffset == 0:
+                    glyph = (c + delta) & 0xffff
+                else:
+                    at = rangeOffsets + i * 2 + rangeOffset + (c - start) * 2
+                    glyph = struct.unpack_from('>H', data, at)[0]
+                    if glyph != 0:
+                        glyph = (glyph + delta) & 0xffff
+                if glyph != 0:
+                    result[c] = glyph
+        return result
+
+    def advance(self, glyph):
+        return self.advances[min(glyph, len(self.advances) - 1)]
+
+    # list of contours, each a list of (x, y, isOnCurve) in font units
+    def contours(self, glyph):
+        data = self.data
+        start = self.tables['glyf'][0] + self.loca[glyph]
+        if self.loca[glyph + 1] == self.loca[glyph]:
+            return []
+
+        contourCount = struct.unpack_from('>h', data, start)[0]
+        at = start + 10
+
+        if contourCount < 0:
+            return self.compositeContours(at)
+
+        ends = struct.unpack_from('>%dH' % contourCount, data, at)
+        at += contourCount * 2
+        pointCount = ends[-1] + 1 if contourCount > 0 else 0
+        at += 2 + struct.unpack_from('>H', data, at)[0]
+
+        flags = []
+        while len(flags) < pointCount:
+            flag = data[at]
+            at += 1
+            flags.append(flag)
+            if flag & 0x08:
+                flags.extend([flag] * data[at])
+                at += 1
+
+        def coords(at, short, same):
+            values = []
+            value = 0
+            for flag in flags:
+                if flag & short:
+                    delta = data[at]
+                    at += 1
+                    value += delta if flag & same else -delta
+                elif not flag & same:
+                    value += struct.unpack_from('>h', data, at)[0]
+                    at += 2
+                values.append(value)
+            return values, at
+
+        xs, at = coords(at, 0x02, 0x10)
+        ys, at = coords(at, 0x04, 0x20)
+
+        result = []
+        first = 0
+        for end in ends:
+            result.append([(xs[i], ys[i], flags[i] & 1 != 0) for i in range(first, end + 1)])
+            first = end + 1
+        return result
+
+    def compositeContours(self, at):
+        data = self.data
+        result = []
+        while True:
+            flags, glyph = struct.unpack_from('>HH', data, at)
+            at += 4
+            if flags & 0x01:
+                dx, dy = struct.unpack_from('>hh', data, at)
+                at += 4
+            else:
+                dx, dy = struct.unpack_from('>bb', data, at)
+                at += 2
+            if not flags & 0x02:
+                # point matching, never used by the glyphs we take
+                dx = dy = 0
+
+            a, b, c, d = 1.0, 0.0, 0.0, 1.0
+            if flags & 0x08:
+                a = d = struct.unpack_from('>h', data, at)[0] / 16384.0
+                at += 2
+            elif flags & 0x40:
+                a, d = [v / 16384.0 for v in struct.unpack_from('>hh', data, at)]
+                at += 4
+            elif flags & 0x80:
+                a, b, c, d = [v / 16384.0 for v in struct.unpack_from('>hhhh', data, at)]
+                at += 8
+
+            for contour in self.contours(glyph):
+                result.append([(x * a + y * c + dx, x * b + y * d + dy, on) for x, y, on in contour])
+
+            if not flags & 0x20:
+                return result
+
+
+# quadratic contours to closed polylines, in pixels with y down
+def flatten(contours, scale):
+    lines = []
+    for contour in contours:
+        points = [(x * scale, -y * scale, on) for x, y, on in contour]
+        if not points:
+            continue
+
+        # start on an on-curve point, implied between two off-curve ones
+        start = next((i for i, p in enumerate(points) if p[2]), None)
+        if start is None:
+            a, b = points[0], points[1 % len(points)]
+            points.insert(0, ((a[0] + b[0]) / 2, (a[1] + b[1]) / 2, True))
+            start = 0
+        points = points[start:] + points[:start] + [points[start]]
+
+        polyline = [points[0][:2]]
+        control = None
+        for x, y, on in points[1:]:
+            if on:
+                if control is None:
+                    polyline.append((x, y))
+                else:
+                    curve(polyline, control, (x, y))
+                    control = None
+            else:
+                if control is not None:
+                    middle = ((control[0] + x) / 2, (control[1] + y) / 2)
+                    curve(polyline, control, middle)
+                control = (x, y)
+
+        lines.append(polyline)
+    return lines
+
+
+def curve(polyline, control, end):
+    x0, y0 = polyline[-1]
+    ddx = x0 - 2 * control[0] + end[0]
+    ddy = y0 - 2 * control[1] + end[1]
+    steps = max(1, int(math.ceil(math.sqrt(math.hypot(ddx, ddy) / (4 * CURVE_TOLERANCE)))))
+    for i in range(1, steps + 1):
+        t = i / steps
+        u = 1 - t
+        polyline.append((
+            u * u * x0 + 2 * u * t * control[0] + t * t * end[0],
+            u * u * y0 + 2 * u * t * control[1] + t * t * end[1]))
+
+
+# signed area accumulation, exact coverage for polygons (non-zero winding
+# approximated by clamping the absolute winding sum)
+def rasterize(polylines, width, height):
+    acc = [0.0] * (width * height + 4)
+
+    def line(x0, y0, x1, y1):
+        if y0 == y1:
+            return
+        direction = 1.0
+        if y0 > y1:
+            direction = -1.0
+            x0, y0, x1, y1 = x1, y1, x0, y0
+        dxdy = (x1 - x0) / (y1 - y0)
+        x = x0
+        if y0 < 0:
+            x -= y0 * dxdy
+        for y in range(max(0, int(y0)), min(height, int(math.ceil(y1)))):
+            row = y * width
+            dy = min(y + 1, y1) - max(y, y0)
+            xnext = x + dxdy * dy
+            d = dy * direction
+            xa, xb = (x, xnext) if x < xnext else (xnext, x)
+            xaFloor = math.floor(xa)
+            xai = int(xaFloor)
+            xbCeil = math.ceil(xb)
+            xbi = int(xbCeil)
+            if xbi <= xai + 1:
+                xmf = 0.5 * (x + xnext) - xaFloor
+                acc[row + xai] += d - d * xmf
+                acc[row + xai + 1] += d * xmf
+            else:
+                s = 1.0 / (xb - xa)
+                xaf = xa - xaFloor
+                a0 = 0.5 * s * (1.0 - xaf) * (1.0 - xaf)
+                xbf = xb - xbCeil + 1.0
+                am = 0.5 * s * xbf * xbf
+                acc[row + xai] += d * a0
+                if xbi == xai + 2:
+                    acc[row + xai + 1] += d * (1.0 - a0 - am)
+                else:
+                    a1 = s * (1.5 - xaf)
+                    acc[row + xai + 1] += d * (a1 - a0)
+                    for xi in range(xai + 2, xbi - 1):
+                        acc[row + xi] += d * s
+                    a2 = a1 + (xbi - xai - 3) * s
+                    acc[row + xbi - 1] += d * (1.0 - a2 - am)
+                acc[row + xbi] += d * am
+            x = xnext
+
+    for polyline in polylines:
+        for (x0, y0), (x1, y1) in zip(polyline, polyline[1:]):
+            line(x0, y0, x1, y1)
+
+    coverage = bytearray(width * height)
+    total = 0.0
+    for i in range(width * height):
+        total += acc[i]
+        coverage[i] = int(min(1.0, abs(total)) * 255.0 + 0.5)
+    return coverage
+
+
+def renderGlyph(font, codepoint, size):
+    glyph = font.cmap.get(codepoint)
+    if glyph is None:
+        raise ValueError('U+%04X is not in the font' % codepoint)
+
+    scale = size / font.unitsPerEm
+    advance = int(round(font.advance(glyph) * scale))
+    polylines = flatten(font.contours(glyph), scale)
+    points = [p for polyline in polylines for p in polyline]
+    if not points:
+        return dict(codepoint=codepoint, width=0, height=0, left=0, top=0,
+                    advance=advance, coverage=bytearray())
+
+    left = int(math.floor(min(p[0] for p in points)))
+    top = int(math.floor(min(p[1] for p in points)))
+    width = int(math.ceil(max(p[0] for p in points))) - left
+    height = int(math.ceil(max(p[1] for p in points))) - top
+
+    moved = [[(x - left, y - top) for x, y in polyline] for polyline in polylines]
+    return dict(codepoint=codepoint, width=width, height=height, left=left,
+                top=-top, advance=advance, coverage=rasterize(moved, width, height))
+
+
+# shelf packing, tallest first
+def pack(glyphs):
+    order = sorted(glyphs, key=lambda g: (-g['height'], -g['width']))
+    x = y = shelf = 0
+    for glyph in order:
+        if glyph['width'] == 0:
+            glyph['x'] = glyph['y'] = 0
+            continue
+        w = glyph['width'] + GLYPH_PADDING
+        if x + w > ATLAS_WIDTH:
+            x = 0
+            y += shelf
+            shelf = 0
+        glyph['x'] = x
+        glyph['y'] = y
+        x += w
+        shelf = max(shelf, glyph['height'] + GLYPH_PADDING)
+    return y + shelf
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit('usage: glyph_atlas.py <font.ttf> <glyph_atlas.h>')
+
+    with open(sys.argv[1], 'rb') as f:
+        font = Font(f.read())
+
+    fonts = []
+    glyphs = []
+    for name, size, codepoints in FONTS:
+        rendered = [renderGlyph(font, c, size) for c in sorted(set(codepoints))]
+        scale = size / font.unitsPerEm
+        fonts.append(dict(
+            name=name,
+            size=size,
+            ascent=int(math.ceil(font.ascender * scale)),
+            descent=int(math.ceil(-font.descender * scale)),
+            lineHeight=int(math.ceil((font.ascender - font.descender + font.lineGap) * scale)),
+            first=len(glyphs),
+            count=len(rendered)))
+        glyphs.extend(rendered)
+
+    height = pack(glyphs)
+    atlas = bytearray(ATLAS_WIDTH * height)
+    for glyph in glyphs:
+        for row in range(glyph['height']):
+            at = (glyph['y'] + row) * ATLAS_WIDTH + glyph['x']
+            atlas[at:at + glyph['width']] = \
+                glyph['coverage'][row * glyph['width']:(row + 1) * glyph['width']]
+
+    out = []
+    out.append('// generated by tools/glyph_atlas.py, do not edit')
+    out.append('#pragma once')
+    out.append('')
+    out.append('#define GLYPH_ATLAS_WIDTH %d' % ATLAS_WIDTH)
+    out.append('#define GLYPH_ATLAS_HEIGHT %d' % height)
+    out.append('')
+    out.append('static const GLYPH glyphAtlasGlyphs_[] = {')
+    for glyph in glyphs:
+        out.append('    {0x%04x, %d, %d, %d, %d, %d, %d, %d},' % (
+            glyph['codepoint'], glyph['x'], glyph['y'], glyph['width'],
+            glyph['height'], glyph['left'], glyph['top'], glyph['advance']))
+    out.append('};')
+    out.append('')
+    out.append('static const GLYPH_FONT glyphAtlasFonts_[] = {')
+    for f in fonts:
+        out.append('    {%d, %d, %d, %d, %d, glyphAtlasGlyphs_ + %d}, // %s' % (
+            f['size'], f['ascent'], f['descent'], f['lineHeight'], f['count'],
+            f['first'], f['name']))
+    out.append('};')
+    out.append('')
+    out.append('static const uint8_t glyphAtlasPixels_[GLYPH_ATLAS_WIDTH * GLYPH_ATLAS_HEIGHT] = {')
+    for i in range(0, len(atlas), 32):
+        out.append('    ' + ','.join(str(v) for v in atlas[i:i + 32]) + ',')
+    out.append('};')
+    out.append('')
+
+    with open(sys.argv[2], 'w', newline='\n') as f:
+        f.write('\n'.join(out))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,65 @@
+import * as native from "native";
+import * as mainWindow from "./window/main";
+
+// ms from the playGame request to each milestone of a launch
+export interface GameLaunchPhases {
+  spawnMs: number; // steam started
+  detectMs?: number; // the game process showed up
+  readyMs?: number; // "VRC Analytics Initialized" was logged
+}
+
+// a launch nobody finished in this long is dropped
+const launchTimeoutMs = 10 * 60 * 1000;
+
+let pending: { startedAt: number; phases: GameLaunchPhases } | undefined =
+  void 0;
+
+function current() {
+  if (
+    pending !== void 0 &&
+    performance.now() - pending.startedAt > launchTimeoutMs
+  ) {
+    pending = void 0;
+  }
+
+  return pending;
+}
+
+function report(phases: GameLaunchPhases) {
+  console.info(`[playGame] ${JSON.stringify(phases)}`);
+  mainWindow.send("native:gameLaunch", phases);
+}
+
+export async function playGame(arg: string): Promise<boolean> {
+  const startedAt = performance.now();
+  const { isLaunched, spawnMs } = await native.playGame(arg);
+  if (!isLaunched) {
+    return false;
+  }
+
+  pending = { startedAt, phases: { spawnMs } };
+  report(pending.phases);
+  return true;
+}
+
+export function markDetected() {
+  const launch = current();
+  if (launch === void 0 || launch.phases.detectMs !== void 0) {
+    return;
+  }
+
+  launch.phases.detectMs = performance.now() - launch.startedAt;
+  report(launch.phases);
+}
+
+export function markReady() {
+  // only after the game this launch started was seen
+  const launch = current();
+  if (launch === void 0 || launch.phases.detectMs === void 0) {
+    return;
+  }
+
+  launch.phases.readyMs = performance.now() - launch.startedAt;
+  report(launch.phases);
+  pending = void 0;
+}
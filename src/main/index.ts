@@ -2,7 +2,10 @@ import * as electron from "electron";
 import * as native from "native";
 import * as util from "../common/util";
 import * as pubsub from "../common/pubsub";
+import * as gameLaunch from "./game-launch";
 import * as global from "./global";
+import * as nativeLog from "./native-log";
+import * as processMonitor from "./process-monitor";
 import * as tray from "./tray";
 import * as mainWindow from "./window/main";
 import * as overlayHmdWindow from "./window/overlay-hmd";
@@ -76,6 +79,8 @@ import * as vrchatLogWatcher from "./vrchat-log-watcher";
   app.on("ready", () => {
     try {
       tray.create();
+      nativeLog.setup();
+      processMonitor.setup();
       mainWindow.create();
       // overlayHmdWindow.create();
       // overlayWristWindow.create();
@@ -90,6 +95,8 @@ import * as vrchatLogWatcher from "./vrchat-log-watcher";
     mainWindow.destroy();
     overlayHmdWindow.destroy();
     overlayWristWindow.destroy();
+    nativeLog.destroy();
+    processMonitor.destroy();
   });
 
   app.on("quit", () => tray.destroy());
@@ -103,9 +110,28 @@ import * as vrchatLogWatcher from "./vrchat-log-watcher";
     setImmediate(() => app.quit());
   });
 
-  ipcMain.handle("native:getRunningApp", () => native.getRunningApp());
-  ipcMain.handle("native:playGame", (_e, arg) => native.playGame(arg));
+  ipcMain.handle("native:getRunningApp", () =>
+    processMonitor.getRunningApp()
+  );
+  ipcMain.handle("native:playGame", (_e, arg) => gameLaunch.playGame(arg));
   ipcMain.handle("native:startOverlay", () => native.startOverlay());
   ipcMain.handle("native:stopOverlay", () => native.stopOverlay());
   ipcMain.handle("native:getVRDeviceList", () => native.getVRDeviceList());
+  ipcMain.handle("native:getOverlayStats", () => native.getOverlayStats());
+  ipcMain.handle("native:getResourceSamples", () =>
+    native.getResourceSamples()
+  );
+  ipcMain.handle("native:startPaintRecord", (_e, path) =>
+    native.startPaintRecord(path)
+  );
+  ipcMain.handle("native:stopPaintRecord", () => native.stopPaintRecord());
+  ipcMain.handle("native:captureOverlayFrame", (_e, target) =>
+    native.captureOverlayFrame(target)
+  );
+
+  native.setOverlayWatchdog(1000, (stall) => {
+    const state = stall.isResolved ? "recovered" : "stalled";
+    const duration = Math.round(stall.durationMs);
+    console.warn(`overlay ${state}: ${stall.phase} (${duration}ms)`);
+  });
 })();
@@ -0,0 +1,60 @@
+import * as native from "native";
+
+let timer: NodeJS.Timeout | undefined = void 0;
+
+function print(record: native.NativeLogRecord) {
+  const time = new Date(record.time).toISOString();
+  const args = record.args.join(", ");
+  const repeat = record.count > 1 ? ` x${record.count}` : "";
+  const text = `[native] ${time} ${record.code}(${args})${repeat}`;
+
+  switch (record.level) {
+    case "error":
+      console.error(text);
+      break;
+
+    case "warn":
+      console.warn(text);
+      break;
+
+    case "info":
+      console.info(text);
+      break;
+
+    default:
+      console.debug(text);
+      break;
+  }
+}
+
+function drain() {
+  for (;;) {
+    const records = native.drainNativeLog();
+    if (records.length === 0) {
+      break;
+    }
+
+    for (const record of records) {
+      print(record);
+    }
+  }
+}
+
+export function setup() {
+  if (timer !== void 0) {
+    return;
+  }
+
+  timer = setInterval(drain, 1000);
+  timer.unref();
+}
+
+export function destroy() {
+  if (timer === void 0) {
+    return;
+  }
+
+  clearInterval(timer);
+  timer = void 0;
+  drain();
+}
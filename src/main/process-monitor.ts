@@ -0,0 +1,54 @@
+import * as native from "native";
+import * as gameLaunch from "./game-launch";
+import * as mainWindow from "./window/main";
+
+// executable names as the monitor sees them: VRChat runs under Proton on
+// linux with its .exe name, SteamVR's server is native there
+const watched: [string, keyof native.RunningApp][] = [
+  ["VRChat.exe", "vrchat"],
+  ["vrserver.exe", "steamvr"],
+  ["vrserver", "steamvr"],
+];
+
+// how often the processes above are sampled while they run
+const sampleIntervalMs = 1000;
+
+const running = new Map<number, keyof native.RunningApp>();
+
+export function getRunningApp(): native.RunningApp {
+  const app: native.RunningApp = { vrchat: false, steamvr: false };
+  for (const key of running.values()) {
+    app[key] = true;
+  }
+  return app;
+}
+
+export function setup() {
+  native.setResourceSampler(sampleIntervalMs);
+  native.setProcessMonitor(
+    watched.map(([name]) => name),
+    ({ name, pid, isRunning }) => {
+      const entry = watched.find(([watchedName]) => watchedName === name);
+      if (entry === void 0) {
+        return;
+      }
+
+      if (isRunning) {
+        running.set(pid, entry[1]);
+        if (entry[1] === "vrchat") {
+          gameLaunch.markDetected();
+        }
+      } else {
+        running.delete(pid);
+      }
+
+      mainWindow.send("native:runningApp", getRunningApp());
+    }
+  );
+}
+
+export function destroy() {
+  native.setProcessMonitor();
+  native.setResourceSampler();
+  running.clear();
+}
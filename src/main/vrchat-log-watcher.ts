@@ -3,6 +3,7 @@ import * as path from "path";
 import * as electron from "electron";
 import * as util from "../common/util";
 import { VRChatLogType } from "../common/constants";
+import * as gameLaunch from "./game-launch";
 import * as mainWindow from "./window/main";
 
 interface LogFile {
@@ -270,6 +271,7 @@ function parseLog(ctx: LogFile, text: string, line: number) {
         } else if (text.startsWith("VRC Analytics Initialized", p)) {
           ctx.rows.push([line, time, VRChatLogType.Init]);
           ctx.isActive = true;
+          gameLaunch.markReady();
         }
         break;
     }
@@ -48,7 +48,14 @@ export function create() {
     )
   );
 
+  // starts at full rate, then follows what the native governor picks from
+  // damage, visibility and whether the headset is worn
   window.webContents.setFrameRate(30);
+  native.setOverlayGovernor(void 0, ({ ingestFps }) =>
+    window?.webContents.setFrameRate(ingestFps)
+  );
+  // trails the head natively instead of being bolted to it
+  native.setOverlayFollow(native.OverlayTarget.HMD, {});
   window.webContents.openDevTools();
 
   // window.loadURL(
@@ -59,6 +66,8 @@ export function create() {
 }
 
 export function destroy() {
+  native.setOverlayGovernor();
+  native.setOverlayFollow(native.OverlayTarget.HMD);
   try {
     window?.destroy();
     window = void 0;